@@ -291,6 +291,17 @@ FUNCTION(add_allpix_test)
         SET_PROPERTY(TEST ${TEST_NAME} PROPERTY LABELS "${TESTLABEL}")
     ENDIF()
 
+    # Allow to skip tests if their requirements are not available at runtime
+    FILE(STRINGS ${TEST_FILE} TESTSKIP REGEX "#SKIP ")
+    FOREACH(skip ${TESTSKIP})
+        STRING(REPLACE "#SKIP " "" skip "${skip}")
+        ESCAPE_REGEX("${skip}" skip)
+        SET_PROPERTY(
+            TEST ${TEST_NAME}
+            APPEND
+            PROPERTY SKIP_REGULAR_EXPRESSION "${skip}")
+    ENDFOREACH()
+
     # Add required files if specified
     FILE(STRINGS ${TEST_FILE} TESTDATA REGEX "#DATA ")
     IF(TESTDATA)
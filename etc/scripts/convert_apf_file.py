@@ -0,0 +1,64 @@
+# SPDX-FileCopyrightText: 2023 CERN and the Allpix Squared authors
+# SPDX-License-Identifier: MIT
+
+# Rewrite a field stored on a regular grid in an APF file with a different version of the APF format. The file layout is
+# read and written independently of the serialization in the framework, such that files of older versions can be created
+# for testing the readers.
+
+import argparse
+import struct
+
+# Alignment of the payload in APF files from version 2 on
+PAYLOAD_ALIGNMENT = 4096
+
+
+def read_apf(data):
+    endianness = "<" if data[0] == 1 else ">"
+    offset = 1
+
+    def read(fmt):
+        nonlocal offset
+        values = struct.unpack_from(endianness + fmt, data, offset)
+        offset += struct.calcsize(endianness + fmt)
+        return values
+
+    (version,) = read("I")
+    if version < 2:
+        raise ValueError("APF version {} is not supported".format(version))
+    (header_length,) = read("Q")
+    header = data[offset : offset + header_length]
+    offset += header_length
+    dimensions = read("3Q")
+    size = read("3d")
+    nodes = read("Q")[0] if version >= 3 else 0
+    if nodes != 0:
+        raise ValueError("fields stored as adaptive grid cannot be converted")
+    count, padding = read("2Q")
+    offset += padding
+    values = read("{}d".format(count))
+    return header, dimensions, size, values
+
+
+def write_apf(version, header, dimensions, size, values):
+    preamble = struct.pack("<BIQ", 1, version, len(header)) + header
+    preamble += struct.pack("<3Q3d", *dimensions, *size)
+    if version >= 3:
+        preamble += struct.pack("<Q", 0)
+    # Account for the number of values and the padding size which follow:
+    offset = len(preamble) + 2 * struct.calcsize("<Q")
+    padding = (PAYLOAD_ALIGNMENT - offset % PAYLOAD_ALIGNMENT) % PAYLOAD_ALIGNMENT
+    preamble += struct.pack("<2Q", len(values), padding)
+    return preamble + bytes(padding) + struct.pack("<{}d".format(len(values)), *values)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--input", help="APF file to read", required=True)
+    parser.add_argument("--output", help="APF file to write", required=True)
+    parser.add_argument("--version", help="APF format version to write", type=int, choices=[2, 3], default=2)
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as file:
+        field = read_apf(file.read())
+    with open(args.output, "wb") as file:
+        file.write(write_apf(args.version, *field))
@@ -24,6 +24,7 @@
 #include <TRandom.h>
 #include <TStyle.h>
 #include <TSystem.h>
+#include <TTreeCacheUnzip.h>
 
 #include "core/config/exceptions.h"
 #include "core/utils/log.h"
@@ -149,6 +150,11 @@ void Allpix::load() {
         global_config.set<uint64_t>("random_seed_core", seed + 1, true);
     }
 
+    // Select the engine of the event random number generators, seeds are always derived using the Mersenne Twister
+    auto random_engine = global_config.get<RandomEngine>("random_engine", RandomEngine::MERSENNE_TWISTER);
+    RandomNumberGenerator::setDefaultEngine(random_engine);
+    LOG(DEBUG) << "Using " << allpix::to_string(random_engine) << " engine for event random number generation";
+
     // Get output directory
     std::string directory = gSystem->pwd();
     directory += "/output";
@@ -185,6 +191,15 @@ void Allpix::load() {
     // Required for spawned threads, even with a single worker
     ROOT::EnableThreadSafety();
 
+    // Enable ROOT's implicit multithreading if requested, allowing trees read through a cache to decompress their baskets in
+    // parallel. This changes the state of ROOT for the whole process and can therefore not be done by individual modules
+    auto root_threads = global_config.get<unsigned int>("root_threads", 0);
+    if(root_threads > 0) {
+        LOG(DEBUG) << "Enabling ROOT implicit multithreading with " << root_threads << " threads";
+        ROOT::EnableImplicitMT(root_threads);
+        TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::kEnable);
+    }
+
     // Set the default units to use
     register_units();
 
@@ -96,8 +96,8 @@ namespace allpix {
         std::unique_ptr<GeometryManager> geo_mgr_{};
 
         // Random generators
-        RandomNumberGenerator seeder_modules_;
-        RandomNumberGenerator seeder_core_;
+        RandomNumberGenerator seeder_modules_{RandomEngine::MERSENNE_TWISTER};
+        RandomNumberGenerator seeder_core_{RandomEngine::MERSENNE_TWISTER};
     };
 } // namespace allpix
 
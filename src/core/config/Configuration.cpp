@@ -22,6 +22,8 @@
 
 using namespace allpix;
 
+thread_local bool Configuration::processing_event_ = false;
+
 Configuration::AccessMarker::AccessMarker(const Configuration::AccessMarker& rhs) {
     for(const auto& [key, value] : rhs.markers_) {
         registerMarker(key);
@@ -212,6 +214,34 @@ std::vector<std::string> Configuration::getUnusedKeys() const {
     return result;
 }
 
+void Configuration::freeze() {
+    frozen_ = true;
+    for(const auto& key_value : config_) {
+        frozen_parsed_.registerMarker(key_value.first);
+        frozen_reported_.registerMarker(key_value.first);
+    }
+}
+
+void Configuration::check_frozen(const std::string& key) const {
+#ifndef NDEBUG
+    // Keys set after freezing and keys read outside of event processing are not tracked
+    if(!frozen_ || !processing_event_ || !frozen_parsed_.isRegistered(key)) {
+        return;
+    }
+
+    // A single parse after freezing is accepted, repeated parsing indicates a value accessed per event
+    if(!frozen_parsed_.isUsed(key)) {
+        frozen_parsed_.markUsed(key);
+    } else if(!frozen_reported_.isUsed(key)) {
+        frozen_reported_.markUsed(key);
+        LOG(WARNING) << "Key \"" << key << "\" of frozen configuration \"" << getName()
+                     << "\" is parsed repeatedly, its value should be cached before processing events";
+    }
+#else
+    (void)key;
+#endif
+}
+
 /**
  * String is recursively parsed for all pair of [ and ] brackets. All parts between single or double quotation marks are
  * skipped.
@@ -19,6 +19,7 @@
 #include <stdexcept>
 #include <string>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "core/config/exceptions.h"
@@ -84,11 +85,52 @@ namespace allpix {
              */
             bool isUsed(const std::string& key) { return markers_.at(key).load(); }
 
+            /**
+             * @brief Check whether a key has been registered
+             * @param key Key to check
+             * @return True if a marker for the key exists, false otherwise
+             */
+            bool isRegistered(const std::string& key) const { return markers_.find(key) != markers_.end(); }
+
         private:
             std::map<std::string, std::atomic<bool>> markers_;
         };
 
     public:
+        /**
+         * @brief Handle to a configuration value which has been parsed once into the requested type
+         *
+         * Handles provide access to the typed value without any lookup or string conversion and are meant to be obtained
+         * before processing events. They hold a snapshot of the value at the time the handle was requested.
+         */
+        template <typename T> class Handle {
+            friend class Configuration;
+
+        public:
+            /**
+             * @brief Construct an empty handle not referring to any value
+             */
+            Handle() = default;
+
+            /**
+             * @brief Check whether the handle refers to a value
+             * @return True if the handle was obtained from a configuration, false otherwise
+             */
+            bool valid() const { return value_ != nullptr; }
+
+            /**
+             * @brief Get the parsed value
+             * @return Reference to the value
+             */
+            const T& get() const { return *value_; }
+            const T& operator*() const { return *value_; }
+            const T* operator->() const { return value_.get(); }
+
+        private:
+            explicit Handle(std::shared_ptr<const T> value) : value_(std::move(value)) {}
+            std::shared_ptr<const T> value_;
+        };
+
         /**
          * @brief Construct a configuration object
          * @param name Name of the section header (empty section if not specified)
@@ -141,6 +183,23 @@ namespace allpix {
          */
         template <typename T> T get(const std::string& key, const T& def) const;
 
+        /**
+         * @brief Get a handle to the value of a key parsed into the requested type
+         * @param key Key to get the handle for
+         * @return Handle to the typed value
+         *
+         * The value is parsed when the handle is requested, later changes to the key are not reflected by the handle.
+         */
+        template <typename T> Handle<T> getHandle(const std::string& key) const;
+
+        /**
+         * @brief Get a handle to the value of a key parsed into the requested type, or to a default value
+         * @param key Key to get the handle for
+         * @param def Default value to use if key is not defined
+         * @return Handle to the typed value
+         */
+        template <typename T> Handle<T> getHandle(const std::string& key, const T& def) const;
+
         /**
          * @brief Get values for a key containing an array
          * @param key Key to get values of
@@ -319,7 +378,37 @@ namespace allpix {
          */
         std::vector<std::string> getUnusedKeys() const;
 
+        /**
+         * @brief Freeze the configuration after initialization
+         *
+         * A frozen configuration is not expected to be parsed repeatedly anymore, all values required while processing
+         * events should be cached beforehand or accessed through \ref Handle "handles". In debug builds, keys which are
+         * parsed more than once while processing events after freezing are reported. Values read in the per-thread
+         * initialization or the finalization are not tracked.
+         */
+        void freeze();
+
+        /**
+         * @brief Check whether the configuration has been frozen
+         * @return True if the configuration is frozen, false otherwise
+         */
+        bool isFrozen() const { return frozen_; }
+
+        /**
+         * @brief Mark whether the calling thread is processing an event
+         * @param processing True while a module processes an event, false otherwise
+         *
+         * Only keys parsed while processing events are tracked for frozen configurations.
+         */
+        static void setProcessingEvent(bool processing) { processing_event_ = processing; }
+
     private:
+        /**
+         * @brief Report repeated parsing of a key after the configuration has been frozen (in debug builds only)
+         * @param key Key which is parsed
+         */
+        void check_frozen(const std::string& key) const;
+
         /**
          * @brief Make relative paths absolute from this configuration file
          * @param path Path to make absolute (if it is not already absolute)
@@ -348,6 +437,12 @@ namespace allpix {
         using ConfigMap = std::map<std::string, std::string>;
         ConfigMap config_;
         mutable AccessMarker used_keys_;
+
+        // Markers for parsing after freezing
+        bool frozen_{false};
+        static thread_local bool processing_event_;
+        mutable AccessMarker frozen_parsed_;
+        mutable AccessMarker frozen_reported_;
     };
 } // namespace allpix
 
@@ -19,6 +19,7 @@ namespace allpix {
         try {
             auto node = parse_value(config_.at(key));
             used_keys_.markUsed(key);
+            check_frozen(key);
             try {
                 return allpix::from_string<T>(node->value);
             } catch(std::invalid_argument& e) {
@@ -43,6 +44,22 @@ namespace allpix {
         return def;
     }
 
+    /**
+     * @throws MissingKeyError If the requested key is not defined
+     * @throws InvalidKeyError If the conversion to the requested type did not succeed
+     * @throws InvalidKeyError If an overflow happened while converting the key
+     */
+    template <typename T> Configuration::Handle<T> Configuration::getHandle(const std::string& key) const {
+        return Handle<T>(std::make_shared<const T>(get<T>(key)));
+    }
+    /**
+     * @throws InvalidKeyError If the conversion to the requested type did not succeed
+     * @throws InvalidKeyError If an overflow happened while converting the key
+     */
+    template <typename T> Configuration::Handle<T> Configuration::getHandle(const std::string& key, const T& def) const {
+        return Handle<T>(std::make_shared<const T>(get<T>(key, def)));
+    }
+
     /**
      * @throws MissingKeyError If the requested key is not defined
      * @throws InvalidKeyError If the conversion to the requested type did not succeed
@@ -52,6 +69,7 @@ namespace allpix {
         try {
             std::string str = config_.at(key);
             used_keys_.markUsed(key);
+            check_frozen(key);
 
             std::vector<T> array;
             auto node = parse_value(str);
@@ -91,6 +109,7 @@ namespace allpix {
         try {
             std::string str = config_.at(key);
             used_keys_.markUsed(key);
+            check_frozen(key);
 
             Matrix<T> matrix;
             auto node = parse_value(str);
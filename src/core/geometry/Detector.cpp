@@ -117,18 +117,50 @@ ROOT::Math::XYZVector Detector::getElectricField(const ROOT::Math::XYZPoint& loc
     return electric_field_.get(local_pos);
 }
 
+void Detector::getElectricField(
+    const double* x, const double* y, const double* z, size_t count, ROOT::Math::XYZVector* output) const {
+    electric_field_.get(x, y, z, count, output);
+}
+
 /**
  * @throws std::invalid_argument If the electric field dimensions are incorrect or the thickness domain is outside the sensor
  */
-void Detector::setElectricFieldGrid(const std::shared_ptr<std::vector<double>>& field,
+void Detector::setElectricFieldGrid(std::shared_ptr<const double> field,
+                                    size_t field_size,
                                     std::array<size_t, 3> bins,
                                     std::array<double, 3> size,
                                     FieldMapping mapping,
                                     std::array<double, 2> scales,
                                     std::array<double, 2> offset,
-                                    std::pair<double, double> thickness_domain) {
+                                    std::pair<double, double> thickness_domain,
+                                    bool compile,
+                                    FieldInterpolation interpolation,
+                                    FieldPrecision precision) {
     check_field_match(size, mapping, scales, thickness_domain);
-    electric_field_.setGrid(field, bins, size, mapping, scales, offset, thickness_domain);
+    electric_field_.setGrid(
+        std::move(field), field_size, bins, size, mapping, scales, offset, thickness_domain, interpolation);
+    if(compile || precision != FieldPrecision::DOUBLE) {
+        electric_field_.compile(precision);
+    }
+    LOG(DEBUG) << "Electric field grid occupies " << static_cast<double>(electric_field_.getStorageSize()) / 1024 << "kB";
+}
+
+/**
+ * @throws std::invalid_argument If the electric field octree does not match or the thickness domain is outside the sensor
+ */
+void Detector::setElectricFieldGrid(std::shared_ptr<const FieldOctree<double>> field,
+                                    std::array<double, 3> size,
+                                    FieldMapping mapping,
+                                    std::array<double, 2> scales,
+                                    std::array<double, 2> offset,
+                                    std::pair<double, double> thickness_domain,
+                                    bool compile,
+                                    FieldInterpolation interpolation) {
+    check_field_match(size, mapping, scales, thickness_domain);
+    electric_field_.setGrid(std::move(field), size, mapping, scales, offset, thickness_domain, interpolation);
+    if(compile) {
+        electric_field_.compile();
+    }
 }
 
 void Detector::setElectricFieldFunction(FieldFunction<ROOT::Math::XYZVector> function,
@@ -149,19 +181,54 @@ double Detector::getWeightingPotential(const ROOT::Math::XYZPoint& local_pos, co
     return weighting_potential_.getRelativeTo(local_pos, ref, true);
 }
 
+void Detector::getWeightingPotential(const ROOT::Math::XYZPoint& local_pos,
+                                     const std::vector<ROOT::Math::XYPoint>& references,
+                                     double* potentials) const {
+    weighting_potential_.getRelativeTo(local_pos, references, potentials, true);
+}
+
 /**
  * @throws std::invalid_argument If the weighting potential dimensions are incorrect or the thickness domain is outside the
  * sensor
  */
-void Detector::setWeightingPotentialGrid(const std::shared_ptr<std::vector<double>>& potential,
+void Detector::setWeightingPotentialGrid(std::shared_ptr<const double> potential,
+                                         size_t potential_size,
                                          std::array<size_t, 3> bins,
                                          std::array<double, 3> size,
                                          FieldMapping mapping,
                                          std::array<double, 2> scales,
                                          std::array<double, 2> offset,
-                                         std::pair<double, double> thickness_domain) {
+                                         std::pair<double, double> thickness_domain,
+                                         bool compile,
+                                         FieldInterpolation interpolation,
+                                         FieldPrecision precision) {
     check_field_match(size, mapping, scales, thickness_domain);
-    weighting_potential_.setGrid(potential, bins, size, mapping, scales, offset, thickness_domain);
+    weighting_potential_.setGrid(
+        std::move(potential), potential_size, bins, size, mapping, scales, offset, thickness_domain, interpolation);
+    if(compile || precision != FieldPrecision::DOUBLE) {
+        weighting_potential_.compile(precision);
+    }
+    LOG(DEBUG) << "Weighting potential grid occupies " << static_cast<double>(weighting_potential_.getStorageSize()) / 1024
+               << "kB";
+}
+
+/**
+ * @throws std::invalid_argument If the weighting potential octree does not match or the thickness domain is outside the
+ * sensor
+ */
+void Detector::setWeightingPotentialGrid(std::shared_ptr<const FieldOctree<double>> potential,
+                                         std::array<double, 3> size,
+                                         FieldMapping mapping,
+                                         std::array<double, 2> scales,
+                                         std::array<double, 2> offset,
+                                         std::pair<double, double> thickness_domain,
+                                         bool compile,
+                                         FieldInterpolation interpolation) {
+    check_field_match(size, mapping, scales, thickness_domain);
+    weighting_potential_.setGrid(std::move(potential), size, mapping, scales, offset, thickness_domain, interpolation);
+    if(compile) {
+        weighting_potential_.compile();
+    }
 }
 
 void Detector::setWeightingPotentialFunction(FieldFunction<double> function,
@@ -193,21 +260,54 @@ double Detector::getDopingConcentration(const ROOT::Math::XYZPoint& pos) const {
     return doping_profile_.get(pos, true);
 }
 
+void Detector::getDopingConcentration(
+    const double* x, const double* y, const double* z, size_t count, double* output) const {
+    // Extrapolate doping profile if outside defined field:
+    doping_profile_.get(x, y, z, count, output, true);
+}
+
 /**
  * @throws std::invalid_argument If the doping profile dimensions are incorrect
  *
  * The doping profile is stored as a large flat array. If the sizes are denoted as respectively X_SIZE, Y_ SIZE and Z_SIZE,
  * each position (x, y, z) has one index, calculated as x*Y_SIZE*Z_SIZE+y*Z_SIZE+z
  */
-void Detector::setDopingProfileGrid(std::shared_ptr<std::vector<double>> field,
+void Detector::setDopingProfileGrid(std::shared_ptr<const double> field,
+                                    size_t field_size,
                                     std::array<size_t, 3> bins,
                                     std::array<double, 3> size,
                                     FieldMapping mapping,
                                     std::array<double, 2> scales,
                                     std::array<double, 2> offset,
-                                    std::pair<double, double> thickness_domain) {
+                                    std::pair<double, double> thickness_domain,
+                                    bool compile,
+                                    FieldInterpolation interpolation,
+                                    FieldPrecision precision) {
+    check_field_match(size, mapping, scales, thickness_domain);
+    doping_profile_.setGrid(
+        std::move(field), field_size, bins, size, mapping, scales, offset, thickness_domain, interpolation);
+    if(compile || precision != FieldPrecision::DOUBLE) {
+        doping_profile_.compile(precision);
+    }
+    LOG(DEBUG) << "Doping profile grid occupies " << static_cast<double>(doping_profile_.getStorageSize()) / 1024 << "kB";
+}
+
+/**
+ * @throws std::invalid_argument If the doping profile octree does not match or the thickness domain is outside the sensor
+ */
+void Detector::setDopingProfileGrid(std::shared_ptr<const FieldOctree<double>> field,
+                                    std::array<double, 3> size,
+                                    FieldMapping mapping,
+                                    std::array<double, 2> scales,
+                                    std::array<double, 2> offset,
+                                    std::pair<double, double> thickness_domain,
+                                    bool compile,
+                                    FieldInterpolation interpolation) {
     check_field_match(size, mapping, scales, thickness_domain);
-    doping_profile_.setGrid(std::move(field), bins, size, mapping, scales, offset, thickness_domain);
+    doping_profile_.setGrid(std::move(field), size, mapping, scales, offset, thickness_domain, interpolation);
+    if(compile) {
+        doping_profile_.compile();
+    }
 }
 
 void Detector::setDopingProfileFunction(FieldFunction<double> function, FieldType type) {
@@ -119,24 +119,61 @@ namespace allpix {
          * @return Vector of the field at the queried point
          */
         ROOT::Math::XYZVector getElectricField(const ROOT::Math::XYZPoint& local_pos) const;
+        /**
+         * @brief Get the electric field in the sensor at a set of local positions
+         * @param x Pointer to the x coordinates of the positions in the local frame
+         * @param y Pointer to the y coordinates of the positions in the local frame
+         * @param z Pointer to the z coordinates of the positions in the local frame
+         * @param count Number of positions
+         * @param output Pointer to storage receiving the vector of the field at each of the positions
+         */
+        void getElectricField(
+            const double* x, const double* y, const double* z, size_t count, ROOT::Math::XYZVector* output) const;
 
         /**
          * @brief Set the electric field in a single pixel in the detector using a grid
-         * @param field Flat array of the field vectors (see detailed description)
+         * @param field Pointer to the flat array of the field vectors (see detailed description)
+         * @param field_size Number of values in the flat array of the field vectors
          * @param bins The dimensions of the flat electric field array
          * @param size Size of the electric field along the three dimensions of the field map
          * @param mapping Specification of the mapping of the field onto the pixel plane
          * @param scales Scaling factors for the field size, given in fractions of the field size in x and y
          * @param offset Offset of the field, given in fractions of the field size in x and y
          * @param thickness_domain Domain in local coordinates in the thickness direction where the field holds
+         * @param compile Compile the grid into a cache-blocked representation for faster lookups
+         * @param interpolation Interpolation applied between the grid points when looking up values
+         * @param precision Storage precision of the compiled grid, implies compilation if not double precision
          */
-        void setElectricFieldGrid(const std::shared_ptr<std::vector<double>>& field,
+        void setElectricFieldGrid(std::shared_ptr<const double> field,
+                                  size_t field_size,
                                   std::array<size_t, 3> bins,
                                   std::array<double, 3> size,
                                   FieldMapping mapping,
                                   std::array<double, 2> scales,
                                   std::array<double, 2> offset,
-                                  std::pair<double, double> thickness_domain);
+                                  std::pair<double, double> thickness_domain,
+                                  bool compile = false,
+                                  FieldInterpolation interpolation = FieldInterpolation::NEAREST,
+                                  FieldPrecision precision = FieldPrecision::DOUBLE);
+        /**
+         * @brief Set the electric field in a single pixel in the detector using an adaptive grid
+         * @param field Octree holding the electric field, defining the dimensions of the field grid
+         * @param size Size of the electric field along the three dimensions of the field map
+         * @param mapping Specification of the mapping of the field onto the pixel plane
+         * @param scales Scaling factors for the field size, given in fractions of the field size in x and y
+         * @param offset Offset of the field, given in fractions of the field size in x and y
+         * @param thickness_domain Domain in local coordinates in the thickness direction where the field holds
+         * @param compile Select the lookup specialized for the field mapping
+         * @param interpolation Interpolation applied between the grid points when looking up values
+         */
+        void setElectricFieldGrid(std::shared_ptr<const FieldOctree<double>> field,
+                                  std::array<double, 3> size,
+                                  FieldMapping mapping,
+                                  std::array<double, 2> scales,
+                                  std::array<double, 2> offset,
+                                  std::pair<double, double> thickness_domain,
+                                  bool compile = false,
+                                  FieldInterpolation interpolation = FieldInterpolation::NEAREST);
         /**
          * @brief Set the electric field in a single pixel using a function
          * @param function Function used to retrieve the electric field
@@ -164,24 +201,60 @@ namespace allpix {
          * @return Value of the field at the queried point
          */
         double getDopingConcentration(const ROOT::Math::XYZPoint& local_pos) const;
+        /**
+         * @brief Get the doping profile in the sensor at a set of local positions
+         * @param x Pointer to the x coordinates of the positions in the local frame
+         * @param y Pointer to the y coordinates of the positions in the local frame
+         * @param z Pointer to the z coordinates of the positions in the local frame
+         * @param count Number of positions
+         * @param output Pointer to storage receiving the value of the field at each of the positions
+         */
+        void getDopingConcentration(const double* x, const double* y, const double* z, size_t count, double* output) const;
 
         /**
          * @brief Set the doping profile in a single pixel in the detector using a grid
-         * @param field Flat array of the field (see detailed description)
+         * @param field Pointer to the flat array of the field (see detailed description)
+         * @param field_size Number of values in the flat array of the field
          * @param bins The dimensions of the flat doping profile array
          * @param size Size of the doping profile along the three dimensions of the field map
          * @param mapping Specification of the mapping of the field onto the pixel plane
          * @param scales Scaling factors for the field size, given in fractions of a pixel unit cell in x and y
          * @param offset Offset of the field, given in fractions of the field size in x and y
          * @param thickness_domain Domain in local coordinates in the thickness direction where the profile holds
+         * @param compile Compile the grid into a cache-blocked representation for faster lookups
+         * @param interpolation Interpolation applied between the grid points when looking up values
+         * @param precision Storage precision of the compiled grid, implies compilation if not double precision
          */
-        void setDopingProfileGrid(std::shared_ptr<std::vector<double>> field,
+        void setDopingProfileGrid(std::shared_ptr<const double> field,
+                                  size_t field_size,
                                   std::array<size_t, 3> bins,
                                   std::array<double, 3> size,
                                   FieldMapping mapping,
                                   std::array<double, 2> scales,
                                   std::array<double, 2> offset,
-                                  std::pair<double, double> thickness_domain);
+                                  std::pair<double, double> thickness_domain,
+                                  bool compile = false,
+                                  FieldInterpolation interpolation = FieldInterpolation::NEAREST,
+                                  FieldPrecision precision = FieldPrecision::DOUBLE);
+        /**
+         * @brief Set the doping profile in a single pixel in the detector using an adaptive grid
+         * @param field Octree holding the doping profile, defining the dimensions of the field grid
+         * @param size Size of the doping profile along the three dimensions of the field map
+         * @param mapping Specification of the mapping of the field onto the pixel plane
+         * @param scales Scaling factors for the field size, given in fractions of a pixel unit cell in x and y
+         * @param offset Offset of the field, given in fractions of the field size in x and y
+         * @param thickness_domain Domain in local coordinates in the thickness direction where the profile holds
+         * @param compile Select the lookup specialized for the field mapping
+         * @param interpolation Interpolation applied between the grid points when looking up values
+         */
+        void setDopingProfileGrid(std::shared_ptr<const FieldOctree<double>> field,
+                                  std::array<double, 3> size,
+                                  FieldMapping mapping,
+                                  std::array<double, 2> scales,
+                                  std::array<double, 2> offset,
+                                  std::pair<double, double> thickness_domain,
+                                  bool compile = false,
+                                  FieldInterpolation interpolation = FieldInterpolation::NEAREST);
         /**
          * @brief Set the doping profile in a single pixel using a function
          * @param function Function used to retrieve the doping profile
@@ -209,23 +282,60 @@ namespace allpix {
          */
         double getWeightingPotential(const ROOT::Math::XYZPoint& local_pos, const Pixel::Index& reference) const;
 
+        /**
+         * @brief Get the weighting potential in the sensor at a local position for a set of reference pixels in one call
+         * @param local_pos Position in the local frame
+         * @param references Centers of the pixels for which we want the weighting potential, x and y coordinate only
+         * @param potentials Pointer to contiguous storage receiving the value of the potential for each reference pixel
+         */
+        void getWeightingPotential(const ROOT::Math::XYZPoint& local_pos,
+                                   const std::vector<ROOT::Math::XYPoint>& references,
+                                   double* potentials) const;
+
         /**
          * @brief Set the weighting potential in a single pixel in the detector using a grid
-         * @param potential Flat array of the potential vectors (see detailed description)
+         * @param potential Pointer to the flat array of the potential vectors (see detailed description)
+         * @param potential_size Number of values in the flat array of the potential
          * @param bins The dimensions of the flat weighting potential array
          * @param size Size of the weighting potential along the three dimensions of the field map
          * @param mapping Specification of the mapping of the field onto the pixel plane
          * @param scales Scaling factors for the field size, given in fractions of a pixel unit cell in x and y
          * @param offset Offset of the field, given in fractions of the field size in x and y
          * @param thickness_domain Domain in local coordinates in the thickness direction where the potential holds
+         * @param compile Compile the grid into a cache-blocked representation for faster lookups
+         * @param interpolation Interpolation applied between the grid points when looking up values
+         * @param precision Storage precision of the compiled grid, implies compilation if not double precision
          */
-        void setWeightingPotentialGrid(const std::shared_ptr<std::vector<double>>& potential,
+        void setWeightingPotentialGrid(std::shared_ptr<const double> potential,
+                                       size_t potential_size,
                                        std::array<size_t, 3> bins,
                                        std::array<double, 3> size,
                                        FieldMapping mapping,
                                        std::array<double, 2> scales,
                                        std::array<double, 2> offset,
-                                       std::pair<double, double> thickness_domain);
+                                       std::pair<double, double> thickness_domain,
+                                       bool compile = false,
+                                       FieldInterpolation interpolation = FieldInterpolation::NEAREST,
+                                       FieldPrecision precision = FieldPrecision::DOUBLE);
+        /**
+         * @brief Set the weighting potential in a single pixel in the detector using an adaptive grid
+         * @param potential Octree holding the weighting potential, defining the dimensions of the field grid
+         * @param size Size of the weighting potential along the three dimensions of the field map
+         * @param mapping Specification of the mapping of the field onto the pixel plane
+         * @param scales Scaling factors for the field size, given in fractions of a pixel unit cell in x and y
+         * @param offset Offset of the field, given in fractions of the field size in x and y
+         * @param thickness_domain Domain in local coordinates in the thickness direction where the potential holds
+         * @param compile Select the lookup specialized for the field mapping
+         * @param interpolation Interpolation applied between the grid points when looking up values
+         */
+        void setWeightingPotentialGrid(std::shared_ptr<const FieldOctree<double>> potential,
+                                       std::array<double, 3> size,
+                                       FieldMapping mapping,
+                                       std::array<double, 2> scales,
+                                       std::array<double, 2> offset,
+                                       std::pair<double, double> thickness_domain,
+                                       bool compile = false,
+                                       FieldInterpolation interpolation = FieldInterpolation::NEAREST);
         /**
          * @brief Set the weighting potential in a single pixel using a function
          * @param function Function used to retrieve the weighting potential
@@ -12,8 +12,13 @@
 #ifndef ALLPIX_DETECTOR_FIELD_H
 #define ALLPIX_DETECTOR_FIELD_H
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <type_traits>
+#include <typeinfo>
 #include <vector>
 
 #include <Math/Point2D.h>
@@ -22,8 +27,11 @@
 #include <Math/Vector3D.h>
 
 #include "DetectorModel.hpp"
+#include "PixelDetectorModel.hpp"
 #include "objects/Pixel.hpp"
 #include "tools/ROOT.h"
+#include "tools/field_interpolation.h"
+#include "tools/field_octree.h"
 
 namespace allpix {
 
@@ -60,6 +68,23 @@ namespace allpix {
                 ///< mirrored at its edges.
     };
 
+    /**
+     * @brief Interpolation of field grids between the centers of neighboring cells
+     */
+    enum class FieldInterpolation {
+        NEAREST = 0, ///< The value of the cell containing the position is used
+        TRILINEAR,   ///< The values of the eight cells surrounding the position are interpolated linearly along each axis
+    };
+
+    /**
+     * @brief Precision of the values of compiled field grids
+     */
+    enum class FieldPrecision {
+        DOUBLE = 0, ///< Values are stored in double precision
+        FLOAT,      ///< Values are stored in single precision
+        INT16,      ///< Values are stored as 16-bit integers with a scale and offset for each component of the field
+    };
+
     /**
      * @brief Functor returning the field at a given position
      * @param pos Position in local coordinates at which the field should be evaluated
@@ -123,6 +148,22 @@ namespace allpix {
          */
         T get(const ROOT::Math::XYZPoint& local_pos, const bool extrapolate_z = false) const;
 
+        /**
+         * @brief Get the field values in the sensor at a set of positions provided in local coordinates
+         * @param x Pointer to contiguous storage of the x coordinates of the positions in the local frame
+         * @param y Pointer to contiguous storage of the y coordinates of the positions in the local frame
+         * @param z Pointer to contiguous storage of the z coordinates of the positions in the local frame
+         * @param count Number of positions
+         * @param output Pointer to contiguous storage receiving one value per position, in the order of the positions
+         * @param extrapolate_z Extrapolate the field along z when outside the defined region
+         */
+        void get(const double* x,
+                 const double* y,
+                 const double* z,
+                 size_t count,
+                 T* output,
+                 const bool extrapolate_z = false) const;
+
         /**
          * @brief Get the value of the field at a position provided in local coordinates with respect to the reference
          * @param local_pos Position in the local frame
@@ -134,23 +175,56 @@ namespace allpix {
                         const ROOT::Math::XYPoint& reference,
                         const bool extrapolate_z = false) const;
 
+        /**
+         * @brief Get the values of the field at a position provided in local coordinates with respect to a set of references
+         * @param local_pos Position in the local frame
+         * @param references Reference positions to calculate the field for, x and y coordinate only
+         * @param output Pointer to contiguous storage receiving one value per reference, in the order of the references
+         * @param extrapolate_z Extrapolate the field along z when outside the defined region
+         */
+        void getRelativeTo(const ROOT::Math::XYZPoint& local_pos,
+                           const std::vector<ROOT::Math::XYPoint>& references,
+                           T* output,
+                           const bool extrapolate_z = false) const;
+
         /**
          * @brief Set the field in the detector using a grid
-         * @param field Flat array of the field
+         * @param field Pointer to the first value of the flat array of the field, keeping the field data alive
+         * @param field_size Number of values in the flat array of the field
          * @param bins The bins of the flat field array
          * @param size Physical extent of the field
          * @param mapping Specification of the mapping of the field onto the pixel plane
          * @param scales Scaling factors for the field size, given in fractions of the field size in x and y
          * @param offset Offset of the field from the pixel center, given in fractions of the field size in x and y
          * @param thickness_domain Domain in local coordinates in the thickness direction where the field holds
+         * @param interpolation Interpolation of the field between the centers of the grid cells
          */
-        void setGrid(std::shared_ptr<std::vector<double>> field,
+        void setGrid(std::shared_ptr<const double> field,
+                     size_t field_size,
                      std::array<size_t, 3> bins,
                      std::array<double, 3> size,
                      FieldMapping mapping,
                      std::array<double, 2> scales,
                      std::array<double, 2> offset,
-                     std::pair<double, double> thickness_domain);
+                     std::pair<double, double> thickness_domain,
+                     FieldInterpolation interpolation = FieldInterpolation::NEAREST);
+        /**
+         * @brief Set the field in the detector using an adaptive grid stored in an octree
+         * @param octree Octree holding the field, defining the bins of the grid
+         * @param size Physical extent of the field
+         * @param mapping Specification of the mapping of the field onto the pixel plane
+         * @param scales Scaling factors for the field size, given in fractions of the field size in x and y
+         * @param offset Offset of the field from the pixel center, given in fractions of the field size in x and y
+         * @param thickness_domain Domain in local coordinates in the thickness direction where the field holds
+         * @param interpolation Interpolation of the field between the centers of the grid cells
+         */
+        void setGrid(std::shared_ptr<const FieldOctree<double>> octree,
+                     std::array<double, 3> size,
+                     FieldMapping mapping,
+                     std::array<double, 2> scales,
+                     std::array<double, 2> offset,
+                     std::pair<double, double> thickness_domain,
+                     FieldInterpolation interpolation = FieldInterpolation::NEAREST);
         /**
          * @brief Set the field in the detector using a function
          * @param function Function used to calculate the field
@@ -161,7 +235,44 @@ namespace allpix {
                          std::pair<double, double> thickness_domain,
                          FieldType type = FieldType::CUSTOM);
 
+        /**
+         * @brief Compile the field grid into a cache-blocked representation with a lookup specialized for its mapping
+         *
+         * The grid is copied into small bricks of neighboring cells stored contiguously in memory, and the mapping and
+         * flipping logic is resolved at compile time for the configured field mapping. In double precision, subsequent
+         * lookups return the very same values as the flat grid. Reduced precisions decrease the memory and cache footprint
+         * of the field at the cost of rounding the values. The reference to the flat grid is released after compilation.
+         * Calling this method has no effect for fields which are not defined via a grid or have been compiled already. For
+         * adaptive grids, only the specialized lookup is selected and the octree is kept in its precision.
+         * @param precision Precision of the stored field values
+         */
+        void compile(FieldPrecision precision = FieldPrecision::DOUBLE);
+
+        /**
+         * @brief Check if the field has been compiled into a cache-blocked representation
+         * @return True if lookups use the compiled field, false otherwise
+         */
+        bool isCompiled() const { return compiled_lookup_ != nullptr; }
+
+        /**
+         * @brief Get the memory occupied by the values of the field grid
+         * @return Number of bytes of the flat grid, the compiled bricks or the octree referenced by this field
+         * @note The flat grid is only freed after compilation if it is not referenced elsewhere
+         */
+        size_t getStorageSize() const;
+
     private:
+        /**
+         * @brief Storage of the values of field grids
+         */
+        enum class GridStorage {
+            FLAT = 0,     ///< Flat field array
+            BRICKS,       ///< Compiled bricks in double precision
+            BRICKS_FLOAT, ///< Compiled bricks in single precision
+            BRICKS_INT16, ///< Compiled bricks quantized to 16-bit integers
+            OCTREE,       ///< Leaves of the adaptive octree
+        };
+
         /**
          * @brief Set the detector model this field is used for
          * @param model The detector model
@@ -169,11 +280,58 @@ namespace allpix {
         void set_model(const std::shared_ptr<DetectorModel>& model) { model_ = model; }
 
         /**
-         * @brief Helper function to retrieve the return type from a calculated index of the field data vector
-         * @param offset The calculated global index to start from
+         * @brief Helper function to construct the return type from the components of the field
+         * @param values Components of the field
          * @note The index sequence is expanded to the number of elements requested, depending on the template instance
          */
-        template <std::size_t... I> auto get_impl(size_t offset, std::index_sequence<I...>) const;
+        template <std::size_t... I> auto get_impl(const std::array<double, N>& values, std::index_sequence<I...>) const;
+
+        /**
+         * @brief Helper function to obtain the components of a grid cell from the given storage
+         * @param x Index of the cell along x
+         * @param y Index of the cell along y
+         * @param z Index of the cell along z
+         * @return Pointer to the first component of the cell
+         */
+        template <GridStorage S> auto cell(size_t x, size_t y, size_t z) const;
+
+        /**
+         * @brief Helper function to sample the field components from the given storage with the given interpolation
+         * @param index Index of the cell containing the position along each axis
+         * @param position Position in units of bins along each axis
+         * @return Components of the field at the position
+         */
+        template <GridStorage S, FieldInterpolation I>
+        std::array<double, N> sample(const std::array<size_t, 3>& index, const std::array<double, 3>& position) const;
+
+        /**
+         * @brief Helper function to select the sampler for the given storage and the configured interpolation
+         */
+        template <GridStorage S> void select_sampler();
+
+        /**
+         * @brief Helper function to copy the flat grid into the bricks in the given precision and to release the flat grid
+         * @param precision Precision of the stored field values
+         */
+        void compile_bricks(FieldPrecision precision);
+
+        /**
+         * @brief Helper function to check and store the geometry of a field grid, common to flat and adaptive grids
+         * @param bins The bins of the field grid
+         * @param size Physical extent of the field
+         * @param mapping Specification of the mapping of the field onto the pixel plane
+         * @param scales Scaling factors for the field size, given in fractions of the field size in x and y
+         * @param offset Offset of the field from the pixel center, given in fractions of the field size in x and y
+         * @param thickness_domain Domain in local coordinates in the thickness direction where the field holds
+         * @param interpolation Interpolation of the field between the centers of the grid cells
+         */
+        void set_grid_geometry(std::array<size_t, 3> bins,
+                               std::array<double, 3> size,
+                               FieldMapping mapping,
+                               std::array<double, 2> scales,
+                               std::array<double, 2> offset,
+                               std::pair<double, double> thickness_domain,
+                               FieldInterpolation interpolation);
 
         /**
          * @brief Helper function to calculate the field index based on the distance from its center and to return the values
@@ -188,6 +346,32 @@ namespace allpix {
                               const bool flip_x = false,
                               const bool flip_y = false) const;
 
+        /**
+         * @brief Helper function to obtain the field relative to a reference with the mapping resolved at compile time
+         * @param pos Position in the local frame
+         * @param ref Reference position to calculate the field for, x and y coordinate only
+         * @param extrapolate_z Extrapolate the field along z when outside the defined region
+         * @return Value(s) of the field assigned to the reference pixel at the queried point
+         */
+        template <FieldMapping M>
+        T get_relative_compiled(const ROOT::Math::XYZPoint& pos,
+                                const ROOT::Math::XYPoint& ref,
+                                const bool extrapolate_z) const;
+
+        /**
+         * @brief Helper function to calculate the position of a grid cell in the cache-blocked field storage
+         * @param x Index of the cell along x
+         * @param y Index of the cell along y
+         * @param z Index of the cell along z
+         * @return Index of the first component of the cell in the compiled field vector
+         */
+        size_t brick_index(size_t x, size_t y, size_t z) const;
+
+        /**
+         * @brief Discard the compiled representation of the field when a new field is set
+         */
+        void reset_compiled();
+
         /**
          * Field properties
          * * bins of the field map (bins in x, y, z)
@@ -196,6 +380,7 @@ namespace allpix {
          */
         std::array<size_t, 3> bins_{};
         FieldMapping mapping_{FieldMapping::PIXEL_FULL};
+        FieldInterpolation interpolation_{FieldInterpolation::NEAREST};
         std::array<double, 2> normalization_{{1., 1.}};
         std::array<double, 2> offset_{{0., 0.}};
 
@@ -205,13 +390,21 @@ namespace allpix {
          * returning the value at each position given in local coordinates. The field is valid within the thickness domain
          * specified, the configured type is stored to allow additional checks in the modules requesting the field.
          *
-         * In case of using a field grid, the field is stored as a large flat array. If the sizes are denoted as X_SIZE, Y_
+         * In case of using a field grid, the field is stored as a large flat array, which is not owned exclusively by the
+         * field but may be shared with other fields or mapped from a file. If the sizes are denoted as X_SIZE, Y_
          * SIZE and Z_SIZE, respectively, and each position (x, y, z) has N indices, the element position of the i-th field
          * component in the flat field vector can be calculated as:
          *
          *   field_i(x, y, z) =  x * Y_SIZE* Z_SIZE * N + y * Z_SIZE * + z * N + i
          */
-        std::shared_ptr<std::vector<double>> field_;
+        std::shared_ptr<const double> field_;
+
+        /**
+         * Adaptive field grid
+         * Instead of the flat array, the field may be stored in an octree which holds blocks of cells with almost constant
+         * field in single leaves. The leaf holding a cell is found in at most as many steps as the octree has levels.
+         */
+        std::shared_ptr<const FieldOctree<double>> octree_;
         std::pair<double, double> thickness_domain_{};
         FieldType type_{FieldType::NONE};
         FieldFunction<T> function_;
@@ -220,6 +413,38 @@ namespace allpix {
          * Relevant parameters from the detector model for this field
          */
         std::shared_ptr<DetectorModel> model_;
+
+        /**
+         * Compiled field
+         * The grid is split into bricks of up to BRICK_SIZE cells along each axis, which are stored contiguously such that
+         * lookups of neighboring positions remain within a few cache lines. Within a brick, cells are stored as in the flat
+         * field vector. Axes with a single bin are not split. The lookup relative to a reference is dispatched to a variant
+         * specialized for the field mapping. Depending on the precision, the bricks are stored in one of the vectors. For
+         * 16-bit integers, each component i is restored as value * quantization_scale_[i] + quantization_offset_[i].
+         */
+        static constexpr size_t BRICK_SIZE = 4;
+        std::vector<double> bricks_;
+        std::vector<float> bricks_float_;
+        std::vector<std::int16_t> bricks_int16_;
+        std::array<double, N> quantization_scale_{};
+        std::array<double, N> quantization_offset_{};
+        std::array<size_t, 3> brick_bins_{};
+        std::array<size_t, 3> brick_count_{};
+        T (DetectorField::*compiled_lookup_)(const ROOT::Math::XYZPoint&, const ROOT::Math::XYPoint&, const bool) const {};
+
+        /**
+         * Sampler of the grid
+         * The storage of the grid values and the interpolation are resolved once when the grid is set or compiled, such that
+         * a lookup calls the sampler specialized for both without further branching.
+         */
+        std::array<double, N> (DetectorField::*sampler_)(const std::array<size_t, 3>&,
+                                                         const std::array<double, 3>&) const {};
+
+        /**
+         * Detector model of plain rectangular pixel matrices, used to call its pixel index calculation without virtual
+         * dispatch for compiled fields. Null for all other models.
+         */
+        const PixelDetectorModel* pixel_model_{};
     };
 } // namespace allpix
 
@@ -18,6 +18,16 @@ namespace allpix {
     template <typename T, size_t N>
     T DetectorField<T, N>::get(const ROOT::Math::XYZPoint& pos, const bool extrapolate_z) const {
 
+        // Compiled fields on rectangular pixel matrices call the pixel index calculation of the model without dispatch
+        if(pixel_model_ != nullptr && mapping_ != FieldMapping::SENSOR) {
+            auto [px, py] = pixel_model_->PixelDetectorModel::getPixelIndex(pos);
+            if(!pixel_model_->PixelDetectorModel::isWithinMatrix(px, py)) {
+                return {};
+            }
+            auto ref = pixel_model_->PixelDetectorModel::getPixelCenter(px, py);
+            return (this->*compiled_lookup_)(pos, {ref.x(), ref.y()}, extrapolate_z);
+        }
+
         // Return empty field if outside the matrix or no field is set
         auto [px, py] = model_->getPixelIndex(pos);
         if(type_ == FieldType::NONE || !model_->isWithinMatrix(px, py)) {
@@ -75,6 +85,34 @@ namespace allpix {
         return ret_val;
     }
 
+    /**
+     * For compiled fields on rectangular pixel matrices, the lookup method is resolved once for all positions, such that
+     * sampling the field for a batch of positions reduces to a tight loop over contiguous storage. All other fields are
+     * evaluated position by position.
+     */
+    template <typename T, size_t N>
+    void DetectorField<T, N>::get(
+        const double* x, const double* y, const double* z, size_t count, T* output, const bool extrapolate_z) const {
+        if(pixel_model_ == nullptr || mapping_ == FieldMapping::SENSOR) {
+            for(size_t i = 0; i < count; ++i) {
+                output[i] = get(ROOT::Math::XYZPoint(x[i], y[i], z[i]), extrapolate_z);
+            }
+            return;
+        }
+
+        const auto lookup = compiled_lookup_;
+        for(size_t i = 0; i < count; ++i) {
+            auto pos = ROOT::Math::XYZPoint(x[i], y[i], z[i]);
+            auto [px, py] = pixel_model_->PixelDetectorModel::getPixelIndex(pos);
+            if(!pixel_model_->PixelDetectorModel::isWithinMatrix(px, py)) {
+                output[i] = T();
+                continue;
+            }
+            auto ref = pixel_model_->PixelDetectorModel::getPixelCenter(px, py);
+            output[i] = (this->*lookup)(pos, {ref.x(), ref.y()}, extrapolate_z);
+        }
+    }
+
     /**
      * Get a value from the field assigned to a specific pixel. This means, we cannot wrap around at the pixel edges and
      * start using the field of the adjacent pixel, but need to calculate the total distance from the lookup point in local
@@ -88,6 +126,11 @@ namespace allpix {
             return {};
         }
 
+        // Use the lookup specialized for the field mapping if the field has been compiled:
+        if(compiled_lookup_ != nullptr) {
+            return (this->*compiled_lookup_)(pos, ref, extrapolate_z);
+        }
+
         // Calculate the coordinates relative to the reference point:
         auto x = pos.x() - ref.x() + offset_[0];
         auto y = pos.y() - ref.y() + offset_[1];
@@ -150,6 +193,33 @@ namespace allpix {
         return ret_val;
     }
 
+    /**
+     * The field type and the lookup method are resolved once for the full set of references, such that evaluating the field
+     * for a stencil of neighboring pixels reduces to a tight loop writing to contiguous storage.
+     */
+    template <typename T, size_t N>
+    void DetectorField<T, N>::getRelativeTo(const ROOT::Math::XYZPoint& pos,
+                                            const std::vector<ROOT::Math::XYPoint>& references,
+                                            T* output,
+                                            const bool extrapolate_z) const {
+        if(type_ == FieldType::NONE) {
+            std::fill(output, output + references.size(), T());
+            return;
+        }
+
+        if(compiled_lookup_ != nullptr) {
+            const auto lookup = compiled_lookup_;
+            for(size_t i = 0; i < references.size(); ++i) {
+                output[i] = (this->*lookup)(pos, references[i], extrapolate_z);
+            }
+            return;
+        }
+
+        for(size_t i = 0; i < references.size(); ++i) {
+            output[i] = getRelativeTo(pos, references[i], extrapolate_z);
+        }
+    }
+
     // Maps the field indices onto the range of -d/2 < x < d/2, where d is the scale of the field in coordinate x.
     // This means, {x,y,z} = (0,0,0) is in the center of the field.
     template <typename T, size_t N>
@@ -158,68 +228,344 @@ namespace allpix {
                                                const bool flip_x,
                                                const bool flip_y) const {
 
-        // Compute indices
+        // Compute the position in units of bins and the indices of the cell containing it
         // If the number of bins in x or y is 1, the field is assumed to be 2-dimensional and the respective index
         // is forced to zero. This circumvents that the field size in the respective dimension would otherwise be zero
-        auto x_ind = (bins_[0] == 1 ? 0 : static_cast<int>(std::floor(dist.x() * static_cast<double>(bins_[0]))));
-        if(x_ind < 0 || x_ind >= static_cast<int>(bins_[0])) {
-            return {};
-        }
-
-        auto y_ind = (bins_[1] == 1 ? 0 : static_cast<int>(std::floor(dist.y() * static_cast<double>(bins_[1]))));
-        if(y_ind < 0 || y_ind >= static_cast<int>(bins_[1])) {
-            return {};
+        std::array<double, 3> position{{dist.x() * static_cast<double>(bins_[0]),
+                                        dist.y() * static_cast<double>(bins_[1]),
+                                        static_cast<double>(bins_[2]) * (dist.z() - thickness_domain_.first) /
+                                            (thickness_domain_.second - thickness_domain_.first)}};
+        std::array<size_t, 3> index{};
+        for(size_t axis = 0; axis < 2; ++axis) {
+            if(bins_[axis] == 1) {
+                position[axis] = 0.5;
+                continue;
+            }
+            auto ind = static_cast<int>(std::floor(position[axis]));
+            if(ind < 0 || ind >= static_cast<int>(bins_[axis])) {
+                return {};
+            }
+            index[axis] = static_cast<size_t>(ind);
         }
 
-        auto z_ind = static_cast<int>(std::floor(static_cast<double>(bins_[2]) * (dist.z() - thickness_domain_.first) /
-                                                 (thickness_domain_.second - thickness_domain_.first)));
+        auto z_ind = static_cast<int>(std::floor(position[2]));
 
         // Check if we need to extrapolate along the z axis:
         if(extrapolate_z) {
             z_ind = std::clamp(z_ind, 0, static_cast<int>(bins_[2]) - 1);
+            position[2] = std::clamp(position[2], 0., static_cast<double>(bins_[2]));
         } else if(z_ind < 0 || z_ind >= static_cast<int>(bins_[2])) {
             return {};
         }
+        index[2] = static_cast<size_t>(z_ind);
 
-        // Compute total index
-        size_t tot_ind = static_cast<size_t>(x_ind) * bins_[1] * bins_[2] * N + static_cast<size_t>(y_ind) * bins_[2] * N +
-                         static_cast<size_t>(z_ind) * N;
+        // Retrieve the field with the sampler selected for the storage and the interpolation of the grid
+        auto values = (this->*sampler_)(index, position);
+        T field_vector = get_impl(values, std::make_index_sequence<N>{});
 
-        // Retrieve field
-        auto field_vector = get_impl(tot_ind, std::make_index_sequence<N>{});
         // Flip sign of vector components if necessary
         flip_vector_components(field_vector, flip_x, flip_y);
         return field_vector;
     }
 
+    template <typename T, size_t N>
+    template <typename DetectorField<T, N>::GridStorage S>
+    auto DetectorField<T, N>::cell(size_t x, size_t y, size_t z) const {
+        if constexpr(S == GridStorage::FLAT) {
+            return field_.get() + ((x * bins_[1] + y) * bins_[2] + z) * N;
+        } else if constexpr(S == GridStorage::OCTREE) {
+            return octree_->getValues().data() + octree_->getLeaf(x, y, z) * N;
+        } else if constexpr(S == GridStorage::BRICKS_INT16) {
+            return bricks_int16_.data() + brick_index(x, y, z);
+        } else if constexpr(S == GridStorage::BRICKS_FLOAT) {
+            return bricks_float_.data() + brick_index(x, y, z);
+        } else {
+            return bricks_.data() + brick_index(x, y, z);
+        }
+    }
+
+    /**
+     * Values quantized to 16-bit integers are restored with the scale and offset of their component. For trilinear
+     * interpolation, the eight cells surrounding the position are weighted as described in \ref interpolate_trilinear.
+     */
+    template <typename T, size_t N>
+    template <typename DetectorField<T, N>::GridStorage S, FieldInterpolation I>
+    std::array<double, N> DetectorField<T, N>::sample(const std::array<size_t, 3>& index,
+                                                      const std::array<double, 3>& position) const {
+        std::array<double, N> values{};
+        auto accumulate = [&](size_t x, size_t y, size_t z, double weight) {
+            const auto* data = cell<S>(x, y, z);
+            for(size_t i = 0; i < N; ++i) {
+                if constexpr(S == GridStorage::BRICKS_INT16) {
+                    values[i] += weight * (static_cast<double>(data[i]) * quantization_scale_[i] + quantization_offset_[i]);
+                } else {
+                    values[i] += weight * static_cast<double>(data[i]);
+                }
+            }
+        };
+
+        if constexpr(I == FieldInterpolation::NEAREST) {
+            accumulate(index[0], index[1], index[2], 1.);
+        } else {
+            interpolate_trilinear(bins_, position, accumulate);
+        }
+        return values;
+    }
+
+    template <typename T, size_t N>
+    template <typename DetectorField<T, N>::GridStorage S>
+    void DetectorField<T, N>::select_sampler() {
+        sampler_ = (interpolation_ == FieldInterpolation::TRILINEAR
+                        ? &DetectorField::sample<S, FieldInterpolation::TRILINEAR>
+                        : &DetectorField::sample<S, FieldInterpolation::NEAREST>);
+    }
+
     /**
      * Woohoo, template magic! Using an index_sequence to construct the templated return type with a variable number of
-     * elements from the flat field vector, e.g. 3 for a vector field and 1 for a scalar field. Using a braced-init-list
+     * elements from the field components, e.g. 3 for a vector field and 1 for a scalar field. Using a braced-init-list
      * allows to call the appropriate constructor of the return type, e.g. ROOT::Math::XYZVector or simply a double.
      */
     template <typename T, size_t N>
     template <std::size_t... I>
-    auto DetectorField<T, N>::get_impl(size_t offset, std::index_sequence<I...>) const {
-        return T{(*field_)[offset + I]...};
+    auto DetectorField<T, N>::get_impl(const std::array<double, N>& values, std::index_sequence<I...>) const {
+        return T{values[I]...};
+    }
+
+    /**
+     * The mapping-dependent flipping and folding of getRelativeTo is evaluated at compile time, leaving only the checks on
+     * the sign of the relative position which are required for the given mapping.
+     */
+    template <typename T, size_t N>
+    template <FieldMapping M>
+    T DetectorField<T, N>::get_relative_compiled(const ROOT::Math::XYZPoint& pos,
+                                                 const ROOT::Math::XYPoint& ref,
+                                                 const bool extrapolate_z) const {
+        constexpr bool left = (M == FieldMapping::PIXEL_QUADRANT_II || M == FieldMapping::PIXEL_QUADRANT_III ||
+                               M == FieldMapping::PIXEL_HALF_LEFT);
+        constexpr bool right = (M == FieldMapping::PIXEL_QUADRANT_I || M == FieldMapping::PIXEL_QUADRANT_IV ||
+                                M == FieldMapping::PIXEL_HALF_RIGHT);
+        constexpr bool bottom = (M == FieldMapping::PIXEL_QUADRANT_III || M == FieldMapping::PIXEL_QUADRANT_IV ||
+                                 M == FieldMapping::PIXEL_HALF_BOTTOM);
+        constexpr bool top = (M == FieldMapping::PIXEL_QUADRANT_I || M == FieldMapping::PIXEL_QUADRANT_II ||
+                              M == FieldMapping::PIXEL_HALF_TOP);
+
+        // Calculate the coordinates relative to the reference point:
+        auto x = pos.x() - ref.x() + offset_[0];
+        auto y = pos.y() - ref.y() + offset_[1];
+
+        // Flip position vector components and fold onto available field scale in the range [0 , 1]
+        const bool flip_x = (left && x > 0) || (right && x < 0);
+        const bool flip_y = (bottom && y > 0) || (top && y < 0);
+        auto px = (flip_x ? -1.0 : 1.0) * x * normalization_[0];
+        auto py = (flip_y ? -1.0 : 1.0) * y * normalization_[1];
+
+        if constexpr(left) {
+            px += 1.0;
+        } else if constexpr(M == FieldMapping::PIXEL_FULL || M == FieldMapping::PIXEL_HALF_TOP ||
+                            M == FieldMapping::PIXEL_HALF_BOTTOM) {
+            px += 0.5;
+        }
+
+        if constexpr(bottom) {
+            py += 1.0;
+        } else if constexpr(M == FieldMapping::PIXEL_FULL || M == FieldMapping::PIXEL_HALF_LEFT ||
+                            M == FieldMapping::PIXEL_HALF_RIGHT) {
+            py += 0.5;
+        }
+
+        // Shuffle quadrants for inverted maps
+        if constexpr(M == FieldMapping::PIXEL_FULL_INVERSE) {
+            px += (x >= 0 ? 0. : 1.0);
+            py += (y >= 0 ? 0. : 1.0);
+        }
+
+        return get_field_from_grid(ROOT::Math::XYZPoint(px, py, pos.z()), extrapolate_z, flip_x, flip_y);
+    }
+
+    template <typename T, size_t N> size_t DetectorField<T, N>::brick_index(size_t x, size_t y, size_t z) const {
+        auto brick = ((x / brick_bins_[0]) * brick_count_[1] + y / brick_bins_[1]) * brick_count_[2] + z / brick_bins_[2];
+        auto cell = ((x % brick_bins_[0]) * brick_bins_[1] + y % brick_bins_[1]) * brick_bins_[2] + z % brick_bins_[2];
+        return (brick * brick_bins_[0] * brick_bins_[1] * brick_bins_[2] + cell) * N;
+    }
+
+    template <typename T, size_t N> void DetectorField<T, N>::compile(FieldPrecision precision) {
+        if(type_ != FieldType::GRID || compiled_lookup_ != nullptr) {
+            return;
+        }
+
+        // Adaptive grids remain in their octree, only the lookup is specialized
+        if(octree_ == nullptr) {
+            compile_bricks(precision);
+        }
+
+        // Select the lookup specialized for the configured mapping
+        switch(mapping_) {
+        case FieldMapping::PIXEL_FULL:
+            compiled_lookup_ = &DetectorField::get_relative_compiled<FieldMapping::PIXEL_FULL>;
+            break;
+        case FieldMapping::PIXEL_FULL_INVERSE:
+            compiled_lookup_ = &DetectorField::get_relative_compiled<FieldMapping::PIXEL_FULL_INVERSE>;
+            break;
+        case FieldMapping::PIXEL_HALF_LEFT:
+            compiled_lookup_ = &DetectorField::get_relative_compiled<FieldMapping::PIXEL_HALF_LEFT>;
+            break;
+        case FieldMapping::PIXEL_HALF_RIGHT:
+            compiled_lookup_ = &DetectorField::get_relative_compiled<FieldMapping::PIXEL_HALF_RIGHT>;
+            break;
+        case FieldMapping::PIXEL_HALF_TOP:
+            compiled_lookup_ = &DetectorField::get_relative_compiled<FieldMapping::PIXEL_HALF_TOP>;
+            break;
+        case FieldMapping::PIXEL_HALF_BOTTOM:
+            compiled_lookup_ = &DetectorField::get_relative_compiled<FieldMapping::PIXEL_HALF_BOTTOM>;
+            break;
+        case FieldMapping::PIXEL_QUADRANT_I:
+            compiled_lookup_ = &DetectorField::get_relative_compiled<FieldMapping::PIXEL_QUADRANT_I>;
+            break;
+        case FieldMapping::PIXEL_QUADRANT_II:
+            compiled_lookup_ = &DetectorField::get_relative_compiled<FieldMapping::PIXEL_QUADRANT_II>;
+            break;
+        case FieldMapping::PIXEL_QUADRANT_III:
+            compiled_lookup_ = &DetectorField::get_relative_compiled<FieldMapping::PIXEL_QUADRANT_III>;
+            break;
+        case FieldMapping::PIXEL_QUADRANT_IV:
+            compiled_lookup_ = &DetectorField::get_relative_compiled<FieldMapping::PIXEL_QUADRANT_IV>;
+            break;
+        case FieldMapping::SENSOR:
+            compiled_lookup_ = &DetectorField::get_relative_compiled<FieldMapping::SENSOR>;
+            break;
+        }
+
+        // Plain rectangular pixel matrices are queried directly, other models through their virtual interface
+        pixel_model_ = (typeid(*model_) == typeid(PixelDetectorModel) ? static_cast<const PixelDetectorModel*>(model_.get())
+                                                                      : nullptr);
+    }
+
+    template <typename T, size_t N> size_t DetectorField<T, N>::getStorageSize() const {
+        auto size = bricks_.size() * sizeof(double) + bricks_float_.size() * sizeof(float) +
+                    bricks_int16_.size() * sizeof(std::int16_t);
+        if(field_ != nullptr) {
+            size += bins_[0] * bins_[1] * bins_[2] * N * sizeof(double);
+        }
+        if(octree_ != nullptr) {
+            size += octree_->getValues().size() * sizeof(double) + octree_->getNodes().size() * sizeof(std::int32_t);
+        }
+        return size;
+    }
+
+    template <typename T, size_t N> void DetectorField<T, N>::compile_bricks(FieldPrecision precision) {
+        // Split the grid into bricks, padding the last brick along each axis
+        for(size_t i = 0; i < 3; ++i) {
+            brick_bins_[i] = std::min(bins_[i], BRICK_SIZE);
+            brick_count_[i] = (bins_[i] + brick_bins_[i] - 1) / brick_bins_[i];
+        }
+        auto brick_values =
+            brick_count_[0] * brick_count_[1] * brick_count_[2] * brick_bins_[0] * brick_bins_[1] * brick_bins_[2] * N;
+        const auto* flat = field_.get();
+        const auto flat_values = bins_[0] * bins_[1] * bins_[2] * N;
+
+        // Copy the field from the flat vector into the bricks, converting the values to the storage precision
+        auto fill_bricks = [&](auto& bricks, auto convert) {
+            bricks.assign(brick_values, {});
+            size_t flat_ind = 0;
+            for(size_t x = 0; x < bins_[0]; ++x) {
+                for(size_t y = 0; y < bins_[1]; ++y) {
+                    for(size_t z = 0; z < bins_[2]; ++z) {
+                        auto brick_ind = brick_index(x, y, z);
+                        for(size_t i = 0; i < N; ++i) {
+                            bricks[brick_ind + i] = convert(flat[flat_ind + i], i);
+                        }
+                        flat_ind += N;
+                    }
+                }
+            }
+        };
+
+        if(precision == FieldPrecision::INT16) {
+            // Map the range of each component symmetrically onto the range of 16-bit integers
+            std::array<double, N> minimum{};
+            std::array<double, N> maximum{};
+            std::fill(minimum.begin(), minimum.end(), std::numeric_limits<double>::max());
+            std::fill(maximum.begin(), maximum.end(), std::numeric_limits<double>::lowest());
+            for(size_t ind = 0; ind < flat_values; ++ind) {
+                minimum[ind % N] = std::min(minimum[ind % N], flat[ind]);
+                maximum[ind % N] = std::max(maximum[ind % N], flat[ind]);
+            }
+            constexpr auto range = static_cast<double>(std::numeric_limits<std::int16_t>::max());
+            for(size_t i = 0; i < N; ++i) {
+                quantization_offset_[i] = (maximum[i] + minimum[i]) / 2;
+                quantization_scale_[i] = (maximum[i] > minimum[i] ? (maximum[i] - minimum[i]) / (2 * range) : 1.);
+            }
+            fill_bricks(bricks_int16_, [&](double value, size_t i) {
+                auto quantized = std::round((value - quantization_offset_[i]) / quantization_scale_[i]);
+                return static_cast<std::int16_t>(std::clamp(quantized, -range, range));
+            });
+            select_sampler<GridStorage::BRICKS_INT16>();
+        } else if(precision == FieldPrecision::FLOAT) {
+            fill_bricks(bricks_float_, [](double value, size_t) { return static_cast<float>(value); });
+            select_sampler<GridStorage::BRICKS_FLOAT>();
+        } else {
+            fill_bricks(bricks_, [](double value, size_t) { return value; });
+            select_sampler<GridStorage::BRICKS>();
+        }
+
+        // Release the reference to the flat field, which remains in the field cache shared by all detectors reading the file
+        field_.reset();
     }
 
     /**
      * @throws std::invalid_argument If the field bins are incorrect or the thickness domain is outside the sensor
      */
     template <typename T, size_t N>
-    void DetectorField<T, N>::setGrid(std::shared_ptr<std::vector<double>> field, // NOLINT
+    void DetectorField<T, N>::setGrid(std::shared_ptr<const double> field, // NOLINT
+                                      size_t field_size,
                                       std::array<size_t, 3> bins,
                                       std::array<double, 3> size,
                                       FieldMapping mapping,
                                       std::array<double, 2> scales,
                                       std::array<double, 2> offset,
-                                      std::pair<double, double> thickness_domain) {
+                                      std::pair<double, double> thickness_domain,
+                                      FieldInterpolation interpolation) {
+        if(bins[0] * bins[1] * bins[2] * N != field_size) {
+            throw std::invalid_argument("field does not match the given dimensions");
+        }
+        set_grid_geometry(bins, size, mapping, scales, offset, std::move(thickness_domain), interpolation);
+        field_ = std::move(field);
+        octree_.reset();
+        select_sampler<GridStorage::FLAT>();
+    }
+
+    /**
+     * @throws std::invalid_argument If the octree does not match the field or the thickness domain is outside the sensor
+     */
+    template <typename T, size_t N>
+    void DetectorField<T, N>::setGrid(std::shared_ptr<const FieldOctree<double>> octree, // NOLINT
+                                      std::array<double, 3> size,
+                                      FieldMapping mapping,
+                                      std::array<double, 2> scales,
+                                      std::array<double, 2> offset,
+                                      std::pair<double, double> thickness_domain,
+                                      FieldInterpolation interpolation) {
+        if(octree == nullptr || octree->getValues().size() != octree->getNumberOfLeaves() * N) {
+            throw std::invalid_argument("field does not match the octree leaves");
+        }
+        set_grid_geometry(
+            octree->getDimensions(), size, mapping, scales, offset, std::move(thickness_domain), interpolation);
+        octree_ = std::move(octree);
+        field_.reset();
+        select_sampler<GridStorage::OCTREE>();
+    }
+
+    template <typename T, size_t N>
+    void DetectorField<T, N>::set_grid_geometry(std::array<size_t, 3> bins,
+                                                std::array<double, 3> size,
+                                                FieldMapping mapping,
+                                                std::array<double, 2> scales,
+                                                std::array<double, 2> offset,
+                                                std::pair<double, double> thickness_domain,
+                                                FieldInterpolation interpolation) {
         if(model_ == nullptr) {
             throw std::invalid_argument("field not initialized with detector model parameters");
         }
-        if(bins[0] * bins[1] * bins[2] * N != field->size()) {
-            throw std::invalid_argument("field does not match the given dimensions");
-        }
         if(thickness_domain.first + 1e-9 < model_->getSensorCenter().z() - model_->getSensorSize().z() / 2.0 ||
            model_->getSensorCenter().z() + model_->getSensorSize().z() / 2.0 < thickness_domain.second - 1e-9) {
             throw std::invalid_argument("thickness domain is outside sensor dimensions");
@@ -228,9 +574,9 @@ namespace allpix {
             throw std::invalid_argument("end of thickness domain is before begin");
         }
 
-        field_ = std::move(field);
         bins_ = bins;
         mapping_ = mapping;
+        interpolation_ = interpolation;
 
         // Calculate normalization of field from field size and scale factors:
         normalization_[0] = 1.0 / scales[0] / size[0];
@@ -240,6 +586,7 @@ namespace allpix {
 
         thickness_domain_ = std::move(thickness_domain);
         type_ = FieldType::GRID;
+        reset_compiled();
     }
 
     template <typename T, size_t N>
@@ -248,5 +595,15 @@ namespace allpix {
         thickness_domain_ = std::move(thickness_domain);
         function_ = std::move(function);
         type_ = type;
+        reset_compiled();
+    }
+
+    template <typename T, size_t N> void DetectorField<T, N>::reset_compiled() {
+        bricks_.clear();
+        bricks_float_.clear();
+        bricks_int16_.clear();
+        compiled_lookup_ = nullptr;
+        sampler_ = nullptr;
+        pixel_model_ = nullptr;
     }
 } // namespace allpix
@@ -12,6 +12,7 @@
 #include "Messenger.hpp"
 
 #include <memory>
+#include <set>
 #include <stdexcept>
 #include <string>
 #include <typeindex>
@@ -34,9 +35,9 @@ Messenger::~Messenger() {
 #endif
 
 // Check if the detectors match for the message and the delegate and that we don't have self-dispatch
-static bool check_send(Module* source, BaseMessage* message, BaseDelegate* delegate) {
+static bool check_send(Module* source, const Detector* detector, BaseDelegate* delegate) {
     if(delegate->getDetector() != nullptr &&
-       (message->getDetector() == nullptr || delegate->getDetector()->getName() != message->getDetector()->getName())) {
+       (detector == nullptr || delegate->getDetector()->getName() != detector->getName())) {
         return false;
     }
     if(delegate->getUniqueName() == source->getUniqueName()) {
@@ -44,6 +45,9 @@ static bool check_send(Module* source, BaseMessage* message, BaseDelegate* deleg
     }
     return true;
 }
+static bool check_send(Module* source, BaseMessage* message, BaseDelegate* delegate) {
+    return check_send(source, message->getDetector().get(), delegate);
+}
 
 /**
  * Messages should be bound during construction, so this function only gives useful information outside the constructor
@@ -85,6 +89,124 @@ bool Messenger::hasReceiver(Module* source, const std::shared_ptr<BaseMessage>&
     return false;
 }
 
+bool Messenger::hasReceiver(Module* source,
+                            const std::shared_ptr<BaseMessage>& message,
+                            const std::shared_ptr<BaseMessage>& alternative) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Get the name of the output message
+    auto name = source->get_configuration().get<std::string>("output");
+
+    // Collect all modules receiving the alternative message
+    const BaseMessage* alternative_inst = alternative.get();
+    std::type_index alternative_idx = typeid(*alternative_inst);
+    std::set<std::string> alternative_receivers;
+    for(const auto& message_name : {name, std::string("*")}) {
+        for(auto& delegate : delegates_[alternative_idx][message_name]) {
+            if(check_send(source, alternative.get(), delegate.get())) {
+                alternative_receivers.insert(delegate->getUniqueName());
+            }
+        }
+    }
+
+    // Check if a specific or generic listener of the message or of all messages does not receive the alternative
+    const BaseMessage* inst = message.get();
+    for(const auto& type_idx : {std::type_index(typeid(*inst)), std::type_index(typeid(BaseMessage))}) {
+        for(const auto& message_name : {name, std::string("*")}) {
+            for(auto& delegate : delegates_[type_idx][message_name]) {
+                if(check_send(source, message.get(), delegate.get()) &&
+                   alternative_receivers.find(delegate->getUniqueName()) == alternative_receivers.end()) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+void Messenger::compileRoutes(const std::list<std::shared_ptr<Module>>& sources) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    routes_.clear();
+    for(const auto& source : sources) {
+        // Get the name of the output message
+        auto name = source->get_configuration().get<std::string>("output");
+        std::vector<std::string> ids{name, "*"};
+        if(name.empty()) {
+            ids.emplace_back("?");
+        }
+
+        // Collect the receivers in the same order as the lookup during dispatch, generic listeners are also routed for all
+        // message types without any specific listener under the type of the base message
+        for(const auto& type_delegates : delegates_) {
+            auto& entry = routes_[std::make_pair(source.get(), type_delegates.first)];
+            entry.name = name;
+
+            std::vector<std::type_index> types{type_delegates.first};
+            if(type_delegates.first != typeid(BaseMessage)) {
+                types.emplace_back(typeid(BaseMessage));
+            }
+            for(const auto& id : ids) {
+                for(const auto& type_idx : types) {
+                    const auto type_iterator = delegates_.find(type_idx);
+                    if(type_iterator == delegates_.end()) {
+                        continue;
+                    }
+                    const auto name_iterator = type_iterator->second.find(id);
+                    if(name_iterator == type_iterator->second.end()) {
+                        continue;
+                    }
+                    for(const auto& delegate : name_iterator->second) {
+                        if(check_send(source.get(), source->getDetector().get(), delegate.get())) {
+                            entry.routes.push_back({delegate.get(),
+                                                    std::get<3>(delegate_to_iterator_.at(delegate.get())),
+                                                    type_idx == typeid(BaseMessage)});
+                        }
+                    }
+                }
+            }
+        }
+        routes_.emplace(std::make_pair(source.get(), std::type_index(typeid(BaseMessage))), RoutingEntry{name, {}});
+    }
+
+    LOG(DEBUG) << "Compiled message routing table with " << routes_.size() << " entries for " << sources.size()
+               << " modules and " << receiver_slots_.size() << " receiver slots";
+}
+
+const Messenger::RoutingEntry* Messenger::find_routes(const Module* source, const BaseMessage* message) const {
+    // Routes are only compiled for messages carrying the detector of the source module
+    if(routes_.empty() || message->getDetector().get() != source->getDetector().get()) {
+        return nullptr;
+    }
+
+    auto iter = routes_.find(std::make_pair(source, std::type_index(typeid(*message))));
+    if(iter == routes_.end()) {
+        iter = routes_.find(std::make_pair(source, std::type_index(typeid(BaseMessage))));
+    }
+    return (iter == routes_.end() ? nullptr : &iter->second);
+}
+
+std::string Messenger::get_output_name(Module* source) const {
+    auto iter = routes_.find(std::make_pair(source, std::type_index(typeid(BaseMessage))));
+    if(iter != routes_.end()) {
+        return iter->second.name;
+    }
+    return source->get_configuration().get<std::string>("output");
+}
+
+size_t Messenger::get_receiver_slot(const Module* module, std::type_index message_type) const {
+    return receiver_slots_.at(std::make_pair(module, message_type));
+}
+
+size_t Messenger::get_receiver_slot(BaseDelegate* delegate) const {
+    auto iter = delegate_to_iterator_.find(delegate);
+    if(iter == delegate_to_iterator_.end()) {
+        throw std::out_of_range("delegate not found in listeners");
+    }
+    return std::get<3>(iter->second);
+}
+
 bool Messenger::isSatisfied(BaseDelegate* delegate, Event* event) const {
     auto* local_messenger = event->get_local_messenger();
     return local_messenger->isSatisfied(delegate);
@@ -105,11 +227,18 @@ void Messenger::add_delegate(const std::type_info& message_type,
         message_name = module->get_configuration().get<std::string>("input");
     }
 
+    // Assign the receiver slot shared by all delegates of the module for this message type
+    auto slot =
+        receiver_slots_.emplace(std::make_pair(module, std::type_index(message_type)), receiver_slots_.size()).first->second;
+
     // Register delegate internally
     delegates_[std::type_index(message_type)][message_name].push_back(delegate);
     auto delegate_iter = --delegates_[std::type_index(message_type)][message_name].end();
     delegate_to_iterator_.emplace(delegate_iter->get(),
-                                  std::make_tuple(std::type_index(message_type), message_name, delegate_iter));
+                                  std::make_tuple(std::type_index(message_type), message_name, delegate_iter, slot));
+
+    // Invalidate the routing table
+    routes_.clear();
 
     // Add delegate to the module itself
     module->add_delegate(this, delegate_iter->get());
@@ -127,6 +256,9 @@ void Messenger::remove_delegate(BaseDelegate* delegate) {
     }
     delegates_[std::get<0>(iter->second)][std::get<1>(iter->second)].erase(std::get<2>(iter->second));
     delegate_to_iterator_.erase(iter);
+
+    // Invalidate the routing table
+    routes_.clear();
 }
 
 std::vector<std::pair<std::shared_ptr<BaseMessage>, std::string>> Messenger::fetchFilteredMessages(Module* module,
@@ -140,25 +272,36 @@ std::vector<std::pair<std::shared_ptr<BaseMessage>, std::string>> Messenger::fet
     }
 }
 
-LocalMessenger::LocalMessenger(Messenger& global_messenger) : global_messenger_(global_messenger) {}
+LocalMessenger::LocalMessenger(Messenger& global_messenger)
+    : global_messenger_(global_messenger), messages_(global_messenger.receiver_slots_.size()),
+      received_(global_messenger.receiver_slots_.size(), false) {}
 
 void LocalMessenger::dispatchMessage(Module* source, std::shared_ptr<BaseMessage> message, std::string name) { // NOLINT
-    // Get the name of the output message
-    if(name == "-") {
-        name = source->get_configuration().get<std::string>("output");
-    }
-
     bool send = false;
 
-    // Send messages to specific listeners
-    send = dispatchMessage(source, message, name, name) || send;
+    // Use the precompiled receivers for messages dispatched under the module output name
+    const auto* routing = (name == "-" ? global_messenger_.find_routes(source, message.get()) : nullptr);
+    if(routing != nullptr) {
+        for(const auto& route : routing->routes) {
+            deliver(source, message, routing->name, route);
+        }
+        send = !routing->routes.empty();
+    } else {
+        // Get the name of the output message
+        if(name == "-") {
+            name = global_messenger_.get_output_name(source);
+        }
+
+        // Send messages to specific listeners
+        send = dispatchMessage(source, message, name, name) || send;
 
-    // Send to generic listeners
-    send = dispatchMessage(source, message, name, "*") || send;
+        // Send to generic listeners
+        send = dispatchMessage(source, message, name, "*") || send;
 
-    // Send to listeners of unnamed messages
-    if(name.empty()) {
-        send = dispatchMessage(source, message, name, "?") || send;
+        // Send to listeners of unnamed messages
+        if(name.empty()) {
+            send = dispatchMessage(source, message, name, "?") || send;
+        }
     }
 
     // Display a TRACE log message if the message is send to no receiver
@@ -190,12 +333,8 @@ bool LocalMessenger::dispatchMessage(Module* source,
             // Send messages only to their specific listeners
             for(const auto& delegate : msg_name_iterator->second) {
                 if(check_send(source, message.get(), delegate.get())) {
-                    LOG(TRACE) << "Sending message " << allpix::demangle(type_idx.name()) << " from "
-                               << source->getUniqueName() << " to " << delegate->getUniqueName();
-                    // Construct BaseMessage where message should be stored
-                    auto& dest = messages_[delegate->getUniqueName()][type_idx];
-
-                    delegate->process(message, name, dest);
+                    auto slot = global_messenger_.get_receiver_slot(delegate.get());
+                    deliver(source, message, name, {delegate.get(), slot, false});
                     send = true;
                 }
             }
@@ -210,10 +349,8 @@ bool LocalMessenger::dispatchMessage(Module* source,
         if(msg_name_iterator != base_msg_type_iterator->second.end()) {
             for(const auto& delegate : msg_name_iterator->second) {
                 if(check_send(source, message.get(), delegate.get())) {
-                    LOG(TRACE) << "Sending message " << allpix::demangle(type_idx.name()) << " from "
-                               << source->getUniqueName() << " to generic listener " << delegate->getUniqueName();
-                    auto& dest = messages_[delegate->getUniqueName()][typeid(BaseMessage)];
-                    delegate->process(message, name, dest);
+                    auto slot = global_messenger_.get_receiver_slot(delegate.get());
+                    deliver(source, message, name, {delegate.get(), slot, true});
                     send = true;
                 }
             }
@@ -223,30 +360,43 @@ bool LocalMessenger::dispatchMessage(Module* source,
     return send;
 }
 
-std::vector<std::pair<std::shared_ptr<BaseMessage>, std::string>> LocalMessenger::fetchFilteredMessages(Module* module) {
-    const std::type_index type_idx = typeid(BaseMessage);
-    return messages_.at(module->getUniqueName()).at(type_idx).filter_multi;
-}
+void LocalMessenger::deliver(Module* source,
+                             const std::shared_ptr<BaseMessage>& message,
+                             const std::string& name,
+                             const Messenger::Route& route) {
+    const BaseMessage* inst = message.get();
+    LOG(TRACE) << "Sending message " << allpix::demangle(typeid(*inst).name()) << " from " << source->getUniqueName()
+               << " to " << (route.generic ? "generic listener " : "") << route.delegate->getUniqueName();
 
-bool LocalMessenger::isSatisfied(BaseDelegate* delegate) const {
-    // check our records for messages for this module
-    const std::string name = delegate->getUniqueName();
-    auto messages_iter = messages_.find(name);
-    if(messages_iter == messages_.end()) {
-        return false;
+    // Delegates registered after the construction of this messenger receive additional slots
+    if(route.slot >= messages_.size()) {
+        messages_.resize(route.slot + 1);
+        received_.resize(route.slot + 1, false);
     }
 
-    // check if this delegate is in our records
-    auto delegate_iter = global_messenger_.delegate_to_iterator_.find(delegate);
-    if(delegate_iter == global_messenger_.delegate_to_iterator_.end()) {
-        throw std::out_of_range("delegate not found in listeners");
-    }
+    route.delegate->process(message, name, messages_[route.slot]);
+    received_[route.slot] = true;
+}
 
-    // check our records for messages for this delegate
-    auto iter = messages_iter->second.find(std::get<0>(delegate_iter->second));
-    if(iter == messages_iter->second.end()) {
-        return false;
+const DelegateTypes& LocalMessenger::get_messages(const Module* module, std::type_index message_type) const {
+    auto slot = global_messenger_.get_receiver_slot(module, message_type);
+    if(slot >= received_.size() || !received_[slot]) {
+        throw std::out_of_range("no message received in slot");
     }
+    return messages_[slot];
+}
 
-    return true;
+bool LocalMessenger::has_messages(const Module* module, std::type_index message_type) const {
+    auto slot = global_messenger_.get_receiver_slot(module, message_type);
+    return slot < received_.size() && received_[slot];
+}
+
+std::vector<std::pair<std::shared_ptr<BaseMessage>, std::string>> LocalMessenger::fetchFilteredMessages(Module* module) {
+    return get_messages(module, typeid(BaseMessage)).filter_multi;
+}
+
+bool LocalMessenger::isSatisfied(BaseDelegate* delegate) const {
+    // check our records for messages for the slot of this delegate
+    auto slot = global_messenger_.get_receiver_slot(delegate);
+    return slot < received_.size() && received_[slot];
 }
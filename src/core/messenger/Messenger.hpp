@@ -17,6 +17,7 @@
 #include <typeindex>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "Message.hpp"
 #include "core/module/Event.hpp"
@@ -124,6 +125,15 @@ namespace allpix {
          */
         template <typename T> std::shared_ptr<T> fetchMessage(Module* module, Event* event);
 
+        /**
+         * @brief Check if a message of specified type meant for the calling module has been received
+         * @param module Module to check the messages for
+         * @param event Event to check the messages in
+         * @return True if a message of this type has been received, false otherwise
+         * @note The module has to be bound to messages of this type
+         */
+        template <typename T> bool hasMessage(Module* module, Event* event) const;
+
         /**
          * @brief Fetches multiple messages of specified type meant for the calling module
          * @param module Module to fetch the messages for
@@ -149,6 +159,20 @@ namespace allpix {
          */
         bool hasReceiver(Module* source, const std::shared_ptr<BaseMessage>& message);
 
+        /**
+         * @brief Check if a specific message has a receiver which does not accept an alternative message
+         * @param source Module that will send the message
+         * @param message Instantiation of the message to check
+         * @param alternative Instantiation of the alternative message
+         * @return True if at least one receiver of the message is not bound to the alternative message, false otherwise
+         *
+         * Only receivers explicitly bound to the type of the alternative message are considered to accept it, receivers
+         * listening to all messages always require the original message.
+         */
+        bool hasReceiver(Module* source,
+                         const std::shared_ptr<BaseMessage>& message,
+                         const std::shared_ptr<BaseMessage>& alternative);
+
         /**
          * @brief Check if a delegate has received its message
          * @param delegate Delegate to check if it was satisfied
@@ -157,7 +181,76 @@ namespace allpix {
          */
         bool isSatisfied(BaseDelegate* delegate, Event* event) const;
 
+        /**
+         * @brief Compile the routing table for the messages dispatched by a set of modules
+         * @param sources Modules which may dispatch messages
+         *
+         * Resolves the receivers of every bound message type for the configured output of each source module once, such
+         * that dispatching a message does not need to look up the output parameter and filter all registered delegates. The
+         * table is discarded as soon as delegates are added or removed, in which case dispatching falls back to the lookup.
+         */
+        void compileRoutes(const std::list<std::shared_ptr<Module>>& sources);
+
     private:
+        /**
+         * @brief Receiver of a message from a given source, resolved in the routing table
+         */
+        struct Route {
+            BaseDelegate* delegate; ///< Delegate receiving the message
+            size_t slot;            ///< Receiver slot storing the message in the local messenger
+            bool generic;           ///< True if the delegate listens to all message types
+        };
+
+        /**
+         * @brief Receivers of a message type dispatched by a source module under its configured output name
+         */
+        struct RoutingEntry {
+            std::string name;
+            std::vector<Route> routes;
+        };
+
+        /**
+         * @brief Hash for combinations of a module and a message type
+         */
+        struct ModuleTypeHash {
+            size_t operator()(const std::pair<const Module*, std::type_index>& key) const {
+                return std::hash<const Module*>()(key.first) ^ (key.second.hash_code() << 1);
+            }
+        };
+        using ModuleTypeKey = std::pair<const Module*, std::type_index>;
+
+        /**
+         * @brief Find the precompiled receivers of a message
+         * @param source Module dispatching the message under its configured output name
+         * @param message Message to dispatch
+         * @return Pointer to the routing entry, or a null pointer if the receivers have to be looked up
+         */
+        const RoutingEntry* find_routes(const Module* source, const BaseMessage* message) const;
+
+        /**
+         * @brief Get the configured output name of a module
+         * @param source Module dispatching messages
+         * @return Output name resolved in the routing table, or read from the module configuration if not compiled
+         */
+        std::string get_output_name(Module* source) const;
+
+        /**
+         * @brief Get the receiver slot in which messages of a given type are stored for a module
+         * @param module Receiving module
+         * @param message_type Type the module listens to
+         * @return Index of the receiver slot
+         * @throws std::out_of_range if the module does not listen to the message type
+         */
+        size_t get_receiver_slot(const Module* module, std::type_index message_type) const;
+
+        /**
+         * @brief Get the receiver slot of a delegate
+         * @param delegate Registered delegate
+         * @return Index of the receiver slot
+         * @throws std::out_of_range if the delegate is not registered
+         */
+        size_t get_receiver_slot(BaseDelegate* delegate) const;
+
         /**
          * @brief Add a delegate to the listeners
          * @param message_type Type the delegate listens to
@@ -174,13 +267,17 @@ namespace allpix {
         void remove_delegate(BaseDelegate* delegate);
 
         using DelegateMap = std::map<std::type_index, std::map<std::string, std::list<std::shared_ptr<BaseDelegate>>>>;
-        using DelegateIteratorMap =
-            std::map<BaseDelegate*,
-                     std::tuple<std::type_index, std::string, std::list<std::shared_ptr<BaseDelegate>>::iterator>>;
+        using DelegateIteratorMap = std::map<
+            BaseDelegate*,
+            std::tuple<std::type_index, std::string, std::list<std::shared_ptr<BaseDelegate>>::iterator, size_t>>;
 
         DelegateMap delegates_;
         DelegateIteratorMap delegate_to_iterator_;
 
+        // Receiver slots for every combination of module and bound message type, and routing table per source module
+        std::unordered_map<ModuleTypeKey, size_t, ModuleTypeHash> receiver_slots_;
+        std::unordered_map<ModuleTypeKey, RoutingEntry, ModuleTypeHash> routes_;
+
         mutable std::mutex mutex_;
     };
 
@@ -212,6 +309,12 @@ namespace allpix {
          */
         template <typename T> std::shared_ptr<T> fetchMessage(Module* module);
 
+        /**
+         * @brief Check if a message of specified type meant for the calling module has been received
+         * @return True if a message of this type has been received, false otherwise
+         */
+        template <typename T> bool hasMessage(Module* module) const;
+
         /**
          * @brief Fetches multiple messages of specified type meant for the calling module
          * @return Vector of shared pointers to messages
@@ -225,10 +328,41 @@ namespace allpix {
         std::vector<std::pair<std::shared_ptr<BaseMessage>, std::string>> fetchFilteredMessages(Module* module);
 
     private:
+        /**
+         * @brief Deliver a message to a receiver
+         * @param source Module that dispatched the message
+         * @param message Message to deliver
+         * @param name Name of the message
+         * @param route Resolved receiver of the message
+         */
+        void deliver(Module* source,
+                     const std::shared_ptr<BaseMessage>& message,
+                     const std::string& name,
+                     const Messenger::Route& route);
+
+        /**
+         * @brief Get the messages received by a module for a given type
+         * @param module Receiving module
+         * @param message_type Type the module listens to
+         * @return Messages stored in the receiver slot
+         * @throws std::out_of_range if no message of this type has been received by the module
+         */
+        const DelegateTypes& get_messages(const Module* module, std::type_index message_type) const;
+
+        /**
+         * @brief Check if a module received any message for a given type
+         * @param module Receiving module
+         * @param message_type Type the module listens to
+         * @return True if the receiver slot received a message, false otherwise
+         */
+        bool has_messages(const Module* module, std::type_index message_type) const;
+
         // The global messenger which contains the shared delegate information
         const Messenger& global_messenger_;
 
-        std::unordered_map<std::string, std::unordered_map<std::type_index, DelegateTypes>> messages_;
+        // Messages stored per receiver slot of the global messenger, and whether a slot received any message
+        std::vector<DelegateTypes> messages_;
+        std::vector<bool> received_;
         std::vector<std::shared_ptr<BaseMessage>> sent_messages_;
     };
 } // namespace allpix
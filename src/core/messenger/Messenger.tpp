@@ -61,6 +61,11 @@ namespace allpix {
         }
     }
 
+    template <typename T> bool Messenger::hasMessage(Module* module, Event* event) const {
+        auto* local_messenger = event->get_local_messenger();
+        return local_messenger->hasMessage<T>(module);
+    }
+
     template <typename T> std::vector<std::shared_ptr<T>> Messenger::fetchMultiMessage(Module* module, Event* event) {
         try {
             auto* local_messenger = event->get_local_messenger();
@@ -73,7 +78,12 @@ namespace allpix {
     template <typename T> std::shared_ptr<T> LocalMessenger::fetchMessage(Module* module) {
         static_assert(std::is_base_of<BaseMessage, T>::value, "Fetched message should inherit from Message class");
         std::type_index type_idx = typeid(T);
-        return std::static_pointer_cast<T>(messages_.at(module->getUniqueName()).at(type_idx).single);
+        return std::static_pointer_cast<T>(get_messages(module, type_idx).single);
+    }
+
+    template <typename T> bool LocalMessenger::hasMessage(Module* module) const {
+        static_assert(std::is_base_of<BaseMessage, T>::value, "Checked message should inherit from Message class");
+        return has_messages(module, typeid(T));
     }
 
     template <typename T> std::vector<std::shared_ptr<T>> LocalMessenger::fetchMultiMessage(Module* module) {
@@ -83,7 +93,7 @@ namespace allpix {
         std::type_index type_idx = typeid(T);
 
         // Construct an empty vector in case no previous modules created one during dispatch
-        auto base_messages = messages_.at(module->getUniqueName()).at(type_idx).multi;
+        const auto& base_messages = get_messages(module, type_idx).multi;
 
         std::vector<std::shared_ptr<T>> derived_messages;
         derived_messages.reserve(base_messages.size());
@@ -55,7 +55,8 @@ namespace allpix {
         REQUIRED = (1 << 0),        ///< Require a message before running a module
         ALLOW_OVERWRITE = (1 << 1), ///< Allow overwriting a previous message
         IGNORE_NAME = (1 << 2),     ///< Listen to all ignoring message name (equal to * as a input configuration parameter)
-        UNNAMED_ONLY = (1 << 3)     ///< Listen to all messages without explicit name (equal to ? as configuration parameter)
+        UNNAMED_ONLY = (1 << 3),    ///< Listen to all messages without explicit name (equal to ? as configuration parameter)
+        REQUIRED_ANY = (1 << 4)     ///< Require at least one of the messages bound with this flag before running a module
     };
     /**
      * @ingroup Delegates
@@ -118,6 +119,12 @@ namespace allpix {
          */
         bool isRequired() const { return (getFlags() & MsgFlags::REQUIRED) != MsgFlags::NONE; }
 
+        /**
+         * @brief Check if delegate has a message of which at least one alternative is required
+         * @return True if message is one of the alternatively required messages, false otherwise
+         */
+        bool isRequiredAny() const { return (getFlags() & MsgFlags::REQUIRED_ANY) != MsgFlags::NONE; }
+
         /**
          * @brief Get the flags for this delegate
          * @return Message flags
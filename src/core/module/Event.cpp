@@ -42,15 +42,44 @@ RandomNumberGenerator& Event::getRandomEngine() {
     return *random_engine_;
 }
 
+RandomNumberGenerator Event::createTaskRandomEngine(uint64_t task) {
+    auto& event_engine = getRandomEngine();
+    if(event_engine.isCounterBased()) {
+        RandomNumberGenerator task_engine(RandomEngine::PHILOX);
+        task_engine.seed(seed_);
+        task_engine.getPhiloxEngine().setStream(random_stream_ + task + 1);
+        return task_engine;
+    }
+
+    RandomNumberGenerator task_engine(RandomEngine::MERSENNE_TWISTER);
+    task_engine.seed(event_engine());
+    return task_engine;
+}
+
+void Event::select_random_stream(const Module* module) {
+    if(random_engine_ == nullptr || !random_engine_->isCounterBased()) {
+        return;
+    }
+
+    // FNV-1a hash of the unique module name in the upper half of the stream, the lower half enumerates the module's tasks
+    uint32_t hash = 2166136261U;
+    for(const auto c : module->get_identifier().getUniqueName()) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619U;
+    }
+    random_stream_ = static_cast<uint64_t>(hash) << 32;
+    random_engine_->getPhiloxEngine().setStream(random_stream_);
+}
+
 void Event::store_random_engine_state() {
-    if(random_engine_ != nullptr && state_.rdbuf()->in_avail() == 0) {
+    // Counter-based generators are reset to the stream of every module before it is run, no state needs to be stored
+    if(random_engine_ != nullptr && !random_engine_->isCounterBased() && state_.rdbuf()->in_avail() == 0) {
         LOG(PRNG) << "Storing PRNG state in event";
         state_ << *random_engine_;
     }
 }
 
 void Event::restore_random_engine_state() {
-    if(random_engine_ != nullptr && state_.rdbuf()->in_avail() != 0) {
+    if(random_engine_ != nullptr && !random_engine_->isCounterBased() && state_.rdbuf()->in_avail() != 0) {
         LOG(PRNG) << "Restoring PRNG state from event";
         state_ >> *random_engine_;
         state_.clear();
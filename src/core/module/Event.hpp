@@ -74,6 +74,17 @@ namespace allpix {
          */
         uint64_t getRandomNumber() { return getRandomEngine()(); }
 
+        /**
+         * @brief Create an independent random engine for a task of the current module
+         * @param task Index of the task within the current module
+         * @return Random engine for the task
+         *
+         * For counter-based engines, the task engine uses the stream of the task derived from the stream of the current
+         * module and does not advance the random engine of the event. Otherwise, the task engine is seeded from the random
+         * engine of the event, such that task engines have to be created from the module thread in the order of the tasks.
+         */
+        RandomNumberGenerator createTaskRandomEngine(uint64_t task);
+
         /**
          * @brief Returns the current seed for the ranom number generator
          * @return The random seed of the current event
@@ -87,6 +98,16 @@ namespace allpix {
          */
         void set_and_seed_random_engine(RandomNumberGenerator* random_engine);
 
+        /**
+         * @brief Select the random number stream of a module
+         * @param module Module to be run next for this event
+         *
+         * Counter-based engines are reset to the beginning of a stream derived from the unique name of the module, such
+         * that the random numbers used by a module depend neither on the other modules nor on their order. The stream of
+         * Mersenne Twister engines cannot be selected and they continue from their current state.
+         */
+        void select_random_stream(const Module* module);
+
         /**
          * @brief Store the state of the PRNG
          */
@@ -103,7 +124,10 @@ namespace allpix {
         // Seed for random number generator
         uint64_t seed_;
 
-        // State of the random number generator
+        // Stream of the current module for counter-based random number generators
+        uint64_t random_stream_{};
+
+        // State of the random number generator, counter-based generators are reset for every module and not stored
         std::stringstream state_;
 
         /**
@@ -18,6 +18,7 @@
 #include <utility>
 
 #include "core/messenger/Messenger.hpp"
+#include "core/module/ThreadPool.hpp"
 #include "core/module/exceptions.h"
 #include "core/utils/log.h"
 
@@ -157,13 +158,67 @@ void Module::set_config_manager(ConfigManager* conf_manager) {
     conf_manager_ = conf_manager;
 }
 
+/**
+ * Tasks only run concurrently if the module is executed by a worker of the thread pool, otherwise they run sequentially. The
+ * log settings of the calling thread, i.e. the log level, format, section and event number set for this module, are applied
+ * around every task such that helper workers log like the module itself.
+ */
+void Module::run_tasks(size_t count, const std::function<void(size_t)>& task) const {
+    if(!multithreading_) {
+        for(size_t index = 0; index < count; ++index) {
+            task(index);
+        }
+        return;
+    }
+
+    auto log_level = Log::getReportingLevel();
+    auto log_format = Log::getFormat();
+    auto log_section = Log::getSection();
+    auto log_event = Log::getEventNum();
+    ThreadPool::runTasks(count, [&](size_t index) {
+        // Set module specific log settings
+        auto prev_level = Log::getReportingLevel();
+        auto prev_format = Log::getFormat();
+        auto prev_section = Log::getSection();
+        auto prev_event = Log::getEventNum();
+        Log::setReportingLevel(log_level);
+        Log::setFormat(log_format);
+        Log::setSection(log_section);
+        Log::setEventNum(log_event);
+
+        // Reset logging also if the task fails
+        auto reset = [&]() {
+            Log::setReportingLevel(prev_level);
+            Log::setFormat(prev_format);
+            Log::setSection(prev_section);
+            Log::setEventNum(prev_event);
+        };
+        try {
+            task(index);
+        } catch(...) {
+            reset();
+            throw;
+        }
+        reset();
+    });
+}
+
 void Module::add_delegate(Messenger* messenger, BaseDelegate* delegate) {
     delegates_.emplace_back(messenger, delegate);
 }
 bool Module::check_delegates(Messenger* messenger, Event* event) {
     // Return false if any delegate is not satisfied
-    return std::all_of(delegates_.cbegin(), delegates_.cend(), [messenger, event](auto& delegate) {
-        return !delegate.second->isRequired() || messenger->isSatisfied(delegate.second, event);
+    if(!std::all_of(delegates_.cbegin(), delegates_.cend(), [messenger, event](auto& delegate) {
+           return !delegate.second->isRequired() || messenger->isSatisfied(delegate.second, event);
+       })) {
+        return false;
+    }
+
+    // Return false if none of the alternatively required delegates is satisfied
+    auto required_any = std::any_of(
+        delegates_.cbegin(), delegates_.cend(), [](auto& delegate) { return delegate.second->isRequiredAny(); });
+    return !required_any || std::any_of(delegates_.cbegin(), delegates_.cend(), [messenger, event](auto& delegate) {
+        return delegate.second->isRequiredAny() && messenger->isSatisfied(delegate.second, event);
     });
 }
 
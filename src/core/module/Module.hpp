@@ -14,9 +14,11 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -28,6 +30,7 @@
 #include "core/geometry/Detector.hpp"
 #include "core/messenger/delegates.h"
 #include "core/module/exceptions.h"
+#include "core/utils/log.h"
 #include "core/utils/prng.h"
 
 namespace allpix {
@@ -183,6 +186,15 @@ namespace allpix {
          */
         void allow_multithreading() { set_multithreading(true); }
 
+        /**
+         * @brief Run independent tasks of the current event concurrently on idle workers of the thread pool
+         * @param count Number of tasks to run
+         * @param task Function executed for every task index between zero and the number of tasks
+         * @note The tasks are executed sequentially on the calling thread if multithreading is not enabled
+         * @warning Tasks should not draw from the event random engine but from their own engine seeded upfront
+         */
+        void run_tasks(size_t count, const std::function<void(size_t)>& task) const;
+
         /**
          * @brief Get the module configuration for internal use
          * @return Configuration of the module
@@ -203,6 +215,10 @@ namespace allpix {
         ModuleIdentifier get_identifier() const { return identifier_; }
         ModuleIdentifier identifier_;
 
+        // Log settings of the module, resolved from its configuration after initialization
+        std::optional<LogLevel> log_level_;
+        std::optional<LogFormat> log_format_;
+
         /**
          * @brief Set the output ROOT directory for this module
          * @param directory ROOT directory for storage
@@ -485,38 +485,62 @@ std::tuple<LogLevel, LogFormat, std::string, uint64_t> ModuleManager::set_module
                                                                                         const Configuration& config,
                                                                                         const std::string& prefix,
                                                                                         const uint64_t event) {
-    // Set new log level if necessary
-    LogLevel prev_level = Log::getReportingLevel();
+    auto [log_level, log_format] = get_log_settings(config);
+    return set_log_settings(name, log_level, log_format, prefix, event);
+}
+
+std::tuple<LogLevel, LogFormat, std::string, uint64_t>
+ModuleManager::set_module_before(const Module* module, const std::string& prefix, const uint64_t event) {
+    return set_log_settings(module->identifier_.getUniqueName(), module->log_level_, module->log_format_, prefix, event);
+}
+
+std::pair<std::optional<LogLevel>, std::optional<LogFormat>>
+ModuleManager::get_log_settings(const Configuration& config) {
+    std::optional<LogLevel> log_level;
     if(config.has("log_level")) {
         auto log_level_string = config.get<std::string>("log_level");
         std::transform(log_level_string.begin(), log_level_string.end(), log_level_string.begin(), ::toupper);
         try {
-            LogLevel log_level = Log::getLevelFromString(log_level_string);
-            if(log_level != prev_level) {
-                LOG(TRACE) << "Local log level is set to " << log_level_string;
-                Log::setReportingLevel(log_level);
-            }
+            log_level = Log::getLevelFromString(log_level_string);
         } catch(std::invalid_argument& e) {
             throw InvalidValueError(config, "log_level", e.what());
         }
     }
 
-    // Set new log format if necessary
-    LogFormat prev_format = Log::getFormat();
+    std::optional<LogFormat> log_format;
     if(config.has("log_format")) {
         auto log_format_string = config.get<std::string>("log_format");
         std::transform(log_format_string.begin(), log_format_string.end(), log_format_string.begin(), ::toupper);
         try {
-            LogFormat log_format = Log::getFormatFromString(log_format_string);
-            if(log_format != prev_format) {
-                LOG(TRACE) << "Local log format is set to " << log_format_string;
-                Log::setFormat(log_format);
-            }
+            log_format = Log::getFormatFromString(log_format_string);
         } catch(std::invalid_argument& e) {
             throw InvalidValueError(config, "log_format", e.what());
         }
     }
 
+    return {log_level, log_format};
+}
+
+std::tuple<LogLevel, LogFormat, std::string, uint64_t>
+ModuleManager::set_log_settings(const std::string& name,
+                                std::optional<LogLevel> log_level,
+                                std::optional<LogFormat> log_format,
+                                const std::string& prefix,
+                                const uint64_t event) {
+    // Set new log level if necessary
+    LogLevel prev_level = Log::getReportingLevel();
+    if(log_level.has_value() && log_level.value() != prev_level) {
+        LOG(TRACE) << "Local log level is set to " << Log::getStringFromLevel(log_level.value());
+        Log::setReportingLevel(log_level.value());
+    }
+
+    // Set new log format if necessary
+    LogFormat prev_format = Log::getFormat();
+    if(log_format.has_value() && log_format.value() != prev_format) {
+        LOG(TRACE) << "Local log format is set to " << Log::getStringFromFormat(log_format.value());
+        Log::setFormat(log_format.value());
+    }
+
     // Set new section name
     auto prev_section = Log::getSection();
     Log::setSection(prefix + name);
@@ -661,6 +685,10 @@ void ModuleManager::initialize() {
         module->initialize();
         // Reset logging
         set_module_after(old_settings);
+
+        // Resolve the log settings used while processing events and freeze the module configuration
+        std::tie(module->log_level_, module->log_format_) = get_log_settings(module->get_configuration());
+        module->get_configuration().freeze();
         // Update execution time
         auto end = std::chrono::steady_clock::now();
         module_execution_time_[module.get()] += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
@@ -689,6 +717,9 @@ void ModuleManager::run(RandomNumberGenerator& seeder) {
     Configuration& global_config = conf_manager_->getGlobalConfiguration();
     auto plot = global_config.get<bool>("performance_plots");
 
+    // Resolve the message receivers of all modules once before processing events
+    messenger_->compileRoutes(modules_);
+
     // Creates the thread pool
     LOG(TRACE) << "Initializing thread pool with " << number_of_threads_ << " threads";
     auto initialize_function =
@@ -700,8 +731,7 @@ void ModuleManager::run(RandomNumberGenerator& seeder) {
             // Call per-thread initialization of each module
             for(const auto& module : modules_list) {
                 // Set module specific log settings
-                auto old_settings = ModuleManager::set_module_before(
-                    module->get_identifier().getUniqueName(), module->get_configuration(), "T:");
+                auto old_settings = ModuleManager::set_module_before(module.get(), "T:");
 
                 LOG(TRACE) << "Initializing thread " << std::this_thread::get_id();
                 module->initializeThread();
@@ -715,8 +745,7 @@ void ModuleManager::run(RandomNumberGenerator& seeder) {
     auto finalize_function = [modules_list = modules_]() {
         for(const auto& module : modules_list) {
             // Set module specific log settings
-            auto old_settings = ModuleManager::set_module_before(
-                module->get_identifier().getUniqueName(), module->get_configuration(), "T:");
+            auto old_settings = ModuleManager::set_module_before(module.get(), "T:");
 
             LOG(TRACE) << "Finalizing thread " << std::this_thread::get_id();
             module->finalizeThread();
@@ -802,8 +831,7 @@ void ModuleManager::run(RandomNumberGenerator& seeder) {
                 auto start = std::chrono::steady_clock::now();
 
                 // Set module specific logging settings
-                auto old_settings = ModuleManager::set_module_before(
-                    module->get_identifier().getUniqueName(), module->get_configuration(), "R:", event->number);
+                auto old_settings = ModuleManager::set_module_before(module.get(), "R:", event->number);
 
                 // Run module
                 bool stop = false;
@@ -812,6 +840,8 @@ void ModuleManager::run(RandomNumberGenerator& seeder) {
                     if(module->require_sequence() && event_num != thread_pool_->minimumUncompleted()) {
                         stop = true;
                     } else {
+                        event->select_random_stream(module.get());
+                        Configuration::setProcessingEvent(true);
                         module->run(event.get());
                     }
                 } catch(const MissingDependenciesException& e) {
@@ -825,7 +855,8 @@ void ModuleManager::run(RandomNumberGenerator& seeder) {
                     this->terminate_ = true;
                 }
 
-                // Reset logging
+                // Reset logging and stop tracking configuration access
+                Configuration::setProcessingEvent(false);
                 ModuleManager::set_module_after(old_settings);
 
                 // Update execution time
@@ -947,7 +978,7 @@ void ModuleManager::finalize() {
         auto start = std::chrono::steady_clock::now();
 
         // Set module specific log settings
-        auto old_settings = set_module_before(module->get_identifier().getUniqueName(), module->get_configuration(), "F:");
+        auto old_settings = set_module_before(module.get(), "F:");
         // Change to our ROOT directory
         module->getROOTDirectory()->cd();
         // Finalize module
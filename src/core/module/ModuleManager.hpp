@@ -16,6 +16,7 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <optional>
 #include <queue>
 
 #include <TDirectory.h>
@@ -143,6 +144,37 @@ namespace allpix {
                                                                                         const std::string& prefix = "",
                                                                                         const uint64_t event = 0);
 
+        /**
+         * @brief Set module specific log setting before processing events, using the settings resolved after initialization
+         * @param module Module to set the log settings for
+         * @param prefix Possible section name prefix
+         * @param event  Event number, defaults to 0 for not displaying it
+         */
+        static std::tuple<LogLevel, LogFormat, std::string, uint64_t>
+        set_module_before(const Module* module, const std::string& prefix, const uint64_t event = 0);
+
+        /**
+         * @brief Resolve the module specific log settings from the module configuration
+         * @param config Module configuration
+         * @return Pair of the configured log level and format, empty if not configured
+         */
+        static std::pair<std::optional<LogLevel>, std::optional<LogFormat>> get_log_settings(const Configuration& config);
+
+        /**
+         * @brief Apply module specific log settings
+         * @param mod_name   Unique identifier of the module
+         * @param log_level  Log level of the module, empty for keeping the current level
+         * @param log_format Log format of the module, empty for keeping the current format
+         * @param prefix     Possible section name prefix
+         * @param event      Event number, 0 for not displaying it
+         * @return Set of previous settings
+         */
+        static std::tuple<LogLevel, LogFormat, std::string, uint64_t> set_log_settings(const std::string& mod_name,
+                                                                                       std::optional<LogLevel> log_level,
+                                                                                       std::optional<LogFormat> log_format,
+                                                                                       const std::string& prefix,
+                                                                                       const uint64_t event);
+
         /**
          * @brief Reset global log setting after running init/run/finalize
          * @param prev Set of previous settings generated by \ref set_module_before
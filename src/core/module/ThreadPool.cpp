@@ -17,6 +17,7 @@
 
 using namespace allpix;
 
+thread_local ThreadPool* ThreadPool::current_pool_{nullptr};
 std::map<std::thread::id, unsigned int> ThreadPool::thread_nums_;
 std::atomic_uint ThreadPool::thread_cnt_{1u};
 std::atomic_uint ThreadPool::thread_total_{1u};
@@ -37,13 +38,14 @@ ThreadPool::ThreadPool(unsigned int num_threads,
                        unsigned int max_buffered_size,
                        const std::function<void()>& worker_init_function,
                        const std::function<void()>& worker_finalize_function)
-    : queue_(max_queue_size, max_buffered_size) {
+    : queue_(max_queue_size, max_buffered_size, num_threads) {
     assert(max_buffered_size == 0 || max_buffered_size >= num_threads);
     // Create threads
     try {
         for(unsigned int i = 0u; i < num_threads; ++i) {
             threads_.emplace_back(&ThreadPool::worker,
                                   this,
+                                  i,
                                   std::min(num_threads, max_buffered_size),
                                   worker_init_function,
                                   worker_finalize_function);
@@ -69,6 +71,66 @@ ThreadPool::~ThreadPool() {
     destroy();
 }
 
+/**
+ * Every helper job claims task indices until none are left, hence helpers starting after all tasks have been claimed return
+ * immediately without accessing the task function. The caller only waits for tasks claimed by running helpers.
+ */
+void ThreadPool::runTasks(size_t count, const std::function<void(size_t)>& task) {
+    struct TaskState {
+        std::atomic_size_t next{0};
+        std::atomic_size_t finished{0};
+        std::exception_ptr exception{nullptr};
+        std::mutex mutex;
+        std::condition_variable condition;
+    };
+    auto state = std::make_shared<TaskState>();
+
+    auto process = [state, count, &task]() {
+        size_t index = 0;
+        while((index = state->next++) < count) {
+            try {
+                task(index);
+            } catch(...) {
+                std::lock_guard<std::mutex> lock{state->mutex};
+                if(!state->exception) {
+                    state->exception = std::current_exception();
+                }
+            }
+            if(++state->finished == count) {
+                std::lock_guard<std::mutex> lock{state->mutex};
+                state->condition.notify_all();
+            }
+        }
+    };
+
+    // Queue helpers for other workers, the calling thread counts as one of them
+    auto* pool = current_pool_;
+    if(pool != nullptr && count > 1) {
+        auto helpers = std::min(count, pool->threads_.size()) - 1;
+        for(size_t i = 0; i < helpers; ++i) {
+            // Increment the run count first to prevent it from dropping to zero while the event is still running
+            {
+                std::lock_guard<std::mutex> lock{pool->run_mutex_};
+                ++pool->run_cnt_;
+            }
+            if(!pool->queue_.pushUrgent(std::make_unique<std::packaged_task<void()>>(process))) {
+                std::lock_guard<std::mutex> lock{pool->run_mutex_};
+                --pool->run_cnt_;
+                break;
+            }
+        }
+    }
+
+    process();
+
+    // Wait for the tasks still processed by helpers
+    std::unique_lock<std::mutex> lock{state->mutex};
+    state->condition.wait(lock, [&]() { return state->finished == count; });
+    if(state->exception) {
+        std::rethrow_exception(state->exception);
+    }
+}
+
 void ThreadPool::markComplete(uint64_t n) {
     queue_.complete(n);
 }
@@ -90,7 +152,8 @@ void ThreadPool::wait() {
 /**
  * If an exception is thrown by a module, the first exception is saved to propagate in the main thread
  */
-void ThreadPool::worker(size_t min_thread_buffer,
+void ThreadPool::worker(size_t worker_index,
+                        size_t min_thread_buffer,
                         const std::function<void()>& initialize_function,
                         const std::function<void()>& finalize_function) {
     try {
@@ -98,6 +161,7 @@ void ThreadPool::worker(size_t min_thread_buffer,
         unsigned int thread_num = thread_cnt_++;
         assert(thread_num < thread_total_);
         thread_nums_[std::this_thread::get_id()] = thread_num;
+        current_pool_ = this;
 
         // Initialize the worker
         if(initialize_function) {
@@ -107,7 +171,7 @@ void ThreadPool::worker(size_t min_thread_buffer,
         while(!done_) {
             Task task{nullptr};
 
-            if(queue_.pop(task, min_thread_buffer)) {
+            if(queue_.pop(task, worker_index, min_thread_buffer)) {
                 // Execute task
                 (*task)();
                 // Fetch the future to propagate exceptions
@@ -14,15 +14,18 @@
 
 #include <algorithm>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <exception>
 #include <functional>
 #include <future>
 #include <map>
 #include <memory>
-#include <queue>
+#include <mutex>
 #include <set>
 #include <thread>
 #include <utility>
+#include <vector>
 
 namespace allpix {
     /**
@@ -33,12 +36,24 @@ namespace allpix {
         /**
          * @brief Internal thread-safe queuing system
          *
-         * It internally consists of two separate queues
-         * - A standard queue pushed in order of jobs to process
-         * - An ordered priority queue for work that need linear processing
+         * It internally consists of two separate parts
+         * - A set of per-worker deques for the standard jobs, filled round-robin by the submitting thread. Workers pop from
+         *   the front of their own deque and steal from the back of the other deques if their own one runs dry, such that
+         *   the workers do not contend on a single lock and thieves take the jobs the owner would reach last.
+         * - A lock-free ring indexed by the ordering identifier for work that needs linear processing, together with a ring
+         *   of completed identifiers used to advance the current identifier without locking.
          *
-         * The priority queue is popped if the top of the queue can be directly processed. Otherwise work is popped from the
-         * default queue unless the priority queue size is too large.
+         * The priority ring is popped if the job with the current identifier is buffered and can thus be directly
+         * processed. Otherwise work is popped from the standard deques unless the priority buffer size is too large. While
+         * jobs are buffered, the standard jobs are popped strictly in order of submission by selecting the deque with the
+         * oldest front job, as the job with the current identifier could otherwise be starved by the buffer limit.
+         * Identifiers that do not fit into the rings (because the current identifier is lagging far behind) are kept in a
+         * mutex-guarded overflow container instead. Threads only sleep on a condition variable if no work is available.
+         *
+         * Urgent jobs, used to split the work of a single event into sub-event tasks, are kept in an additional unbounded
+         * queue which is popped before all other queues.
+         *
+         * @note The value type is required to be a std::unique_ptr, as its raw pointer is stored in the priority ring
          */
         template <typename T> class SafeQueue {
         public:
@@ -46,8 +61,17 @@ namespace allpix {
              * @brief Default constructor, initializes empty queue
              * @param max_standard_size Max size of the default queue
              * @param max_priority_size Max size of the priority queue
+             * @param num_workers Number of workers popping from the queue, each of which owns a standard deque
+             */
+            SafeQueue(unsigned int max_standard_size, unsigned int max_priority_size, unsigned int num_workers = 1);
+
+            /// @{
+            /**
+             * @brief Copying or moving the queue is not allowed
              */
-            SafeQueue(unsigned int max_standard_size, unsigned int max_priority_size);
+            SafeQueue(const SafeQueue& rhs) = delete;
+            SafeQueue& operator=(const SafeQueue& rhs) = delete;
+            /// @}
 
             /**
              * @brief Erases the queue and release waiting threads on destruction
@@ -57,10 +81,11 @@ namespace allpix {
             /**
              * @brief Get the top value from the appropriate queue
              * @param out Reference where the value at the top of the queue will be written to
+             * @param worker Index of the popping worker, used to select the owned standard deque
              * @param buffer_left Optional number of jobs that should be left in priority buffer without stall on push
              * @return True if a task was acquired or false if pop was exited for another reason
              */
-            bool pop(T& out, size_t buffer_left = 0);
+            bool pop(T& out, size_t worker = 0, size_t buffer_left = 0);
 
             /**
              * @brief Push a new value onto the standard queue, will block if queue is full
@@ -77,6 +102,12 @@ namespace allpix {
              * @return If the push was successful
              */
             bool push(uint64_t n, T value, bool wait = true);
+            /**
+             * @brief Push a new value onto the urgent queue, which is popped before all others and never blocks
+             * @param value Value to push to the queue
+             * @return If the push was successful
+             */
+            bool pushUrgent(T value);
 
             /**
              * @brief Mark an identifier as complete
@@ -120,14 +151,67 @@ namespace allpix {
             void invalidate();
 
         private:
+            using Pointer = typename T::pointer;
+
+            // Standard deque owned by a single worker, aligned to avoid false sharing between workers. Jobs are stored with
+            // a ticket denoting the order of submission, the ticket of the front job is readable without locking.
+            struct alignas(64) WorkerDeque {
+                std::mutex mutex;
+                std::deque<std::pair<uint64_t, T>> jobs;
+                std::atomic<uint64_t> front_ticket{UINT64_MAX};
+            };
+            std::vector<std::unique_ptr<WorkerDeque>> deques_;
+            std::atomic_size_t next_deque_{0};
+            std::atomic<uint64_t> next_ticket_{0};
+            std::atomic_size_t standard_size_{0};
+
+            // Urgent jobs popped before all others
+            std::mutex urgent_mutex_{};
+            std::deque<T> urgent_jobs_;
+            std::atomic_size_t urgent_size_{0};
+
+            // Try to acquire a job without blocking
+            bool try_pop_urgent(T& out);
+            bool try_pop_priority(T& out);
+            bool try_pop_standard(T& out, size_t worker, size_t buffer_left);
+            bool try_pop_oldest(T& out);
+            void pop_front(WorkerDeque& deque, T& out);
+            void pop_back(WorkerDeque& deque, T& out);
+
+            // Advance the current identifier over all consecutive completed identifiers
+            bool advance();
+
+            // Wake up sleeping poppers or pushers after the state of the queue changed
+            void notify_poppers(bool all);
+            void notify_pushers();
+
+            // Slot of the priority ring, the identifier is used to claim and publish the slot
+            struct PrioritySlot {
+                std::atomic<uint64_t> id{UINT64_MAX};
+                Pointer value{nullptr};
+            };
+            static constexpr uint64_t empty_slot_{UINT64_MAX};
+            static constexpr uint64_t busy_slot_{UINT64_MAX - 1};
+
+            // Ordering rings, sized to a power of two
+            uint64_t ring_mask_;
+            std::unique_ptr<PrioritySlot[]> priority_ring_;
+            std::unique_ptr<std::atomic<uint64_t>[]> completed_ring_;
+            std::atomic<uint64_t> current_id_{0};
+            std::atomic_size_t priority_size_{0};
+
+            // Overflow containers for identifiers not fitting in the rings
+            mutable std::mutex overflow_mutex_{};
+            std::map<uint64_t, T> priority_overflow_;
+            std::set<uint64_t> completed_overflow_;
+            std::atomic_size_t overflow_size_{0};
+
+            // Sleeping of threads when no work or capacity is available
             std::atomic_bool valid_{true};
-            mutable std::mutex mutex_{};
-            std::queue<T> queue_;
-            std::set<uint64_t> completed_ids_;
-            uint64_t current_id_{0};
-            using PQValue = std::pair<uint64_t, T>;
-            std::priority_queue<PQValue, std::vector<PQValue>, std::greater<>> priority_queue_;
-            std::atomic_size_t priority_queue_size_{0};
+            std::atomic<uint64_t> pop_epoch_{0};
+            std::atomic_uint pop_sleepers_{0};
+            std::atomic_uint push_sleepers_{0};
+            std::mutex sleep_mutex_{};
             std::condition_variable push_condition_;
             std::condition_variable pop_condition_;
             const size_t max_standard_size_;
@@ -188,6 +272,17 @@ namespace allpix {
          */
         template <typename Func, typename... Args> auto submit(uint64_t n, Func&& func, Args&&... args);
 
+        /**
+         * @brief Run a number of tasks concurrently on the workers of the thread pool the calling thread belongs to. The
+         * tasks are queued as urgent jobs and the calling thread processes tasks itself until all are claimed, such that
+         * waiting for idle workers can never stall the caller. If the calling thread is not a worker of a thread pool, all
+         * tasks are executed sequentially on the calling thread.
+         * @param count Number of tasks to run
+         * @param task Function to execute for every task index between zero and the number of tasks
+         * @throw Exception thrown by the first failing task, rethrown after all tasks have finished
+         */
+        static void runTasks(size_t count, const std::function<void(size_t)>& task);
+
         /**
          * @brief Mark identifier as completed
          * @param n Identifier that is complete
@@ -259,11 +354,13 @@ namespace allpix {
     private:
         /**
          * @brief Constantly running internal function each thread uses to acquire work items from the queue.
+         * @param worker_index        Index of the worker in the pool, selecting its own standard deque
          * @param min_thread_buffer   Minimum buffer size to keep available without stall on push
          * @param initialize_function Function to initialize the thread
          * @param finalize_function   Function to finalize the thread
          */
-        void worker(size_t min_thread_buffer,
+        void worker(size_t worker_index,
+                    size_t min_thread_buffer,
                     const std::function<void()>& initialize_function,
                     const std::function<void()>& finalize_function);
 
@@ -283,6 +380,7 @@ namespace allpix {
         std::atomic_flag has_exception_{false};
         std::exception_ptr exception_ptr_{nullptr};
 
+        static thread_local ThreadPool* current_pool_;
         static std::map<std::thread::id, unsigned int> thread_nums_;
         static std::atomic_uint thread_cnt_;
         static std::atomic_uint thread_total_;
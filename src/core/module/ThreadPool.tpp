@@ -11,163 +11,412 @@
 
 #include <cassert>
 #include <climits>
+#include <cstdint>
 
 namespace allpix {
+    /*
+     * The rings hold the identifiers between the current identifier and the furthest identifier that can be in flight in
+     * regular operation, identifiers further ahead are stored in the overflow containers
+     */
     template <typename T>
-    ThreadPool::SafeQueue<T>::SafeQueue(unsigned int max_standard_size, unsigned max_priority_size)
-        : max_standard_size_(max_standard_size), max_priority_size_(max_priority_size) {}
+    ThreadPool::SafeQueue<T>::SafeQueue(unsigned int max_standard_size, unsigned max_priority_size, unsigned int num_workers)
+        : max_standard_size_(max_standard_size), max_priority_size_(max_priority_size) {
+        for(unsigned int i = 0; i < std::max(num_workers, 1u); ++i) {
+            deques_.push_back(std::make_unique<WorkerDeque>());
+        }
+
+        uint64_t ring_size = 1024;
+        while(ring_size < 2 * (uint64_t(max_standard_size) + max_priority_size + num_workers)) {
+            ring_size <<= 1;
+        }
+        ring_mask_ = ring_size - 1;
+        priority_ring_ = std::make_unique<PrioritySlot[]>(ring_size);
+        completed_ring_ = std::make_unique<std::atomic<uint64_t>[]>(ring_size);
+        for(uint64_t i = 0; i < ring_size; ++i) {
+            completed_ring_[i] = empty_slot_;
+        }
+    }
 
     /*
-     * Block until a value is available if the wait parameter is set to true. The wait exits when the queue is invalidated.
+     * Block until a value is available. The wait exits when the queue is invalidated. The epoch of the poppers is read
+     * before trying to acquire a job, such that any change of the queue state after the attempt prevents the thread from
+     * sleeping.
      */
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wstrict-overflow"
-    template <typename T> bool ThreadPool::SafeQueue<T>::pop(T& out, size_t buffer_left) {
+    template <typename T> bool ThreadPool::SafeQueue<T>::pop(T& out, size_t worker, size_t buffer_left) {
         assert(buffer_left <= max_priority_size_);
-        // Lock the mutex
-        std::unique_lock<std::mutex> lock{mutex_};
-        if(!valid_) {
-            return false;
-        }
-
-        // Wait for one of the queues to be available
-        bool pop_priority = !priority_queue_.empty() && priority_queue_.top().first == current_id_;
-        bool pop_standard = !queue_.empty() && priority_queue_.size() + buffer_left <= max_priority_size_;
-        while(!pop_priority && !pop_standard) {
-            // Wait for new item in the queue (unlocks the mutex while waiting)
-            pop_condition_.wait(lock);
+        while(true) {
+            auto epoch = pop_epoch_.load();
             if(!valid_) {
                 return false;
             }
-            pop_priority = !priority_queue_.empty() && priority_queue_.top().first == current_id_;
-            pop_standard = !queue_.empty() && priority_queue_.size() + buffer_left <= max_priority_size_;
+
+            // Urgent jobs are preferred since a running event waits for them, followed by priority jobs which unblock the
+            // ordered processing
+            if(try_pop_urgent(out)) {
+                return true;
+            }
+            if(try_pop_priority(out)) {
+                // A smaller priority buffer might allow other workers to pop from the standard queue again
+                notify_poppers(true);
+                notify_pushers();
+                return true;
+            }
+            if(try_pop_standard(out, worker, buffer_left)) {
+                notify_pushers();
+                return true;
+            }
+
+            // Wait for a change of the queue state
+            std::unique_lock<std::mutex> lock{sleep_mutex_};
+            ++pop_sleepers_;
+            pop_condition_.wait(lock, [this, epoch]() { return pop_epoch_ != epoch || !valid_; });
+            --pop_sleepers_;
         }
+    }
 
-        // Pop the appropriate queue
-        if(pop_priority) {
-            // Priority queue is missing a pop returning a non-const reference, so need to apply a const_cast
-            out = std::move(const_cast<PQValue&>(priority_queue_.top())).second; // NOLINT
-            priority_queue_.pop();
-            priority_queue_size_--;
-        } else { // pop_standard
-            out = std::move(queue_.front());
-            queue_.pop();
+    template <typename T> bool ThreadPool::SafeQueue<T>::try_pop_urgent(T& out) {
+        if(urgent_size_ == 0) {
+            return false;
         }
 
-        // Notify possible pusher waiting to fill the queue
-        lock.unlock();
-        if(pop_priority) {
-            pop_condition_.notify_one();
+        std::lock_guard<std::mutex> lock{urgent_mutex_};
+        if(urgent_jobs_.empty()) {
+            return false;
         }
-        push_condition_.notify_one();
+        out = std::move(urgent_jobs_.front());
+        urgent_jobs_.pop_front();
+        --urgent_size_;
         return true;
     }
-#pragma GCC diagnostic pop
 
-    template <typename T> bool ThreadPool::SafeQueue<T>::push(T value, bool wait) {
-        // Lock the mutex
-        std::unique_lock<std::mutex> lock{mutex_};
+    template <typename T> bool ThreadPool::SafeQueue<T>::try_pop_priority(T& out) {
+        if(priority_size_ == 0) {
+            return false;
+        }
+
+        // Only the job with the current identifier can be processed
+        auto current_id = current_id_.load();
+        auto& slot = priority_ring_[current_id & ring_mask_];
+        auto expected = current_id;
+        if(slot.id.compare_exchange_strong(expected, busy_slot_)) {
+            out = T(slot.value);
+            slot.value = nullptr;
+            slot.id = empty_slot_;
+            --priority_size_;
+            return true;
+        }
+
+        // Fall back to the overflow if the job did not fit into the ring
+        if(overflow_size_ != 0) {
+            std::lock_guard<std::mutex> lock{overflow_mutex_};
+            auto iter = priority_overflow_.find(current_id);
+            if(iter != priority_overflow_.end()) {
+                out = std::move(iter->second);
+                priority_overflow_.erase(iter);
+                --overflow_size_;
+                --priority_size_;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*
+     * The own deque is tried first, afterwards work is stolen from the back of the other deques, away from the end the owner
+     * pops from. If jobs are buffered, the order of
+     * submission is kept instead: all jobs popped in the mean time are started before the job with the current identifier,
+     * which could thus starve if the buffer fills up. Without buffered jobs each worker can start at most one job out of
+     * order before it buffers it, hence the order is also kept if the buffer cannot hold two jobs per worker.
+     */
+    template <typename T>
+    bool ThreadPool::SafeQueue<T>::try_pop_standard(T& out, size_t worker, size_t buffer_left) {
+        if(standard_size_ == 0 || priority_size_ + buffer_left > max_priority_size_) {
+            return false;
+        }
+
+        if(max_priority_size_ != 0 && (priority_size_ != 0 || max_priority_size_ < 2 * deques_.size())) {
+            return try_pop_oldest(out);
+        }
+
+        for(size_t i = 0; i < deques_.size(); ++i) {
+            auto& deque = *deques_[(worker + i) % deques_.size()];
+            if(deque.front_ticket == UINT64_MAX) {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock{deque.mutex};
+            if(!deque.jobs.empty()) {
+                if(i == 0) {
+                    pop_front(deque, out);
+                } else {
+                    pop_back(deque, out);
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*
+     * Since the tickets in every deque are increasing, the smallest front ticket is the oldest job of all deques. If the
+     * front changed before the deque is locked, another worker took the job and the search is repeated.
+     */
+    template <typename T> bool ThreadPool::SafeQueue<T>::try_pop_oldest(T& out) {
+        while(true) {
+            WorkerDeque* oldest = nullptr;
+            uint64_t oldest_ticket = UINT64_MAX;
+            for(auto& deque : deques_) {
+                auto ticket = deque->front_ticket.load();
+                if(ticket < oldest_ticket) {
+                    oldest = deque.get();
+                    oldest_ticket = ticket;
+                }
+            }
+            if(oldest == nullptr) {
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock{oldest->mutex};
+            if(!oldest->jobs.empty() && oldest->jobs.front().first == oldest_ticket) {
+                pop_front(*oldest, out);
+                return true;
+            }
+        }
+    }
 
+    template <typename T> void ThreadPool::SafeQueue<T>::pop_front(WorkerDeque& deque, T& out) {
+        out = std::move(deque.jobs.front().second);
+        deque.jobs.pop_front();
+        deque.front_ticket = (deque.jobs.empty() ? UINT64_MAX : deque.jobs.front().first);
+        --standard_size_;
+    }
+
+    template <typename T> void ThreadPool::SafeQueue<T>::pop_back(WorkerDeque& deque, T& out) {
+        out = std::move(deque.jobs.back().second);
+        deque.jobs.pop_back();
+        if(deque.jobs.empty()) {
+            deque.front_ticket = UINT64_MAX;
+        }
+        --standard_size_;
+    }
+
+    template <typename T> bool ThreadPool::SafeQueue<T>::push(T value, bool wait) {
         // Check if the queue reached its full size
-        if(queue_.size() >= max_standard_size_) {
+        if(standard_size_ >= max_standard_size_) {
             // Wait until the queue is below the max size or it was invalidated(shutdown)
             if(!wait) {
                 return false;
             }
-            push_condition_.wait(lock, [this]() { return queue_.size() < max_standard_size_ || !valid_; });
+            std::unique_lock<std::mutex> lock{sleep_mutex_};
+            ++push_sleepers_;
+            push_condition_.wait(lock, [this]() { return standard_size_ < max_standard_size_ || !valid_; });
+            --push_sleepers_;
         }
 
         // Abort the push operation if conditions not met
-        if(queue_.size() >= max_standard_size_ || !valid_) {
+        if(standard_size_ >= max_standard_size_ || !valid_) {
             return false;
         }
 
-        // Push a new element to the queue and notify possible consumer
-        queue_.push(std::move(value));
-        lock.unlock();
-        pop_condition_.notify_one();
+        // Push a new element to the next deque and notify possible consumer, the ticket is drawn while holding the lock to
+        // keep the tickets within a deque increasing
+        auto& deque = *deques_[next_deque_++ % deques_.size()];
+        {
+            std::lock_guard<std::mutex> lock{deque.mutex};
+            auto ticket = next_ticket_++;
+            deque.jobs.emplace_back(ticket, std::move(value));
+            if(deque.jobs.size() == 1) {
+                deque.front_ticket = ticket;
+            }
+            ++standard_size_;
+        }
+        notify_poppers(false);
         return true;
     }
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wstrict-overflow"
     template <typename T> bool ThreadPool::SafeQueue<T>::push(uint64_t n, T value, bool wait) {
-        // Lock the mutex
-        std::unique_lock<std::mutex> lock{mutex_};
         assert(n >= current_id_);
 
-        // Check if the queue reached its full size
-        if(priority_queue_.size() >= max_priority_size_) {
+        // Reserve capacity in the priority buffer
+        while(priority_size_++ >= max_priority_size_) {
+            --priority_size_;
             // Wait until the queue is below the max size or it was invalidated(shutdown)
             if(!wait) {
                 return false;
             }
-            push_condition_.wait(lock, [this]() { return priority_queue_.size() < max_priority_size_ || !valid_; });
+            std::unique_lock<std::mutex> lock{sleep_mutex_};
+            ++push_sleepers_;
+            push_condition_.wait(lock, [this]() { return priority_size_ < max_priority_size_ || !valid_; });
+            --push_sleepers_;
+            if(!valid_) {
+                return false;
+            }
         }
 
-        // Abort the push operation if conditions not met
-        if(priority_queue_.size() >= max_priority_size_ || !valid_) {
+        // Abort the push operation if the queue has been invalidated
+        if(!valid_) {
+            --priority_size_;
             return false;
         }
 
-        // Push a new element to the queue and notify possible consumer
-        priority_queue_.emplace(n, std::move(value));
-        priority_queue_size_++;
-        lock.unlock();
-        pop_condition_.notify_one();
+        // Claim the slot of the identifier, publishing the value by storing the identifier afterwards
+        auto& slot = priority_ring_[n & ring_mask_];
+        auto expected = empty_slot_;
+        if(slot.id.compare_exchange_strong(expected, busy_slot_)) {
+            slot.value = value.release();
+            slot.id = n;
+        } else {
+            std::lock_guard<std::mutex> lock{overflow_mutex_};
+            priority_overflow_.emplace(n, std::move(value));
+            ++overflow_size_;
+        }
+
+        // The buffered job might be the current one, thus notify all consumers
+        notify_poppers(true);
+        return true;
+    }
+
+    template <typename T> bool ThreadPool::SafeQueue<T>::pushUrgent(T value) {
+        if(!valid_) {
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{urgent_mutex_};
+            urgent_jobs_.push_back(std::move(value));
+            ++urgent_size_;
+        }
+        notify_poppers(false);
         return true;
     }
-#pragma GCC diagnostic pop
 
     template <typename T> void ThreadPool::SafeQueue<T>::complete(uint64_t n) {
-        std::unique_lock<std::mutex> lock{mutex_};
-        completed_ids_.insert(n);
-        auto iter = completed_ids_.begin();
-        while(iter != completed_ids_.end()) {
-            if(*iter != current_id_) {
-                return;
+        // Identifiers too far ahead of the current one would overwrite a pending slot of the ring
+        if(n - current_id_ > ring_mask_) {
+            std::lock_guard<std::mutex> lock{overflow_mutex_};
+            completed_overflow_.insert(n);
+            ++overflow_size_;
+        } else {
+            completed_ring_[n & ring_mask_] = n;
+        }
+
+        if(advance()) {
+            notify_poppers(true);
+        }
+    }
+
+    /*
+     * Concurrent callers advance the identifier together via compare-and-swap. Since every caller checks the ring after
+     * publishing its own identifier, the current identifier cannot get stuck on a completed identifier.
+     */
+    template <typename T> bool ThreadPool::SafeQueue<T>::advance() {
+        bool advanced = false;
+        auto current_id = current_id_.load();
+        while(true) {
+            if(completed_ring_[current_id & ring_mask_] == current_id) {
+                if(current_id_.compare_exchange_strong(current_id, current_id + 1)) {
+                    ++current_id;
+                    advanced = true;
+                }
+                continue;
             }
-            iter = completed_ids_.erase(iter);
-            ++current_id_;
-            lock.unlock();
-            pop_condition_.notify_one();
-            lock.lock();
+
+            // Move completed identifiers from the overflow into the ring once they fit
+            if(overflow_size_ != 0) {
+                std::lock_guard<std::mutex> lock{overflow_mutex_};
+                bool moved = false;
+                for(auto iter = completed_overflow_.begin(); iter != completed_overflow_.end();) {
+                    if(*iter >= current_id && *iter - current_id > ring_mask_) {
+                        break;
+                    }
+                    if(*iter >= current_id) {
+                        completed_ring_[*iter & ring_mask_] = *iter;
+                    }
+                    iter = completed_overflow_.erase(iter);
+                    --overflow_size_;
+                    moved = true;
+                }
+                if(moved) {
+                    continue;
+                }
+            }
+            return advanced;
         }
     }
 
-    template <typename T> uint64_t ThreadPool::SafeQueue<T>::currentId() const {
-        std::lock_guard<std::mutex> lock{mutex_};
-        return current_id_;
+    /*
+     * The epoch is increased before checking for sleepers, such that a popper going to sleep concurrently either sees the
+     * new epoch or is registered as sleeper and will be notified.
+     */
+    template <typename T> void ThreadPool::SafeQueue<T>::notify_poppers(bool all) {
+        ++pop_epoch_;
+        if(pop_sleepers_ != 0) {
+            std::lock_guard<std::mutex> lock{sleep_mutex_};
+            if(all) {
+                pop_condition_.notify_all();
+            } else {
+                pop_condition_.notify_one();
+            }
+        }
     }
 
-    template <typename T> bool ThreadPool::SafeQueue<T>::valid() const {
-        std::lock_guard<std::mutex> lock{mutex_};
-        return valid_;
+    template <typename T> void ThreadPool::SafeQueue<T>::notify_pushers() {
+        if(push_sleepers_ != 0) {
+            std::lock_guard<std::mutex> lock{sleep_mutex_};
+            push_condition_.notify_all();
+        }
     }
 
+    template <typename T> uint64_t ThreadPool::SafeQueue<T>::currentId() const { return current_id_; }
+
+    template <typename T> bool ThreadPool::SafeQueue<T>::valid() const { return valid_; }
+
     template <typename T> bool ThreadPool::SafeQueue<T>::empty() const {
-        std::lock_guard<std::mutex> lock{mutex_};
-        return !valid_ || (queue_.empty() && priority_queue_.empty());
+        return !valid_ || (standard_size_ == 0 && priority_size_ == 0 && urgent_size_ == 0);
     }
 
     template <typename T> size_t ThreadPool::SafeQueue<T>::size() const {
-        std::lock_guard<std::mutex> lock{mutex_};
-        return queue_.size() + priority_queue_.size();
+        return standard_size_ + priority_size_ + urgent_size_;
     }
 
-    template <typename T> size_t ThreadPool::SafeQueue<T>::prioritySize() const { return priority_queue_size_; }
+    template <typename T> size_t ThreadPool::SafeQueue<T>::prioritySize() const { return priority_size_; }
 
     /*
      * Used to ensure no conditions are being waited for in pop when a thread or the application is trying to exit. The queue
      * is invalid after calling this method and it is an error to continue using a queue after this method has been called.
      */
     template <typename T> void ThreadPool::SafeQueue<T>::invalidate() {
-        std::unique_lock<std::mutex> lock{mutex_};
-        std::priority_queue<PQValue, std::vector<PQValue>, std::greater<>>().swap(priority_queue_);
-        priority_queue_size_ = 0;
-        std::queue<T>().swap(queue_);
         valid_ = false;
-        lock.unlock();
+
+        for(auto& deque : deques_) {
+            std::lock_guard<std::mutex> lock{deque->mutex};
+            std::deque<std::pair<uint64_t, T>>().swap(deque->jobs);
+            deque->front_ticket = UINT64_MAX;
+        }
+        standard_size_ = 0;
+        {
+            std::lock_guard<std::mutex> lock{urgent_mutex_};
+            std::deque<T>().swap(urgent_jobs_);
+        }
+        urgent_size_ = 0;
+
+        // Release the values stored in the priority ring
+        for(uint64_t i = 0; i <= ring_mask_; ++i) {
+            auto id = priority_ring_[i].id.load();
+            if(id != empty_slot_ && id != busy_slot_ && priority_ring_[i].id.compare_exchange_strong(id, busy_slot_)) {
+                T(priority_ring_[i].value).reset();
+                priority_ring_[i].value = nullptr;
+                priority_ring_[i].id = empty_slot_;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock{overflow_mutex_};
+            priority_overflow_.clear();
+        }
+        priority_size_ = 0;
+
+        // Wake up all waiting threads while holding the lock to avoid missing a thread about to sleep
+        ++pop_epoch_;
+        std::lock_guard<std::mutex> lock{sleep_mutex_};
         push_condition_.notify_all();
         pop_condition_.notify_all();
     }
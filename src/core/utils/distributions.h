@@ -12,6 +12,10 @@
 #ifndef ALLPIX_RANDOM_DISTRIBUTIONS_H
 #define ALLPIX_RANDOM_DISTRIBUTIONS_H
 
+#include <array>
+#include <cmath>
+#include <cstddef>
+
 #include <boost/random/exponential_distribution.hpp>
 #include <boost/random/normal_distribution.hpp>
 #include <boost/random/piecewise_linear_distribution.hpp>
@@ -24,6 +28,50 @@ namespace allpix {
     template <typename T> using poisson_distribution = boost::random::poisson_distribution<T>;
     template <typename T> using uniform_real_distribution = boost::random::uniform_real_distribution<T>;
     template <typename T> using exponential_distribution = boost::random::exponential_distribution<T>;
+
+    /**
+     * @brief Standard normal distribution drawing its uniform random numbers from the generator in blocks
+     *
+     * Blocks of N uniform random numbers are requested from the generator via its fill method and transformed into pairs of
+     * normally distributed numbers using the Box-Muller method. This avoids the per-number overhead of the generator for
+     * consumers of many normally distributed numbers. Random numbers of a block which have not been used when the
+     * distribution is destroyed are discarded.
+     */
+    template <typename T, std::size_t N = 64> class buffered_normal_distribution {
+        static_assert(N % 2 == 0, "Block size needs to be even for the Box-Muller method");
+
+    public:
+        /**
+         * @brief Draw the next normally distributed number
+         * @param generator Generator providing the uniform random numbers via its fill method
+         * @return Normally distributed number with zero mean and unit standard deviation
+         */
+        template <typename Generator> T operator()(Generator& generator) {
+            if(next_ == N) {
+                refill(generator);
+            }
+            return values_[next_++];
+        }
+
+    private:
+        template <typename Generator> void refill(Generator& generator) {
+            std::array<typename Generator::result_type, N> raw{};
+            generator.fill(raw.data(), N);
+            for(std::size_t i = 0; i < N; i += 2) {
+                // Uniform numbers from the upper 53 bits, the first one in (0, 1] to keep the logarithm finite
+                auto u1 = (static_cast<T>(raw[i] >> 11) + 1) * static_cast<T>(0x1.0p-53);
+                auto u2 = static_cast<T>(raw[i + 1] >> 11) * static_cast<T>(0x1.0p-53);
+                auto radius = std::sqrt(-2 * std::log(u1));
+                auto angle = 2 * static_cast<T>(M_PI) * u2;
+                values_[i] = radius * std::cos(angle);
+                values_[i + 1] = radius * std::sin(angle);
+            }
+            next_ = 0;
+        }
+
+        std::array<T, N> values_{};
+        std::size_t next_{N};
+    };
 } // namespace allpix
 
 #endif // ALLPIX_RANDOM_DISTRIBUTIONS_H
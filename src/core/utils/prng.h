@@ -1,6 +1,6 @@
 /**
  * @file
- * @brief Provides a wrapper around the STL pseudo-random number generator Mersenne Twister
+ * @brief Provides a wrapper around the STL pseudo-random number generator Mersenne Twister and a counter-based generator
  *
  * @copyright Copyright (c) 2020-2023 CERN and the Allpix Squared authors.
  * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
@@ -14,15 +14,202 @@
 
 #include "core/utils/log.h"
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
 #include <random>
+#include <variant>
 
 namespace allpix {
 
     /**
-     * @brief Wrapper around the STL's Mersenne Twister
+     * @brief Counter-based pseudo-random number generator Philox4x32-10
+     *
+     * The generator computes each block of 128 random bits as a bijection of a counter, keyed by the seed. Its full state
+     * consists of the key, the stream and the position within the stream, such that it can be copied, stored and restored
+     * at no cost and independent streams are obtained by choosing different stream numbers with the same key. Random
+     * numbers are provided as 64-bit integers, two of which are generated by each evaluation of the bijection.
      */
-    class RandomNumberGenerator : public std::mt19937_64 {
+    class PhiloxEngine {
     public:
+        using result_type = std::uint64_t;
+
+        /**
+         * @brief Construct a generator at the beginning of a stream
+         * @param key Key (seed) of the generator
+         * @param stream Number of the independent stream
+         */
+        explicit PhiloxEngine(std::uint64_t key = 0, std::uint64_t stream = 0) : key_(key), stream_(stream) {}
+
+        /**
+         * @brief Seed the generator, resetting it to the beginning of the stream
+         * @param key Key (seed) of the generator
+         */
+        void seed(std::uint64_t key) {
+            key_ = key;
+            counter_ = 0;
+            cached_block_ = no_block;
+        }
+
+        /**
+         * @brief Select the stream of the generator, resetting it to the beginning of the stream
+         * @param stream Number of the independent stream
+         */
+        void setStream(std::uint64_t stream) {
+            stream_ = stream;
+            counter_ = 0;
+            cached_block_ = no_block;
+        }
+
+        /**
+         * @brief Advance the generator without generating the random numbers
+         * @param steps Number of random numbers to skip
+         */
+        void discard(std::uint64_t steps) { counter_ += steps; }
+
+        /**
+         * @brief Generate the next random number
+         * @return 64-bit pseudo-random number
+         */
+        result_type operator()() {
+            auto block = counter_ >> 1;
+            if(block != cached_block_) {
+                cached_ = generate(block);
+                cached_block_ = block;
+            }
+            return cached_[counter_++ & 1];
+        }
+
+        /**
+         * @brief Fill a buffer with consecutive random numbers of the stream
+         * @param output Pointer to the buffer
+         * @param count Number of random numbers to generate
+         *
+         * The result is identical to calling the generator \p count times, but the blocks are generated without
+         * intermediate caching.
+         */
+        void fill(result_type* output, std::size_t count) {
+            std::size_t i = 0;
+            // Complete a partially consumed block
+            for(; i < count && (counter_ & 1) != 0; ++i) {
+                output[i] = (*this)();
+            }
+            for(; i + 1 < count; i += 2) {
+                auto values = generate(counter_ >> 1);
+                output[i] = values[0];
+                output[i + 1] = values[1];
+                counter_ += 2;
+            }
+            for(; i < count; ++i) {
+                output[i] = (*this)();
+            }
+        }
+
+        static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        /**
+         * @brief Write the key, stream and position of the generator to a stream
+         * @param os Output stream
+         * @param engine Generator to store
+         * @return Output stream
+         */
+        friend std::ostream& operator<<(std::ostream& os, const PhiloxEngine& engine) {
+            return os << engine.key_ << ' ' << engine.stream_ << ' ' << engine.counter_;
+        }
+
+        /**
+         * @brief Read the key, stream and position of the generator from a stream
+         * @param is Input stream
+         * @param engine Generator to restore
+         * @return Input stream
+         */
+        friend std::istream& operator>>(std::istream& is, PhiloxEngine& engine) {
+            is >> engine.key_ >> engine.stream_ >> engine.counter_;
+            engine.cached_block_ = no_block;
+            return is;
+        }
+
+    private:
+        /**
+         * @brief Evaluate the Philox4x32-10 bijection for a block of the stream
+         * @param block Number of the block within the stream
+         * @return Two 64-bit random numbers
+         */
+        std::array<result_type, 2> generate(std::uint64_t block) const {
+            std::array<std::uint32_t, 4> ctr{static_cast<std::uint32_t>(block),
+                                             static_cast<std::uint32_t>(block >> 32),
+                                             static_cast<std::uint32_t>(stream_),
+                                             static_cast<std::uint32_t>(stream_ >> 32)};
+            std::uint32_t k0 = static_cast<std::uint32_t>(key_);
+            std::uint32_t k1 = static_cast<std::uint32_t>(key_ >> 32);
+            for(int round = 0; round < 10; ++round) {
+                auto product0 = std::uint64_t(0xD2511F53) * ctr[0];
+                auto product1 = std::uint64_t(0xCD9E8D57) * ctr[2];
+                ctr = {static_cast<std::uint32_t>(product1 >> 32) ^ ctr[1] ^ k0,
+                       static_cast<std::uint32_t>(product1),
+                       static_cast<std::uint32_t>(product0 >> 32) ^ ctr[3] ^ k1,
+                       static_cast<std::uint32_t>(product0)};
+                k0 += 0x9E3779B9;
+                k1 += 0xBB67AE85;
+            }
+            return {(result_type(ctr[1]) << 32) | ctr[0], (result_type(ctr[3]) << 32) | ctr[2]};
+        }
+
+        static constexpr std::uint64_t no_block = std::numeric_limits<std::uint64_t>::max();
+
+        std::uint64_t key_;
+        std::uint64_t stream_;
+        std::uint64_t counter_{0};
+
+        // Last generated block, derived from the state
+        std::array<result_type, 2> cached_{};
+        std::uint64_t cached_block_{no_block};
+    };
+
+    /**
+     * @brief Engines available for pseudo-random number generation
+     */
+    enum class RandomEngine {
+        MERSENNE_TWISTER, ///< 64-bit Mersenne Twister mt19937_64 from the C++ Standard Library
+        PHILOX,           ///< Counter-based Philox4x32-10 generator
+    };
+
+    /**
+     * @brief Wrapper around the STL's Mersenne Twister or the counter-based \ref PhiloxEngine
+     *
+     * The engine is selected at construction, either explicitly or from the framework-wide setting, and held in a variant
+     * such that only the selected engine is constructed and seeded. Counter-based generators allow to store and restore
+     * their state by means of a single integer and to derive independent streams from the same seed.
+     */
+    class RandomNumberGenerator {
+    public:
+        using result_type = std::uint64_t;
+        static constexpr result_type default_seed = std::mt19937_64::default_seed;
+
+        /**
+         * @brief Construct a generator using the framework-wide engine selection
+         */
+        RandomNumberGenerator() : RandomNumberGenerator(default_engine_.load()) {}
+
+        /**
+         * @brief Construct a generator using the given engine
+         * @param engine Engine to use for pseudo-random number generation
+         */
+        explicit RandomNumberGenerator(RandomEngine engine) : engine_(make_engine(engine)) {}
+
+        /// @{
+        /**
+         * @brief Allow copy construction and move construction
+         */
+        RandomNumberGenerator(const RandomNumberGenerator&) = default;
+        RandomNumberGenerator(RandomNumberGenerator&&) = default;
+        /// @}
+
         /// @{
         /**
          * @brief Disallow copy-assignment
@@ -36,22 +223,121 @@ namespace allpix {
         RandomNumberGenerator& operator=(RandomNumberGenerator&&) = delete;
 
         /**
-         * Redefine function operator to retrieve pseudo-random numbers. This allows us to log the number at retrieval.
-         * Technically we are shadowing the base class operator since it is non-virtual and explicitly call it from within.
+         * Function operator to retrieve pseudo-random numbers. This allows us to log the number at retrieval.
          *
          * @return 64-bit pseudo-random number
          */
-        std::uint_fast64_t operator()() {
+        result_type operator()() {
             // Only copy if we want to log it
             IFLOG(PRNG) {
-                auto prn = std::mt19937_64::operator()();
+                auto prn = next();
                 LOG(PRNG) << "Using random number " << prn;
                 return prn;
             }
             else {
-                return std::mt19937_64::operator()();
+                return next();
+            }
+        }
+
+        /**
+         * @brief Seed the generator
+         * @param value Seed value
+         */
+        void seed(result_type value = default_seed) {
+            std::visit([value](auto& engine) { engine.seed(value); }, engine_);
+        }
+
+        /**
+         * @brief Advance the generator without using the random numbers
+         * @param steps Number of random numbers to skip
+         */
+        void discard(unsigned long long steps) {
+            std::visit([steps](auto& engine) { engine.discard(steps); }, engine_);
+        }
+
+        /**
+         * @brief Fill a buffer with consecutive pseudo-random numbers, identical to repeated calls of the generator
+         * @param output Pointer to the buffer
+         * @param count Number of random numbers to generate
+         */
+        void fill(result_type* output, std::size_t count) {
+            if(auto* philox = std::get_if<PhiloxEngine>(&engine_)) {
+                philox->fill(output, count);
+            } else {
+                auto& mersenne_twister = std::get<std::mt19937_64>(engine_);
+                for(std::size_t i = 0; i < count; ++i) {
+                    output[i] = mersenne_twister();
+                }
+            }
+            IFLOG(PRNG) {
+                for(std::size_t i = 0; i < count; ++i) {
+                    LOG(PRNG) << "Using random number " << output[i];
+                }
             }
         }
+
+        /**
+         * @brief Check whether the generator is counter-based
+         * @return True if the \ref PhiloxEngine is used, false for the Mersenne Twister
+         */
+        bool isCounterBased() const { return std::holds_alternative<PhiloxEngine>(engine_); }
+
+        /**
+         * @brief Get the counter-based engine
+         * @return Reference to the engine
+         * @throws std::bad_variant_access If the generator is not counter-based
+         */
+        PhiloxEngine& getPhiloxEngine() { return std::get<PhiloxEngine>(engine_); }
+
+        /**
+         * @brief Select the engine of all generators constructed subsequently without explicit engine
+         * @param engine Engine to use for pseudo-random number generation
+         */
+        static void setDefaultEngine(RandomEngine engine) { default_engine_.store(engine); }
+
+        static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        /**
+         * @brief Write the state of the generator to a stream
+         * @param os Output stream
+         * @param generator Generator to store
+         * @return Output stream
+         */
+        friend std::ostream& operator<<(std::ostream& os, const RandomNumberGenerator& generator) {
+            std::visit([&os](const auto& engine) { os << engine; }, generator.engine_);
+            return os;
+        }
+
+        /**
+         * @brief Read the state of the generator from a stream, the generator has to use the same engine as when storing
+         * @param is Input stream
+         * @param generator Generator to restore
+         * @return Input stream
+         */
+        friend std::istream& operator>>(std::istream& is, RandomNumberGenerator& generator) {
+            std::visit([&is](auto& engine) { is >> engine; }, generator.engine_);
+            return is;
+        }
+
+    private:
+        static std::variant<std::mt19937_64, PhiloxEngine> make_engine(RandomEngine engine) {
+            if(engine == RandomEngine::PHILOX) {
+                return PhiloxEngine();
+            }
+            return std::mt19937_64();
+        }
+
+        result_type next() {
+            if(auto* philox = std::get_if<PhiloxEngine>(&engine_)) {
+                return (*philox)();
+            }
+            return std::get<std::mt19937_64>(engine_)();
+        }
+
+        std::variant<std::mt19937_64, PhiloxEngine> engine_;
+
+        static inline std::atomic<RandomEngine> default_engine_{RandomEngine::MERSENNE_TWISTER};
     };
 } // namespace allpix
 
@@ -11,6 +11,10 @@
 
 #include "CSADigitizerModule.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
 #include "core/utils/distributions.h"
 #include "core/utils/unit.h"
 #include "tools/ROOT.h"
@@ -26,6 +30,44 @@
 
 using namespace allpix;
 
+namespace {
+    /**
+     * @brief In-place iterative radix-2 fast Fourier transform
+     * @param data     Sequence to transform, the size is required to be a power of two
+     * @param twiddles Twiddle factors exp(-2 pi i k / N) for k < N / 2
+     * @param inverse  Perform the inverse transform, without normalization
+     */
+    void fft(std::vector<std::complex<double>>& data, const std::vector<std::complex<double>>& twiddles, bool inverse) {
+        auto size = data.size();
+
+        // Bit-reversal permutation
+        for(size_t i = 1, j = 0; i < size; ++i) {
+            auto bit = size >> 1;
+            for(; (j & bit) != 0; bit >>= 1) {
+                j ^= bit;
+            }
+            j ^= bit;
+            if(i < j) {
+                std::swap(data[i], data[j]);
+            }
+        }
+
+        // Butterflies, doubling the transform length in every stage
+        for(size_t length = 2; length <= size; length <<= 1) {
+            auto half = length / 2;
+            auto stride = size / length;
+            for(size_t start = 0; start < size; start += length) {
+                for(size_t k = 0; k < half; ++k) {
+                    auto twiddle = (inverse ? std::conj(twiddles[k * stride]) : twiddles[k * stride]);
+                    auto odd = data[start + k + half] * twiddle;
+                    data[start + k + half] = data[start + k] - odd;
+                    data[start + k] += odd;
+                }
+            }
+        }
+    }
+} // namespace
+
 CSADigitizerModule::CSADigitizerModule(Configuration& config, Messenger* messenger, std::shared_ptr<Detector> detector)
     : Module(config, std::move(detector)), messenger_(messenger) {
 
@@ -39,6 +81,7 @@ CSADigitizerModule::CSADigitizerModule(Configuration& config, Messenger* messeng
     config_.setDefault<double>("integration_time", Units::get(500, "ns"));
     config_.setDefault<double>("threshold", Units::get(10e-3, "V"));
     config_.setDefault<bool>("ignore_polarity", false);
+    config_.setDefault("convolution", ConvolutionMethod::AUTO);
 
     config_.setDefault<double>("sigma_noise", Units::get(1e-4, "V"));
 
@@ -79,6 +122,7 @@ CSADigitizerModule::CSADigitizerModule(Configuration& config, Messenger* messeng
     sigmaNoise_ = config_.get<double>("sigma_noise");
     threshold_ = config_.get<double>("threshold");
     ignore_polarity_ = config.get<bool>("ignore_polarity");
+    convolution_ = config_.get<ConvolutionMethod>("convolution");
 
     if(model_ == DigitizerType::SIMPLE) {
         auto tauF = config_.get<double>("feedback_time_constant");
@@ -259,6 +303,10 @@ void CSADigitizerModule::run(Event* event) {
                 getROOTDirectory()->WriteTObject(response_graph, "response_function");
             }
 
+            if(convolution_ != ConvolutionMethod::DIRECT) {
+                prepare_fft();
+            }
+
             LOG(INFO) << "Initialized impulse response with timestep " << Units::display(timestep, {"ps", "ns", "us"})
                       << " and integration time " << Units::display(integration_time_, {"ns", "us", "ms"})
                       << ", samples: " << ntimepoints;
@@ -269,17 +317,16 @@ void CSADigitizerModule::run(Event* event) {
                    << Units::display(timestep, {"ps", "ns"}) << ", total charge: " << Units::display(pulse.getCharge(), "e");
 
         // Convolution of the input pulse with the impulse response (size ntimepoints)
+        thread_local std::vector<double> convolved;
+        if(use_fft(pulse.size())) {
+            LOG(TRACE) << "Convolving pulse with impulse response in frequency domain";
+            convolve_fft(pulse, convolved);
+        } else {
+            LOG(TRACE) << "Convolving pulse with impulse response in time domain";
+            convolve_direct(pulse, convolved);
+        }
         for(size_t k = 0; k < ntimepoints; ++k) {
-            double outsum{};
-            // Convolution: multiply pulse.at(k - i) * impulse_response_function_.at(i), when (k - i) < input length
-            // -> no point to start i at 0, start from jmin:
-            size_t jmin = (k >= pulse.size() - 1) ? k - (pulse.size() - 1) : 0;
-            for(size_t i = jmin; i <= k; ++i) {
-                if((k - i) < pulse.size()) {
-                    outsum += pulse.at(k - i) * impulse_response_function_.at(i);
-                }
-            }
-            amplified_pulse.addCharge(outsum, timestep * static_cast<double>(k));
+            amplified_pulse.addCharge(convolved[k], timestep * static_cast<double>(k));
         }
 
         if(output_pulsegraphs_) {
@@ -362,6 +409,78 @@ void CSADigitizerModule::run(Event* event) {
     }
 }
 
+void CSADigitizerModule::prepare_fft() {
+    // Smallest power of two holding the linear convolution of two sequences with the length of the impulse response
+    size_t fft_size = 1;
+    while(fft_size < 2 * impulse_response_function_.size()) {
+        fft_size <<= 1;
+    }
+
+    fft_twiddles_.resize(fft_size / 2);
+    for(size_t k = 0; k < fft_twiddles_.size(); ++k) {
+        fft_twiddles_[k] = std::polar(1.0, -2. * M_PI * static_cast<double>(k) / static_cast<double>(fft_size));
+    }
+
+    impulse_response_spectrum_.assign(fft_size, {});
+    std::copy(impulse_response_function_.begin(), impulse_response_function_.end(), impulse_response_spectrum_.begin());
+    fft(impulse_response_spectrum_, fft_twiddles_, false);
+
+    LOG(DEBUG) << "Prepared impulse response spectrum with " << fft_size << " frequency bins";
+}
+
+bool CSADigitizerModule::use_fft(size_t pulse_size) const {
+    if(convolution_ != ConvolutionMethod::AUTO) {
+        return convolution_ == ConvolutionMethod::FFT;
+    }
+
+    // Only input bins within the impulse response length contribute to the output
+    auto samples = static_cast<double>(impulse_response_function_.size());
+    auto direct_cost = samples * static_cast<double>(std::min(pulse_size, impulse_response_function_.size()));
+
+    // Forward and inverse transform, each butterfly weighted with the cost of about four multiply-adds
+    auto fft_size = static_cast<double>(impulse_response_spectrum_.size());
+    auto fft_cost = 4. * fft_size * std::log2(fft_size);
+    return direct_cost > fft_cost;
+}
+
+void CSADigitizerModule::convolve_direct(const std::vector<double>& pulse, std::vector<double>& output) const {
+    auto ntimepoints = impulse_response_function_.size();
+    output.assign(ntimepoints, 0.);
+    for(size_t k = 0; k < ntimepoints; ++k) {
+        double outsum{};
+        // Convolution: multiply pulse.at(k - i) * impulse_response_function_.at(i), when (k - i) < input length
+        // -> no point to start i at 0, start from jmin:
+        size_t jmin = (k >= pulse.size() - 1) ? k - (pulse.size() - 1) : 0;
+        for(size_t i = jmin; i <= k; ++i) {
+            if((k - i) < pulse.size()) {
+                outsum += pulse[k - i] * impulse_response_function_[i];
+            }
+        }
+        output[k] = outsum;
+    }
+}
+
+void CSADigitizerModule::convolve_fft(const std::vector<double>& pulse, std::vector<double>& output) const {
+    auto ntimepoints = impulse_response_function_.size();
+
+    // Transform the pulse, truncated to the impulse response length, zero-padded to the size of the cached spectrum
+    thread_local std::vector<std::complex<double>> spectrum;
+    spectrum.assign(impulse_response_spectrum_.size(), {});
+    std::copy_n(pulse.begin(), std::min(pulse.size(), ntimepoints), spectrum.begin());
+    fft(spectrum, fft_twiddles_, false);
+
+    // Multiply with the impulse response in frequency domain and transform back
+    std::transform(
+        spectrum.begin(), spectrum.end(), impulse_response_spectrum_.begin(), spectrum.begin(), std::multiplies<>());
+    fft(spectrum, fft_twiddles_, true);
+
+    output.resize(ntimepoints);
+    auto norm = 1. / static_cast<double>(spectrum.size());
+    for(size_t k = 0; k < ntimepoints; ++k) {
+        output[k] = spectrum[k].real() * norm;
+    }
+}
+
 std::tuple<bool, unsigned int, double> CSADigitizerModule::get_toa(double timestep, const std::vector<double>& pulse) const {
 
     LOG(TRACE) << "Calculating time-of-arrival";
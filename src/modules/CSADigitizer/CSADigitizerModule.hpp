@@ -12,8 +12,10 @@
 #ifndef ALLPIX_CSA_DIGITIZER_MODULE_H
 #define ALLPIX_CSA_DIGITIZER_MODULE_H
 
+#include <complex>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "core/config/Configuration.hpp"
 #include "core/messenger/Messenger.hpp"
@@ -46,6 +48,15 @@ namespace allpix {
             CUSTOM, ///< Custom impulse response function using a ROOT::TFormula expression
         };
 
+        /**
+         * @brief Different methods for the convolution of the pulse with the impulse response
+         */
+        enum class ConvolutionMethod {
+            AUTO,   ///< Select the method with the lower expected cost for each pulse
+            DIRECT, ///< Direct summation in the time domain
+            FFT,    ///< Multiplication in the frequency domain using fast Fourier transforms
+        };
+
     public:
         /**
          * @brief Constructor for this detector-specific module
@@ -88,10 +99,44 @@ namespace allpix {
         std::vector<double> impulse_response_function_;
         std::once_flag first_event_flag_;
 
+        // Convolution method and cached transform of the impulse response
+        ConvolutionMethod convolution_;
+        std::vector<std::complex<double>> fft_twiddles_;
+        std::vector<std::complex<double>> impulse_response_spectrum_;
+
         // Output histograms
         Histogram<TH1D> h_tot{}, h_toa{};
         Histogram<TH2D> h_pxq_vs_tot{};
 
+        /**
+         * @brief Prepare the transform of the impulse response for the convolution in the frequency domain
+         *
+         * The transform size is the smallest power of two which accommodates the linear convolution of the full impulse
+         * response with an input pulse of the same length, such that no circular aliasing occurs.
+         */
+        void prepare_fft();
+
+        /**
+         * @brief Decide whether the convolution of a pulse is cheaper in the frequency domain
+         * @param pulse_size Number of bins of the input pulse
+         * @return True if the frequency domain convolution should be used
+         */
+        bool use_fft(size_t pulse_size) const;
+
+        /**
+         * @brief Convolve a pulse with the impulse response by direct summation
+         * @param pulse  Input pulse
+         * @param output Output buffer, holding the amplifier response for each bin of the impulse response
+         */
+        void convolve_direct(const std::vector<double>& pulse, std::vector<double>& output) const;
+
+        /**
+         * @brief Convolve a pulse with the impulse response via the cached transform of the impulse response
+         * @param pulse  Input pulse
+         * @param output Output buffer, holding the amplifier response for each bin of the impulse response
+         */
+        void convolve_fft(const std::vector<double>& pulse, std::vector<double>& output) const;
+
         /**
          * @brief Calculate time of first threshold crossing
          * @param timestep Step size of the input pulse
@@ -12,10 +12,12 @@
 
 #include <fstream>
 #include <limits>
+#include <map>
 #include <memory>
 #include <new>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
 
 #include "core/config/exceptions.h"
@@ -46,8 +48,9 @@ CapacitiveTransferModule::CapacitiveTransferModule(Configuration& config,
     cross_coupling_ = config_.get<bool>("cross_coupling");
     max_depth_distance_ = config_.get<double>("max_depth_distance");
 
-    // Require propagated deposits for single detector
-    messenger_->bindSingle<PropagatedChargeMessage>(this, MsgFlags::REQUIRED);
+    // Require either full or compact propagated deposits for single detector
+    messenger_->bindSingle<PropagatedChargeMessage>(this, MsgFlags::REQUIRED_ANY);
+    messenger_->bindSingle<CompactPropagatedChargeMessage>(this, MsgFlags::REQUIRED_ANY);
 }
 
 void CapacitiveTransferModule::initialize() {
@@ -261,13 +264,21 @@ void CapacitiveTransferModule::initialize() {
 }
 
 void CapacitiveTransferModule::run(Event* event) {
-    auto propagated_message = messenger_->fetchMessage<PropagatedChargeMessage>(this, event);
+    // Transfer the compact propagated charges if available, the full objects otherwise
+    if(messenger_->hasMessage<CompactPropagatedChargeMessage>(this, event)) {
+        transfer_charges(event, messenger_->fetchMessage<CompactPropagatedChargeMessage>(this, event)->getData());
+    } else {
+        transfer_charges(event, messenger_->fetchMessage<PropagatedChargeMessage>(this, event)->getData());
+    }
+}
 
+template <typename T>
+void CapacitiveTransferModule::transfer_charges(Event* event, const std::vector<T>& propagated_charges) {
     // Find corresponding pixels for all propagated charges
     LOG(TRACE) << "Transferring charges to pixels";
     unsigned int transferred_charges_count = 0;
     std::map<Pixel::Index, std::pair<double, std::vector<const PropagatedCharge*>>> pixel_map;
-    for(const auto& propagated_charge : propagated_message->getData()) {
+    for(const auto& propagated_charge : propagated_charges) {
         auto position = propagated_charge.getLocalPosition();
         // Ignore if outside depth range of implant
         if(std::fabs(position.z() - (model_->getSensorCenter().z() + model_->getSensorSize().z() / 2.0)) >
@@ -336,9 +347,11 @@ void CapacitiveTransferModule::run(Event* event) {
                            << col << "," << row << " pixel " << pixel_index << "with cross-coupling of " << ccpd_factor * 100
                            << "%";
 
-                // Add the pixel the list of hit pixels
+                // Add the pixel the list of hit pixels, keeping the history for full propagated charge objects
                 pixel_map[pixel_index].first += neighbour_charge;
-                pixel_map[pixel_index].second.emplace_back(&propagated_charge);
+                if constexpr(std::is_same_v<T, PropagatedCharge>) {
+                    pixel_map[pixel_index].second.emplace_back(&propagated_charge);
+                }
             }
         }
     }
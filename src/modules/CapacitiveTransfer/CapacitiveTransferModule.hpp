@@ -26,6 +26,7 @@
 #include "core/module/Event.hpp"
 #include "core/module/Module.hpp"
 
+#include "objects/CompactPropagatedCharge.hpp"
 #include "objects/Pixel.hpp"
 #include "objects/PixelCharge.hpp"
 #include "objects/PropagatedCharge.hpp"
@@ -69,6 +70,13 @@ namespace allpix {
         void finalize() override;
 
     private:
+        /**
+         * @brief Transfer a set of propagated charges to the pixels and dispatch the resulting pixel charges
+         * @param event Pointer to the event the charges belong to
+         * @param propagated_charges Full or compact propagated charges to transfer
+         */
+        template <typename T> void transfer_charges(Event* event, const std::vector<T>& propagated_charges);
+
         // Configuration config_;
         Messenger* messenger_;
         std::shared_ptr<Detector> detector_;
@@ -0,0 +1,259 @@
+/**
+ * @file
+ * @brief Implementation of columnar data file reader module
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ColumnarReaderModule.hpp"
+
+#include <string>
+#include <utility>
+
+#include "core/utils/log.h"
+
+#include "objects/DepositedCharge.hpp"
+#include "objects/MCParticle.hpp"
+#include "objects/PixelCharge.hpp"
+#include "objects/PixelHit.hpp"
+
+using namespace allpix;
+using namespace allpix::columnar;
+
+namespace {
+    /**
+     * @brief Views on the three consecutive columns holding the coordinates of a point
+     */
+    struct PointColumns {
+        ColumnView<double> x, y, z;
+
+        ROOT::Math::XYZPoint operator[](size_t row) const { return {x[row], y[row], z[row]}; }
+    };
+
+    template <typename C> PointColumns get_point(const ColumnarReader& reader, size_t chunk, Table table, C first_column) {
+        auto column = static_cast<uint32_t>(first_column);
+        return {reader.getColumn<double>(chunk, table, column),
+                reader.getColumn<double>(chunk, table, column + 1),
+                reader.getColumn<double>(chunk, table, column + 2)};
+    }
+
+    /**
+     * @brief Reserve the storage for the objects of every detector in a range of rows
+     * @note Reserving the exact size upfront keeps the objects at a fixed address for relations between them
+     */
+    template <typename T>
+    std::map<uint16_t, std::vector<T>>
+    reserve_objects(const ColumnView<uint16_t>& detectors, std::pair<uint64_t, uint64_t> rows) {
+        std::map<uint16_t, size_t> counts;
+        for(auto row = rows.first; row < rows.second; ++row) {
+            counts[detectors[row]]++;
+        }
+        std::map<uint16_t, std::vector<T>> objects;
+        for(const auto& [detector, count] : counts) {
+            objects[detector].reserve(count);
+        }
+        return objects;
+    }
+} // namespace
+
+ColumnarReaderModule::ColumnarReaderModule(Configuration& config, Messenger* messenger, GeometryManager* geo_mgr)
+    : Module(config), messenger_(messenger), geo_mgr_(geo_mgr) {
+    // Enable multithreading of this module if multithreading is enabled
+    allow_multithreading();
+
+    config_.setDefault("cached_chunks", 4);
+    config_.setDefaultArray<std::string>("include", {object_names.begin(), object_names.end()});
+}
+
+void ColumnarReaderModule::initialize() {
+    // Read and check the objects to read
+    for(const auto& name : config_.getArray<std::string>("include")) {
+        if(object_names.find(name) == object_names.end()) {
+            throw InvalidValueError(config_, "include", "object " + name + " is not stored in columnar format");
+        }
+        include_.insert(name);
+    }
+
+    // Open the file with the objects
+    auto input_file_name = config_.getPathWithExtension("file_name", "apxc", true);
+    try {
+        reader_ = std::make_unique<ColumnarReader>(input_file_name, config_.get<size_t>("cached_chunks"));
+    } catch(const std::runtime_error& e) {
+        throw InvalidValueError(config_, "file_name", e.what());
+    }
+    LOG(DEBUG) << "Opened columnar file with " << reader_->getEventCount() << " events";
+
+    // Match the detectors stored in the file
+    for(const auto& name : reader_->getDetectors()) {
+        detectors_.push_back(geo_mgr_->getDetector(name));
+    }
+}
+
+void ColumnarReaderModule::run(Event* event) {
+    // Locate the event in the file
+    auto event_index = event->number - 1;
+    if(event_index >= reader_->getEventCount()) {
+        throw EndOfRunException("Requesting end of run because file only contains data for " +
+                                std::to_string(reader_->getEventCount()) + " events");
+    }
+    auto [chunk, index] = reader_->locate(event_index);
+    const auto& reader = *reader_;
+
+    // Monte-Carlo particles, with the location of every row to resolve relations
+    std::map<uint16_t, std::vector<MCParticle>> mc_particles;
+    std::vector<MCParticle*> mc_particle_rows;
+    if(include_.count("MCParticle") != 0) {
+        using Column = MCParticleColumn;
+        constexpr auto table = Table::MCPARTICLE;
+        auto rows = reader.getRows(chunk, index, table);
+        auto detector = reader.getColumn<uint16_t>(chunk, table, Column::DETECTOR);
+        auto particle_id = reader.getColumn<int32_t>(chunk, table, Column::PARTICLE_ID);
+        auto local_start = get_point(reader, chunk, table, Column::LOCAL_START_X);
+        auto global_start = get_point(reader, chunk, table, Column::GLOBAL_START_X);
+        auto local_end = get_point(reader, chunk, table, Column::LOCAL_END_X);
+        auto global_end = get_point(reader, chunk, table, Column::GLOBAL_END_X);
+        auto local_time = reader.getColumn<double>(chunk, table, Column::LOCAL_TIME);
+        auto global_time = reader.getColumn<double>(chunk, table, Column::GLOBAL_TIME);
+        auto deposited_charge = reader.getColumn<uint32_t>(chunk, table, Column::DEPOSITED_CHARGE);
+        auto parent = reader.getColumn<int32_t>(chunk, table, Column::PARENT);
+
+        mc_particles = reserve_objects<MCParticle>(detector, rows);
+        for(auto row = rows.first; row < rows.second; ++row) {
+            auto& mc_particle = mc_particles[detector[row]].emplace_back(local_start[row],
+                                                                          global_start[row],
+                                                                          local_end[row],
+                                                                          global_end[row],
+                                                                          particle_id[row],
+                                                                          local_time[row],
+                                                                          global_time[row]);
+            mc_particle.setTotalDepositedCharge(deposited_charge[row]);
+            mc_particle_rows.push_back(&mc_particle);
+        }
+
+        // Restore the parents once all particles of the event exist
+        for(auto row = rows.first; row < rows.second; ++row) {
+            auto parent_row = parent[row];
+            if(parent_row != no_row && static_cast<size_t>(parent_row) < mc_particle_rows.size()) {
+                mc_particle_rows[row - rows.first]->setParent(mc_particle_rows[parent_row]);
+            }
+        }
+    }
+    auto get_mc_particle = [&mc_particle_rows](int32_t row) -> const MCParticle* {
+        return (row == no_row || static_cast<size_t>(row) >= mc_particle_rows.size() ? nullptr : mc_particle_rows[row]);
+    };
+
+    // Deposited charges
+    std::map<uint16_t, std::vector<DepositedCharge>> deposits;
+    if(include_.count("DepositedCharge") != 0) {
+        using Column = DepositedChargeColumn;
+        constexpr auto table = Table::DEPOSITEDCHARGE;
+        auto rows = reader.getRows(chunk, index, table);
+        auto detector = reader.getColumn<uint16_t>(chunk, table, Column::DETECTOR);
+        auto local_position = get_point(reader, chunk, table, Column::LOCAL_X);
+        auto global_position = get_point(reader, chunk, table, Column::GLOBAL_X);
+        auto carrier_type = reader.getColumn<int8_t>(chunk, table, Column::CARRIER_TYPE);
+        auto charge = reader.getColumn<uint32_t>(chunk, table, Column::CHARGE);
+        auto local_time = reader.getColumn<double>(chunk, table, Column::LOCAL_TIME);
+        auto global_time = reader.getColumn<double>(chunk, table, Column::GLOBAL_TIME);
+        auto mc_particle = reader.getColumn<int32_t>(chunk, table, Column::MCPARTICLE);
+
+        deposits = reserve_objects<DepositedCharge>(detector, rows);
+        for(auto row = rows.first; row < rows.second; ++row) {
+            deposits[detector[row]].emplace_back(local_position[row],
+                                                 global_position[row],
+                                                 static_cast<CarrierType>(carrier_type[row]),
+                                                 charge[row],
+                                                 local_time[row],
+                                                 global_time[row],
+                                                 get_mc_particle(mc_particle[row]));
+        }
+    }
+
+    // Pixel charges, with the location of every row to resolve relations
+    std::map<uint16_t, std::vector<PixelCharge>> pixel_charges;
+    std::vector<const PixelCharge*> pixel_charge_rows;
+    if(include_.count("PixelCharge") != 0) {
+        using Column = PixelChargeColumn;
+        constexpr auto table = Table::PIXELCHARGE;
+        auto rows = reader.getRows(chunk, index, table);
+        auto detector = reader.getColumn<uint16_t>(chunk, table, Column::DETECTOR);
+        auto index_x = reader.getColumn<int32_t>(chunk, table, Column::INDEX_X);
+        auto index_y = reader.getColumn<int32_t>(chunk, table, Column::INDEX_Y);
+        auto charge = reader.getColumn<int64_t>(chunk, table, Column::CHARGE);
+
+        pixel_charges = reserve_objects<PixelCharge>(detector, rows);
+        for(auto row = rows.first; row < rows.second; ++row) {
+            if(detector[row] == no_detector) {
+                pixel_charge_rows.push_back(nullptr);
+                continue;
+            }
+            auto pixel = detectors_.at(detector[row])->getPixel(index_x[row], index_y[row]);
+            auto& pixel_charge = pixel_charges[detector[row]].emplace_back(pixel, static_cast<long>(charge[row]));
+            pixel_charge_rows.push_back(&pixel_charge);
+        }
+    }
+
+    // Pixel hits
+    std::map<uint16_t, std::vector<PixelHit>> pixel_hits;
+    if(include_.count("PixelHit") != 0) {
+        using Column = PixelHitColumn;
+        constexpr auto table = Table::PIXELHIT;
+        auto rows = reader.getRows(chunk, index, table);
+        auto detector = reader.getColumn<uint16_t>(chunk, table, Column::DETECTOR);
+        auto index_x = reader.getColumn<int32_t>(chunk, table, Column::INDEX_X);
+        auto index_y = reader.getColumn<int32_t>(chunk, table, Column::INDEX_Y);
+        auto local_time = reader.getColumn<double>(chunk, table, Column::LOCAL_TIME);
+        auto global_time = reader.getColumn<double>(chunk, table, Column::GLOBAL_TIME);
+        auto signal = reader.getColumn<double>(chunk, table, Column::SIGNAL);
+        auto pixel_charge = reader.getColumn<int32_t>(chunk, table, Column::PIXELCHARGE);
+
+        pixel_hits = reserve_objects<PixelHit>(detector, rows);
+        for(auto row = rows.first; row < rows.second; ++row) {
+            if(detector[row] == no_detector) {
+                continue;
+            }
+            auto pixel = detectors_.at(detector[row])->getPixel(index_x[row], index_y[row]);
+            auto charge_row = pixel_charge[row];
+            const PixelCharge* related_charge =
+                (charge_row == no_row || static_cast<size_t>(charge_row) >= pixel_charge_rows.size()
+                     ? nullptr
+                     : pixel_charge_rows[charge_row]);
+            pixel_hits[detector[row]].emplace_back(
+                pixel, local_time[row], global_time[row], signal[row], related_charge);
+        }
+    }
+
+    // Dispatch all messages once the relations between the objects have been resolved
+    dispatch_objects(mc_particles, event);
+    dispatch_objects(deposits, event);
+    dispatch_objects(pixel_charges, event);
+    dispatch_objects(pixel_hits, event);
+}
+
+template <typename T>
+void ColumnarReaderModule::dispatch_objects(std::map<uint16_t, std::vector<T>>& objects, Event* event) {
+    for(auto& [detector, data] : objects) {
+        if(data.empty()) {
+            continue;
+        }
+        read_cnt_ += data.size();
+
+        // NOTE Moving the objects into the message keeps their addresses, such that relations remain valid
+        std::shared_ptr<Message<T>> message;
+        if(detector == no_detector) {
+            message = std::make_shared<Message<T>>(std::move(data));
+        } else {
+            message = std::make_shared<Message<T>>(std::move(data), detectors_.at(detector));
+        }
+        messenger_->dispatchMessage(this, message, event);
+    }
+}
+
+void ColumnarReaderModule::finalize() {
+    // Print statistics
+    LOG(INFO) << "Read " << read_cnt_ << " objects from " << reader_->getEventCount() << " events in file";
+}
@@ -0,0 +1,82 @@
+/**
+ * @file
+ * @brief Definition of columnar data file reader module
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "core/config/Configuration.hpp"
+#include "core/geometry/GeometryManager.hpp"
+#include "core/messenger/Messenger.hpp"
+#include "core/module/Event.hpp"
+#include "core/module/Module.hpp"
+
+#include "tools/columnar.h"
+
+namespace allpix {
+    /**
+     * @ingroup Modules
+     * @brief Module to read object data from a columnar binary file back to allpix messages
+     *
+     * Reads files in the format of the \ref ColumnarWriterModule. The file is memory-mapped and events are located via its
+     * chunk index, such that every worker can read its event independently. The objects are converted back to messages per
+     * detector and dispatched.
+     */
+    class ColumnarReaderModule : public Module {
+    public:
+        /**
+         * @brief Constructor for this unique module
+         * @param config Configuration object for this module as retrieved from the steering file
+         * @param messenger Pointer to the messenger object to allow binding to messages on the bus
+         * @param geo_mgr Pointer to the geometry manager, containing the detectors
+         */
+        ColumnarReaderModule(Configuration& config, Messenger* messenger, GeometryManager* geo_mgr);
+
+        /**
+         * @brief Open the columnar file and match its detectors to the geometry
+         */
+        void initialize() override;
+
+        /**
+         * @brief Convert the objects stored for the current event to messages
+         */
+        void run(Event* event) override;
+
+        /**
+         * @brief Output summary
+         */
+        void finalize() override;
+
+    private:
+        /**
+         * @brief Dispatch the objects of every detector as separate message
+         * @param objects Objects to dispatch, indexed by the detector index of the file
+         * @param event Event to dispatch the messages in
+         */
+        template <typename T> void dispatch_objects(std::map<uint16_t, std::vector<T>>& objects, Event* event);
+
+        Messenger* messenger_;
+        GeometryManager* geo_mgr_;
+
+        // Object names to read
+        std::set<std::string> include_;
+
+        // File containing the objects, and the detectors referenced by their detector index
+        std::unique_ptr<columnar::ColumnarReader> reader_;
+        std::vector<std::shared_ptr<Detector>> detectors_;
+
+        // Statistics for total amount of objects read
+        std::atomic<unsigned long> read_cnt_{};
+    };
+} // namespace allpix
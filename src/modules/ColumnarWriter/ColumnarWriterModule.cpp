@@ -0,0 +1,258 @@
+/**
+ * @file
+ * @brief Implementation of columnar data file writer module
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ColumnarWriterModule.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "core/utils/log.h"
+#include "core/utils/type.h"
+
+#include "objects/DepositedCharge.hpp"
+#include "objects/MCParticle.hpp"
+#include "objects/PixelCharge.hpp"
+#include "objects/PixelHit.hpp"
+#include "objects/exceptions.h"
+
+using namespace allpix;
+using namespace allpix::columnar;
+
+namespace {
+    /**
+     * @brief Append the coordinates of a point to three consecutive columns
+     */
+    template <typename C>
+    void append_point(ColumnarWriter& writer, Table table, C first_column, const ROOT::Math::XYZPoint& point) {
+        auto column = static_cast<uint32_t>(first_column);
+        writer.append(table, column, point.x());
+        writer.append(table, column + 1, point.y());
+        writer.append(table, column + 2, point.z());
+    }
+
+    /**
+     * @brief Look up the row of a referenced object in the current event
+     */
+    template <typename T> int32_t get_row(const std::unordered_map<const T*, int32_t>& rows, const T* object) {
+        if(object == nullptr) {
+            return no_row;
+        }
+        auto iter = rows.find(object);
+        return (iter == rows.end() ? no_row : iter->second);
+    }
+
+    /**
+     * @brief Retrieve referenced objects, returning an empty result if they are not in scope
+     *
+     * References cannot be resolved if the referenced objects have not been stored or read, e.g. when the Monte-Carlo
+     * history has been excluded from the input, in which case no rows are referenced.
+     */
+    template <typename F> auto get_reference(F&& getter) -> decltype(getter()) {
+        try {
+            return getter();
+        } catch(const MissingReferenceException&) {
+            return {};
+        }
+    }
+} // namespace
+
+ColumnarWriterModule::ColumnarWriterModule(Configuration& config, Messenger* messenger, GeometryManager*)
+    : SequentialModule(config), messenger_(messenger) {
+    // Enable multithreading of this module if multithreading is enabled
+    allow_multithreading();
+
+    // Bind to all messages with filter
+    messenger_->registerFilter(this, &ColumnarWriterModule::filter);
+
+    config_.setDefault("file_name", "data");
+    config_.setDefault("compression", 404);
+    config_.setDefault("chunk_size", 1000);
+    config_.setDefaultArray<std::string>("include", {object_names.begin(), object_names.end()});
+}
+
+void ColumnarWriterModule::initialize() {
+    // Read and check the objects to write
+    for(const auto& name : config_.getArray<std::string>("include")) {
+        if(object_names.find(name) == object_names.end()) {
+            throw InvalidValueError(config_, "include", "object " + name + " cannot be stored in columnar format");
+        }
+        include_.insert(name);
+    }
+
+    auto chunk_size = config_.get<size_t>("chunk_size");
+    if(chunk_size == 0) {
+        throw InvalidValueError(config_, "chunk_size", "chunks need to contain at least one event");
+    }
+
+    // Create output file
+    output_file_name_ = createOutputFile(config_.get<std::string>("file_name"), "apxc", true);
+    try {
+        writer_ = std::make_unique<ColumnarWriter>(output_file_name_, config_.get<int>("compression"), chunk_size);
+    } catch(const std::runtime_error& e) {
+        throw ModuleError("Cannot open output file: " + std::string(e.what()));
+    }
+}
+
+bool ColumnarWriterModule::filter(const std::shared_ptr<BaseMessage>& message,
+                                  const std::string& message_name) const { // NOLINT
+    std::string object_name;
+    if(std::dynamic_pointer_cast<MCParticleMessage>(message) != nullptr) {
+        object_name = "MCParticle";
+    } else if(std::dynamic_pointer_cast<DepositedChargeMessage>(message) != nullptr) {
+        object_name = "DepositedCharge";
+    } else if(std::dynamic_pointer_cast<PixelChargeMessage>(message) != nullptr) {
+        object_name = "PixelCharge";
+    } else if(std::dynamic_pointer_cast<PixelHitMessage>(message) != nullptr) {
+        object_name = "PixelHit";
+    } else {
+        return false;
+    }
+
+    if(include_.find(object_name) == include_.end()) {
+        return false;
+    }
+
+    LOG(TRACE) << "Columnar writer received " << object_name << " message"
+               << (message_name.empty() ? " without a name" : " named " + message_name);
+    return true;
+}
+
+void ColumnarWriterModule::run(Event* event) {
+    auto messages = messenger_->fetchFilteredMessages(this, event);
+
+    // Sort the messages by object type, keeping their order of dispatch
+    std::vector<std::shared_ptr<MCParticleMessage>> mc_particle_messages;
+    std::vector<std::shared_ptr<DepositedChargeMessage>> deposit_messages;
+    std::vector<std::shared_ptr<PixelChargeMessage>> pixel_charge_messages;
+    std::vector<std::shared_ptr<PixelHitMessage>> pixel_hit_messages;
+    for(auto& pair : messages) {
+        if(auto mc_particles = std::dynamic_pointer_cast<MCParticleMessage>(pair.first)) {
+            mc_particle_messages.push_back(std::move(mc_particles));
+        } else if(auto deposits = std::dynamic_pointer_cast<DepositedChargeMessage>(pair.first)) {
+            deposit_messages.push_back(std::move(deposits));
+        } else if(auto pixel_charges = std::dynamic_pointer_cast<PixelChargeMessage>(pair.first)) {
+            pixel_charge_messages.push_back(std::move(pixel_charges));
+        } else if(auto pixel_hits = std::dynamic_pointer_cast<PixelHitMessage>(pair.first)) {
+            pixel_hit_messages.push_back(std::move(pixel_hits));
+        }
+    }
+
+    auto detector_index = [this](const std::shared_ptr<BaseMessage>& message) {
+        auto detector = message->getDetector();
+        return (detector == nullptr ? no_detector : writer_->getDetectorIndex(detector->getName()));
+    };
+
+    // Assign rows to all Monte-Carlo particles first, since parents may be stored after their daughters
+    std::unordered_map<const MCParticle*, int32_t> mc_particle_rows;
+    for(auto& message : mc_particle_messages) {
+        for(const auto& mc_particle : message->getData()) {
+            mc_particle_rows.emplace(&mc_particle, writer_->addRow(Table::MCPARTICLE));
+        }
+    }
+
+    for(auto& message : mc_particle_messages) {
+        using Column = MCParticleColumn;
+        constexpr auto table = Table::MCPARTICLE;
+        auto detector = detector_index(message);
+        for(const auto& mc_particle : message->getData()) {
+            writer_->append(table, Column::DETECTOR, detector);
+            writer_->append(table, Column::PARTICLE_ID, static_cast<int32_t>(mc_particle.getParticleID()));
+            append_point(*writer_, table, Column::LOCAL_START_X, mc_particle.getLocalStartPoint());
+            append_point(*writer_, table, Column::GLOBAL_START_X, mc_particle.getGlobalStartPoint());
+            append_point(*writer_, table, Column::LOCAL_END_X, mc_particle.getLocalEndPoint());
+            append_point(*writer_, table, Column::GLOBAL_END_X, mc_particle.getGlobalEndPoint());
+            writer_->append(table, Column::LOCAL_TIME, mc_particle.getLocalTime());
+            writer_->append(table, Column::GLOBAL_TIME, mc_particle.getGlobalTime());
+            writer_->append(table, Column::DEPOSITED_CHARGE, static_cast<uint32_t>(mc_particle.getTotalDepositedCharge()));
+            writer_->append(table, Column::PARENT, get_row(mc_particle_rows, mc_particle.getParent()));
+        }
+        write_cnt_ += message->getData().size();
+    }
+
+    for(auto& message : deposit_messages) {
+        using Column = DepositedChargeColumn;
+        constexpr auto table = Table::DEPOSITEDCHARGE;
+        auto detector = detector_index(message);
+        for(const auto& deposit : message->getData()) {
+            writer_->addRow(table);
+            writer_->append(table, Column::DETECTOR, detector);
+            append_point(*writer_, table, Column::LOCAL_X, deposit.getLocalPosition());
+            append_point(*writer_, table, Column::GLOBAL_X, deposit.getGlobalPosition());
+            writer_->append(table, Column::CARRIER_TYPE, static_cast<int8_t>(deposit.getType()));
+            writer_->append(table, Column::CHARGE, static_cast<uint32_t>(deposit.getCharge()));
+            writer_->append(table, Column::LOCAL_TIME, deposit.getLocalTime());
+            writer_->append(table, Column::GLOBAL_TIME, deposit.getGlobalTime());
+            auto* mc_particle = get_reference([&]() { return deposit.getMCParticle(); });
+            writer_->append(table, Column::MCPARTICLE, get_row(mc_particle_rows, mc_particle));
+        }
+        write_cnt_ += message->getData().size();
+    }
+
+    std::unordered_map<const PixelCharge*, int32_t> pixel_charge_rows;
+    for(auto& message : pixel_charge_messages) {
+        using Column = PixelChargeColumn;
+        constexpr auto table = Table::PIXELCHARGE;
+        auto detector = detector_index(message);
+        for(const auto& pixel_charge : message->getData()) {
+            pixel_charge_rows.emplace(&pixel_charge, writer_->addRow(table));
+            writer_->append(table, Column::DETECTOR, detector);
+            writer_->append(table, Column::INDEX_X, static_cast<int32_t>(pixel_charge.getIndex().x()));
+            writer_->append(table, Column::INDEX_Y, static_cast<int32_t>(pixel_charge.getIndex().y()));
+            writer_->append(table, Column::CHARGE, static_cast<int64_t>(pixel_charge.getCharge()));
+            writer_->append(table, Column::LOCAL_TIME, pixel_charge.getLocalTime());
+            writer_->append(table, Column::GLOBAL_TIME, pixel_charge.getGlobalTime());
+
+            auto mc_particles = get_reference([&]() { return pixel_charge.getMCParticles(); });
+            writer_->append(table, Column::MCPARTICLE_COUNT, static_cast<uint32_t>(mc_particles.size()));
+            for(const auto* mc_particle : mc_particles) {
+                writer_->append(table, Column::MCPARTICLES, get_row(mc_particle_rows, mc_particle));
+            }
+        }
+        write_cnt_ += message->getData().size();
+    }
+
+    for(auto& message : pixel_hit_messages) {
+        using Column = PixelHitColumn;
+        constexpr auto table = Table::PIXELHIT;
+        auto detector = detector_index(message);
+        for(const auto& pixel_hit : message->getData()) {
+            writer_->addRow(table);
+            writer_->append(table, Column::DETECTOR, detector);
+            writer_->append(table, Column::INDEX_X, static_cast<int32_t>(pixel_hit.getIndex().x()));
+            writer_->append(table, Column::INDEX_Y, static_cast<int32_t>(pixel_hit.getIndex().y()));
+            writer_->append(table, Column::LOCAL_TIME, pixel_hit.getLocalTime());
+            writer_->append(table, Column::GLOBAL_TIME, pixel_hit.getGlobalTime());
+            writer_->append(table, Column::SIGNAL, pixel_hit.getSignal());
+            auto* pixel_charge = get_reference([&]() { return pixel_hit.getPixelCharge(); });
+            writer_->append(table, Column::PIXELCHARGE, get_row(pixel_charge_rows, pixel_charge));
+
+            auto mc_particles = get_reference([&]() { return pixel_hit.getMCParticles(); });
+            writer_->append(table, Column::MCPARTICLE_COUNT, static_cast<uint32_t>(mc_particles.size()));
+            for(const auto* mc_particle : mc_particles) {
+                writer_->append(table, Column::MCPARTICLES, get_row(mc_particle_rows, mc_particle));
+            }
+        }
+        write_cnt_ += message->getData().size();
+    }
+
+    LOG(TRACE) << "Writing event " << event->number << " to columnar file";
+    writer_->endEvent(event->number, event->getSeed());
+}
+
+void ColumnarWriterModule::finalize() {
+    auto events = writer_->getEventCount();
+    writer_->close();
+
+    // Print statistics
+    LOG(STATUS) << "Wrote " << write_cnt_ << " objects from " << events << " events to file:" << std::endl
+                << output_file_name_;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file
+ * @brief Definition of columnar data file writer module
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <string>
+
+#include "core/config/Configuration.hpp"
+#include "core/geometry/GeometryManager.hpp"
+#include "core/messenger/Messenger.hpp"
+#include "core/module/Event.hpp"
+#include "core/module/Module.hpp"
+
+#include "tools/columnar.h"
+
+namespace allpix {
+    /**
+     * @ingroup Modules
+     * @brief Module to write flat object data to a compressed, columnar binary file
+     *
+     * Listens to all Monte-Carlo particles, deposited charges, pixel charges and pixel hits dispatched in the framework and
+     * stores their data members in fixed columns, grouped in chunks of events. Relations between the objects are stored as
+     * row indices within the event instead of references.
+     */
+    class ColumnarWriterModule : public SequentialModule {
+    public:
+        /**
+         * @brief Constructor for this unique module
+         * @param config Configuration object for this module as retrieved from the steering file
+         * @param messenger Pointer to the messenger object to allow binding to messages on the bus
+         * @param geo_mgr Pointer to the geometry manager, containing the detectors
+         */
+        ColumnarWriterModule(Configuration& config, Messenger* messenger, GeometryManager* geo_mgr);
+
+        /**
+         * @brief Receive a single message containing objects of arbitrary type
+         * @param message Message dispatched in the framework
+         * @param name Name of the message
+         */
+        bool filter(const std::shared_ptr<BaseMessage>& message, const std::string& name) const;
+
+        /**
+         * @brief Opens the file to write the objects to
+         */
+        void initialize() override;
+
+        /**
+         * @brief Writes the objects fetched to their columns
+         */
+        void run(Event* event) override;
+
+        /**
+         * @brief Writes the remaining events and the file index, and prints statistics
+         */
+        void finalize() override;
+
+    private:
+        Messenger* messenger_;
+
+        // Object names to write
+        std::set<std::string> include_;
+
+        // Output data file to write
+        std::string output_file_name_{};
+        std::unique_ptr<columnar::ColumnarWriter> writer_;
+
+        // Statistical information about number of objects
+        std::atomic<unsigned long> write_cnt_{};
+    };
+} // namespace allpix
@@ -11,6 +11,8 @@
 
 #include "DatabaseWriterModule.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <optional>
 #include <string>
@@ -29,6 +31,24 @@
 using namespace allpix;
 
 thread_local std::shared_ptr<pqxx::connection> DatabaseWriterModule::conn_ = nullptr;
+thread_local DatabaseWriterModule::RowBatch DatabaseWriterModule::batch_;
+
+namespace {
+    /**
+     * @brief Open a COPY stream to the given columns of a table
+     */
+    pqxx::stream_to open_stream(pqxx::work& transaction, const std::string& table, const std::vector<std::string>& columns) {
+#if PQXX_VERSION_MAJOR > 7 || (PQXX_VERSION_MAJOR == 7 && PQXX_VERSION_MINOR >= 3)
+        std::string column_list;
+        for(const auto& column : columns) {
+            column_list += (column_list.empty() ? "" : ", ") + column;
+        }
+        return pqxx::stream_to::raw_table(transaction, table, column_list);
+#else
+        return pqxx::stream_to(transaction, table, columns);
+#endif
+    }
+} // namespace
 
 DatabaseWriterModule::DatabaseWriterModule(Configuration& config, Messenger* messenger, GeometryManager*)
     : SequentialModule(config), messenger_(messenger) {
@@ -39,6 +59,7 @@ DatabaseWriterModule::DatabaseWriterModule(Configuration& config, Messenger* mes
 
     config_.setDefault("global_timing", false);
     config_.setDefault("require_sequence", false);
+    config_.setDefault("batch_size", 0);
 
     config_.setDefault("run_id", "none");
 
@@ -53,6 +74,9 @@ DatabaseWriterModule::DatabaseWriterModule(Configuration& config, Messenger* mes
     // Select pixel hit timing information to be saved:
     timing_global_ = config_.get<bool>("global_timing");
 
+    // Number of events to buffer before streaming them to the database, row-wise insertion if zero
+    batch_size_ = config_.get<size_t>("batch_size");
+
     // Waive sequence requirement if requested by user
     if(!config_.get<bool>("require_sequence")) {
         waive_sequence_requirement();
@@ -98,12 +122,19 @@ void DatabaseWriterModule::prepare_statements(std::shared_ptr<pqxx::connection>
     connection->prepare("add_pixelhit",
                         "INSERT INTO PixelHit (run_nr, event_nr, mcparticle_nr, pixelcharge_nr, detector, x, y, signal, "
                         "hittime) VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9) RETURNING pixelHit_nr;");
+
+    // Reserve a range of keys from the sequence of a serial column for rows streamed to the database
+    connection->prepare("reserve_keys", "SELECT nextval(pg_get_serial_sequence($1, $2)) FROM generate_series(1, $3);");
 }
 
 void DatabaseWriterModule::initializeThread() {
     // Establishing connection to the database
-    conn_ = std::make_shared<pqxx::connection>("host=" + host_ + " port=" + port_ + " dbname=" + database_name_ +
-                                               " user=" + user_ + " password=" + password_);
+    try {
+        conn_ = std::make_shared<pqxx::connection>("host=" + host_ + " port=" + port_ + " dbname=" + database_name_ +
+                                                   " user=" + user_ + " password=" + password_);
+    } catch(const pqxx::broken_connection& e) {
+        throw ModuleError("Could not connect to database " + database_name_ + " at host " + host_ + ": " + e.what());
+    }
     if(!conn_->is_open()) {
         throw ModuleError("Could not connect to database " + database_name_ + " at host " + host_);
     }
@@ -173,6 +204,18 @@ bool DatabaseWriterModule::filter(const std::shared_ptr<BaseMessage>& message,
 void DatabaseWriterModule::run(Event* event) {
     auto messages = messenger_->fetchFilteredMessages(this, event);
 
+    if(batch_size_ > 0) {
+        buffer_event(event, messages);
+        if(batch_.events >= batch_size_) {
+            flush_batch();
+        }
+    } else {
+        insert_event(event, messages);
+    }
+}
+
+void DatabaseWriterModule::insert_event(
+    Event* event, const std::vector<std::pair<std::shared_ptr<BaseMessage>, std::string>>& messages) {
     // TO BE NOTED
     // the correct relations of objects in the database are guaranteed by the fact that sequence of dispatched messages
     // within one event always follows this order: MCTrack -> MCParticle -> DepositedCharge -> PropagatedCharge ->
@@ -196,8 +239,8 @@ void DatabaseWriterModule::run(Event* event) {
         int event_nr = event_row.front().as<int>();
 
         // Looping through messages
-        for(auto& pair : messages) {
-            auto& message = pair.first;
+        for(const auto& pair : messages) {
+            const auto& message = pair.first;
             auto detectorName = (message->getDetector() != nullptr ? message->getDetector()->getName() : "global");
 
             for(const auto& object : message->getObjectArray()) {
@@ -332,7 +375,357 @@ void DatabaseWriterModule::run(Event* event) {
     }
 }
 
+void DatabaseWriterModule::buffer_event(
+    Event* event, const std::vector<std::pair<std::shared_ptr<BaseMessage>, std::string>>& messages) {
+    // References are resolved following the same order of messages as for row-wise insertion, but using the position of
+    // the referenced row in the batch instead of its key
+    std::optional<size_t> mctrack_row;
+    std::optional<size_t> mcparticle_row;
+    std::optional<size_t> depositedcharge_row;
+    std::optional<size_t> propagatedcharge_row;
+    std::optional<size_t> pixelcharge_row;
+
+    auto event_row = batch_.event_rows.size();
+    batch_.event_rows.push_back(event->number);
+
+    LOG(TRACE) << "Buffering objects of event " << event->number << " for database";
+    for(const auto& pair : messages) {
+        const auto& message = pair.first;
+        auto detectorName = (message->getDetector() != nullptr ? message->getDetector()->getName() : "global");
+
+        for(const auto& object : message->getObjectArray()) {
+            auto& o = object.get();
+            std::string class_name = allpix::demangle(typeid(o).name());
+
+            if(class_name == "PixelHit") {
+                const auto& hit = static_cast<const PixelHit&>(o);
+                batch_.pixelhit_rows.push_back({event_row,
+                                                {mcparticle_row, pixelcharge_row},
+                                                {detectorName,
+                                                 hit.getIndex().X(),
+                                                 hit.getIndex().Y(),
+                                                 hit.getSignal(),
+                                                 (timing_global_ ? hit.getGlobalTime() : hit.getLocalTime())}});
+            } else if(class_name == "PixelCharge") {
+                const auto& charge = static_cast<const PixelCharge&>(o);
+                pixelcharge_row = batch_.pixelcharge_rows.size();
+                batch_.pixelcharge_rows.push_back({event_row,
+                                                   {propagatedcharge_row},
+                                                   {detectorName,
+                                                    charge.getCharge(),
+                                                    charge.getIndex().X(),
+                                                    charge.getIndex().Y(),
+                                                    charge.getPixel().getLocalCenter().X(),
+                                                    charge.getPixel().getLocalCenter().Y(),
+                                                    charge.getPixel().getGlobalCenter().X(),
+                                                    charge.getPixel().getGlobalCenter().Y()}});
+            } else if(class_name == "PropagatedCharge") {
+                const auto& charge = static_cast<const PropagatedCharge&>(o);
+                propagatedcharge_row = batch_.propagatedcharge_rows.size();
+                batch_.propagatedcharge_rows.push_back({event_row,
+                                                        {depositedcharge_row},
+                                                        {detectorName,
+                                                         static_cast<int>(charge.getType()),
+                                                         charge.getCharge(),
+                                                         charge.getLocalPosition().X(),
+                                                         charge.getLocalPosition().Y(),
+                                                         charge.getLocalPosition().Z(),
+                                                         charge.getGlobalPosition().X(),
+                                                         charge.getGlobalPosition().Y(),
+                                                         charge.getGlobalPosition().Z()}});
+            } else if(class_name == "MCTrack") {
+                const auto& track = static_cast<const MCTrack&>(o);
+                mctrack_row = batch_.mctrack_rows.size();
+                batch_.mctrack_rows.push_back({event_row,
+                                               {},
+                                               {detectorName,
+                                                reinterpret_cast<uintptr_t>(&o),
+                                                reinterpret_cast<uintptr_t>(track.getParent()),
+                                                track.getParticleID(),
+                                                track.getCreationProcessName(),
+                                                track.getOriginatingVolumeName(),
+                                                track.getStartPoint().X(),
+                                                track.getStartPoint().Y(),
+                                                track.getStartPoint().Z(),
+                                                track.getEndPoint().X(),
+                                                track.getEndPoint().Y(),
+                                                track.getEndPoint().Z(),
+                                                track.getGlobalStartTime(),
+                                                track.getGlobalEndTime(),
+                                                track.getKineticEnergyInitial(),
+                                                track.getKineticEnergyFinal()}});
+            } else if(class_name == "DepositedCharge") {
+                const auto& charge = static_cast<const DepositedCharge&>(o);
+                depositedcharge_row = batch_.depositedcharge_rows.size();
+                batch_.depositedcharge_rows.push_back({event_row,
+                                                       {mcparticle_row},
+                                                       {detectorName,
+                                                        static_cast<int>(charge.getType()),
+                                                        charge.getCharge(),
+                                                        charge.getLocalPosition().X(),
+                                                        charge.getLocalPosition().Y(),
+                                                        charge.getLocalPosition().Z(),
+                                                        charge.getGlobalPosition().X(),
+                                                        charge.getGlobalPosition().Y(),
+                                                        charge.getGlobalPosition().Z()}});
+            } else if(class_name == "MCParticle") {
+                const auto& particle = static_cast<const MCParticle&>(o);
+                mcparticle_row = batch_.mcparticle_rows.size();
+                batch_.mcparticle_rows.push_back({event_row,
+                                                  {mctrack_row},
+                                                  {detectorName,
+                                                   reinterpret_cast<uintptr_t>(&o),
+                                                   reinterpret_cast<uintptr_t>(particle.getParent()),
+                                                   reinterpret_cast<uintptr_t>(particle.getTrack()),
+                                                   particle.getParticleID(),
+                                                   particle.getLocalStartPoint().X(),
+                                                   particle.getLocalStartPoint().Y(),
+                                                   particle.getLocalStartPoint().Z(),
+                                                   particle.getLocalEndPoint().X(),
+                                                   particle.getLocalEndPoint().Y(),
+                                                   particle.getLocalEndPoint().Z(),
+                                                   particle.getGlobalStartPoint().X(),
+                                                   particle.getGlobalStartPoint().Y(),
+                                                   particle.getGlobalStartPoint().Z(),
+                                                   particle.getGlobalEndPoint().X(),
+                                                   particle.getGlobalEndPoint().Y(),
+                                                   particle.getGlobalEndPoint().Z()}});
+            } else {
+                LOG(WARNING) << "Following object type is not yet accounted for in database output: " << class_name;
+            }
+            write_cnt_++;
+        }
+        msg_cnt_++;
+    }
+    batch_.events++;
+}
+
+void DatabaseWriterModule::flush_batch() {
+    if(batch_.events == 0) {
+        return;
+    }
+
+    LOG(DEBUG) << "Streaming " << batch_.events << " buffered events to database";
+    auto start = std::chrono::steady_clock::now();
+    size_t rows = 0;
+    try {
+        // Open new transaction for the full batch
+        pqxx::work transaction(*conn_);
+
+        // Reserve the keys of all rows of a table with a single query, such that references can be resolved locally
+        auto reserve_keys = [&](const std::string& table, const std::string& column, size_t count) {
+            std::vector<int> keys;
+            keys.reserve(count);
+            if(count > 0) {
+                for(const auto& row : transaction.exec_prepared("reserve_keys", table, column, count)) {
+                    keys.push_back(row.front().as<int>());
+                }
+            }
+            rows += count;
+            return keys;
+        };
+        auto event_keys = reserve_keys("event", "event_nr", batch_.event_rows.size());
+        auto mctrack_keys = reserve_keys("mctrack", "mctrack_nr", batch_.mctrack_rows.size());
+        auto mcparticle_keys = reserve_keys("mcparticle", "mcparticle_nr", batch_.mcparticle_rows.size());
+        auto depositedcharge_keys =
+            reserve_keys("depositedcharge", "depositedcharge_nr", batch_.depositedcharge_rows.size());
+        auto propagatedcharge_keys =
+            reserve_keys("propagatedcharge", "propagatedcharge_nr", batch_.propagatedcharge_rows.size());
+        auto pixelcharge_keys = reserve_keys("pixelcharge", "pixelcharge_nr", batch_.pixelcharge_rows.size());
+        auto pixelhit_keys = reserve_keys("pixelhit", "pixelhit_nr", batch_.pixelhit_rows.size());
+
+        // Stream the tables in order of their references, since foreign keys are checked for every row
+        auto event_stream = open_stream(transaction, "event", {"event_nr", "run_nr", "eventid"});
+        for(size_t i = 0; i < batch_.event_rows.size(); ++i) {
+            event_stream << std::make_tuple(event_keys[i], run_nr_, batch_.event_rows[i]);
+        }
+        event_stream.complete();
+
+        stream_rows(transaction,
+                    "mctrack",
+                    {"mctrack_nr",
+                     "run_nr",
+                     "event_nr",
+                     "detector",
+                     "address",
+                     "parentaddress",
+                     "particleid",
+                     "productionprocess",
+                     "productionvolume",
+                     "initialpositionx",
+                     "initialpositiony",
+                     "initialpositionz",
+                     "finalpositionx",
+                     "finalpositiony",
+                     "finalpositionz",
+                     "initialtime",
+                     "finaltime",
+                     "initialkineticenergy",
+                     "finalkineticenergy"},
+                    batch_.mctrack_rows,
+                    mctrack_keys,
+                    event_keys,
+                    {});
+        stream_rows(transaction,
+                    "mcparticle",
+                    {"mcparticle_nr",
+                     "run_nr",
+                     "event_nr",
+                     "mctrack_nr",
+                     "detector",
+                     "address",
+                     "parentaddress",
+                     "trackaddress",
+                     "particleid",
+                     "localstartpointx",
+                     "localstartpointy",
+                     "localstartpointz",
+                     "localendpointx",
+                     "localendpointy",
+                     "localendpointz",
+                     "globalstartpointx",
+                     "globalstartpointy",
+                     "globalstartpointz",
+                     "globalendpointx",
+                     "globalendpointy",
+                     "globalendpointz"},
+                    batch_.mcparticle_rows,
+                    mcparticle_keys,
+                    event_keys,
+                    {&mctrack_keys});
+        stream_rows(transaction,
+                    "depositedcharge",
+                    {"depositedcharge_nr",
+                     "run_nr",
+                     "event_nr",
+                     "mcparticle_nr",
+                     "detector",
+                     "carriertype",
+                     "charge",
+                     "localx",
+                     "localy",
+                     "localz",
+                     "globalx",
+                     "globaly",
+                     "globalz"},
+                    batch_.depositedcharge_rows,
+                    depositedcharge_keys,
+                    event_keys,
+                    {&mcparticle_keys});
+        stream_rows(transaction,
+                    "propagatedcharge",
+                    {"propagatedcharge_nr",
+                     "run_nr",
+                     "event_nr",
+                     "depositedcharge_nr",
+                     "detector",
+                     "carriertype",
+                     "charge",
+                     "localx",
+                     "localy",
+                     "localz",
+                     "globalx",
+                     "globaly",
+                     "globalz"},
+                    batch_.propagatedcharge_rows,
+                    propagatedcharge_keys,
+                    event_keys,
+                    {&depositedcharge_keys});
+        stream_rows(transaction,
+                    "pixelcharge",
+                    {"pixelcharge_nr",
+                     "run_nr",
+                     "event_nr",
+                     "propagatedcharge_nr",
+                     "detector",
+                     "charge",
+                     "x",
+                     "y",
+                     "localx",
+                     "localy",
+                     "globalx",
+                     "globaly"},
+                    batch_.pixelcharge_rows,
+                    pixelcharge_keys,
+                    event_keys,
+                    {&propagatedcharge_keys});
+        stream_rows(transaction,
+                    "pixelhit",
+                    {"pixelhit_nr",
+                     "run_nr",
+                     "event_nr",
+                     "mcparticle_nr",
+                     "pixelcharge_nr",
+                     "detector",
+                     "x",
+                     "y",
+                     "signal",
+                     "hittime"},
+                    batch_.pixelhit_rows,
+                    pixelhit_keys,
+                    event_keys,
+                    {&mcparticle_keys, &pixelcharge_keys});
+
+        // Commit transaction to database:
+        transaction.commit();
+    } catch(const std::exception& e) {
+        throw ModuleError("SQL error: " + std::string(e.what()));
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    LOG(DEBUG) << "Streamed " << rows << " rows to database in "
+               << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() << "us";
+
+    // Track the wall-clock interval spanned by the batches of all threads, which stream concurrently
+    {
+        std::lock_guard<std::mutex> lock{stream_mutex_};
+        stream_cnt_ += rows;
+        stream_start_ = (stream_start_.has_value() ? std::min(stream_start_.value(), start) : start);
+        stream_end_ = (stream_end_.has_value() ? std::max(stream_end_.value(), end) : end);
+    }
+
+    // Start a new batch
+    batch_ = RowBatch();
+}
+
+template <size_t N, typename... T>
+void DatabaseWriterModule::stream_rows(pqxx::work& transaction,
+                                       const std::string& table,
+                                       const std::vector<std::string>& columns,
+                                       const std::vector<BufferedRow<N, T...>>& rows,
+                                       const std::vector<int>& keys,
+                                       const std::vector<int>& event_keys,
+                                       const std::array<const std::vector<int>*, N>& references) const {
+    if(rows.empty()) {
+        return;
+    }
+
+    auto stream = open_stream(transaction, table, columns);
+    for(size_t i = 0; i < rows.size(); ++i) {
+        const auto& row = rows[i];
+
+        // Replace the positions of referenced rows by their keys, leaving missing references empty
+        std::array<std::optional<int>, N> reference_keys;
+        std::transform(row.references.begin(),
+                       row.references.end(),
+                       references.begin(),
+                       reference_keys.begin(),
+                       [](const auto& position, const auto* referenced_keys) -> std::optional<int> {
+                           if(!position.has_value()) {
+                               return std::nullopt;
+                           }
+                           return (*referenced_keys)[position.value()];
+                       });
+
+        stream << std::tuple_cat(std::make_tuple(keys[i], run_nr_, event_keys[row.event]), reference_keys, row.values);
+    }
+    stream.complete();
+}
+
 void DatabaseWriterModule::finalizeThread() {
+    // Stream remaining buffered events
+    flush_batch();
+
 // Disconnecting from database
 #if PQXX_VERSION_MAJOR > 6
     conn_->close();
@@ -343,4 +736,11 @@ void DatabaseWriterModule::finalizeThread() {
 
 void DatabaseWriterModule::finalize() {
     LOG(STATUS) << "Wrote " << write_cnt_ << " objects from " << msg_cnt_ << " messages to database" << std::endl;
+
+    // Report the throughput of the bulk insertion from the start of the first to the end of the last batch of any thread
+    if(stream_start_.has_value() && stream_end_.value() > stream_start_.value()) {
+        auto stream_time = std::chrono::duration<double>(stream_end_.value() - stream_start_.value()).count();
+        LOG(STATUS) << "Streamed " << stream_cnt_ << " rows to database in " << stream_time << "s, "
+                    << static_cast<double>(stream_cnt_) / stream_time << " rows per second";
+    }
 }
@@ -9,10 +9,16 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <fstream>
 #include <map>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include "core/config/Configuration.hpp"
 #include "core/geometry/GeometryManager.hpp"
@@ -57,7 +63,7 @@ namespace allpix {
         void run(Event* event) override;
 
         /**
-         * @brief CLose database connections from each of the threads
+         * @brief Stream remaining buffered rows and close database connections from each of the threads
          */
         void finalizeThread() override;
 
@@ -70,18 +76,119 @@ namespace allpix {
     private:
         Messenger* messenger_;
 
+        /**
+         * @brief Row buffered for bulk insertion, referring to other rows of the same batch by their position
+         */
+        template <size_t N, typename... T> struct BufferedRow {
+            size_t event;
+            std::array<std::optional<size_t>, N> references;
+            std::tuple<T...> values;
+        };
+
+        /**
+         * @brief Rows of all tables buffered for bulk insertion by a single thread
+         */
+        struct RowBatch {
+            size_t events{};
+            std::vector<uint64_t> event_rows;
+            std::vector<BufferedRow<0,
+                                    std::string,
+                                    uintptr_t,
+                                    uintptr_t,
+                                    int,
+                                    std::string,
+                                    std::string,
+                                    double,
+                                    double,
+                                    double,
+                                    double,
+                                    double,
+                                    double,
+                                    double,
+                                    double,
+                                    double,
+                                    double>>
+                mctrack_rows;
+            std::vector<BufferedRow<1,
+                                    std::string,
+                                    uintptr_t,
+                                    uintptr_t,
+                                    uintptr_t,
+                                    int,
+                                    double,
+                                    double,
+                                    double,
+                                    double,
+                                    double,
+                                    double,
+                                    double,
+                                    double,
+                                    double,
+                                    double,
+                                    double,
+                                    double>>
+                mcparticle_rows;
+            std::vector<
+                BufferedRow<1, std::string, int, unsigned int, double, double, double, double, double, double>>
+                depositedcharge_rows;
+            std::vector<
+                BufferedRow<1, std::string, int, unsigned int, double, double, double, double, double, double>>
+                propagatedcharge_rows;
+            std::vector<BufferedRow<1, std::string, long, int, int, double, double, double, double>> pixelcharge_rows;
+            std::vector<BufferedRow<2, std::string, int, int, double, double>> pixelhit_rows;
+        };
+
         /**
          * @brief Submit "prepared statements" to the database connection(s)
          * @param connection  Database connection to be used
          */
         static void prepare_statements(std::shared_ptr<pqxx::connection> connection);
 
+        /**
+         * @brief Insert all objects of an event row by row, retrieving the keys of the rows from the database
+         * @param event Event the messages belong to
+         * @param messages Messages with the objects to write
+         */
+        void insert_event(Event* event, const std::vector<std::pair<std::shared_ptr<BaseMessage>, std::string>>& messages);
+
+        /**
+         * @brief Add all objects of an event to the batch of the current thread
+         * @param event Event the messages belong to
+         * @param messages Messages with the objects to write
+         */
+        void buffer_event(Event* event, const std::vector<std::pair<std::shared_ptr<BaseMessage>, std::string>>& messages);
+
+        /**
+         * @brief Stream the batch of the current thread to the database with COPY in a single transaction
+         */
+        void flush_batch();
+
+        /**
+         * @brief Stream rows of one table, resolving the positions of referenced rows to their keys
+         * @param transaction Transaction to stream the rows in
+         * @param table Name of the table
+         * @param columns Columns of the table, starting with the key, the run, the event and the references
+         * @param rows Rows to stream
+         * @param keys Keys reserved for the rows
+         * @param event_keys Keys reserved for the events of the batch
+         * @param references Keys reserved for the rows of the referenced tables
+         */
+        template <size_t N, typename... T>
+        void stream_rows(pqxx::work& transaction,
+                         const std::string& table,
+                         const std::vector<std::string>& columns,
+                         const std::vector<BufferedRow<N, T...>>& rows,
+                         const std::vector<int>& keys,
+                         const std::vector<int>& event_keys,
+                         const std::array<const std::vector<int>*, N>& references) const;
+
         // Object names to include or exclude from writing
         std::set<std::string> include_;
         std::set<std::string> exclude_;
 
         // postgreSQL objects
         static thread_local std::shared_ptr<pqxx::connection> conn_;
+        static thread_local RowBatch batch_;
         std::string host_;
         std::string port_;
         std::string database_name_;
@@ -90,9 +197,16 @@ namespace allpix {
         std::string run_id_;
         int run_nr_{0};
         bool timing_global_{};
+        size_t batch_size_{};
 
         // Statistical information about number of objects
         std::atomic<unsigned long> write_cnt_{};
         std::atomic<unsigned long> msg_cnt_{};
+
+        // Number of rows streamed in batches and wall-clock interval from the first to the last batch of all threads
+        std::mutex stream_mutex_;
+        unsigned long stream_cnt_{};
+        std::optional<std::chrono::steady_clock::time_point> stream_start_;
+        std::optional<std::chrono::steady_clock::time_point> stream_end_;
     };
 } // namespace allpix
@@ -12,6 +12,7 @@
 #include "DepositionReaderModule.hpp"
 
 #include <string>
+#include <string_view>
 #include <utility>
 
 #include "core/utils/distributions.h"
@@ -21,7 +22,7 @@
 using namespace allpix;
 
 DepositionReaderModule::DepositionReaderModule(Configuration& config, Messenger* messenger, GeometryManager* geo_manager)
-    : SequentialModule(config), geo_manager_(geo_manager), messenger_(messenger) {
+    : Module(config), geo_manager_(geo_manager), messenger_(messenger) {
     // Enable multithreading of this module if multithreading is enabled
     allow_multithreading();
 
@@ -73,12 +74,20 @@ void DepositionReaderModule::initialize() {
 
     // Check which file type we want to read:
     if(file_model_ == FileModel::CSV) {
-        // Open the file with the objects
+        // Open the file with the objects and index its events
         auto file_path = config_.getPathWithExtension("file_name", "csv", true);
-        input_file_ = std::make_unique<std::ifstream>(file_path);
-        if(!input_file_->is_open()) {
-            throw InvalidValueError(config_, "file_name", "could not open input file");
+        try {
+            input_file_ = std::make_unique<MappedCSVFile>(file_path);
+        } catch(const std::runtime_error& e) {
+            throw InvalidValueError(config_, "file_name", e.what());
+        }
+        for(const auto& [event_number, ranges] : input_file_->getEvents()) {
+            auto& event_ranges = event_index_[event_number];
+            for(const auto& range : ranges) {
+                event_ranges.emplace_back(range.first, range.second);
+            }
         }
+        LOG(INFO) << "Indexed CSV file, found " << event_index_.size() << " events";
     } else if(file_model_ == FileModel::ROOT) {
         auto file_path = config_.getPathWithExtension("file_name", "root", true);
         input_file_root_ = std::make_unique<TFile>(file_path.c_str(), "READ");
@@ -163,6 +172,30 @@ void DepositionReaderModule::initialize() {
             check_tree_reader(track_id_);
             check_tree_reader(parent_id_);
         }
+
+        // Index the entries of all events, reading only the event branch. Events are identified by their event number or,
+        // if events are not required to be sequential, by the order of the blocks of entries with the same event number
+        TTreeReader index_reader(tree.c_str(), input_file_root_.get());
+        TTreeReaderValue<int> event_id(index_reader, branches.at("event").c_str());
+        std::pair<uint64_t, uint64_t>* block = nullptr;
+        int block_event_id = 0;
+        uint64_t block_count = 0;
+        while(index_reader.Next()) {
+            auto entry = static_cast<uint64_t>(index_reader.GetCurrentEntry());
+            if(block != nullptr && *event_id == block_event_id) {
+                block->second = entry + 1;
+                continue;
+            }
+
+            block_event_id = *event_id;
+            if(require_sequential_events_ && block_event_id < 0) {
+                throw InvalidValueError(
+                    config_, "file_name", "tree contains negative event number " + std::to_string(block_event_id));
+            }
+            auto key = (require_sequential_events_ ? static_cast<uint64_t>(block_event_id) : block_count++);
+            block = &event_index_[key].emplace_back(entry, entry + 1);
+        }
+        LOG(INFO) << "Indexed tree, found " << event_index_.size() << " events";
     }
 
     // If requested, prepare output plots
@@ -226,33 +259,27 @@ void DepositionReaderModule::run(Event* event) {
     std::map<std::shared_ptr<Detector>, std::map<int, size_t>> track_id_to_mcparticle;
 
     LOG(DEBUG) << "Start reading event " << event_num;
-    int64_t curr_event_id = -1;
-    bool end_of_run = false;
-    std::string eof_message;
 
-    do {
-        bool read_status = false;
-        ROOT::Math::XYZPoint global_position;
-        std::string volume;
-        double energy = NAN, time = NAN;
-        int pdg_code = 0, track_id = 0, parent_id = 0;
+    // Look up the deposits of this event in the index of the input file
+    auto event_key = event_num - 1;
+    if(event_index_.empty() || event_key > event_index_.rbegin()->first) {
+        throw EndOfRunException(end_of_run_message());
+    }
+    auto end_of_run = (event_key == event_index_.rbegin()->first);
 
-        try {
+    std::vector<Deposit> energy_deposits;
+    auto event_ranges = event_index_.find(event_key);
+    if(event_ranges != event_index_.end()) {
+        for(const auto& range : event_ranges->second) {
             if(file_model_ == FileModel::CSV) {
-                read_status = read_csv(event_num, volume, global_position, time, energy, pdg_code, track_id, parent_id);
+                read_csv(range, energy_deposits);
             } else if(file_model_ == FileModel::ROOT) {
-                read_status = read_root(
-                    event_num, curr_event_id, volume, global_position, time, energy, pdg_code, track_id, parent_id);
+                read_root(range, energy_deposits);
             }
-        } catch(EndOfRunException& e) {
-            end_of_run = true;
-            eof_message = e.what();
-        }
-
-        if(!read_status || end_of_run) {
-            break;
         }
+    }
 
+    for(auto& [volume, global_position, time, energy, pdg_code, track_id, parent_id] : energy_deposits) {
         // Trim detector name if requested:
         if(volume_chars_ != 0) {
             volume = volume.substr(0, std::min(volume_chars_, volume.size()));
@@ -260,8 +287,8 @@ void DepositionReaderModule::run(Event* event) {
         }
 
         auto detectors = geo_manager_->getDetectors();
-        auto pos = std::find_if(detectors.begin(), detectors.end(), [volume](const std::shared_ptr<Detector>& d) {
-            return d->getName() == volume;
+        auto pos = std::find_if(detectors.begin(), detectors.end(), [&name = volume](const std::shared_ptr<Detector>& d) {
+            return d->getName() == name;
         });
         if(pos == detectors.end()) {
             LOG(TRACE) << "Ignored detector \"" << volume << "\", not found in current simulation";
@@ -280,8 +307,9 @@ void DepositionReaderModule::run(Event* event) {
 
         // Calculate number of electron hole pairs produced, taking into account fluctuations between ionization and lattice
         // excitations via the Fano factor. We assume Gaussian statistics here.
-        auto mean_charge = energy / charge_creation_energy_[detector];
-        allpix::normal_distribution<double> charge_fluctuation(mean_charge, std::sqrt(mean_charge * fano_factor_[detector]));
+        auto mean_charge = energy / charge_creation_energy_.at(detector);
+        allpix::normal_distribution<double> charge_fluctuation(mean_charge,
+                                                               std::sqrt(mean_charge * fano_factor_.at(detector)));
         auto charge = static_cast<unsigned int>(charge_fluctuation(event->getRandomEngine()));
 
         LOG(DEBUG) << "Found deposition of " << charge << " e/h pairs inside sensor at "
@@ -317,9 +345,9 @@ void DepositionReaderModule::run(Event* event) {
         }
 
         particles_to_deposits[detector].push_back(track_id);
-    } while(true);
+    }
 
-    LOG(INFO) << "Finished reading event " << event;
+    LOG(INFO) << "Finished reading event " << event_num;
 
     double time_reference = 0;
 
@@ -411,17 +439,25 @@ void DepositionReaderModule::run(Event* event) {
             // Fill output plots if requested:
             if(output_plots_) {
                 double charge = static_cast<double>(Units::convert(total_deposits, "ke"));
-                charge_per_event_[detector]->Fill(charge);
+                charge_per_event_.at(detector)->Fill(charge);
             }
         }
     }
 
     // Request end-of-run since we don't have events anymore
     if(end_of_run) {
-        throw EndOfRunException(eof_message);
+        throw EndOfRunException(end_of_run_message());
     }
 }
 
+std::string DepositionReaderModule::end_of_run_message() const {
+    if(file_model_ == FileModel::CSV) {
+        return "Requesting end of run, CSV file only contains data for " +
+               std::to_string(event_index_.empty() ? 0 : event_index_.rbegin()->first + 1) + " events";
+    }
+    return "Requesting end of run: end of tree reached";
+}
+
 void DepositionReaderModule::finalize() {
     if(output_plots_) {
         // Write histograms
@@ -431,137 +467,83 @@ void DepositionReaderModule::finalize() {
         }
     }
 }
-bool DepositionReaderModule::read_root(uint64_t event_num,
-                                       int64_t& curr_event_id,
-                                       std::string& volume,
-                                       ROOT::Math::XYZPoint& position,
-                                       double& time,
-                                       double& energy,
-                                       int& pdg_code,
-                                       int& track_id,
-                                       int& parent_id) {
-
-    auto status = tree_reader_->GetEntryStatus();
-    if(status == TTreeReader::kEntryNotFound || status == TTreeReader::kEntryBeyondEnd) {
-        throw EndOfRunException("Requesting end of run: end of tree reached");
-    } else if(status != TTreeReader::kEntryValid) {
-        throw EndOfRunException("Problem reading from tree, error: " + std::to_string(static_cast<int>(status)));
-    }
-
-    if(require_sequential_events_) {
-        // sequential read, return if eventID is larger than allpix-squared event number
-        if(static_cast<uint64_t>(*event_->Get()) > event_num - 1) {
-            return false;
+void DepositionReaderModule::read_root(const std::pair<uint64_t, uint64_t>& range, std::vector<Deposit>& deposits) {
+    // The tree reader can only be used by one thread at a time
+    std::lock_guard<std::mutex> lock(tree_mutex_);
+
+    for(auto entry = range.first; entry < range.second; ++entry) {
+        auto status = tree_reader_->SetEntry(static_cast<Long64_t>(entry));
+        if(status != TTreeReader::kEntryValid) {
+            throw EndOfRunException("Problem reading from tree, error: " + std::to_string(static_cast<int>(status)));
         }
-    } else {
-        // non-sequential read, return if eventID changes (requires events to be in blocks)
-        if(curr_event_id == -1) {
-            // first entry in event, save eventID for later
-            curr_event_id = *event_->Get();
-            LOG(TRACE) << "Read eventID " << curr_event_id;
-        } else {
-            // check if eventID changed compared to last entry, if yes reset curr_event_id
-            if(*event_->Get() != curr_event_id) {
-                curr_event_id = -1;
-                return false;
-            }
-        }
-    }
 
-    // Read detector name
-    volume = std::string(static_cast<char*>(volume_->GetAddress()));
+        Deposit deposit;
 
-    // Read other information, interpret in framework units:
-    position = ROOT::Math::XYZPoint(
-        Units::get(*px_->Get(), unit_length_), Units::get(*py_->Get(), unit_length_), Units::get(*pz_->Get(), unit_length_));
+        // Read detector name
+        deposit.volume = std::string(static_cast<char*>(volume_->GetAddress()));
 
-    // Attempt to read time only if available:
-    time = (time_available_ ? Units::get(*time_->Get(), unit_time_) : 0);
-    energy = Units::get(*edep_->Get(), unit_energy_);
+        // Read other information, interpret in framework units:
+        deposit.position = ROOT::Math::XYZPoint(Units::get(*px_->Get(), unit_length_),
+                                                Units::get(*py_->Get(), unit_length_),
+                                                Units::get(*pz_->Get(), unit_length_));
 
-    // Read PDG code and track ids
-    pdg_code = (*pdg_code_->Get());
-    if(create_mcparticles_) {
-        track_id = (*track_id_->Get());
-        parent_id = (*parent_id_->Get());
-    }
-
-    // Return and advance to next tree entry:
-    tree_reader_->Next();
-    return true;
-}
+        // Attempt to read time only if available:
+        deposit.time = (time_available_ ? Units::get(*time_->Get(), unit_time_) : 0);
+        deposit.energy = Units::get(*edep_->Get(), unit_energy_);
 
-bool DepositionReaderModule::read_csv(uint64_t event_num,
-                                      std::string& volume,
-                                      ROOT::Math::XYZPoint& position,
-                                      double& time,
-                                      double& energy,
-                                      int& pdg_code,
-                                      int& track_id,
-                                      int& parent_id) {
-
-    std::string line, tmp;
-    do {
-        // Read input file line-by-line and trim whitespaces at beginning and end:
-        std::getline(*input_file_, line);
-        line = allpix::trim(line);
-        LOG(TRACE) << "Line read: " << line;
-
-        // Request end of run if we reached end of file:
-        if(input_file_->eof()) {
-            throw EndOfRunException("Requesting end of run, CSV file only contains data for " + std::to_string(event_num) +
-                                    " events");
-        }
-
-        // Check for event header:
-        if(line.front() == 'E') {
-            std::stringstream lse(line);
-            uint64_t event_read = 0;
-            lse >> tmp >> event_read;
-            if(event_read + 1 > event_num) {
-                return false;
-            }
-            LOG(DEBUG) << "Parsed header of event " << event_read << ", continuing";
-            continue;
+        // Read PDG code and track ids
+        deposit.pdg_code = (*pdg_code_->Get());
+        if(create_mcparticles_) {
+            deposit.track_id = (*track_id_->Get());
+            deposit.parent_id = (*parent_id_->Get());
         }
-    } while(line.empty() || line.front() == '#' || line.front() == 'E');
 
-    std::istringstream ls(line);
-    double px = NAN, py = NAN, pz = NAN;
-
-    std::getline(ls, tmp, ',');
-    std::istringstream(tmp) >> pdg_code;
-
-    if(time_available_) {
-        std::getline(ls, tmp, ',');
-        std::istringstream(tmp) >> time;
+        deposits.push_back(std::move(deposit));
     }
+}
 
-    std::getline(ls, tmp, ',');
-    std::istringstream(tmp) >> energy;
+void DepositionReaderModule::read_csv(const std::pair<uint64_t, uint64_t>& range, std::vector<Deposit>& deposits) const {
+    // Number of columns, depending on whether time and Monte Carlo particle information are available
+    size_t columns = 6 + (time_available_ ? 1 : 0) + (create_mcparticles_ ? 2 : 0);
 
-    std::getline(ls, tmp, ',');
-    std::istringstream(tmp) >> px;
-    std::getline(ls, tmp, ',');
-    std::istringstream(tmp) >> py;
-    std::getline(ls, tmp, ',');
-    std::istringstream(tmp) >> pz;
+    MappedCSVFile::Range file_range{static_cast<size_t>(range.first), static_cast<size_t>(range.second)};
+    input_file_->readLines(file_range, [&](const std::vector<std::string_view>& fields) {
+        if(fields.size() < columns) {
+            throw ModuleError("CSV line with " + std::to_string(fields.size()) + " columns found, expected " +
+                              std::to_string(columns));
+        }
 
-    std::getline(ls, volume, ',');
-    volume = allpix::trim(volume);
+        size_t column = 0;
+        auto parse = [&](auto& value) {
+            const auto& field = fields[column++];
+            if(!MappedFile::parse(field, value)) {
+                throw ModuleError("Could not parse value \"" + std::string(field) + "\" in column " +
+                                  std::to_string(column) + " of CSV line");
+            }
+        };
 
-    if(create_mcparticles_) {
-        std::getline(ls, tmp, ',');
-        std::istringstream(tmp) >> track_id;
-        std::getline(ls, tmp, ',');
-        std::istringstream(tmp) >> parent_id;
-    }
+        Deposit deposit;
+        double px = NAN, py = NAN, pz = NAN;
+        parse(deposit.pdg_code);
+        if(time_available_) {
+            parse(deposit.time);
+        }
+        parse(deposit.energy);
+        parse(px);
+        parse(py);
+        parse(pz);
+        deposit.volume = std::string(fields[column++]);
+        if(create_mcparticles_) {
+            parse(deposit.track_id);
+            parse(deposit.parent_id);
+        }
 
-    // Calculate the charge deposit at a global position and convert the proper units
-    position =
-        ROOT::Math::XYZPoint(Units::get(px, unit_length_), Units::get(py, unit_length_), Units::get(pz, unit_length_));
-    time = (time_available_ ? Units::get(time, unit_time_) : 0);
-    energy = Units::get(energy, unit_energy_);
+        // Calculate the charge deposit at a global position and convert the proper units
+        deposit.position =
+            ROOT::Math::XYZPoint(Units::get(px, unit_length_), Units::get(py, unit_length_), Units::get(pz, unit_length_));
+        deposit.time = (time_available_ ? Units::get(deposit.time, unit_time_) : 0);
+        deposit.energy = Units::get(deposit.energy, unit_energy_);
 
-    return true;
+        deposits.push_back(std::move(deposit));
+    });
 }
@@ -14,9 +14,12 @@
  * Refer to the User's Manual for more details.
  */
 
-#include <fstream>
 #include <functional>
+#include <map>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <TFile.h>
 #include <TH1D.h>
@@ -29,6 +32,8 @@
 #include "core/module/Module.hpp"
 #include "objects/DepositedCharge.hpp"
 
+#include "MappedCSVFile.hpp"
+
 namespace allpix {
     /**
      * @ingroup Modules
@@ -36,9 +41,9 @@ namespace allpix {
      *
      * This module allows to read pre-computed energy deposits from data files of different formats. The files should contain
      * individual events with a list of energy deposits at specific position given in local coordinates of the respective
-     * detector.
+     * detector. The entries of all events are indexed when opening the file, such that events can be read independently.
      */
-    class DepositionReaderModule : public SequentialModule {
+    class DepositionReaderModule : public Module {
 
         /**
          * @brief Different implemented file models
@@ -73,14 +78,30 @@ namespace allpix {
         void finalize() override;
 
     private:
+        /**
+         * @brief Energy deposit read from the input file, converted to framework units
+         */
+        struct Deposit {
+            std::string volume;
+            ROOT::Math::XYZPoint position;
+            double time{};
+            double energy{};
+            int pdg_code{};
+            int track_id{};
+            int parent_id{};
+        };
+
         // General module members
         GeometryManager* geo_manager_;
         Messenger* messenger_;
 
         // File containing the input data
-        std::unique_ptr<std::ifstream> input_file_;
+        std::unique_ptr<MappedCSVFile> input_file_;
         std::unique_ptr<TFile> input_file_root_;
 
+        // Ranges of lines or tree entries holding the deposits of every event, indexed by the event number minus one
+        std::map<uint64_t, std::vector<std::pair<uint64_t, uint64_t>>> event_index_;
+
         // Helper to create and check tree branches
         template <typename T> void create_tree_reader(std::shared_ptr<T>& branch_ptr, const std::string& name);
         template <typename T> void check_tree_reader(std::shared_ptr<T> branch_ptr);
@@ -97,6 +118,7 @@ namespace allpix {
         std::shared_ptr<TTreeReaderValue<int>> pdg_code_;
         std::shared_ptr<TTreeReaderValue<int>> track_id_;
         std::shared_ptr<TTreeReaderValue<int>> parent_id_;
+        std::mutex tree_mutex_;
         std::map<std::shared_ptr<Detector>, double> charge_creation_energy_;
         std::map<std::shared_ptr<Detector>, double> fano_factor_;
 
@@ -107,23 +129,24 @@ namespace allpix {
 
         bool require_sequential_events_{}, create_mcparticles_{}, time_available_{};
 
-        bool read_csv(uint64_t event_num,
-                      std::string& volume,
-                      ROOT::Math::XYZPoint& position,
-                      double& time,
-                      double& energy,
-                      int& pdg_code,
-                      int& track_id,
-                      int& parent_id);
-        bool read_root(uint64_t event_num,
-                       int64_t& curr_event_id,
-                       std::string& volume,
-                       ROOT::Math::XYZPoint& position,
-                       double& time,
-                       double& energy,
-                       int& pdg_code,
-                       int& track_id,
-                       int& parent_id);
+        /**
+         * @brief Parse the deposits from a range of lines of the CSV file
+         * @param range Byte range of the lines in the file
+         * @param deposits Vector to append the deposits to
+         */
+        void read_csv(const std::pair<uint64_t, uint64_t>& range, std::vector<Deposit>& deposits) const;
+
+        /**
+         * @brief Read the deposits from a range of tree entries
+         * @param range First and one past the last entry to read
+         * @param deposits Vector to append the deposits to
+         */
+        void read_root(const std::pair<uint64_t, uint64_t>& range, std::vector<Deposit>& deposits);
+
+        /**
+         * @brief Message to request the end of the run with once all events of the input file have been read
+         */
+        std::string end_of_run_message() const;
 
         // Vector of histogram pointers for debugging plots
         std::map<std::shared_ptr<Detector>, Histogram<TH1D>> charge_per_event_;
@@ -0,0 +1,56 @@
+/**
+ * @file
+ * @brief Implementation of a memory-mapped CSV file with an index of its events
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "MappedCSVFile.hpp"
+
+#include <stdexcept>
+
+using namespace allpix;
+
+MappedCSVFile::MappedCSVFile(const std::string& file_name) : file_(file_name, true) {
+    index();
+}
+
+void MappedCSVFile::index() {
+    uint64_t event = 0;
+    size_t data_begin = 0;
+
+    auto text = file_.view();
+    std::string_view line;
+    while(!text.empty()) {
+        auto line_begin = file_.size() - text.size();
+        MappedFile::nextLine(text, line);
+
+        if(!line.empty() && line.front() == 'E') {
+            // Close the range of data lines of the previous event
+            if(line_begin > data_begin) {
+                events_[event].emplace_back(data_begin, line_begin);
+            }
+
+            // Parse the event number following the first token of the header
+            auto separator = line.find_first_of(" \t");
+            auto number =
+                (separator == std::string_view::npos ? std::string_view() : MappedFile::trim(line.substr(separator)));
+            if(!MappedFile::parse(number, event)) {
+                throw std::runtime_error("malformed event header \"" + std::string(line) + "\"");
+            }
+
+            // Register the event also if no data lines follow
+            events_[event];
+            data_begin = file_.size() - text.size();
+        }
+    }
+
+    // Data lines of the last event extend to the end of the file
+    if(file_.size() > data_begin) {
+        events_[event].emplace_back(data_begin, file_.size());
+    }
+}
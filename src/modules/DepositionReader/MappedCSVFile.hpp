@@ -0,0 +1,91 @@
+/**
+ * @file
+ * @brief Definition of a memory-mapped CSV file with an index of its events
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ALLPIX_DEPOSITION_READER_MAPPED_CSV_FILE_H
+#define ALLPIX_DEPOSITION_READER_MAPPED_CSV_FILE_H
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "tools/mapped_file.h"
+
+namespace allpix {
+    /**
+     * @brief Read-only CSV file mapped into memory, with the byte ranges of all events indexed when opening it
+     *
+     * Lines starting with `E` are event headers, which are followed by the data lines of the event. The event number is
+     * parsed from the second whitespace-separated token of the header. Data lines before the first header are attributed to
+     * event zero. Since the file is only read, data lines of different events can be parsed concurrently.
+     */
+    class MappedCSVFile {
+    public:
+        /**
+         * @brief Range of bytes in the file, given as offsets of its first and one past its last byte
+         */
+        using Range = std::pair<size_t, size_t>;
+
+        /**
+         * @brief Map a file and index its events
+         * @param file_name Path of the file to read
+         * @throws std::runtime_error if the file cannot be mapped or contains a malformed event header
+         */
+        explicit MappedCSVFile(const std::string& file_name);
+
+        /**
+         * @brief Get the ranges of data lines following the headers of every event
+         * @return Ranges in the file, indexed by the event number of their header
+         */
+        const std::map<uint64_t, std::vector<Range>>& getEvents() const { return events_; }
+
+        /**
+         * @brief Split all data lines in a range of the file into their fields
+         * @param range Range of the file to read
+         * @param callback Function called with the fields of every data line, empty lines and comments are skipped
+         */
+        template <typename F> void readLines(const Range& range, F callback) const {
+            std::vector<std::string_view> fields;
+            auto text = file_.view(range.first, range.second);
+            std::string_view line;
+            while(MappedFile::nextLine(text, line)) {
+                if(line.empty() || line.front() == '#') {
+                    continue;
+                }
+
+                fields.clear();
+                while(true) {
+                    auto length = std::min(line.find(','), line.size());
+                    fields.push_back(MappedFile::trim(line.substr(0, length)));
+                    if(length == line.size()) {
+                        break;
+                    }
+                    line.remove_prefix(length + 1);
+                }
+                callback(fields);
+            }
+        }
+
+    private:
+        /**
+         * @brief Index the ranges of all events in the file
+         */
+        void index();
+
+        MappedFile file_;
+
+        std::map<uint64_t, std::vector<Range>> events_;
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_DEPOSITION_READER_MAPPED_CSV_FILE_H */
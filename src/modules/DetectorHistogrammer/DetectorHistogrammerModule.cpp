@@ -12,6 +12,7 @@
 #include "DetectorHistogrammerModule.hpp"
 
 #include <algorithm>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <utility>
@@ -23,6 +24,7 @@
 #include "core/utils/log.h"
 
 #include "tools/ROOT.h"
+#include "tools/pixel_clustering.h"
 
 using namespace allpix;
 
@@ -815,47 +817,23 @@ void DetectorHistogrammerModule::finalize() {
  * @brief Perform a sparse clustering on the PixelHits
  */
 std::vector<Cluster> DetectorHistogrammerModule::doClustering(std::shared_ptr<PixelHitMessage>& pixels_message) const {
-    std::vector<Cluster> clusters;
-    std::map<const PixelHit*, bool> usedPixel;
-
-    auto pixel_it = pixels_message->getData().begin();
-    for(; pixel_it != pixels_message->getData().end(); pixel_it++) {
-        const PixelHit* pixel_hit = &(*pixel_it);
-
-        // Check if the pixel has been used:
-        if(usedPixel[pixel_hit]) {
-            continue;
-        }
+    const auto& pixel_hits = pixels_message->getData();
+    auto groups = PixelClustering::findClusters(
+        pixel_hits, *detector_->getModel(), [](const PixelHit& pixel_hit) { return pixel_hit.getIndex(); });
 
+    std::vector<Cluster> clusters;
+    clusters.reserve(groups.size());
+    for(const auto& group : groups) {
         // Create new cluster
-        Cluster cluster(pixel_hit);
-        usedPixel[pixel_hit] = true;
-        LOG(TRACE) << "Creating new cluster with seed: " << pixel_hit->getPixel().getIndex();
-
-        auto touching = [&](const PixelHit* pixel) {
-            for(const auto& cluster_pixel : cluster.getPixelHits()) {
-                if(detector_->getModel()->areNeighbors(cluster_pixel->getIndex(), pixel->getIndex(), 1)) {
-                    return true;
-                }
-            }
-            return false;
-        };
-
-        // Keep adding pixels to the cluster:
-        for(auto other_pixel = pixel_it + 1; other_pixel != pixels_message->getData().end(); other_pixel++) {
-            const PixelHit* neighbor = &(*other_pixel);
-
-            // Check if neighbor has been used or if it touches the current cluster:
-            if(usedPixel[neighbor] || !touching(neighbor)) {
-                continue;
-            }
+        Cluster cluster(&pixel_hits[group.front()]);
+        LOG(TRACE) << "Creating new cluster with seed: " << pixel_hits[group.front()].getIndex();
 
-            cluster.addPixelHit(neighbor);
-            LOG(TRACE) << "Adding pixel: " << neighbor->getPixel().getIndex();
-            usedPixel[neighbor] = true;
-            other_pixel = pixel_it;
+        // Add all other pixels connected to the seed
+        for(auto hit = std::next(group.begin()); hit != group.end(); ++hit) {
+            cluster.addPixelHit(&pixel_hits[*hit]);
+            LOG(TRACE) << "Adding pixel: " << pixel_hits[*hit].getIndex();
         }
-        clusters.push_back(cluster);
+        clusters.push_back(std::move(cluster));
     }
     return clusters;
 }
@@ -47,6 +47,17 @@ void DopingProfileReaderModule::initialize() {
         auto field_mapping = config_.get<FieldMapping>("field_mapping");
         LOG(DEBUG) << "Doping concentration maps to " << magic_enum::enum_name(field_mapping);
 
+        // Interpolation between grid points and storage precision of the compiled grid. A linear 16-bit quantization cannot
+        // resolve concentrations spanning several orders of magnitude, low concentrations would be rounded to zero
+        auto field_interpolation = config_.get<FieldInterpolation>("field_interpolation", FieldInterpolation::NEAREST);
+        auto field_precision = config_.get<FieldPrecision>("field_precision", FieldPrecision::DOUBLE);
+        if(field_precision == FieldPrecision::INT16) {
+            throw InvalidValueError(config_,
+                                    "field_precision",
+                                    "16-bit quantization cannot represent doping concentrations spanning several orders of "
+                                    "magnitude, use FLOAT or DOUBLE");
+        }
+
         auto field_data = read_field();
 
         // By default, set field scale from physical extent read from field file:
@@ -70,13 +81,42 @@ void DopingProfileReaderModule::initialize() {
         }
         LOG(DEBUG) << "Doping profile has offset of " << offset << " fractions of the field size";
 
-        detector_->setDopingProfileGrid(field_data.getData(),
-                                        field_data.getDimensions(),
-                                        field_data.getSize(),
-                                        field_mapping,
-                                        field_scale,
-                                        {{offset.x(), offset.y()}},
-                                        thickness_domain);
+        // Optionally compile the grid into a cache-blocked representation for faster lookups:
+        auto compile_field = config_.get<bool>("compile_field", false);
+        if(compile_field) {
+            LOG(DEBUG) << "Doping profile grid will be compiled for faster lookups";
+        }
+
+        LOG(DEBUG) << "Doping profile grid uses " << magic_enum::enum_name(field_interpolation) << " interpolation and "
+                   << magic_enum::enum_name(field_precision) << " storage precision";
+
+        if(field_data.getOctree() != nullptr) {
+            LOG(DEBUG) << "Doping profile is stored in an adaptive grid with " << field_data.getOctree()->getNumberOfLeaves()
+                       << " leaves";
+            if(field_precision != FieldPrecision::DOUBLE) {
+                LOG(WARNING) << "Storage precision is not applicable to adaptive field grids, ignoring";
+            }
+            detector_->setDopingProfileGrid(field_data.getOctree(),
+                                            field_data.getSize(),
+                                            field_mapping,
+                                            field_scale,
+                                            {{offset.x(), offset.y()}},
+                                            thickness_domain,
+                                            compile_field,
+                                            field_interpolation);
+        } else {
+            detector_->setDopingProfileGrid(field_data.getValues(),
+                                            field_data.getNumberOfValues(),
+                                            field_data.getDimensions(),
+                                            field_data.getSize(),
+                                            field_mapping,
+                                            field_scale,
+                                            {{offset.x(), offset.y()}},
+                                            thickness_domain,
+                                            compile_field,
+                                            field_interpolation,
+                                            field_precision);
+        }
 
     } else if(field_model == DopingProfile::CONSTANT) {
         LOG(TRACE) << "Adding constant doping concentration";
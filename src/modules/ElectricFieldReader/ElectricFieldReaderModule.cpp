@@ -20,13 +20,13 @@
 #include <utility>
 
 #include <Math/Vector3D.h>
-#include <TFormula.h>
 #include <TH2F.h>
 
 #include "core/config/exceptions.h"
 #include "core/geometry/DetectorModel.hpp"
 #include "core/utils/log.h"
 #include "core/utils/unit.h"
+#include "tools/formula.h"
 
 using namespace allpix;
 
@@ -96,13 +96,50 @@ void ElectricFieldReaderModule::initialize() {
         }
         LOG(DEBUG) << "Electric field has offset of " << offset << " fractions of the field size";
 
-        detector_->setElectricFieldGrid(field_data.getData(),
-                                        field_data.getDimensions(),
-                                        field_data.getSize(),
-                                        field_mapping,
-                                        field_scale,
-                                        {{offset.x(), offset.y()}},
-                                        thickness_domain);
+        // Optionally compile the grid into a cache-blocked representation for faster lookups:
+        auto compile_field = config_.get<bool>("compile_field", false);
+        if(compile_field) {
+            LOG(DEBUG) << "Electric field grid will be compiled for faster lookups";
+        }
+
+        // Interpolation between grid points and storage precision of the compiled grid:
+        auto field_interpolation = config_.get<FieldInterpolation>("field_interpolation", FieldInterpolation::NEAREST);
+        auto field_precision = config_.get<FieldPrecision>("field_precision", FieldPrecision::DOUBLE);
+        LOG(DEBUG) << "Electric field grid uses " << magic_enum::enum_name(field_interpolation) << " interpolation and "
+                   << magic_enum::enum_name(field_precision) << " storage precision";
+
+        if(field_data.getOctree() != nullptr) {
+            LOG(DEBUG) << "Electric field is stored in an adaptive grid with " << field_data.getOctree()->getNumberOfLeaves()
+                       << " leaves";
+            if(field_precision != FieldPrecision::DOUBLE) {
+                LOG(WARNING) << "Storage precision is not applicable to adaptive field grids, ignoring";
+            }
+            detector_->setElectricFieldGrid(field_data.getOctree(),
+                                            field_data.getSize(),
+                                            field_mapping,
+                                            field_scale,
+                                            {{offset.x(), offset.y()}},
+                                            thickness_domain,
+                                            compile_field,
+                                            field_interpolation);
+        } else {
+            detector_->setElectricFieldGrid(field_data.getValues(),
+                                            field_data.getNumberOfValues(),
+                                            field_data.getDimensions(),
+                                            field_data.getSize(),
+                                            field_mapping,
+                                            field_scale,
+                                            {{offset.x(), offset.y()}},
+                                            thickness_domain,
+                                            compile_field,
+                                            field_interpolation,
+                                            field_precision);
+        }
+
+        // Report the field as returned by the lookup, including interpolation and reduced storage precision
+        LOG(DEBUG) << "Value of electric field at pixel center: "
+                   << Units::display(detector_->getElectricField(ROOT::Math::XYZPoint(0., 0., model->getSensorCenter().z())),
+                                     {"V/cm"});
     } else if(field_model == ElectricField::CONSTANT) {
         LOG(TRACE) << "Adding constant electric field";
         auto field_z = config_.get<double>("bias_voltage") / getDetector()->getModel()->getSensorSize().z();
@@ -199,14 +236,15 @@ FieldFunction<ROOT::Math::XYZVector> ElectricFieldReaderModule::get_custom_field
 
     auto field_functions = config_.getArray<std::string>("field_function");
     auto field_parameters = config_.getArray<double>("field_parameters");
+    auto compile = config_.get<bool>("compile_functions", true);
 
     // 1D field, interpret as field along z-axis:
     if(field_functions.size() == 1) {
         LOG(DEBUG) << "Found definition of 1D custom field, applying to z axis";
-        auto z = std::make_shared<TFormula>("ez", field_functions.front().c_str(), false);
+        auto z = std::make_shared<Formula>("ez", field_functions.front(), compile);
 
         // Check if number of parameters match up
-        if(static_cast<size_t>(z->GetNpar()) != field_parameters.size()) {
+        if(z->getNParameters() != field_parameters.size()) {
             throw InvalidValueError(
                 config_,
                 "field_parameters",
@@ -215,21 +253,21 @@ FieldFunction<ROOT::Math::XYZVector> ElectricFieldReaderModule::get_custom_field
 
         // Apply parameters to the function
         for(size_t n = 0; n < field_parameters.size(); ++n) {
-            z->SetParameter(static_cast<int>(n), field_parameters.at(n));
+            z->setParameter(n, field_parameters.at(n));
         }
 
-        LOG(DEBUG) << "Value of custom field at pixel center: " << Units::display(z->Eval(0., 0., 0.), "V/cm");
+        LOG(DEBUG) << "Value of custom field at pixel center: " << Units::display(z->eval(0., 0., 0.), "V/cm");
         return [z = std::move(z)](const ROOT::Math::XYZPoint& pos) {
-            return ROOT::Math::XYZVector(0, 0, z->Eval(pos.x(), pos.y(), pos.z()));
+            return ROOT::Math::XYZVector(0, 0, z->eval(pos.x(), pos.y(), pos.z()));
         };
     } else if(field_functions.size() == 3) {
         LOG(DEBUG) << "Found definition of 3D custom field, applying to three Cartesian axes";
-        auto x = std::make_shared<TFormula>("ex", field_functions.at(0).c_str(), false);
-        auto y = std::make_shared<TFormula>("ey", field_functions.at(1).c_str(), false);
-        auto z = std::make_shared<TFormula>("ez", field_functions.at(2).c_str(), false);
+        auto x = std::make_shared<Formula>("ex", field_functions.at(0), compile);
+        auto y = std::make_shared<Formula>("ey", field_functions.at(1), compile);
+        auto z = std::make_shared<Formula>("ez", field_functions.at(2), compile);
 
         // Check if number of parameters match up
-        if(static_cast<size_t>(x->GetNpar() + y->GetNpar() + z->GetNpar()) != field_parameters.size()) {
+        if(x->getNParameters() + y->getNParameters() + z->getNParameters() != field_parameters.size()) {
             throw InvalidValueError(
                 config_,
                 "field_parameters",
@@ -237,22 +275,22 @@ FieldFunction<ROOT::Math::XYZVector> ElectricFieldReaderModule::get_custom_field
         }
 
         // Apply parameters to the functions
-        for(auto n = 0; n < x->GetNpar(); ++n) {
-            x->SetParameter(n, field_parameters.at(static_cast<size_t>(n)));
+        for(size_t n = 0; n < x->getNParameters(); ++n) {
+            x->setParameter(n, field_parameters.at(n));
         }
-        for(auto n = 0; n < y->GetNpar(); ++n) {
-            y->SetParameter(n, field_parameters.at(static_cast<size_t>(n + x->GetNpar())));
+        for(size_t n = 0; n < y->getNParameters(); ++n) {
+            y->setParameter(n, field_parameters.at(n + x->getNParameters()));
         }
-        for(auto n = 0; n < z->GetNpar(); ++n) {
-            z->SetParameter(n, field_parameters.at(static_cast<size_t>(n + x->GetNpar() + y->GetNpar())));
+        for(size_t n = 0; n < z->getNParameters(); ++n) {
+            z->setParameter(n, field_parameters.at(n + x->getNParameters() + y->getNParameters()));
         }
 
         LOG(DEBUG) << "Value of custom field at pixel center: "
-                   << Units::display(ROOT::Math::XYZVector(x->Eval(0., 0., 0.), y->Eval(0., 0., 0.), z->Eval(0., 0., 0.)),
+                   << Units::display(ROOT::Math::XYZVector(x->eval(0., 0., 0.), y->eval(0., 0., 0.), z->eval(0., 0., 0.)),
                                      {"V/cm"});
         return [x = std::move(x), y = std::move(y), z = std::move(z)](const ROOT::Math::XYZPoint& pos) {
             return ROOT::Math::XYZVector(
-                x->Eval(pos.x(), pos.y(), pos.z()), y->Eval(pos.x(), pos.y(), pos.z()), z->Eval(pos.x(), pos.y(), pos.z()));
+                x->eval(pos.x(), pos.y(), pos.z()), y->eval(pos.x(), pos.y(), pos.z()), z->eval(pos.x(), pos.y(), pos.z()));
         };
     } else {
         throw InvalidValueError(config_,
@@ -276,7 +314,8 @@ FieldData<double> ElectricFieldReaderModule::read_field() {
         auto field_data = field_parser_.getByFileName(config_.getPath("file_name", true), "V/cm");
 
         // Warn at field values larger than 1MV/cm / 10 MV/mm. Simple lookup per vector component, not total field magnitude
-        auto max_field = *std::max_element(std::begin(*field_data.getData()), std::end(*field_data.getData()));
+        auto values = field_data.getValues();
+        auto max_field = *std::max_element(values.get(), values.get() + field_data.getNumberOfValues());
         if(max_field > 10) {
             LOG(WARNING) << "Very high electric field of " << Units::display(max_field, "kV/cm")
                          << ", this is most likely not desired.";
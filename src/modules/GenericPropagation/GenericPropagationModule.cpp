@@ -12,13 +12,17 @@
 
 #include "GenericPropagationModule.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <iterator>
 #include <limits>
 #include <map>
 #include <memory>
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <Eigen/Core>
 
@@ -60,6 +64,9 @@ GenericPropagationModule::GenericPropagationModule(Configuration& config,
     config_.setDefault<double>("integration_time", Units::get(25, "ns"));
     config_.setDefault<unsigned int>("charge_per_step", 10);
     config_.setDefault<unsigned int>("max_charge_groups", 1000);
+    config_.setDefault<unsigned int>("carrier_batch_size", 0);
+    config_.setDefault<unsigned int>("charge_groups_per_task", 0);
+    config_.setDefault<bool>("compact_output", false);
     config_.setDefault<double>("temperature", 293.15);
 
     // Models:
@@ -113,11 +120,31 @@ GenericPropagationModule::GenericPropagationModule(Configuration& config,
     output_linegraphs_trapped_ = config_.get<bool>("output_linegraphs_trapped");
     output_animations_ = config_.get<bool>("output_animations");
     output_plots_step_ = config_.get<double>("output_plots_step");
+    if(output_linegraphs_ || output_animations_) {
+        linegraph_settings_ = LineGraph::Settings(config_);
+    }
     propagate_electrons_ = config_.get<bool>("propagate_electrons");
     propagate_holes_ = config_.get<bool>("propagate_holes");
     charge_per_step_ = config_.get<unsigned int>("charge_per_step");
     max_charge_groups_ = config_.get<unsigned int>("max_charge_groups");
     max_multiplication_level_ = config.get<unsigned int>("max_multiplication_level");
+    carrier_batch_size_ = config_.get<unsigned int>("carrier_batch_size");
+    charge_groups_per_task_ = config_.get<unsigned int>("charge_groups_per_task");
+    compact_output_ = config_.get<bool>("compact_output");
+
+    // Batched propagation does not keep track of individual paths
+    if(carrier_batch_size_ > 0 && output_linegraphs_) {
+        throw InvalidCombinationError(config_,
+                                      {"carrier_batch_size", "output_linegraphs"},
+                                      "Line graphs cannot be produced when propagating charge carriers in batches");
+    }
+
+    // Line graphs are collected per event and cannot be merged from independent tasks
+    if(charge_groups_per_task_ > 0 && output_linegraphs_) {
+        throw InvalidCombinationError(config_,
+                                      {"charge_groups_per_task", "output_linegraphs"},
+                                      "Line graphs cannot be produced when splitting events into tasks");
+    }
 
     // Enable multithreading of this module if multithreading is enabled and no per-event output plots are requested:
     // FIXME: Review if this is really the case or we can still use multithreading
@@ -290,6 +317,33 @@ void GenericPropagationModule::initialize() {
                         "unphysical results";
     }
 
+    // Batched propagation does not support the generation of secondary charge carriers
+    if(carrier_batch_size_ > 0) {
+        if(!multiplication_.is<NoImpactIonization>()) {
+            throw InvalidCombinationError(
+                config_,
+                {"carrier_batch_size", "multiplication_model"},
+                "Charge multiplication is not supported when propagating charge carriers in batches");
+        }
+        LOG(INFO) << "Propagating charge carriers in batches of " << carrier_batch_size_ << " charge carrier groups";
+    }
+    if(charge_groups_per_task_ > 0) {
+        LOG(INFO) << "Splitting events into tasks of " << charge_groups_per_task_ << " charge carrier groups";
+    }
+
+    // Only dispatch compact propagated charges if none of the receivers requires the full objects
+    if(compact_output_) {
+        compact_output_ = !messenger_->hasReceiver(
+            this,
+            std::make_shared<PropagatedChargeMessage>(std::vector<PropagatedCharge>(), detector_),
+            std::make_shared<CompactPropagatedChargeMessage>(std::vector<CompactPropagatedCharge>(), detector_));
+        if(compact_output_) {
+            LOG(INFO) << "Dispatching compact propagated charges without Monte-Carlo history";
+        } else {
+            LOG(WARNING) << "Compact output requested but receivers require full propagated charge objects";
+        }
+    }
+
     // Prepare trapping model
     trapping_ = Trapping(config_);
 
@@ -300,19 +354,15 @@ void GenericPropagationModule::initialize() {
 void GenericPropagationModule::run(Event* event) {
     auto deposits_message = messenger_->fetchMessage<DepositedChargeMessage>(this, event);
 
-    // Create vector of propagated charges to output
-    std::vector<PropagatedCharge> propagated_charges;
-
     // List of points to plot to plot for output plots
     LineGraph::OutputPlotPoints output_plot_points;
 
     // Loop over all deposits for propagation
     LOG(TRACE) << "Propagating charges in sensor";
-    unsigned int propagated_charges_count = 0;
-    unsigned int recombined_charges_count = 0;
-    unsigned int trapped_charges_count = 0;
-    unsigned int step_count = 0;
-    long double total_time = 0;
+
+    // Charge carrier groups collected for propagation
+    std::vector<std::pair<const DepositedCharge*, unsigned int>> groups;
+
     for(const auto& deposit : deposits_message->getData()) {
 
         if((deposit.getType() == CarrierType::ELECTRON && !propagate_electrons_) ||
@@ -352,42 +402,31 @@ void GenericPropagationModule::run(Event* event) {
                 charge_per_step = charges_remaining;
             }
             charges_remaining -= charge_per_step;
-
-            // Propagate a single charge deposit
-            auto [recombined, trapped, propagated, steps, time] = propagate(event,
-                                                                            deposit,
-                                                                            deposit.getLocalPosition(),
-                                                                            deposit.getType(),
-                                                                            charge_per_step,
-                                                                            deposit.getLocalTime(),
-                                                                            deposit.getGlobalTime(),
-                                                                            0,
-                                                                            propagated_charges,
-                                                                            output_plot_points);
-
-            // Update statistical information
-            recombined_charges_count += recombined;
-            trapped_charges_count += trapped;
-            propagated_charges_count += propagated;
-            step_count += steps;
-            total_time += time;
+            groups.emplace_back(&deposit, charge_per_step);
         }
     }
 
+    // Fill the compact representation directly if the full objects are not required by any receiver
+    std::vector<PropagatedCharge> propagated_charges;
+    std::vector<CompactPropagatedCharge> compact_charges;
+    auto [recombined_charges_count, trapped_charges_count, propagated_charges_count, step_count, total_time] =
+        (compact_output_ ? propagate_event(event, groups, compact_charges, output_plot_points)
+                         : propagate_event(event, groups, propagated_charges, output_plot_points));
+
     // Output plots if required
     if(output_linegraphs_) {
-        LineGraph::Create(event->number, this, config_, output_plot_points, CarrierState::UNKNOWN);
+        LineGraph::Create(event->number, this, linegraph_settings_, output_plot_points, CarrierState::UNKNOWN);
         if(output_linegraphs_collected_) {
-            LineGraph::Create(event->number, this, config_, output_plot_points, CarrierState::HALTED);
+            LineGraph::Create(event->number, this, linegraph_settings_, output_plot_points, CarrierState::HALTED);
         }
         if(output_linegraphs_recombined_) {
-            LineGraph::Create(event->number, this, config_, output_plot_points, CarrierState::RECOMBINED);
+            LineGraph::Create(event->number, this, linegraph_settings_, output_plot_points, CarrierState::RECOMBINED);
         }
         if(output_linegraphs_trapped_) {
-            LineGraph::Create(event->number, this, config_, output_plot_points, CarrierState::TRAPPED);
+            LineGraph::Create(event->number, this, linegraph_settings_, output_plot_points, CarrierState::TRAPPED);
         }
         if(output_animations_) {
-            LineGraph::Animate(event->number, this, config_, output_plot_points);
+            LineGraph::Animate(event->number, this, linegraph_settings_, output_plot_points);
         }
     }
 
@@ -407,6 +446,14 @@ void GenericPropagationModule::run(Event* event) {
         trapped_histo_->Fill(static_cast<double>(trapped_charges_count) / (total == 0 ? 1 : total));
     }
 
+    if(compact_output_) {
+        // Create and dispatch a new message with compact propagated charges
+        auto compact_charge_message =
+            std::make_shared<CompactPropagatedChargeMessage>(std::move(compact_charges), detector_);
+        messenger_->dispatchMessage(this, compact_charge_message, event);
+        return;
+    }
+
     // Create a new message with propagated charges
     auto propagated_charge_message = std::make_shared<PropagatedChargeMessage>(std::move(propagated_charges), detector_);
 
@@ -414,13 +461,115 @@ void GenericPropagationModule::run(Event* event) {
     messenger_->dispatchMessage(this, propagated_charge_message, event);
 }
 
+template <typename C>
+std::tuple<unsigned int, unsigned int, unsigned int, unsigned int, long double>
+GenericPropagationModule::propagate_event(Event* event,
+                                          const std::vector<std::pair<const DepositedCharge*, unsigned int>>& groups,
+                                          std::vector<C>& propagated_charges,
+                                          LineGraph::OutputPlotPoints& output_plot_points) const {
+    unsigned int propagated_charges_count = 0;
+    unsigned int recombined_charges_count = 0;
+    unsigned int trapped_charges_count = 0;
+    unsigned int step_count = 0;
+    long double total_time = 0;
+
+    if(charge_groups_per_task_ > 0 && groups.size() > charge_groups_per_task_) {
+        // Split the charge carrier groups into tasks with their own random number generator, created upfront from the event
+        // to keep the result independent of the number of workers
+        auto tasks = (groups.size() + charge_groups_per_task_ - 1) / charge_groups_per_task_;
+        std::vector<RandomNumberGenerator> task_engines;
+        task_engines.reserve(tasks);
+        for(size_t task = 0; task < tasks; ++task) {
+            task_engines.push_back(event->createTaskRandomEngine(task));
+        }
+        LOG(DEBUG) << "Propagating " << groups.size() << " charge carrier groups in " << tasks << " tasks";
+
+        std::vector<std::vector<C>> task_charges(tasks);
+        std::vector<std::tuple<unsigned int, unsigned int, unsigned int, unsigned int, long double>> task_results(tasks);
+        run_tasks(tasks, [&](size_t task) {
+            auto& random_generator = task_engines[task];
+            auto end = std::min((task + 1) * charge_groups_per_task_, groups.size());
+            auto first = groups.begin() + static_cast<std::ptrdiff_t>(task * charge_groups_per_task_);
+            auto last = groups.begin() + static_cast<std::ptrdiff_t>(end);
+            LineGraph::OutputPlotPoints task_plot_points;
+            task_results[task] = propagate_groups(random_generator, {first, last}, task_charges[task], task_plot_points);
+        });
+
+        // Merge the results in the order of the tasks
+        for(size_t task = 0; task < tasks; ++task) {
+            auto [recombined, trapped, propagated, steps, time] = task_results[task];
+            recombined_charges_count += recombined;
+            trapped_charges_count += trapped;
+            propagated_charges_count += propagated;
+            step_count += steps;
+            total_time += time;
+            std::move(task_charges[task].begin(), task_charges[task].end(), std::back_inserter(propagated_charges));
+        }
+    } else {
+        auto [recombined, trapped, propagated, steps, time] =
+            propagate_groups(event->getRandomEngine(), groups, propagated_charges, output_plot_points);
+        recombined_charges_count += recombined;
+        trapped_charges_count += trapped;
+        propagated_charges_count += propagated;
+        step_count += steps;
+        total_time += time;
+    }
+
+
+    return {recombined_charges_count, trapped_charges_count, propagated_charges_count, step_count, total_time};
+}
+
+template <typename C>
+std::tuple<unsigned int, unsigned int, unsigned int, unsigned int, long double>
+GenericPropagationModule::propagate_groups(RandomNumberGenerator& random_generator,
+                                           const std::vector<std::pair<const DepositedCharge*, unsigned int>>& groups,
+                                           std::vector<C>& propagated_charges,
+                                           LineGraph::OutputPlotPoints& output_plot_points) const {
+    if(groups.empty()) {
+        return {};
+    }
+
+    // Propagate all charge carrier groups in batches
+    if(carrier_batch_size_ > 0) {
+        return propagate_batched(random_generator, groups, propagated_charges);
+    }
+
+    unsigned int propagated_charges_count = 0;
+    unsigned int recombined_charges_count = 0;
+    unsigned int trapped_charges_count = 0;
+    unsigned int step_count = 0;
+    long double total_time = 0;
+    for(const auto& [deposit, charge] : groups) {
+        // Propagate a single charge deposit
+        auto [recombined, trapped, propagated, steps, time] = propagate(random_generator,
+                                                                        *deposit,
+                                                                        deposit->getLocalPosition(),
+                                                                        deposit->getType(),
+                                                                        charge,
+                                                                        deposit->getLocalTime(),
+                                                                        deposit->getGlobalTime(),
+                                                                        0,
+                                                                        propagated_charges,
+                                                                        output_plot_points);
+
+        // Update statistical information
+        recombined_charges_count += recombined;
+        trapped_charges_count += trapped;
+        propagated_charges_count += propagated;
+        step_count += steps;
+        total_time += time;
+    }
+    return {recombined_charges_count, trapped_charges_count, propagated_charges_count, step_count, total_time};
+}
+
 /**
  * Propagation is simulated using a parameterization for the electron mobility. This is used to calculate the electron
  * velocity at every point with help of the electric field map of the detector. An Runge-Kutta integration is applied in
  * multiple steps, adding a random diffusion to the propagating charge every step.
  */
+template <typename C>
 std::tuple<unsigned int, unsigned int, unsigned int, unsigned int, long double>
-GenericPropagationModule::propagate(Event* event,
+GenericPropagationModule::propagate(RandomNumberGenerator& random_generator,
                                     const DepositedCharge& deposit,
                                     const ROOT::Math::XYZPoint& pos,
                                     const CarrierType& type,
@@ -428,7 +577,7 @@ GenericPropagationModule::propagate(Event* event,
                                     const double initial_time_local,
                                     const double initial_time_global,
                                     const unsigned int level,
-                                    std::vector<PropagatedCharge>& propagated_charges,
+                                    std::vector<C>& propagated_charges,
                                     LineGraph::OutputPlotPoints& output_plot_points) const {
 
     if(level > max_multiplication_level_) {
@@ -459,16 +608,28 @@ GenericPropagationModule::propagate(Event* event,
     double gain_previous = 1.;
     unsigned int gain_integer = 1;
 
+    // Counter-based generators provide the random numbers for the diffusion in blocks, the Mersenne Twister draws them one
+    // by one to keep the results of existing simulations unchanged
+    const bool buffered_diffusion = random_generator.isCounterBased();
+    allpix::buffered_normal_distribution<double> buffered_gauss_distribution;
+
     // Define a function to compute the diffusion
     auto carrier_diffusion = [&](double efield_mag, double doping_concentration, double timestep) -> Eigen::Vector3d {
         double diffusion_constant = boltzmann_kT_ * mobility_(type, efield_mag, doping_concentration);
         double diffusion_std_dev = std::sqrt(2. * diffusion_constant * timestep);
 
+        if(buffered_diffusion) {
+            auto x = diffusion_std_dev * buffered_gauss_distribution(random_generator);
+            auto y = diffusion_std_dev * buffered_gauss_distribution(random_generator);
+            auto z = diffusion_std_dev * buffered_gauss_distribution(random_generator);
+            return Eigen::Vector3d(x, y, z);
+        }
+
         // Compute the independent diffusion in three
         allpix::normal_distribution<double> gauss_distribution(0, diffusion_std_dev);
-        auto x = gauss_distribution(event->getRandomEngine());
-        auto y = gauss_distribution(event->getRandomEngine());
-        auto z = gauss_distribution(event->getRandomEngine());
+        auto x = gauss_distribution(random_generator);
+        auto y = gauss_distribution(random_generator);
+        auto z = gauss_distribution(random_generator);
         return Eigen::Vector3d(x, y, z);
     };
 
@@ -562,18 +723,18 @@ GenericPropagationModule::propagate(Event* event,
         // Check if charge carrier is still alive:
         if(recombination_(type,
                           detector_->getDopingConcentration(static_cast<ROOT::Math::XYZPoint>(position)),
-                          uniform_distribution(event->getRandomEngine()),
+                          uniform_distribution(random_generator),
                           timestep)) {
             state = CarrierState::RECOMBINED;
         }
 
         // Check if the charge carrier has been trapped:
-        if(trapping_(type, uniform_distribution(event->getRandomEngine()), timestep, std::sqrt(efield.Mag2()))) {
+        if(trapping_(type, uniform_distribution(random_generator), timestep, std::sqrt(efield.Mag2()))) {
             if(output_plots_) {
                 trapping_time_histo_->Fill(static_cast<double>(Units::convert(runge_kutta.getTime(), "ns")), charge);
             }
 
-            auto detrap_time = detrapping_(type, uniform_distribution(event->getRandomEngine()), std::sqrt(efield.Mag2()));
+            auto detrap_time = detrapping_(type, uniform_distribution(random_generator), std::sqrt(efield.Mag2()));
             if((initial_time_local + runge_kutta.getTime() + detrap_time) < integration_time_) {
                 LOG(DEBUG) << "De-trapping charge carrier after " << Units::display(detrap_time, {"ns", "us"});
                 // De-trap and advance in time if still below integration time
@@ -628,7 +789,7 @@ GenericPropagationModule::propagate(Event* event,
                 }
 
                 auto [recombined, trapped, propagated, psteps, ptime] =
-                    propagate(event,
+                    propagate(random_generator,
                               deposit,
                               carrier_pos,
                               inverted_type,
@@ -744,17 +905,8 @@ GenericPropagationModule::propagate(Event* event,
                << Units::display(time, "ns") << " time, gain " << gain << ", final state: " << allpix::to_string(state);
 
     // Create a new propagated charge and add it to the list
-    auto global_position = detector_->getGlobalPosition(local_position);
-    PropagatedCharge propagated_charge(local_position,
-                                       global_position,
-                                       deposit.getType(),
-                                       static_cast<unsigned int>(std::lround(charge * gain)),
-                                       deposit.getLocalTime() + time,
-                                       deposit.getGlobalTime() + time,
-                                       state,
-                                       &deposit);
-
-    propagated_charges.push_back(std::move(propagated_charge));
+    auto rounded_charge = static_cast<unsigned int>(std::lround(charge * gain));
+    store_charge(propagated_charges, deposit, local_position, rounded_charge, time, state);
 
     if(output_plots_) {
         drift_time_histo_->Fill(static_cast<double>(Units::convert(time, "ns")), charge);
@@ -765,6 +917,354 @@ GenericPropagationModule::propagate(Event* event,
     return std::make_tuple(recombined_charges_count, trapped_charges_count, propagated_charges_count, steps, total_time);
 }
 
+/**
+ * Charge carrier groups are assigned to a fixed number of lanes. The state of all lanes is kept in a structure-of-arrays
+ * layout, such that the Runge-Kutta stages and the drift velocity calculation are performed as array operations over all
+ * lanes. The electric field and the doping profile are sampled for all lanes with a single call on the detector, which
+ * resolves the lookup method once per batch, and only the model evaluations are carried out lane by lane. A lane is refilled
+ * with the next pending charge carrier group as soon as its group has finished propagating.
+ *
+ * Every group draws its random numbers from an individual generator seeded from the event random engine in the order of the
+ * groups, and the arithmetic operations on a lane never depend on the content of other lanes. The result of the propagation
+ * is therefore identical for any choice of the batch size.
+ */
+template <typename C>
+std::tuple<unsigned int, unsigned int, unsigned int, unsigned int, long double>
+GenericPropagationModule::propagate_batched(RandomNumberGenerator& random_generator,
+                                            const std::vector<std::pair<const DepositedCharge*, unsigned int>>& groups,
+                                            std::vector<C>& propagated_charges) const {
+    using Lanes = Eigen::ArrayXd;
+    constexpr auto stages = 6;
+    constexpr auto no_group = std::numeric_limits<size_t>::max();
+    const auto lanes = static_cast<Eigen::Index>(std::min(static_cast<size_t>(carrier_batch_size_), groups.size()));
+
+    // Draw seeds for all charge carrier groups upfront to decouple the random number streams from the lane assignment
+    std::vector<uint64_t> seeds;
+    seeds.reserve(groups.size());
+    for(size_t group = 0; group < groups.size(); ++group) {
+        seeds.push_back(random_generator());
+    }
+
+    // Final state of all charge carrier groups, stored in the order of the groups
+    std::vector<std::tuple<Eigen::Vector3d, double, CarrierState>> results(groups.size());
+
+    // State of all lanes: group index, position, time and timestep as well as carrier type properties
+    std::vector<size_t> lane_group(static_cast<size_t>(lanes), no_group);
+    std::vector<CarrierType> lane_type(static_cast<size_t>(lanes));
+    std::vector<CarrierState> lane_state(static_cast<size_t>(lanes));
+    std::vector<RandomNumberGenerator> lane_engine(static_cast<size_t>(lanes));
+    Lanes pos_x = Lanes::Zero(lanes), pos_y = Lanes::Zero(lanes), pos_z = Lanes::Zero(lanes);
+    Lanes last_x = Lanes::Zero(lanes), last_y = Lanes::Zero(lanes), last_z = Lanes::Zero(lanes);
+    Lanes time = Lanes::Zero(lanes), timestep = Lanes::Zero(lanes), initial_time = Lanes::Zero(lanes);
+    Lanes sign = Lanes::Zero(lanes), hall = Lanes::Zero(lanes);
+
+    // Scratch arrays for field samples, Runge-Kutta stages and diffusion
+    Lanes e_x(lanes), e_y(lanes), e_z(lanes), b_x(lanes), b_y(lanes), b_z(lanes), mobility(lanes), doping(lanes);
+    std::vector<ROOT::Math::XYZVector> efield(static_cast<size_t>(lanes));
+    std::array<Lanes, stages> k_x, k_y, k_z;
+    Lanes gauss_x(lanes), gauss_y(lanes), gauss_z(lanes);
+
+    // Sample the electric field and the doping profile at the positions of all lanes at once and evaluate the mobility for
+    // the occupied lanes
+    auto sample_fields = [&](const Lanes& x, const Lanes& y, const Lanes& z) {
+        detector_->getElectricField(x.data(), y.data(), z.data(), static_cast<size_t>(lanes), efield.data());
+        detector_->getDopingConcentration(x.data(), y.data(), z.data(), static_cast<size_t>(lanes), doping.data());
+        for(Eigen::Index lane = 0; lane < lanes; ++lane) {
+            auto idx = static_cast<size_t>(lane);
+            if(lane_group[idx] == no_group) {
+                e_x[lane] = e_y[lane] = e_z[lane] = mobility[lane] = 0.;
+                continue;
+            }
+            e_x[lane] = efield[idx].x();
+            e_y[lane] = efield[idx].y();
+            e_z[lane] = efield[idx].z();
+            mobility[lane] = mobility_(lane_type[idx], std::sqrt(efield[idx].Mag2()), doping[lane]);
+        }
+    };
+
+    // Sample the fields for all occupied lanes and compute the drift velocity
+    auto carrier_velocity = [&](const Lanes& x, const Lanes& y, const Lanes& z, Lanes& v_x, Lanes& v_y, Lanes& v_z) {
+        sample_fields(x, y, z);
+        if(!has_magnetic_field_) {
+            v_x = sign * mobility * e_x;
+            v_y = sign * mobility * e_y;
+            v_z = sign * mobility * e_z;
+            return;
+        }
+
+        for(Eigen::Index lane = 0; lane < lanes; ++lane) {
+            if(lane_group[static_cast<size_t>(lane)] == no_group) {
+                b_x[lane] = b_y[lane] = b_z[lane] = 0.;
+                continue;
+            }
+            auto bfield = detector_->getMagneticField(ROOT::Math::XYZPoint(x[lane], y[lane], z[lane]));
+            b_x[lane] = bfield.x();
+            b_y[lane] = bfield.y();
+            b_z[lane] = bfield.z();
+        }
+
+        // Lorentz drift, see the scalar implementation in propagate()
+        Lanes mob_hall = mobility * hall;
+        Lanes term2 = mob_hall * mob_hall * (e_x * b_x + e_y * b_y + e_z * b_z);
+        Lanes rnorm = 1. + mob_hall * mob_hall * (b_x * b_x + b_y * b_y + b_z * b_z);
+        v_x = sign * mobility * (e_x + sign * mob_hall * (e_y * b_z - e_z * b_y) + term2 * b_x) / rnorm;
+        v_y = sign * mobility * (e_y + sign * mob_hall * (e_z * b_x - e_x * b_z) + term2 * b_y) / rnorm;
+        v_z = sign * mobility * (e_z + sign * mob_hall * (e_x * b_y - e_y * b_x) + term2 * b_z) / rnorm;
+    };
+
+    unsigned int propagated_charges_count = 0;
+    unsigned int recombined_charges_count = 0;
+    unsigned int trapped_charges_count = 0;
+    unsigned int steps = 0;
+    long double total_time = 0;
+
+    // Store the final state of the group in a lane and mark the lane as free
+    auto finish_lane = [&](Eigen::Index lane) {
+        auto idx = static_cast<size_t>(lane);
+        auto group = lane_group[idx];
+        auto charge = groups[group].second;
+
+        // Find proper final position in the sensor
+        auto position = ROOT::Math::XYZPoint(pos_x[lane], pos_y[lane], pos_z[lane]);
+        if(lane_state[idx] == CarrierState::HALTED && !model_->isWithinSensor(position)) {
+            position = model_->getSensorIntercept(ROOT::Math::XYZPoint(last_x[lane], last_y[lane], last_z[lane]), position);
+        }
+
+        if(lane_state[idx] == CarrierState::RECOMBINED) {
+            recombined_charges_count += charge;
+            if(output_plots_) {
+                recombination_time_histo_->Fill(static_cast<double>(Units::convert(time[lane], "ns")), charge);
+            }
+        } else if(lane_state[idx] == CarrierState::TRAPPED) {
+            trapped_charges_count += charge;
+        }
+        propagated_charges_count += charge;
+        ++steps;
+        total_time += time[lane] * charge;
+
+        if(output_plots_) {
+            drift_time_histo_->Fill(static_cast<double>(Units::convert(time[lane], "ns")), charge);
+            group_size_histo_->Fill(charge);
+        }
+
+        LOG(DEBUG) << " Propagated " << charge << " to " << Units::display(position, {"mm", "um"}) << " in "
+                   << Units::display(time[lane], "ns") << " time, final state: " << allpix::to_string(lane_state[idx]);
+
+        results[group] =
+            std::make_tuple(Eigen::Vector3d(position.x(), position.y(), position.z()), time[lane], lane_state[idx]);
+        lane_group[idx] = no_group;
+    };
+
+    // Assign pending charge carrier groups to free lanes
+    size_t next_group = 0;
+    auto fill_lanes = [&]() {
+        for(Eigen::Index lane = 0; lane < lanes; ++lane) {
+            auto idx = static_cast<size_t>(lane);
+            while(lane_group[idx] == no_group && next_group < groups.size()) {
+                const auto& deposit = *groups[next_group].first;
+                lane_group[idx] = next_group;
+                lane_type[idx] = deposit.getType();
+                lane_state[idx] = CarrierState::MOTION;
+                lane_engine[idx].seed(seeds[next_group]);
+                pos_x[lane] = last_x[lane] = deposit.getLocalPosition().x();
+                pos_y[lane] = last_y[lane] = deposit.getLocalPosition().y();
+                pos_z[lane] = last_z[lane] = deposit.getLocalPosition().z();
+                time[lane] = 0.;
+                timestep[lane] = timestep_start_;
+                initial_time[lane] = deposit.getLocalTime();
+                sign[lane] = static_cast<int>(deposit.getType());
+                hall[lane] = (deposit.getType() == CarrierType::ELECTRON ? electron_Hall_ : hole_Hall_);
+                ++next_group;
+
+                // Groups deposited at the end of the integration time are finished right away
+                if(initial_time[lane] >= integration_time_) {
+                    finish_lane(lane);
+                }
+            }
+        }
+    };
+
+    fill_lanes();
+    while(std::any_of(lane_group.begin(), lane_group.end(), [&](auto group) { return group != no_group; })) {
+        // Free lanes do not move
+        for(Eigen::Index lane = 0; lane < lanes; ++lane) {
+            if(lane_group[static_cast<size_t>(lane)] == no_group) {
+                timestep[lane] = 0.;
+            }
+        }
+
+        // Execute a Runge-Kutta step with the RKF5 tableau for all lanes
+        Lanes step_x = Lanes::Zero(lanes), step_y = Lanes::Zero(lanes), step_z = Lanes::Zero(lanes);
+        Lanes error_x = Lanes::Zero(lanes), error_y = Lanes::Zero(lanes), error_z = Lanes::Zero(lanes);
+        for(int i = 0; i < stages; ++i) {
+            Lanes stage_x = pos_x, stage_y = pos_y, stage_z = pos_z;
+            for(int j = 0; j < i; ++j) {
+                stage_x += timestep * tableau::RK5(i, j) * k_x[static_cast<size_t>(j)];
+                stage_y += timestep * tableau::RK5(i, j) * k_y[static_cast<size_t>(j)];
+                stage_z += timestep * tableau::RK5(i, j) * k_z[static_cast<size_t>(j)];
+            }
+            auto stage = static_cast<size_t>(i);
+            carrier_velocity(stage_x, stage_y, stage_z, k_x[stage], k_y[stage], k_z[stage]);
+
+            step_x += timestep * tableau::RK5(stages, i) * k_x[stage];
+            step_y += timestep * tableau::RK5(stages, i) * k_y[stage];
+            step_z += timestep * tableau::RK5(stages, i) * k_z[stage];
+            error_x += timestep * tableau::RK5(stages + 1, i) * k_x[stage];
+            error_y += timestep * tableau::RK5(stages + 1, i) * k_y[stage];
+            error_z += timestep * tableau::RK5(stages + 1, i) * k_z[stage];
+        }
+        error_x = step_x - error_x;
+        error_y = step_y - error_y;
+        error_z = step_z - error_z;
+
+        // Update positions and time
+        last_x = pos_x;
+        last_y = pos_y;
+        last_z = pos_z;
+        pos_x += step_x;
+        pos_y += step_y;
+        pos_z += step_z;
+        time += timestep;
+
+        // Sample the fields at the new positions and draw the diffusion from the random number streams of the groups
+        allpix::normal_distribution<double> gauss_distribution(0, 1);
+        sample_fields(pos_x, pos_y, pos_z);
+        for(Eigen::Index lane = 0; lane < lanes; ++lane) {
+            auto idx = static_cast<size_t>(lane);
+            if(lane_group[idx] == no_group) {
+                gauss_x[lane] = gauss_y[lane] = gauss_z[lane] = 0.;
+                continue;
+            }
+            gauss_x[lane] = gauss_distribution(lane_engine[idx]);
+            gauss_y[lane] = gauss_distribution(lane_engine[idx]);
+            gauss_z[lane] = gauss_distribution(lane_engine[idx]);
+        }
+
+        // Apply diffusion step
+        Lanes diffusion_std_dev = (2. * boltzmann_kT_ * mobility * timestep).sqrt();
+        pos_x += diffusion_std_dev * gauss_x;
+        pos_y += diffusion_std_dev * gauss_y;
+        pos_z += diffusion_std_dev * gauss_z;
+        Lanes efield_mag = (e_x * e_x + e_y * e_y + e_z * e_z).sqrt();
+
+        // Check final states and adapt the timestep lane by lane
+        for(Eigen::Index lane = 0; lane < lanes; ++lane) {
+            auto idx = static_cast<size_t>(lane);
+            if(lane_group[idx] == no_group) {
+                continue;
+            }
+            auto& engine = lane_engine[idx];
+            const auto type = lane_type[idx];
+            const auto charge = groups[lane_group[idx]].second;
+            auto position = ROOT::Math::XYZPoint(pos_x[lane], pos_y[lane], pos_z[lane]);
+
+            // Check if we are still in the sensor and not in an implant:
+            if(!model_->isWithinSensor(position) || model_->isWithinImplant(position)) {
+                lane_state[idx] = CarrierState::HALTED;
+            }
+
+            // Check if charge carrier is still alive:
+            allpix::uniform_real_distribution<double> uniform_distribution(0, 1);
+            if(recombination_(
+                   type, detector_->getDopingConcentration(position), uniform_distribution(engine), timestep[lane])) {
+                lane_state[idx] = CarrierState::RECOMBINED;
+            }
+
+            // Check if the charge carrier has been trapped:
+            if(trapping_(type, uniform_distribution(engine), timestep[lane], efield_mag[lane])) {
+                if(output_plots_) {
+                    trapping_time_histo_->Fill(static_cast<double>(Units::convert(time[lane], "ns")), charge);
+                }
+
+                auto detrap_time = detrapping_(type, uniform_distribution(engine), efield_mag[lane]);
+                if((initial_time[lane] + time[lane] + detrap_time) < integration_time_) {
+                    // De-trap and advance in time if still below integration time
+                    time[lane] += detrap_time;
+                    if(output_plots_) {
+                        detrapping_time_histo_->Fill(static_cast<double>(Units::convert(detrap_time, "ns")), charge);
+                    }
+                } else {
+                    // Mark as trapped otherwise
+                    lane_state[idx] = CarrierState::TRAPPED;
+                }
+            }
+
+            // Update step length histogram
+            auto step_length =
+                std::sqrt(step_x[lane] * step_x[lane] + step_y[lane] * step_y[lane] + step_z[lane] * step_z[lane]);
+            auto uncertainty =
+                std::sqrt(error_x[lane] * error_x[lane] + error_y[lane] * error_y[lane] + error_z[lane] * error_z[lane]);
+            if(output_plots_) {
+                step_length_histo_->Fill(static_cast<double>(Units::convert(step_length, "um")));
+                uncertainty_histo_->Fill(static_cast<double>(Units::convert(uncertainty, "nm")));
+            }
+
+            // Adapt step size to match target precision, lower timestep when reaching the sensor edge
+            if(std::fabs(model_->getSensorSize().z() / 2.0 - pos_z[lane]) < 2 * step_z[lane]) {
+                timestep[lane] *= 0.75;
+            } else {
+                if(uncertainty > target_spatial_precision_) {
+                    timestep[lane] *= 0.75;
+                } else if(2 * uncertainty < target_spatial_precision_) {
+                    timestep[lane] *= 1.5;
+                }
+            }
+            // Limit the timestep to certain minimum and maximum step sizes
+            timestep[lane] = std::clamp(timestep[lane], timestep_min_, timestep_max_);
+
+            // Release the lane if the propagation of this group has ended
+            if(lane_state[idx] != CarrierState::MOTION || initial_time[lane] + time[lane] >= integration_time_) {
+                finish_lane(lane);
+            }
+        }
+
+        fill_lanes();
+    }
+
+    // Create the propagated charges in the order of the charge carrier groups
+    for(size_t group = 0; group < groups.size(); ++group) {
+        const auto& deposit = *groups[group].first;
+        const auto& [position, time_final, state] = results[group];
+
+        auto local_position = static_cast<ROOT::Math::XYZPoint>(position);
+        store_charge(propagated_charges, deposit, local_position, groups[group].second, time_final, state);
+    }
+
+    return std::make_tuple(recombined_charges_count, trapped_charges_count, propagated_charges_count, steps, total_time);
+}
+
+void GenericPropagationModule::store_charge(std::vector<PropagatedCharge>& propagated_charges,
+                                            const DepositedCharge& deposit,
+                                            const ROOT::Math::XYZPoint& local_position,
+                                            unsigned int charge,
+                                            double time,
+                                            CarrierState state) const {
+    propagated_charges.emplace_back(local_position,
+                                    detector_->getGlobalPosition(local_position),
+                                    deposit.getType(),
+                                    charge,
+                                    deposit.getLocalTime() + time,
+                                    deposit.getGlobalTime() + time,
+                                    state,
+                                    &deposit);
+}
+
+void GenericPropagationModule::store_charge(std::vector<CompactPropagatedCharge>& propagated_charges,
+                                            const DepositedCharge& deposit,
+                                            const ROOT::Math::XYZPoint& local_position,
+                                            unsigned int charge,
+                                            double time,
+                                            CarrierState state) const {
+    propagated_charges.emplace_back(local_position,
+                                    deposit.getType(),
+                                    charge,
+                                    deposit.getLocalTime() + time,
+                                    deposit.getGlobalTime() + time,
+                                    state,
+                                    deposit.getLocalPosition(),
+                                    deposit.getGlobalTime());
+}
+
 void GenericPropagationModule::finalize() {
     if(output_plots_) {
         group_size_histo_->Get()->GetXaxis()->SetRange(1, group_size_histo_->Get()->GetNbinsX() + 1);
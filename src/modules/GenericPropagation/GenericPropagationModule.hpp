@@ -24,6 +24,7 @@
 #include "core/module/Event.hpp"
 #include "core/module/Module.hpp"
 
+#include "objects/CompactPropagatedCharge.hpp"
 #include "objects/DepositedCharge.hpp"
 #include "objects/PropagatedCharge.hpp"
 
@@ -80,7 +81,7 @@ namespace allpix {
 
         /**
          * @brief Propagate a single set of charges through the sensor
-         * @param event               Pointer to current event
+         * @param random_generator    Reference to the random number generator to draw from
          * @param deposit             Reference to the original deposited charge object
          * @param pos                 Position of the deposit in the sensor
          * @param type                Type of the carrier to propagate
@@ -88,13 +89,14 @@ namespace allpix {
          * @param initial_time_local  Initial local time with respect to the start of the event
          * @param initial_time_global Initial global time with respect to the start of the event
          * @param level               Current level depth of the generated shower
-         * @param propagated_charges  Reference to vector with all produced final PropagatedCharge objects
+         * @param propagated_charges  Reference to vector with all produced final full or compact propagated charges
          * @param output_plot_points Reference to vector to hold points for line graph output plots
          *
          * @return Total recombined, trapped and propagated charge for statistics purposes
          */
+        template <typename C>
         std::tuple<unsigned int, unsigned int, unsigned int, unsigned int, long double>
-        propagate(Event* event,
+        propagate(RandomNumberGenerator& random_generator,
                   const DepositedCharge& deposit,
                   const ROOT::Math::XYZPoint& pos,
                   const CarrierType& type,
@@ -102,18 +104,104 @@ namespace allpix {
                   const double initial_time_local,
                   const double initial_time_global,
                   const unsigned int level,
-                  std::vector<PropagatedCharge>& propagated_charges,
+                  std::vector<C>& propagated_charges,
                   LineGraph::OutputPlotPoints& output_plot_points) const;
 
+        /**
+         * @brief Propagate sets of charges in batches, stepping all charge carrier groups of a batch together
+         * @param random_generator   Reference to the random number generator to draw from
+         * @param groups             List of charge carrier groups, given as originating deposit and number of charges
+         * @param propagated_charges Reference to vector with all produced final full or compact propagated charges
+         *
+         * @return Total recombined, trapped and propagated charge for statistics purposes
+         *
+         * The state of all groups currently in flight is stored in a structure-of-arrays layout, and the Runge-Kutta stages,
+         * the drift velocity and the diffusion are evaluated for all of them at once. Every group draws its random numbers
+         * from its own generator seeded from the given one, the result is therefore independent of the batch size.
+         */
+        template <typename C>
+        std::tuple<unsigned int, unsigned int, unsigned int, unsigned int, long double>
+        propagate_batched(RandomNumberGenerator& random_generator,
+                          const std::vector<std::pair<const DepositedCharge*, unsigned int>>& groups,
+                          std::vector<C>& propagated_charges) const;
+
+        /**
+         * @brief Propagate a list of charge carrier groups, either one by one or in batches
+         * @param random_generator   Reference to the random number generator to draw from
+         * @param groups             List of charge carrier groups, given as originating deposit and number of charges
+         * @param propagated_charges Reference to vector with all produced final full or compact propagated charges
+         * @param output_plot_points Reference to vector to hold points for line graph output plots
+         *
+         * @return Total recombined, trapped and propagated charge for statistics purposes
+         */
+        template <typename C>
+        std::tuple<unsigned int, unsigned int, unsigned int, unsigned int, long double>
+        propagate_groups(RandomNumberGenerator& random_generator,
+                         const std::vector<std::pair<const DepositedCharge*, unsigned int>>& groups,
+                         std::vector<C>& propagated_charges,
+                         LineGraph::OutputPlotPoints& output_plot_points) const;
+
+        /**
+         * @brief Propagate all charge carrier groups of an event, splitting them into tasks if configured
+         * @param event              Event to draw the random numbers from and to run the tasks for
+         * @param groups             List of charge carrier groups, given as originating deposit and number of charges
+         * @param propagated_charges Reference to vector with all produced final full or compact propagated charges
+         * @param output_plot_points Reference to vector to hold points for line graph output plots
+         *
+         * @return Total recombined, trapped and propagated charge for statistics purposes
+         */
+        template <typename C>
+        std::tuple<unsigned int, unsigned int, unsigned int, unsigned int, long double>
+        propagate_event(Event* event,
+                        const std::vector<std::pair<const DepositedCharge*, unsigned int>>& groups,
+                        std::vector<C>& propagated_charges,
+                        LineGraph::OutputPlotPoints& output_plot_points) const;
+
+        /**
+         * @brief Store the final state of a set of propagated charges as full object referencing its deposit
+         * @param propagated_charges Reference to vector with all produced final PropagatedCharge objects
+         * @param deposit            Deposited charge the set of charges originates from
+         * @param local_position     Final position of the set of charges in local coordinates
+         * @param charge             Total charge of the set
+         * @param time               Propagation time of the set since its deposition
+         * @param state              Final state of the charge carriers
+         */
+        void store_charge(std::vector<PropagatedCharge>& propagated_charges,
+                          const DepositedCharge& deposit,
+                          const ROOT::Math::XYZPoint& local_position,
+                          unsigned int charge,
+                          double time,
+                          CarrierState state) const;
+
+        /**
+         * @brief Store the final state of a set of propagated charges in the compact representation
+         * @param propagated_charges Reference to vector with all produced final CompactPropagatedCharge objects
+         * @param deposit            Deposited charge the set of charges originates from
+         * @param local_position     Final position of the set of charges in local coordinates
+         * @param charge             Total charge of the set
+         * @param time               Propagation time of the set since its deposition
+         * @param state              Final state of the charge carriers
+         */
+        void store_charge(std::vector<CompactPropagatedCharge>& propagated_charges,
+                          const DepositedCharge& deposit,
+                          const ROOT::Math::XYZPoint& local_position,
+                          unsigned int charge,
+                          double time,
+                          CarrierState state) const;
+
         // Local copies of configuration parameters to avoid costly lookup:
         double temperature_{}, timestep_min_{}, timestep_max_{}, timestep_start_{}, integration_time_{},
             target_spatial_precision_{}, output_plots_step_{};
         bool output_plots_{}, output_linegraphs_{}, output_linegraphs_collected_{}, output_linegraphs_recombined_{},
             output_linegraphs_trapped_{}, output_animations_{};
+        LineGraph::Settings linegraph_settings_;
         bool propagate_electrons_{}, propagate_holes_{};
         unsigned int charge_per_step_{};
         unsigned int max_charge_groups_{};
         unsigned int max_multiplication_level_{};
+        unsigned int carrier_batch_size_{};
+        unsigned int charge_groups_per_task_{};
+        bool compact_output_{};
 
         // Models for electron and hole mobility and lifetime
         Mobility mobility_;
@@ -12,6 +12,7 @@
 #include "InducedTransferModule.hpp"
 
 #include <string>
+#include <type_traits>
 #include <utility>
 
 #include "core/module/Event.hpp"
@@ -33,8 +34,9 @@ InducedTransferModule::InducedTransferModule(Configuration& config, Messenger* m
     config_.setDefault<unsigned int>("distance", 1);
     distance_ = config_.get<unsigned int>("distance");
 
-    // Require propagated deposits for single detector
-    messenger_->bindSingle<PropagatedChargeMessage>(this, MsgFlags::REQUIRED);
+    // Require either full or compact propagated deposits for single detector
+    messenger_->bindSingle<PropagatedChargeMessage>(this, MsgFlags::REQUIRED_ANY);
+    messenger_->bindSingle<CompactPropagatedChargeMessage>(this, MsgFlags::REQUIRED_ANY);
 }
 
 void InducedTransferModule::initialize() {
@@ -46,14 +48,21 @@ void InducedTransferModule::initialize() {
 }
 
 void InducedTransferModule::run(Event* event) {
-    auto propagated_message = messenger_->fetchMessage<PropagatedChargeMessage>(this, event);
+    // Transfer the compact propagated charges if available, the full objects otherwise
+    if(messenger_->hasMessage<CompactPropagatedChargeMessage>(this, event)) {
+        transfer_charges(event, messenger_->fetchMessage<CompactPropagatedChargeMessage>(this, event)->getData());
+    } else {
+        transfer_charges(event, messenger_->fetchMessage<PropagatedChargeMessage>(this, event)->getData());
+    }
+}
 
+template <typename T> void InducedTransferModule::transfer_charges(Event* event, const std::vector<T>& propagated_charges) {
     // Calculate induced charge by total motion of charge carriers
     LOG(TRACE) << "Calculating induced charge on pixels";
     bool found_electrons = false, found_holes = false;
 
     std::map<Pixel::Index, std::vector<std::pair<double, const PropagatedCharge*>>> pixel_map;
-    for(const auto& propagated_charge : propagated_message->getData()) {
+    for(const auto& propagated_charge : propagated_charges) {
 
         // Make sure both electrons and holes are present in the input data
         if(propagated_charge.getType() == CarrierType::ELECTRON) {
@@ -62,11 +71,20 @@ void InducedTransferModule::run(Event* event) {
             found_holes = true;
         }
 
-        const auto* deposited_charge = propagated_charge.getDepositedCharge();
-
         // Get start and end point by looking at deposited and propagated charge local positions
         auto position_end = propagated_charge.getLocalPosition();
-        auto position_start = deposited_charge->getLocalPosition();
+        ROOT::Math::XYZPoint position_start;
+        double deposit_time = 0;
+        const PropagatedCharge* history = nullptr;
+        if constexpr(std::is_same_v<T, PropagatedCharge>) {
+            const auto* deposited_charge = propagated_charge.getDepositedCharge();
+            position_start = deposited_charge->getLocalPosition();
+            deposit_time = deposited_charge->getGlobalTime();
+            history = &propagated_charge;
+        } else {
+            position_start = propagated_charge.getDepositPosition();
+            deposit_time = propagated_charge.getDepositTime();
+        }
 
         // Find the nearest pixel
         auto [xpixel, ypixel] = model_->getPixelIndex(position_end);
@@ -74,7 +92,7 @@ void InducedTransferModule::run(Event* event) {
         LOG(TRACE) << "Calculating induced charge from carriers below pixel " << Pixel::Index(xpixel, ypixel)
                    << ", moved from " << Units::display(position_start, {"um", "mm"}) << " to "
                    << Units::display(position_end, {"um", "mm"}) << ", "
-                   << Units::display(propagated_charge.getGlobalTime() - deposited_charge->getGlobalTime(), "ns");
+                   << Units::display(propagated_charge.getGlobalTime() - deposit_time, "ns");
 
         // Loop over NxN pixels:
         auto idx = Pixel::Index(xpixel, ypixel);
@@ -89,7 +107,7 @@ void InducedTransferModule::run(Event* event) {
                        << propagated_charge.getType() << " q = " << Units::display(induced, "e");
 
             // Add the pixel the list of hit pixels
-            pixel_map[pixel_index].emplace_back(induced, &propagated_charge);
+            pixel_map[pixel_index].emplace_back(induced, history);
         }
     }
 
@@ -108,7 +126,9 @@ void InducedTransferModule::run(Event* event) {
         std::vector<const PropagatedCharge*> prop_charges;
         for(auto& prop_pair : pixel_index_charge.second) {
             charge += prop_pair.first;
-            prop_charges.push_back(prop_pair.second);
+            if(prop_pair.second != nullptr) {
+                prop_charges.push_back(prop_pair.second);
+            }
         }
 
         // Get pixel object from detector
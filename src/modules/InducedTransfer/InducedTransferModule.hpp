@@ -10,12 +10,14 @@
  */
 
 #include <string>
+#include <vector>
 
 #include "core/config/Configuration.hpp"
 #include "core/geometry/DetectorModel.hpp"
 #include "core/messenger/Messenger.hpp"
 #include "core/module/Module.hpp"
 
+#include "objects/CompactPropagatedCharge.hpp"
 #include "objects/PropagatedCharge.hpp"
 
 namespace allpix {
@@ -52,6 +54,13 @@ namespace allpix {
         void run(Event*) override;
 
     private:
+        /**
+         * @brief Calculate the charge induced by a set of propagated charges and dispatch the resulting pixel charges
+         * @param event Pointer to the event the charges belong to
+         * @param propagated_charges Full or compact propagated charges to calculate the induced charge for
+         */
+        template <typename T> void transfer_charges(Event* event, const std::vector<T>& propagated_charges);
+
         Messenger* messenger_;
 
         std::shared_ptr<Detector> detector_;
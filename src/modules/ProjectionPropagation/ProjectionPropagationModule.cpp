@@ -46,6 +46,7 @@ ProjectionPropagationModule::ProjectionPropagationModule(Configuration& config,
     config_.setDefault<bool>("diffuse_deposit", false);
     config_.setDefault<bool>("repulsion_deposit", false);
     config_.setDefault<double>("repulsion_attenuation_factor", 0.1);
+    config_.setDefault<bool>("compact_output", false);
 
     config_.setDefault<std::string>("recombination_model", "none");
 
@@ -65,9 +66,13 @@ ProjectionPropagationModule::ProjectionPropagationModule(Configuration& config,
     repulse_attenuation_factor_ = config_.get<double>("repulsion_attenuation_factor");
     charge_per_step_ = config_.get<unsigned int>("charge_per_step");
     max_charge_groups_ = config_.get<unsigned int>("max_charge_groups");
+    compact_output_ = config_.get<bool>("compact_output");
 
     output_plots_ = config_.get<bool>("output_plots");
     output_linegraphs_ = config_.get<bool>("output_linegraphs");
+    if(output_linegraphs_) {
+        linegraph_settings_ = LineGraph::Settings(config_);
+    }
 
     // Enable multithreading of this module if multithreading is enabled and no per-event output plots are requested:
     // FIXME: Review if this is really the case or we can still use multithreading
@@ -119,6 +124,19 @@ void ProjectionPropagationModule::initialize() {
         LOG(WARNING) << "A magnetic field is switched on, but is set to be ignored for this module.";
     }
 
+    // Only dispatch compact propagated charges if none of the receivers requires the full objects
+    if(compact_output_) {
+        compact_output_ = !messenger_->hasReceiver(
+            this,
+            std::make_shared<PropagatedChargeMessage>(std::vector<PropagatedCharge>(), detector_),
+            std::make_shared<CompactPropagatedChargeMessage>(std::vector<CompactPropagatedCharge>(), detector_));
+        if(compact_output_) {
+            LOG(INFO) << "Dispatching compact propagated charges without Monte-Carlo history";
+        } else {
+            LOG(WARNING) << "Compact output requested but receivers require full propagated charge objects";
+        }
+    }
+
     // Find correct top side
     if(detector_->getElectricField({0, 0, top_z_}).z() > detector_->getElectricField({0, 0, -top_z_}).z()) {
         top_z_ *= -1;
@@ -180,8 +198,9 @@ void ProjectionPropagationModule::initialize() {
 void ProjectionPropagationModule::run(Event* event) {
     auto deposits_message = messenger_->fetchMessage<DepositedChargeMessage>(this, event);
 
-    // Create vector of propagated charges to output
+    // Create vector of propagated charges to output, either full objects or their compact representation
     std::vector<PropagatedCharge> propagated_charges;
+    std::vector<CompactPropagatedCharge> compact_charges;
 
     unsigned int charge_lost = 0;
     unsigned int total_charge = 0;
@@ -460,17 +479,27 @@ void ProjectionPropagationModule::run(Event* event) {
                 group_size_histo_->Fill(charge_per_step);
             }
 
-            auto global_position = detector_->getGlobalPosition(local_position);
-
             // Produce charge carrier at this position
-            propagated_charges.emplace_back(local_position,
-                                            global_position,
-                                            deposit.getType(),
-                                            charge_per_step,
-                                            local_time,
-                                            global_time,
-                                            CarrierState::HALTED,
-                                            &deposit);
+            if(compact_output_) {
+                compact_charges.emplace_back(local_position,
+                                             deposit.getType(),
+                                             charge_per_step,
+                                             local_time,
+                                             global_time,
+                                             CarrierState::HALTED,
+                                             deposit.getLocalPosition(),
+                                             deposit.getGlobalTime());
+            } else {
+                auto global_position = detector_->getGlobalPosition(local_position);
+                propagated_charges.emplace_back(local_position,
+                                                global_position,
+                                                deposit.getType(),
+                                                charge_per_step,
+                                                local_time,
+                                                global_time,
+                                                CarrierState::HALTED,
+                                                &deposit);
+            }
 
             LOG(DEBUG) << "Propagated " << charge_per_step << " " << type << " to "
                        << Units::display(local_position, {"mm", "um"}) << " in " << Units::display(global_time, "ns")
@@ -485,17 +514,26 @@ void ProjectionPropagationModule::run(Event* event) {
     LOG(INFO) << "Total charge: " << total_charge << " (lost: " << charge_lost << ", "
               << (total_charge > 0 ? (charge_lost / total_charge * 100.) : 0) << "%)";
 
-    LOG(DEBUG) << "Total count of propagated charge carriers: " << propagated_charges.size();
+    LOG(DEBUG) << "Total count of propagated charge carriers: "
+               << (compact_output_ ? compact_charges.size() : propagated_charges.size());
 
     // Output plots if required
     if(output_linegraphs_) {
-        LineGraph::Create(event->number, this, config_, output_plot_points, CarrierState::UNKNOWN);
+        LineGraph::Create(event->number, this, linegraph_settings_, output_plot_points, CarrierState::UNKNOWN);
     }
 
     if(output_plots_) {
         recombine_histo_->Fill(total_charge > 0 ? (static_cast<double>(recombined_charges_count) / total_charge) : 0.);
     }
 
+    if(compact_output_) {
+        // Create and dispatch a new message with compact propagated charges
+        auto compact_charge_message =
+            std::make_shared<CompactPropagatedChargeMessage>(std::move(compact_charges), detector_);
+        messenger_->dispatchMessage(this, compact_charge_message, event);
+        return;
+    }
+
     // Create a new message with propagated charges
     auto propagated_charge_message = std::make_shared<PropagatedChargeMessage>(std::move(propagated_charges), detector_);
 
@@ -23,6 +23,7 @@
 #include "core/module/Event.hpp"
 #include "core/module/Module.hpp"
 
+#include "objects/CompactPropagatedCharge.hpp"
 #include "objects/DepositedCharge.hpp"
 #include "objects/PropagatedCharge.hpp"
 
@@ -73,12 +74,14 @@ namespace allpix {
 
         // Config parameters
         bool output_plots_{}, output_linegraphs_{};
+        LineGraph::Settings linegraph_settings_;
         double integration_time_{};
         bool diffuse_deposit_;
         bool repulse_deposit_;
         double repulse_attenuation_factor_;
         unsigned int charge_per_step_{};
         unsigned int max_charge_groups_{};
+        bool compact_output_{};
 
         // Carrier type to be propagated
         CarrierType propagate_type_;
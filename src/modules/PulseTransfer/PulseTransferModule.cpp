@@ -15,8 +15,10 @@
 #include "objects/PixelCharge.hpp"
 #include "objects/exceptions.h"
 
+#include <map>
 #include <set>
 #include <string>
+#include <type_traits>
 #include <utility>
 
 #include <TAxis.h>
@@ -51,7 +53,8 @@ PulseTransferModule::PulseTransferModule(Configuration& config, Messenger* messe
         LOG(WARNING) << "Per-event pulse graphs requested, disabling parallel event processing";
     }
 
-    messenger_->bindSingle<PropagatedChargeMessage>(this, MsgFlags::REQUIRED);
+    messenger_->bindSingle<PropagatedChargeMessage>(this, MsgFlags::REQUIRED_ANY);
+    messenger_->bindSingle<CompactPropagatedChargeMessage>(this, MsgFlags::REQUIRED_ANY);
 }
 
 void PulseTransferModule::initialize() {
@@ -92,15 +95,26 @@ void PulseTransferModule::initialize() {
 }
 
 void PulseTransferModule::run(Event* event) {
-    auto propagated_message = messenger_->fetchMessage<PropagatedChargeMessage>(this, event);
+    // Transfer the compact propagated charges if available, the full objects otherwise
+    if(messenger_->hasMessage<CompactPropagatedChargeMessage>(this, event)) {
+        transfer_charges(event, messenger_->fetchMessage<CompactPropagatedChargeMessage>(this, event)->getData());
+    } else {
+        transfer_charges(event, messenger_->fetchMessage<PropagatedChargeMessage>(this, event)->getData());
+    }
+}
 
+template <typename T> void PulseTransferModule::transfer_charges(Event* event, const std::vector<T>& propagated_charges) {
     // Create map for all pixels: pulse and propagated charges
     std::map<Pixel::Index, Pulse> pixel_pulse_map;
     std::map<Pixel::Index, std::set<const PropagatedCharge*>> pixel_charge_map;
 
-    LOG(DEBUG) << "Received " << propagated_message->getData().size() << " propagated charge objects.";
-    for(const auto& propagated_charge : propagated_message->getData()) {
-        auto pulses = propagated_charge.getPulses();
+    LOG(DEBUG) << "Received " << propagated_charges.size() << " propagated charge objects.";
+    for(const auto& propagated_charge : propagated_charges) {
+        // Only full propagated charge objects can carry pulses
+        std::map<Pixel::Index, Pulse> pulses;
+        if constexpr(std::is_same_v<T, PropagatedCharge>) {
+            pulses = propagated_charge.getPulses();
+        }
 
         if(pulses.empty()) {
             LOG_ONCE(INFO) << "No pulse information available - producing pseudo-pulse from arrival time of charge carriers";
@@ -164,8 +178,10 @@ void PulseTransferModule::run(Event* event) {
             pixel_pulse_map[pixel_index] += pulse;
 
             // For each pulse, store the corresponding propagated charges to preserve history:
-            pixel_charge_map[pixel_index].emplace(&propagated_charge);
-        } else {
+            if constexpr(std::is_same_v<T, PropagatedCharge>) {
+                pixel_charge_map[pixel_index].emplace(&propagated_charge);
+            }
+        } else if constexpr(std::is_same_v<T, PropagatedCharge>) {
             LOG(TRACE) << "Found pulse information";
             LOG_ONCE(INFO) << "Pulses available - settings \"timestep\", \"max_depth_distance\" and "
                               "\"collect_from_implant\" have no effect";
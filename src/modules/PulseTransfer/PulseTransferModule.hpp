@@ -10,12 +10,14 @@
  */
 
 #include <string>
+#include <vector>
 
 #include "core/config/Configuration.hpp"
 #include "core/geometry/DetectorModel.hpp"
 #include "core/messenger/Messenger.hpp"
 #include "core/module/Module.hpp"
 
+#include "objects/CompactPropagatedCharge.hpp"
 #include "objects/PropagatedCharge.hpp"
 
 #include "tools/ROOT.h"
@@ -65,6 +67,13 @@ namespace allpix {
 
         void create_pulsegraphs(uint64_t event_num, const Pixel::Index& index, const Pulse& pulse) const;
 
+        /**
+         * @brief Transfer a set of propagated charges to the pixels and dispatch the resulting pixel pulses
+         * @param event Pointer to the event the charges belong to
+         * @param propagated_charges Full or compact propagated charges to transfer, compact ones never carry pulses
+         */
+        template <typename T> void transfer_charges(Event* event, const std::vector<T>& propagated_charges);
+
         // General module members
         std::shared_ptr<Detector> detector_;
 
@@ -11,6 +11,7 @@
 
 #include "ROOTObjectReaderModule.hpp"
 
+#include <algorithm>
 #include <climits>
 #include <string>
 #include <utility>
@@ -43,6 +44,8 @@ ROOTObjectReaderModule::ROOTObjectReaderModule(Configuration& config, Messenger*
  * @note Objects cannot be stored in smart pointers due to internal ROOT logic
  */
 ROOTObjectReaderModule::~ROOTObjectReaderModule() {
+    stop_read_ahead();
+
     for(const auto& message_inf : message_info_array_) {
         delete message_inf.objects;
     }
@@ -206,6 +209,17 @@ void ROOTObjectReaderModule::initialize() {
                      << " - this might lead to unexpected behavior.";
     }
 
+    // Prepare reading ahead of the workers if requested
+    read_ahead_ = config_.get<size_t>("read_ahead", 0);
+    if(read_ahead_ > 0) {
+        // Cache all branches since every stored object is converted to a message
+        for(auto& tree : trees_) {
+            tree->SetCacheSize(-1);
+            tree->AddBranchToCache("*", true);
+            tree->StopCacheLearningPhase();
+        }
+    }
+
     // Loop over all found trees
     for(auto& tree : trees_) {
         // Loop over the list of branches and create the set of receiver objects
@@ -263,13 +277,54 @@ void ROOTObjectReaderModule::initialize() {
             }
         }
     }
+
+    // Start reading events ahead of the workers
+    if(read_ahead_ > 0) {
+        LOG(DEBUG) << "Reading up to " << read_ahead_ << " events ahead of the requested event";
+        read_thread_ = std::thread(&ROOTObjectReaderModule::read_ahead_loop, this);
+    }
 }
 
 void ROOTObjectReaderModule::run(Event* event) {
+    MessageList messages;
+
+    if(read_ahead_ == 0) {
+        messages = read_event(event->number);
+    } else {
+        // Request the event from the read-ahead thread and wait for it to become available
+        std::unique_lock<std::mutex> lock{read_mutex_};
+        read_requested_ = std::max(read_requested_, event->number);
+        read_condition_.notify_all();
+        read_condition_.wait(lock, [this, event]() {
+            return read_error_ != nullptr || read_buffer_.count(event->number) != 0 ||
+                   (read_end_.has_value() && event->number >= read_end_.value());
+        });
+        if(read_error_ != nullptr) {
+            std::rethrow_exception(read_error_);
+        }
+
+        auto iter = read_buffer_.find(event->number);
+        if(iter == read_buffer_.end()) {
+            throw EndOfRunException(read_end_message_);
+        }
+        messages = std::move(iter->second);
+        read_buffer_.erase(iter);
+        lock.unlock();
+        read_condition_.notify_all();
+    }
+
+    // Dispatch the messages, only counting objects of events actually requested
+    for(auto& [message, name] : messages) {
+        read_cnt_ += message->getObjectArray().size();
+        messenger_->dispatchMessage(this, message, event, name);
+    }
+}
+
+ROOTObjectReaderModule::MessageList ROOTObjectReaderModule::read_event(uint64_t event_number) {
     auto root_lock = root_process_lock();
 
     // Beware: ROOT uses signed entry counters for its trees
-    auto event_num = static_cast<int64_t>(event->number);
+    auto event_num = static_cast<int64_t>(event_number);
     --event_num;
     for(auto& tree : trees_) {
         if(event_num >= tree->GetEntries()) {
@@ -281,6 +336,7 @@ void ROOTObjectReaderModule::run(Event* event) {
     LOG(TRACE) << "Building messages from stored objects";
 
     // Loop through all branches to construct messages
+    MessageList messages;
     for(auto& message_inf : message_info_array_) {
         auto* objects = message_inf.objects;
 
@@ -298,33 +354,69 @@ void ROOTObjectReaderModule::run(Event* event) {
             continue;
         }
 
-        // Update statistics
-        read_cnt_ += objects->size();
-
         // Create a message
-        message_inf.message = iter->second(*objects, message_inf.detector);
+        messages.emplace_back(iter->second(*objects, message_inf.detector), message_inf.name);
     }
 
-    for(auto& message_inf : message_info_array_) {
-        // We might not have every message, so just continue
-        if(!message_inf.message) {
-            continue;
-        }
-
-        // Resolve history
-        for(auto& object : message_inf.message->getObjectArray()) {
+    // Resolve history while the object references of this entry are registered
+    for(auto& message : messages) {
+        for(auto& object : message.first->getObjectArray()) {
             object.get().loadHistory();
         }
+    }
+
+    return messages;
+}
 
-        // Dispatch the messages
-        messenger_->dispatchMessage(this, message_inf.message, event, message_inf.name);
+void ROOTObjectReaderModule::read_ahead_loop() {
+    try {
+        while(true) {
+            // Wait until the next event is within the read-ahead window of the latest requested event
+            std::unique_lock<std::mutex> lock{read_mutex_};
+            read_condition_.wait(lock, [this]() { return read_stop_ || read_next_ <= read_requested_ + read_ahead_; });
+            if(read_stop_) {
+                return;
+            }
+            auto event_number = read_next_++;
+            lock.unlock();
+
+            try {
+                auto messages = read_event(event_number);
+                lock.lock();
+                read_buffer_.emplace(event_number, std::move(messages));
+            } catch(const EndOfRunException& e) {
+                // All further events are beyond the end of the stored data
+                lock.lock();
+                read_end_ = event_number;
+                read_end_message_ = e.what();
+                read_stop_ = true;
+            }
+            lock.unlock();
+            read_condition_.notify_all();
+        }
+    } catch(...) {
+        // Save the exception to propagate it to the waiting workers
+        std::lock_guard<std::mutex> lock{read_mutex_};
+        read_error_ = std::current_exception();
+        read_condition_.notify_all();
+    }
+}
 
-        // Reset the message pointer:
-        message_inf.message.reset();
+void ROOTObjectReaderModule::stop_read_ahead() {
+    if(read_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock{read_mutex_};
+            read_stop_ = true;
+        }
+        read_condition_.notify_all();
+        read_thread_.join();
     }
+    read_buffer_.clear();
 }
 
 void ROOTObjectReaderModule::finalize() {
+    stop_read_ahead();
+
     int branch_count = 0;
     for(auto& tree : trees_) {
         branch_count += tree->GetListOfBranches()->GetEntries();
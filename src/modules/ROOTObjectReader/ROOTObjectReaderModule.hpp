@@ -9,9 +9,15 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <condition_variable>
+#include <exception>
 #include <functional>
 #include <map>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <TFile.h>
 #include <TTree.h>
@@ -32,6 +38,9 @@ namespace allpix {
      *
      * Reads the tree of objects in the data format of the \ref ROOTObjectWriterModule. Converts all the stored objects that
      * are supported back to messages containing those objects and dispatches those messages.
+     *
+     * Optionally, upcoming entries are read, decompressed and converted to messages ahead of time on a separate thread, such
+     * that workers only have to dispatch the prepared messages of their event.
      */
     class ROOTObjectReaderModule : public Module {
     public:
@@ -67,6 +76,25 @@ namespace allpix {
         void finalize() override;
 
     private:
+        using MessageList = std::vector<std::pair<std::shared_ptr<BaseMessage>, std::string>>;
+
+        /**
+         * @brief Read the entry of an event from all trees and convert the stored objects to messages
+         * @param event_number Number of the event to read
+         * @return List of messages with their names, ready to be dispatched
+         */
+        MessageList read_event(uint64_t event_number);
+
+        /**
+         * @brief Reads events ahead of the workers requesting them until it is stopped
+         */
+        void read_ahead_loop();
+
+        /**
+         * @brief Stops the read-ahead thread and discards all events not requested yet
+         */
+        void stop_read_ahead();
+
         Messenger* messenger_;
         GeometryManager* geo_mgr_;
 
@@ -77,7 +105,6 @@ namespace allpix {
             std::vector<Object*>* objects;
             std::shared_ptr<Detector> detector;
             std::string name;
-            std::shared_ptr<BaseMessage> message;
         };
 
         // Object names to include or exclude from reading
@@ -98,5 +125,18 @@ namespace allpix {
 
         // Internal map to construct an object from it's type index
         MessageCreatorMap message_creator_map_;
+
+        // Read-ahead thread and the messages of events read but not yet requested, indexed by event number
+        size_t read_ahead_{};
+        std::thread read_thread_;
+        std::map<uint64_t, MessageList> read_buffer_;
+        uint64_t read_next_{1};
+        uint64_t read_requested_{0};
+        std::optional<uint64_t> read_end_;
+        std::string read_end_message_;
+        std::mutex read_mutex_;
+        std::condition_variable read_condition_;
+        bool read_stop_{};
+        std::exception_ptr read_error_{nullptr};
     };
 } // namespace allpix
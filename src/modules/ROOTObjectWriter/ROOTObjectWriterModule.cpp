@@ -42,6 +42,13 @@ ROOTObjectWriterModule::ROOTObjectWriterModule(Configuration& config, Messenger*
  * @note Objects cannot be stored in smart pointers due to internal ROOT logic
  */
 ROOTObjectWriterModule::~ROOTObjectWriterModule() {
+    // Discard events not written yet if the run was aborted, and stop the output thread before releasing its data
+    {
+        std::lock_guard<std::mutex> lock{output_mutex_};
+        output_queue_.clear();
+    }
+    stop_output();
+
     // Delete all object pointers
     for(auto& index_data : write_list_) {
         delete index_data.second;
@@ -70,6 +77,17 @@ void ROOTObjectWriterModule::initialize() {
         auto exc_arr = config_.getArray<std::string>("exclude");
         exclude_.insert(exc_arr.begin(), exc_arr.end());
     }
+
+    // Move the serialization and compression of the trees to a separate thread if requested
+    parallel_output_ = config_.get<bool>("parallel_output", false);
+    output_buffer_size_ = config_.get<size_t>("output_buffer_size", 128);
+    if(output_buffer_size_ == 0) {
+        throw InvalidValueError(config_, "output_buffer_size", "output buffer has to hold at least one event");
+    }
+    if(parallel_output_) {
+        LOG(DEBUG) << "Writing trees in separate output thread, buffering up to " << output_buffer_size_ << " events";
+        output_thread_ = std::thread(&ROOTObjectWriterModule::output_loop, this);
+    }
 }
 
 bool ROOTObjectWriterModule::filter(const std::shared_ptr<BaseMessage>& message,
@@ -108,31 +126,75 @@ bool ROOTObjectWriterModule::filter(const std::shared_ptr<BaseMessage>& message,
 }
 
 void ROOTObjectWriterModule::run(Event* event) {
-    auto root_lock = root_process_lock();
+    check_output_error();
 
-    // Retrieve current object count:
-    auto object_count = TProcessID::GetObjectCount();
+    EventRecord record;
+    record.number = event->number;
+    record.seed = event->getSeed();
 
-    // Fetch filtered messages
-    auto messages = messenger_->fetchFilteredMessages(this, event);
+    {
+        auto root_lock = root_process_lock();
 
-    // Mark objects to be stored:
-    for(auto& pair : messages) {
-        auto& message = pair.first;
-        auto object_array = message->getObjectArray();
-        for(Object& object : object_array) {
-            object.markForStorage();
+        // Retrieve current object count:
+        auto object_count = TProcessID::GetObjectCount();
+
+        // Fetch filtered messages
+        record.messages = messenger_->fetchFilteredMessages(this, event);
+
+        // Mark objects to be stored:
+        for(auto& pair : record.messages) {
+            auto& message = pair.first;
+            auto object_array = message->getObjectArray();
+            for(Object& object : object_array) {
+                object.markForStorage();
+            }
         }
+
+        // Trigger the creation of TRefs for cross-object references to be able to store them to file.
+        for(auto& pair : record.messages) {
+            auto& message = pair.first;
+            auto object_array = message->getObjectArray();
+            for(Object& object : object_array) {
+                object.petrifyHistory();
+            }
+        }
+
+        if(!parallel_output_) {
+            write_event(record);
+        }
+
+        // We can reset the TObject count after processing this event because the TRef creation is only done here locally
+        // in one worker thread instead of framework wide.
+        TProcessID::SetObjectCount(object_count);
+    }
+
+    if(!parallel_output_) {
+        return;
+    }
+
+    // Hand the event over to the output thread, waiting for space in the buffer if the output cannot keep up
+    // NOTE Events arrive here in order because this module requires sequential processing
+    std::unique_lock<std::mutex> lock{output_mutex_};
+    output_condition_.wait(
+        lock, [this]() { return output_queue_.size() < output_buffer_size_ || output_error_ != nullptr; });
+    if(output_error_ == nullptr) {
+        output_queue_.push_back(std::move(record));
     }
+    lock.unlock();
+    output_condition_.notify_all();
 
+    check_output_error();
+}
+
+void ROOTObjectWriterModule::write_event(const EventRecord& record) {
     // Add event data
-    current_event_ = event->number;
-    current_seed_ = event->getSeed();
+    current_event_ = record.number;
+    current_seed_ = record.seed;
 
     // Generate trees and index data
-    for(auto& pair : messages) {
-        auto& message = pair.first;
-        auto& message_name = pair.second;
+    for(const auto& pair : record.messages) {
+        const auto& message = pair.first;
+        const auto& message_name = pair.second;
 
         // Get the detector name
         std::string detector_name;
@@ -149,6 +211,11 @@ void ROOTObjectWriterModule::run(Event* event) {
         // Create a new branch of the correct type if this message was not received before
         auto index_tuple = std::make_tuple(type_idx, detector_name, message_name);
         if(write_list_.find(index_tuple) == write_list_.end()) {
+            // The output thread does not hold the ROOT lock otherwise, but has to take it to modify the file structure
+            std::unique_lock<std::mutex> root_lock;
+            if(parallel_output_) {
+                root_lock = root_process_lock();
+            }
 
             std::string class_name = allpix::demangle(typeid(first_object).name());
             std::string class_name_with_namespace = allpix::demangle(typeid(first_object).name(), true);
@@ -195,8 +262,6 @@ void ROOTObjectWriterModule::run(Event* event) {
 
         // Fill the branch vector
         for(Object& object : object_array) {
-            // Trigger the creation of TRefs for cross-object references to be able to store them to file.
-            object.petrifyHistory();
             ++write_cnt_;
             write_list_[index_tuple]->push_back(&object);
         }
@@ -214,13 +279,62 @@ void ROOTObjectWriterModule::run(Event* event) {
     for(auto& index_data : write_list_) {
         index_data.second->clear();
     }
+}
+
+void ROOTObjectWriterModule::output_loop() {
+    try {
+        while(true) {
+            std::unique_lock<std::mutex> lock{output_mutex_};
+            output_condition_.wait(lock, [this]() { return output_stop_ || !output_queue_.empty(); });
+            if(output_queue_.empty()) {
+                // Stop requested and all events written
+                return;
+            }
+            auto record = std::move(output_queue_.front());
+            output_queue_.pop_front();
+            lock.unlock();
+            output_condition_.notify_all();
 
-    // We can reset the TObject count after processing this event because the TRef creation is only done here locally
-    // in one worker thread instead of framework wide.
-    TProcessID::SetObjectCount(object_count);
+            write_event(record);
+        }
+    } catch(...) {
+        // Save the exception to propagate it to the next worker and discard all pending events
+        std::lock_guard<std::mutex> lock{output_mutex_};
+        output_error_ = std::current_exception();
+        output_queue_.clear();
+        output_condition_.notify_all();
+    }
+}
+
+void ROOTObjectWriterModule::stop_output() {
+    if(!output_thread_.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{output_mutex_};
+        output_stop_ = true;
+    }
+    output_condition_.notify_all();
+    output_thread_.join();
+}
+
+void ROOTObjectWriterModule::check_output_error() {
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock{output_mutex_};
+        error = output_error_;
+    }
+    if(error != nullptr) {
+        std::rethrow_exception(error);
+    }
 }
 
 void ROOTObjectWriterModule::finalize() {
+    // Wait for the output thread to write all remaining events
+    stop_output();
+    check_output_error();
+
     LOG(TRACE) << "Writing objects to file";
     output_file_->cd();
 
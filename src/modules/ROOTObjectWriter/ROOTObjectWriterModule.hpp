@@ -10,8 +10,14 @@
  */
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <map>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <TFile.h>
 #include <TTree.h>
@@ -30,6 +36,9 @@ namespace allpix {
      * Listens to all objects dispatched in the framework. Creates a tree as soon as a new type of object is encountered and
      * saves the data in those objects to tree for every event. The tree name is the class name of the object. A separate
      * branch is created for every combination of detector name and message name that outputs this object.
+     *
+     * Optionally, the serialization and compression of the trees is moved to a dedicated output thread. Events are then
+     * only prepared for storage in the calling worker and handed over to the output thread, which writes them in order.
      */
     class ROOTObjectWriterModule : public SequentialModule {
     public:
@@ -69,6 +78,36 @@ namespace allpix {
         void finalize() override;
 
     private:
+        /**
+         * @brief Messages of a single event prepared for writing
+         */
+        struct EventRecord {
+            uint64_t number{};
+            uint64_t seed{};
+            std::vector<std::pair<std::shared_ptr<BaseMessage>, std::string>> messages;
+        };
+
+        /**
+         * @brief Writes the objects of an event to their trees, constructing trees and branches on the fly
+         * @param record Prepared messages of the event to write
+         */
+        void write_event(const EventRecord& record);
+
+        /**
+         * @brief Processes the queue of prepared events in the output thread until it is stopped
+         */
+        void output_loop();
+
+        /**
+         * @brief Stops the output thread after all queued events have been written
+         */
+        void stop_output();
+
+        /**
+         * @brief Rethrows an exception raised in the output thread in the calling thread
+         */
+        void check_output_error();
+
         Messenger* messenger_;
         GeometryManager* geo_mgr_;
 
@@ -94,5 +133,15 @@ namespace allpix {
 
         // Statistical information about number of objects
         std::atomic<unsigned long> write_cnt_{};
+
+        // Output thread and the queue of events waiting to be written, bounded by the maximum buffer size
+        bool parallel_output_{};
+        size_t output_buffer_size_{};
+        std::thread output_thread_;
+        std::deque<EventRecord> output_queue_;
+        std::mutex output_mutex_;
+        std::condition_variable output_condition_;
+        bool output_stop_{};
+        std::exception_ptr output_error_{nullptr};
     };
 } // namespace allpix
@@ -13,10 +13,12 @@
 
 #include <fstream>
 #include <limits>
+#include <map>
 #include <memory>
 #include <new>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
 
 #include "core/config/exceptions.h"
@@ -54,8 +56,9 @@ SimpleTransferModule::SimpleTransferModule(Configuration& config, Messenger* mes
     // Cache flag for output plots:
     output_plots_ = config_.get<bool>("output_plots");
 
-    // Require propagated deposits for single detector
-    messenger_->bindSingle<PropagatedChargeMessage>(this, MsgFlags::REQUIRED);
+    // Require either full or compact propagated deposits for single detector
+    messenger_->bindSingle<PropagatedChargeMessage>(this, MsgFlags::REQUIRED_ANY);
+    messenger_->bindSingle<CompactPropagatedChargeMessage>(this, MsgFlags::REQUIRED_ANY);
 }
 
 void SimpleTransferModule::initialize() {
@@ -88,13 +91,20 @@ void SimpleTransferModule::initialize() {
 }
 
 void SimpleTransferModule::run(Event* event) {
-    auto propagated_message = messenger_->fetchMessage<PropagatedChargeMessage>(this, event);
+    // Transfer the compact propagated charges if available, the full objects otherwise
+    if(messenger_->hasMessage<CompactPropagatedChargeMessage>(this, event)) {
+        transfer_charges(event, messenger_->fetchMessage<CompactPropagatedChargeMessage>(this, event)->getData());
+    } else {
+        transfer_charges(event, messenger_->fetchMessage<PropagatedChargeMessage>(this, event)->getData());
+    }
+}
 
+template <typename T> void SimpleTransferModule::transfer_charges(Event* event, const std::vector<T>& propagated_charges) {
     // Find corresponding pixels for all propagated charges
     LOG(TRACE) << "Transferring charges to pixels";
     unsigned int transferred_charges_count = 0;
-    std::map<Pixel::Index, std::vector<const PropagatedCharge*>> pixel_map;
-    for(const auto& propagated_charge : propagated_message->getData()) {
+    std::map<Pixel::Index, std::pair<long, std::vector<const PropagatedCharge*>>> pixel_map;
+    for(const auto& propagated_charge : propagated_charges) {
         auto position = propagated_charge.getLocalPosition();
 
         if(collect_from_implant_) {
@@ -145,23 +155,24 @@ void SimpleTransferModule::run(Event* event) {
                    << Units::display(propagated_charge.getLocalPosition(), {"mm", "um"}) << " brought to pixel "
                    << pixel_index;
 
-        // Add the pixel the list of hit pixels
-        pixel_map[pixel_index].emplace_back(&propagated_charge);
+        // Add the pixel the list of hit pixels, keeping the history for full propagated charge objects
+        auto& [pixel_charge, pixel_history] = pixel_map[pixel_index];
+        pixel_charge += propagated_charge.getSign() * propagated_charge.getCharge();
+        if constexpr(std::is_same_v<T, PropagatedCharge>) {
+            pixel_history.emplace_back(&propagated_charge);
+        }
     }
 
     // Create pixel charges
     LOG(TRACE) << "Combining charges at same pixel";
     std::vector<PixelCharge> pixel_charges;
-    for(auto& pixel_index_charge : pixel_map) {
-        long charge = 0;
-        for(auto& propagated_charge : pixel_index_charge.second) {
-            charge += propagated_charge->getSign() * propagated_charge->getCharge();
-        }
+    for(auto& [pixel_index, pixel_charge] : pixel_map) {
+        auto& [charge, history] = pixel_charge;
 
         // Get pixel object from detector
-        auto pixel = detector_->getPixel(pixel_index_charge.first.x(), pixel_index_charge.first.y());
+        auto pixel = detector_->getPixel(pixel_index.x(), pixel_index.y());
 
-        pixel_charges.emplace_back(pixel, charge, pixel_index_charge.second);
+        pixel_charges.emplace_back(pixel, charge, history);
         LOG(DEBUG) << "Set of " << charge << " charges combined at " << pixel.getIndex();
     }
 
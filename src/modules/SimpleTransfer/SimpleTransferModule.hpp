@@ -22,6 +22,7 @@
 #include "core/module/Event.hpp"
 #include "core/module/Module.hpp"
 
+#include "objects/CompactPropagatedCharge.hpp"
 #include "objects/Pixel.hpp"
 #include "objects/PixelCharge.hpp"
 #include "objects/PropagatedCharge.hpp"
@@ -36,7 +37,8 @@ namespace allpix {
      *
      * This module does a simple direct mapping from propagated charges to the nearest pixel in the grid. It only considers
      * propagated charges within a certain distance from the implants and within the pixel grid, charges in the rest of the
-     * sensor are ignored. The module combines all the propagated charges to a set of charges at a specific pixel.
+     * sensor are ignored. The module combines all the propagated charges to a set of charges at a specific pixel. Compact
+     * propagated charges are transferred directly, the resulting pixel charges then carry no Monte-Carlo history.
      */
     class SimpleTransferModule : public Module {
     public:
@@ -64,6 +66,13 @@ namespace allpix {
         void finalize() override;
 
     private:
+        /**
+         * @brief Transfer a set of propagated charges to the pixels and dispatch the resulting pixel charges
+         * @param event Pointer to the event the charges belong to
+         * @param propagated_charges Full or compact propagated charges to transfer
+         */
+        template <typename T> void transfer_charges(Event* event, const std::vector<T>& propagated_charges);
+
         Messenger* messenger_;
 
         std::shared_ptr<Detector> detector_;
@@ -11,10 +11,14 @@
 
 #include "TransientPropagationModule.hpp"
 
+#include <algorithm>
+#include <iterator>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <Eigen/Core>
 
@@ -42,6 +46,7 @@ TransientPropagationModule::TransientPropagationModule(Configuration& config,
     config_.setDefault<double>("integration_time", Units::get(25, "ns"));
     config_.setDefault<unsigned int>("charge_per_step", 10);
     config_.setDefault<unsigned int>("max_charge_groups", 1000);
+    config_.setDefault<unsigned int>("charge_groups_per_task", 0);
 
     // Models:
     config_.setDefault<std::string>("mobility_model", "jacoboni");
@@ -81,17 +86,29 @@ TransientPropagationModule::TransientPropagationModule(Configuration& config,
     max_charge_groups_ = config_.get<unsigned int>("max_charge_groups");
     boltzmann_kT_ = Units::get(8.6173333e-5, "eV/K") * temperature_;
     max_multiplication_level_ = config.get<unsigned int>("max_multiplication_level");
+    charge_groups_per_task_ = config_.get<unsigned int>("charge_groups_per_task");
 
     output_plots_ = config_.get<bool>("output_plots");
     output_linegraphs_ = config_.get<bool>("output_linegraphs");
     output_linegraphs_collected_ = config_.get<bool>("output_linegraphs_collected");
     output_linegraphs_recombined_ = config_.get<bool>("output_linegraphs_recombined");
     output_linegraphs_trapped_ = config_.get<bool>("output_linegraphs_trapped");
+    output_animations_ = config_.get<bool>("output_animations");
     output_plots_step_ = config_.get<double>("output_plots_step");
+    if(output_linegraphs_ || output_animations_) {
+        linegraph_settings_ = LineGraph::Settings(config_);
+    }
+
+    // Line graphs are collected per event and cannot be merged from independent tasks
+    if(charge_groups_per_task_ > 0 && output_linegraphs_) {
+        throw InvalidCombinationError(config_,
+                                      {"charge_groups_per_task", "output_linegraphs"},
+                                      "Line graphs cannot be produced when splitting events into tasks");
+    }
 
     // Enable multithreading of this module if multithreading is enabled and no per-event output plots are requested:
     // FIXME: Review if this is really the case or we can still use multithreading
-    if(!(config_.get<bool>("output_animations") || output_linegraphs_)) {
+    if(!(output_animations_ || output_linegraphs_)) {
         allow_multithreading();
     } else {
         LOG(WARNING) << "Per-event line graphs or animations requested, disabling parallel event processing";
@@ -139,6 +156,10 @@ void TransientPropagationModule::initialize() {
                      << "This might lead to unphysical gain values.";
     }
 
+    if(charge_groups_per_task_ > 0) {
+        LOG(INFO) << "Splitting events into tasks of " << charge_groups_per_task_ << " charge carrier groups";
+    }
+
     // Check for magnetic field
     has_magnetic_field_ = detector_->hasMagneticField();
     if(has_magnetic_field_) {
@@ -368,6 +389,9 @@ void TransientPropagationModule::run(Event* event) {
     // List of points to plot to plot for output plots
     LineGraph::OutputPlotPoints output_plot_points;
 
+    // Charge carrier groups collected for propagation
+    std::vector<std::pair<const DepositedCharge*, unsigned int>> groups;
+
     // Loop over all deposits for propagation
     LOG(TRACE) << "Propagating charges in sensor";
     for(const auto& deposit : deposits_message->getData()) {
@@ -402,40 +426,62 @@ void TransientPropagationModule::run(Event* event) {
                 charge_per_step = charges_remaining;
             }
             charges_remaining -= charge_per_step;
+            groups.emplace_back(&deposit, charge_per_step);
+        }
+    }
 
-            // Get position and propagate through sensor
-            auto [recombined, trapped, propagated] = propagate(event,
-                                                               deposit,
-                                                               deposit.getLocalPosition(),
-                                                               deposit.getType(),
-                                                               charge_per_step,
-                                                               deposit.getLocalTime(),
-                                                               deposit.getGlobalTime(),
-                                                               0,
-                                                               propagated_charges,
-                                                               output_plot_points);
-
-            // Update statistics:
+    if(charge_groups_per_task_ > 0 && groups.size() > charge_groups_per_task_) {
+        // Split the charge carrier groups into tasks with their own random number generator, created upfront from the event
+        // to keep the result independent of the number of workers
+        auto tasks = (groups.size() + charge_groups_per_task_ - 1) / charge_groups_per_task_;
+        std::vector<RandomNumberGenerator> task_engines;
+        task_engines.reserve(tasks);
+        for(size_t task = 0; task < tasks; ++task) {
+            task_engines.push_back(event->createTaskRandomEngine(task));
+        }
+        LOG(DEBUG) << "Propagating " << groups.size() << " charge carrier groups in " << tasks << " tasks";
+
+        std::vector<std::vector<PropagatedCharge>> task_charges(tasks);
+        std::vector<std::tuple<unsigned int, unsigned int, unsigned int>> task_results(tasks);
+        run_tasks(tasks, [&](size_t task) {
+            auto& random_generator = task_engines[task];
+            auto end = std::min((task + 1) * charge_groups_per_task_, groups.size());
+            auto first = groups.begin() + static_cast<std::ptrdiff_t>(task * charge_groups_per_task_);
+            auto last = groups.begin() + static_cast<std::ptrdiff_t>(end);
+            LineGraph::OutputPlotPoints task_plot_points;
+            task_results[task] = propagate_groups(random_generator, {first, last}, task_charges[task], task_plot_points);
+        });
+
+        // Merge the results in the order of the tasks
+        for(size_t task = 0; task < tasks; ++task) {
+            auto [recombined, trapped, propagated] = task_results[task];
             recombined_charges_count += recombined;
             trapped_charges_count += trapped;
             propagated_charges_count += propagated;
+            std::move(task_charges[task].begin(), task_charges[task].end(), std::back_inserter(propagated_charges));
         }
+    } else {
+        auto [recombined, trapped, propagated] =
+            propagate_groups(event->getRandomEngine(), groups, propagated_charges, output_plot_points);
+        recombined_charges_count += recombined;
+        trapped_charges_count += trapped;
+        propagated_charges_count += propagated;
     }
 
     // Output plots if required
     if(output_linegraphs_) {
-        LineGraph::Create(event->number, this, config_, output_plot_points, CarrierState::UNKNOWN);
+        LineGraph::Create(event->number, this, linegraph_settings_, output_plot_points, CarrierState::UNKNOWN);
         if(output_linegraphs_collected_) {
-            LineGraph::Create(event->number, this, config_, output_plot_points, CarrierState::HALTED);
+            LineGraph::Create(event->number, this, linegraph_settings_, output_plot_points, CarrierState::HALTED);
         }
         if(output_linegraphs_recombined_) {
-            LineGraph::Create(event->number, this, config_, output_plot_points, CarrierState::RECOMBINED);
+            LineGraph::Create(event->number, this, linegraph_settings_, output_plot_points, CarrierState::RECOMBINED);
         }
         if(output_linegraphs_trapped_) {
-            LineGraph::Create(event->number, this, config_, output_plot_points, CarrierState::TRAPPED);
+            LineGraph::Create(event->number, this, linegraph_settings_, output_plot_points, CarrierState::TRAPPED);
         }
-        if(config_.get<bool>("output_animations")) {
-            LineGraph::Animate(event->number, this, config_, output_plot_points);
+        if(output_animations_) {
+            LineGraph::Animate(event->number, this, linegraph_settings_, output_plot_points);
         }
     }
 
@@ -456,13 +502,42 @@ void TransientPropagationModule::run(Event* event) {
     messenger_->dispatchMessage(this, propagated_charge_message, event);
 }
 
+std::tuple<unsigned int, unsigned int, unsigned int>
+TransientPropagationModule::propagate_groups(RandomNumberGenerator& random_generator,
+                                             const std::vector<std::pair<const DepositedCharge*, unsigned int>>& groups,
+                                             std::vector<PropagatedCharge>& propagated_charges,
+                                             LineGraph::OutputPlotPoints& output_plot_points) const {
+    unsigned int propagated_charges_count = 0;
+    unsigned int recombined_charges_count = 0;
+    unsigned int trapped_charges_count = 0;
+    for(const auto& [deposit, charge] : groups) {
+        // Get position and propagate through sensor
+        auto [recombined, trapped, propagated] = propagate(random_generator,
+                                                           *deposit,
+                                                           deposit->getLocalPosition(),
+                                                           deposit->getType(),
+                                                           charge,
+                                                           deposit->getLocalTime(),
+                                                           deposit->getGlobalTime(),
+                                                           0,
+                                                           propagated_charges,
+                                                           output_plot_points);
+
+        // Update statistics:
+        recombined_charges_count += recombined;
+        trapped_charges_count += trapped;
+        propagated_charges_count += propagated;
+    }
+    return {recombined_charges_count, trapped_charges_count, propagated_charges_count};
+}
+
 /**
  * Propagation is simulated using a parameterization for the electron mobility. This is used to calculate the electron
  * velocity at every point with help of the electric field map of the detector. A Runge-Kutta integration is applied in
  * multiple steps, adding a random diffusion to the propagating charge every step.
  */
 std::tuple<unsigned int, unsigned int, unsigned int>
-TransientPropagationModule::propagate(Event* event,
+TransientPropagationModule::propagate(RandomNumberGenerator& random_generator,
                                       const DepositedCharge& deposit,
                                       const ROOT::Math::XYZPoint& pos,
                                       const CarrierType& type,
@@ -480,7 +555,18 @@ TransientPropagationModule::propagate(Event* event,
     }
 
     Eigen::Vector3d position(pos.x(), pos.y(), pos.z());
-    std::map<Pixel::Index, Pulse> pixel_map;
+
+    // Induced pulses, stored contiguously with one slot per pixel the carriers have induced a signal on
+    std::vector<Pixel::Index> pulse_pixels;
+    std::vector<Pulse> pulses;
+
+    // Induction stencil of the current step: pulse slots and reference points of its pixels, and the weighting potentials at
+    // the current and last position. The stencil is only rebuilt when the carriers move to a different pixel.
+    std::vector<Pixel::Index> stencil_pixels;
+    std::vector<size_t> stencil_slots;
+    std::vector<ROOT::Math::XYPoint> stencil_references;
+    std::vector<double> ramo, last_ramo;
+    std::optional<std::pair<Pixel::Index, Pixel::Index>> stencil_key;
 
     unsigned int propagated_charges_count = 0;
     unsigned int recombined_charges_count = 0;
@@ -498,16 +584,28 @@ TransientPropagationModule::propagate(Event* event,
     double gain_previous = 1.;
     unsigned int gain_integer = 1;
 
+    // Counter-based generators provide the random numbers for the diffusion in blocks, the Mersenne Twister draws them one
+    // by one to keep the results of existing simulations unchanged
+    const bool buffered_diffusion = random_generator.isCounterBased();
+    allpix::buffered_normal_distribution<double> buffered_gauss_distribution;
+
     // Define a function to compute the diffusion
     auto carrier_diffusion = [&](double efield_mag, double doping, double timestep) -> Eigen::Vector3d {
         double diffusion_constant = boltzmann_kT_ * mobility_(type, efield_mag, doping);
         double diffusion_std_dev = std::sqrt(2. * diffusion_constant * timestep);
 
+        if(buffered_diffusion) {
+            auto x = diffusion_std_dev * buffered_gauss_distribution(random_generator);
+            auto y = diffusion_std_dev * buffered_gauss_distribution(random_generator);
+            auto z = diffusion_std_dev * buffered_gauss_distribution(random_generator);
+            return Eigen::Vector3d(x, y, z);
+        }
+
         // Compute the independent diffusion in three
         allpix::normal_distribution<double> gauss_distribution(0, diffusion_std_dev);
-        auto x = gauss_distribution(event->getRandomEngine());
-        auto y = gauss_distribution(event->getRandomEngine());
-        auto z = gauss_distribution(event->getRandomEngine());
+        auto x = gauss_distribution(random_generator);
+        auto y = gauss_distribution(random_generator);
+        auto z = gauss_distribution(random_generator);
         return Eigen::Vector3d(x, y, z);
     };
 
@@ -590,18 +688,18 @@ TransientPropagationModule::propagate(Event* event,
         // Check if charge carrier is still alive:
         if(recombination_(type,
                           detector_->getDopingConcentration(static_cast<ROOT::Math::XYZPoint>(position)),
-                          uniform_distribution(event->getRandomEngine()),
+                          uniform_distribution(random_generator),
                           timestep_)) {
             state = CarrierState::RECOMBINED;
         }
 
         // Check if the charge carrier has been trapped:
-        if(trapping_(type, uniform_distribution(event->getRandomEngine()), timestep_, std::sqrt(efield.Mag2()))) {
+        if(trapping_(type, uniform_distribution(random_generator), timestep_, std::sqrt(efield.Mag2()))) {
             if(output_plots_) {
                 trapping_time_histo_->Fill(runge_kutta.getTime(), charge);
             }
 
-            auto detrap_time = detrapping_(type, uniform_distribution(event->getRandomEngine()), std::sqrt(efield.Mag2()));
+            auto detrap_time = detrapping_(type, uniform_distribution(random_generator), std::sqrt(efield.Mag2()));
             if((initial_time_local + runge_kutta.getTime() + detrap_time) < integration_time_) {
                 // De-trap and advance in time if still below integration time
                 LOG(TRACE) << "De-trapping charge carrier after " << Units::display(detrap_time, {"ns", "us"});
@@ -644,7 +742,7 @@ TransientPropagationModule::propagate(Event* event,
                     multiplication_depth_histo_->Fill(carrier_pos.z(), charge * (floor_gain - gain_integer));
                 }
 
-                auto [recombined, trapped, propagated] = propagate(event,
+                auto [recombined, trapped, propagated] = propagate(random_generator,
                                                                    deposit,
                                                                    carrier_pos,
                                                                    inverted_type,
@@ -697,44 +795,77 @@ TransientPropagationModule::propagate(Event* event,
         auto [xpixel, ypixel] = model_->getPixelIndex(static_cast<ROOT::Math::XYZPoint>(position));
         auto [last_xpixel, last_ypixel] = model_->getPixelIndex(static_cast<ROOT::Math::XYZPoint>(last_position));
         auto idx = Pixel::Index(xpixel, ypixel);
-        auto neighbors = model_->getNeighbors(idx, distance_);
-
-        // If the charge carrier crossed pixel boundaries, ensure that we always calculate the induced current for both of
-        // them by extending the induction matrix temporarily. Otherwise we end up doing "double-counting" because we would
-        // only jump "into" a pixel but never "out". At the border of the induction matrix, this would create an imbalance.
+        auto last_idx = Pixel::Index(last_xpixel, last_ypixel);
         if(last_xpixel != xpixel || last_ypixel != ypixel) {
-            auto last_idx = Pixel::Index(last_xpixel, last_ypixel);
-            neighbors.merge(model_->getNeighbors(last_idx, distance_));
-            LOG(TRACE) << "Carrier crossed boundary from pixel " << Pixel::Index(last_xpixel, last_ypixel) << " to pixel "
-                       << Pixel::Index(xpixel, ypixel);
+            LOG(TRACE) << "Carrier crossed boundary from pixel " << last_idx << " to pixel " << idx;
         }
-        LOG(TRACE) << "Moving carriers below pixel " << Pixel::Index(xpixel, ypixel) << " from "
+        LOG(TRACE) << "Moving carriers below pixel " << idx << " from "
                    << Units::display(static_cast<ROOT::Math::XYZPoint>(last_position), {"um", "mm"}) << " to "
                    << Units::display(static_cast<ROOT::Math::XYZPoint>(position), {"um", "mm"}) << ", "
                    << Units::display(initial_time_local + runge_kutta.getTime(), "ns");
 
-        for(const auto& pixel_index : neighbors) {
-            auto ramo = detector_->getWeightingPotential(static_cast<ROOT::Math::XYZPoint>(position), pixel_index);
-            auto last_ramo = detector_->getWeightingPotential(static_cast<ROOT::Math::XYZPoint>(last_position), pixel_index);
+        if(stencil_key != std::make_pair(idx, last_idx)) {
+            // Rebuild the induction stencil for the pixels of this step
+            auto neighbors = model_->getNeighbors(idx, distance_);
+
+            // If the charge carrier crossed pixel boundaries, ensure that we always calculate the induced current for both
+            // of them by extending the induction matrix temporarily. Otherwise we end up doing "double-counting" because we
+            // would only jump "into" a pixel but never "out". At the border of the induction matrix, this would create an
+            // imbalance.
+            if(last_idx != idx) {
+                neighbors.merge(model_->getNeighbors(last_idx, distance_));
+            }
+
+            stencil_pixels.assign(neighbors.begin(), neighbors.end());
+            stencil_slots.clear();
+            stencil_references.clear();
+            for(const auto& pixel_index : stencil_pixels) {
+                // Create pulse if it doesn't exist yet
+                auto slot = static_cast<size_t>(
+                    std::distance(pulse_pixels.begin(), std::find(pulse_pixels.begin(), pulse_pixels.end(), pixel_index)));
+                if(slot == pulse_pixels.size()) {
+                    pulse_pixels.push_back(pixel_index);
+                    pulses.emplace_back(timestep_, integration_time_);
+                }
+                stencil_slots.push_back(slot);
+                stencil_references.emplace_back(model_->getPixelCenter(pixel_index.x(), pixel_index.y()));
+            }
+
+            // Evaluate the weighting potentials of the full stencil at the last position
+            last_ramo.resize(stencil_pixels.size());
+            detector_->getWeightingPotential(
+                static_cast<ROOT::Math::XYZPoint>(last_position), stencil_references, last_ramo.data());
+            ramo.resize(stencil_pixels.size());
+            stencil_key = std::make_pair(idx, last_idx);
+        } else {
+            // The last position is the position of the previous step, for which the stencil has been evaluated already
+            std::swap(ramo, last_ramo);
+        }
+
+        // Evaluate the weighting potentials of the full stencil at the current position
+        detector_->getWeightingPotential(static_cast<ROOT::Math::XYZPoint>(position), stencil_references, ramo.data());
+
+        for(size_t pixel = 0; pixel < stencil_pixels.size(); ++pixel) {
+            const auto& pixel_index = stencil_pixels[pixel];
+            auto delta_ramo = ramo[pixel] - last_ramo[pixel];
 
             // Induced charge on electrode is q_int = q * (phi(x1) - phi(x0))
-            auto induced = charge * gain * (ramo - last_ramo) * static_cast<std::underlying_type<CarrierType>::type>(type);
+            auto induced = charge * gain * delta_ramo * static_cast<std::underlying_type<CarrierType>::type>(type);
 
-            auto induced_primary = charge * (ramo - last_ramo) * static_cast<std::underlying_type<CarrierType>::type>(type);
+            auto induced_primary = charge * delta_ramo * static_cast<std::underlying_type<CarrierType>::type>(type);
             auto induced_secondary =
-                charge * (gain - 1) * (ramo - last_ramo) * static_cast<std::underlying_type<CarrierType>::type>(type);
+                charge * (gain - 1) * delta_ramo * static_cast<std::underlying_type<CarrierType>::type>(type);
             if(level != 0) {
                 induced_primary = 0.;
                 induced_secondary = induced;
             }
 
-            LOG(TRACE) << "Pixel " << pixel_index << " dPhi = " << (ramo - last_ramo) << ", induced " << type
+            LOG(TRACE) << "Pixel " << pixel_index << " dPhi = " << delta_ramo << ", induced " << type
                        << " q = " << Units::display(induced, "e");
 
-            // Create pulse if it doesn't exist. Store induced charge in the returned pulse iterator
-            auto pixel_map_iterator = pixel_map.emplace(pixel_index, Pulse(timestep_, integration_time_));
+            // Store induced charge in the pulse of this pixel
             try {
-                pixel_map_iterator.first->second.addCharge(induced, initial_time_local + runge_kutta.getTime());
+                pulses[stencil_slots[pixel]].addCharge(induced, initial_time_local + runge_kutta.getTime());
             } catch(const PulseBadAllocException& e) {
                 LOG(ERROR) << e.what() << std::endl
                            << "Ignoring pulse contribution at time "
@@ -745,7 +876,7 @@ TransientPropagationModule::propagate(Event* event,
                 auto inPixel_um_x = (position.x() - model_->getPixelCenter(xpixel, ypixel).x()) * 1e3;
                 auto inPixel_um_y = (position.y() - model_->getPixelCenter(xpixel, ypixel).y()) * 1e3;
 
-                potential_difference_->Fill(std::fabs(ramo - last_ramo));
+                potential_difference_->Fill(std::fabs(delta_ramo));
                 induced_charge_histo_->Fill(initial_time_local + runge_kutta.getTime(), induced);
                 induced_charge_vs_depth_histo_->Fill(initial_time_local + runge_kutta.getTime(), position.z(), induced);
                 induced_charge_map_->Fill(inPixel_um_x, inPixel_um_y, induced);
@@ -801,6 +932,12 @@ TransientPropagationModule::propagate(Event* event,
         }
     }
 
+    // Collect the induced pulses per pixel
+    std::map<Pixel::Index, Pulse> pixel_map;
+    for(size_t slot = 0; slot < pulse_pixels.size(); ++slot) {
+        pixel_map.emplace(pulse_pixels[slot], std::move(pulses[slot]));
+    }
+
     // Create a new propagated charge and add it to the list
     auto local_position = static_cast<ROOT::Math::XYZPoint>(position);
     auto global_position = detector_->getGlobalPosition(local_position);
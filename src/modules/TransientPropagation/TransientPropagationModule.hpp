@@ -78,7 +78,7 @@ namespace allpix {
 
         /**
          * @brief Propagate a single set of charges through the sensor
-         * @param event               Pointer to current event
+         * @param random_generator    Reference to the random number generator to draw from
          * @param deposit             Reference to the original deposited charge object
          * @param pos                 Position of the deposit in the sensor
          * @param type                Type of the carrier to propagate
@@ -92,7 +92,7 @@ namespace allpix {
          * @return Total recombined, trapped and propagated charge for statistics purposes
          */
         std::tuple<unsigned int, unsigned int, unsigned int>
-        propagate(Event* event,
+        propagate(RandomNumberGenerator& random_generator,
                   const DepositedCharge& deposit,
                   const ROOT::Math::XYZPoint& pos,
                   const CarrierType& type,
@@ -103,14 +103,31 @@ namespace allpix {
                   std::vector<PropagatedCharge>& propagated_charges,
                   LineGraph::OutputPlotPoints& output_plot_points) const;
 
+        /**
+         * @brief Propagate a list of charge carrier groups one by one
+         * @param random_generator   Reference to the random number generator to draw from
+         * @param groups             List of charge carrier groups, given as originating deposit and number of charges
+         * @param propagated_charges Reference to vector with all produced final PropagatedCharge objects
+         * @param output_plot_points Reference to vector to hold points for line graph output plots
+         *
+         * @return Total recombined, trapped and propagated charge for statistics purposes
+         */
+        std::tuple<unsigned int, unsigned int, unsigned int>
+        propagate_groups(RandomNumberGenerator& random_generator,
+                         const std::vector<std::pair<const DepositedCharge*, unsigned int>>& groups,
+                         std::vector<PropagatedCharge>& propagated_charges,
+                         LineGraph::OutputPlotPoints& output_plot_points) const;
+
         // Local copies of configuration parameters to avoid costly lookup:
         double temperature_{}, timestep_{}, integration_time_{}, output_plots_step_{};
         bool output_plots_{}, output_linegraphs_{}, output_linegraphs_collected_{}, output_linegraphs_recombined_{},
-            output_linegraphs_trapped_{};
+            output_linegraphs_trapped_{}, output_animations_{};
+        LineGraph::Settings linegraph_settings_;
         unsigned int distance_{};
         unsigned int charge_per_step_{};
         unsigned int max_charge_groups_{};
         unsigned int max_multiplication_level_{};
+        unsigned int charge_groups_per_task_{};
 
         // Models for electron and hole mobility and lifetime
         Mobility mobility_;
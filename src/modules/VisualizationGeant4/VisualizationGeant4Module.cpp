@@ -95,6 +95,10 @@ void VisualizationGeant4Module::initialize() {
         throw ModuleError("Cannot visualize using Geant4 without a Geant4 geometry builder");
     }
 
+    // Obtain the settings used after every event
+    accumulate_ = config_.getHandle<bool>("accumulate");
+    accumulate_time_step_ = config_.getHandle<unsigned long>("accumulate_time_step", Units::get(100ul, "ms"));
+
     // Create the gui if required
     if(mode_ == ViewingMode::GUI) {
         // Need to provide parameters, simulate this behaviour
@@ -403,10 +407,9 @@ void VisualizationGeant4Module::set_visualization_attributes() {
 }
 
 void VisualizationGeant4Module::run(Event*) {
-    if(!config_.get<bool>("accumulate")) {
+    if(!*accumulate_) {
         vis_manager_g4_->GetCurrentViewer()->ShowView();
-        std::this_thread::sleep_for(
-            std::chrono::nanoseconds(config_.get<unsigned long>("accumulate_time_step", Units::get(100ul, "ms"))));
+        std::this_thread::sleep_for(std::chrono::nanoseconds(*accumulate_time_step_));
     }
 }
 
@@ -100,6 +100,10 @@ namespace allpix {
 
         ViewingMode mode_;
 
+        // Settings used after every event
+        Configuration::Handle<bool> accumulate_;
+        Configuration::Handle<unsigned long> accumulate_time_step_;
+
         // Own the Geant4 visualization manager
         std::unique_ptr<G4VisManager> vis_manager_g4_;
 
@@ -81,14 +81,46 @@ void WeightingPotentialReaderModule::initialize() {
         }
         LOG(DEBUG) << "Weighting potential has offset of " << offset << " fractions of the field size";
 
+        // Optionally compile the grid into a cache-blocked representation for faster lookups:
+        auto compile_field = config_.get<bool>("compile_field", false);
+        if(compile_field) {
+            LOG(DEBUG) << "Weighting potential grid will be compiled for faster lookups";
+        }
+
+        // Interpolation between grid points and storage precision of the compiled grid:
+        auto field_interpolation = config_.get<FieldInterpolation>("field_interpolation", FieldInterpolation::NEAREST);
+        auto field_precision = config_.get<FieldPrecision>("field_precision", FieldPrecision::DOUBLE);
+        LOG(DEBUG) << "Weighting potential grid uses " << magic_enum::enum_name(field_interpolation) << " interpolation and "
+                   << magic_enum::enum_name(field_precision) << " storage precision";
+
         // Set the field grid, provide scale factors as fraction of the pixel pitch for correct scaling:
-        detector_->setWeightingPotentialGrid(field_data.getData(),
-                                             field_data.getDimensions(),
-                                             field_data.getSize(),
-                                             field_mapping,
-                                             field_scale,
-                                             {{offset.x(), offset.y()}},
-                                             thickness_domain);
+        if(field_data.getOctree() != nullptr) {
+            LOG(DEBUG) << "Weighting potential is stored in an adaptive grid with "
+                       << field_data.getOctree()->getNumberOfLeaves() << " leaves";
+            if(field_precision != FieldPrecision::DOUBLE) {
+                LOG(WARNING) << "Storage precision is not applicable to adaptive field grids, ignoring";
+            }
+            detector_->setWeightingPotentialGrid(field_data.getOctree(),
+                                                 field_data.getSize(),
+                                                 field_mapping,
+                                                 field_scale,
+                                                 {{offset.x(), offset.y()}},
+                                                 thickness_domain,
+                                                 compile_field,
+                                                 field_interpolation);
+        } else {
+            detector_->setWeightingPotentialGrid(field_data.getValues(),
+                                                 field_data.getNumberOfValues(),
+                                                 field_data.getDimensions(),
+                                                 field_data.getSize(),
+                                                 field_mapping,
+                                                 field_scale,
+                                                 {{offset.x(), offset.y()}},
+                                                 thickness_domain,
+                                                 compile_field,
+                                                 field_interpolation,
+                                                 field_precision);
+        }
     } else if(field_model == WeightingPotential::PAD) {
         LOG(TRACE) << "Adding weighting potential from pad in plane condenser";
 
@@ -284,7 +316,8 @@ FieldData<double> WeightingPotentialReaderModule::read_field() {
         auto field_data = field_parser_.getByFileName(config_.getPath("file_name", true));
 
         // Check maximum/minimum values of the potential:
-        auto elements = std::minmax_element(field_data.getData()->begin(), field_data.getData()->end());
+        auto values = field_data.getValues();
+        auto elements = std::minmax_element(values.get(), values.get() + field_data.getNumberOfValues());
         if(*elements.first < 0 || *elements.second > 1) {
             throw InvalidValueError(config_,
                                     "file_name",
@@ -0,0 +1,133 @@
+/**
+ * @file
+ * @brief Definition of the compact propagated charge representation
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ALLPIX_COMPACT_PROPAGATED_CHARGE_H
+#define ALLPIX_COMPACT_PROPAGATED_CHARGE_H
+
+#include <type_traits>
+
+#include <Math/Point3D.h>
+
+#include "PropagatedCharge.hpp"
+
+namespace allpix {
+
+    /**
+     * @brief Compact, trivially copyable representation of a set of propagated charges
+     *
+     * In contrast to the \ref PropagatedCharge object, this representation does not derive from TObject, carries no pulses
+     * and keeps no references to the Monte-Carlo history. Instead, the local position and time of the originating deposit
+     * are stored by value. It is dispatched by propagation modules instead of the full objects if none of the receivers of
+     * their output requires the full objects, and is consumed directly by the charge transfer modules. Pixel charges created
+     * from compact propagated charges consequently do not carry any Monte-Carlo history.
+     */
+    class CompactPropagatedCharge {
+    public:
+        /**
+         * @brief Construct a compact set of propagated charges
+         * @param local_position Local position of the propagated set of charges in the sensor
+         * @param type Type of the carrier
+         * @param charge Total charge propagated
+         * @param local_time Time of propagation arrival after energy deposition, local reference frame
+         * @param global_time Total time of propagation arrival after event start, global reference frame
+         * @param state State of the charge carrier when reaching its position
+         * @param deposit_position Local position of the deposit the charges originate from
+         * @param deposit_time Total time of the deposit after event start, global reference frame
+         */
+        CompactPropagatedCharge(const ROOT::Math::XYZPoint& local_position,
+                                CarrierType type,
+                                unsigned int charge,
+                                double local_time,
+                                double global_time,
+                                CarrierState state,
+                                const ROOT::Math::XYZPoint& deposit_position,
+                                double deposit_time)
+            : local_position_(local_position), deposit_position_(deposit_position), local_time_(local_time),
+              global_time_(global_time), deposit_time_(deposit_time), charge_(charge), type_(type), state_(state) {}
+
+        /**
+         * @brief Construct a compact copy of a full set of propagated charges
+         * @param propagated_charge Propagated charge to copy, which is required to reference its deposited charge
+         */
+        explicit CompactPropagatedCharge(const PropagatedCharge& propagated_charge)
+            : CompactPropagatedCharge(propagated_charge.getLocalPosition(),
+                                      propagated_charge.getType(),
+                                      propagated_charge.getCharge(),
+                                      propagated_charge.getLocalTime(),
+                                      propagated_charge.getGlobalTime(),
+                                      propagated_charge.getState(),
+                                      propagated_charge.getDepositedCharge()->getLocalPosition(),
+                                      propagated_charge.getDepositedCharge()->getGlobalTime()) {}
+
+        /**
+         * @brief Get local position of the set of charges in the sensor
+         * @return Local position of charges
+         */
+        const ROOT::Math::XYZPoint& getLocalPosition() const { return local_position_; }
+        /**
+         * @brief Get the type of charge carrier
+         * @return Type of charge carrier
+         */
+        CarrierType getType() const { return type_; }
+        /**
+         * @brief Get total amount of charges stored
+         * @return Total charge stored
+         */
+        unsigned int getCharge() const { return charge_; }
+        /**
+         * @brief Get the sign of the charge carriers
+         * @return Sign of the charge carriers, -1 for electrons and +1 for holes
+         */
+        long getSign() const { return static_cast<std::underlying_type<CarrierType>::type>(type_); }
+        /**
+         * @brief Get local time of the set of charges in the sensor
+         * @return Time after deposition in the local reference frame
+         */
+        double getLocalTime() const { return local_time_; }
+        /**
+         * @brief Get the global time of the set of charges
+         * @return Time after event start in the global reference frame
+         */
+        double getGlobalTime() const { return global_time_; }
+        /**
+         * @brief Get state of the charge carrier
+         * @return Charge carrier state
+         */
+        CarrierState getState() const { return state_; }
+        /**
+         * @brief Get local position of the deposit the charges originate from
+         * @return Local position of the originating deposit
+         */
+        const ROOT::Math::XYZPoint& getDepositPosition() const { return deposit_position_; }
+        /**
+         * @brief Get global time of the deposit the charges originate from
+         * @return Time of the originating deposit after event start in the global reference frame
+         */
+        double getDepositTime() const { return deposit_time_; }
+
+    private:
+        ROOT::Math::XYZPoint local_position_;
+        ROOT::Math::XYZPoint deposit_position_;
+        double local_time_;
+        double global_time_;
+        double deposit_time_;
+        unsigned int charge_;
+        CarrierType type_;
+        CarrierState state_;
+    };
+
+    /**
+     * @brief Typedef for message carrying compact propagated charges
+     */
+    using CompactPropagatedChargeMessage = Message<CompactPropagatedCharge>;
+} // namespace allpix
+
+#endif /* ALLPIX_COMPACT_PROPAGATED_CHARGE_H */
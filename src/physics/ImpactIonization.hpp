@@ -12,10 +12,14 @@
 #ifndef ALLPIX_IMPACTIONIZATION_MODELS_H
 #define ALLPIX_IMPACTIONIZATION_MODELS_H
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <optional>
+#include <type_traits>
 #include <typeindex>
-
-#include <TFormula.h>
+#include <variant>
+#include <vector>
 
 #include "exceptions.h"
 
@@ -23,6 +27,7 @@
 #include "core/utils/log.h"
 #include "core/utils/unit.h"
 #include "objects/SensorCharge.hpp"
+#include "tools/formula.h"
 
 namespace allpix {
 
@@ -57,8 +62,21 @@ namespace allpix {
             return std::exp(step * gain_factor(type, efield_mag));
         };
 
-    protected:
+        /**
+         * Impact ionization coefficient for the given carrier type and electric field magnitude
+         * @param type Type of charge carrier (electron or hole)
+         * @param efield_mag Magnitude of the electric field
+         * @return Impact ionization coefficient, i.e. the number of generated charge carriers per unit length
+         */
         virtual double gain_factor(const CarrierType& type, double efield_mag) const = 0;
+
+        /**
+         * Get the threshold electric field for impact ionization
+         * @return Threshold electric field
+         */
+        double getThreshold() const { return threshold_; }
+
+    protected:
         double threshold_{std::numeric_limits<double>::max()};
     };
 
@@ -71,8 +89,6 @@ namespace allpix {
     public:
         NoImpactIonization() : ImpactIonizationModel(std::numeric_limits<double>::max()){};
         double operator()(const CarrierType&, double, double) const override { return 1.; };
-
-    private:
         double gain_factor(const CarrierType&, double) const override { return 1.; };
     };
 
@@ -93,7 +109,6 @@ namespace allpix {
               hole_a_(Units::get(1.13e6, "/cm")),
               hole_b_(Units::get(1.71e6, "V/cm") + Units::get(1.09e3, "V/cm/K") * temperature) {}
 
-    private:
         double gain_factor(const CarrierType& type, double efield_mag) const override {
             if(type == CarrierType::ELECTRON) {
                 return electron_a_ * std::exp(-1. * electron_b_ / efield_mag);
@@ -150,7 +165,6 @@ namespace allpix {
               hole_a_high_(Units::get(6.71e5, "/cm")), hole_b_low_(Units::get(2.036e6, "V/cm")),
               hole_b_high_(Units::get(1.693e6, "V/cm")) {}
 
-    private:
         double gain_factor(const CarrierType& type, double efield_mag) const override {
             if(type == CarrierType::ELECTRON) {
                 return gamma_ * electron_a_ * std::exp(-(gamma_ * electron_b_ / efield_mag));
@@ -216,7 +230,6 @@ namespace allpix {
               hole_ac_(Units::get(0.243, "/V") * (1. + 5.35e-4 * (temperature - 300))),
               hole_bd_(Units::get(6.53e5, "V/cm") * (1. + 5.67e-4 * (temperature - 300))) {}
 
-    private:
         double gain_factor(const CarrierType& type, double efield_mag) const override {
             if(type == CarrierType::ELECTRON) {
                 return electron_ac_ * efield_mag * std::exp(-1 * electron_bd_ * electron_bd_ / efield_mag / efield_mag);
@@ -273,7 +286,6 @@ namespace allpix {
               hole_d_(Units::get(1.4043e6, "V/cm") + Units::get(2.9744e3, "V/cm") * temperature +
                       Units::get(1.4829, "V/cm") * std::pow(temperature, 2)) {}
 
-    private:
         double gain_factor(const CarrierType& type, double efield_mag) const override {
             if(type == CarrierType::ELECTRON) {
                 return efield_mag / (electron_a_ + electron_b_ * std::exp(electron_d_ / (efield_mag + electron_c_)));
@@ -282,6 +294,7 @@ namespace allpix {
             }
         };
 
+    private:
         double electron_a_;
         double electron_b_;
         double electron_c_;
@@ -305,31 +318,32 @@ namespace allpix {
 
         double gain_factor(const CarrierType& type, double efield_mag) const override {
             if(type == CarrierType::ELECTRON) {
-                return electron_gain_->Eval(efield_mag);
+                return electron_gain_->eval(efield_mag);
             } else {
-                return hole_gain_->Eval(efield_mag);
+                return hole_gain_->eval(efield_mag);
             }
         };
 
     private:
-        std::unique_ptr<TFormula> electron_gain_;
-        std::unique_ptr<TFormula> hole_gain_;
+        std::unique_ptr<Formula> electron_gain_;
+        std::unique_ptr<Formula> hole_gain_;
 
-        std::unique_ptr<TFormula> configure_gain(const Configuration& config, const CarrierType type) {
+        std::unique_ptr<Formula> configure_gain(const Configuration& config, const CarrierType type) {
             std::string name = (type == CarrierType::ELECTRON ? "electrons" : "holes");
             auto function = config.get<std::string>("multiplication_function_" + name);
             auto parameters = config.getArray<double>("multiplication_parameters_" + name, {});
 
-            auto gain = std::make_unique<TFormula>(("multiplication_" + name).c_str(), function.c_str());
+            auto gain =
+                std::make_unique<Formula>("multiplication_" + name, function, config.get<bool>("compile_functions", true));
 
-            if(!gain->IsValid()) {
+            if(!gain->isValid()) {
                 throw InvalidValueError(config,
                                         "multiplication_function_" + name,
                                         "The provided model is not a valid ROOT::TFormula expression");
             }
 
             // Check if number of parameters match up
-            if(static_cast<size_t>(gain->GetNpar()) != parameters.size()) {
+            if(gain->getNParameters() != parameters.size()) {
                 throw InvalidValueError(config,
                                         "multiplication_parameters_" + name,
                                         "The number of provided parameters and parameters in the function do not match");
@@ -337,13 +351,115 @@ namespace allpix {
 
             // Set the parameters
             for(size_t n = 0; n < parameters.size(); ++n) {
-                gain->SetParameter(static_cast<int>(n), parameters[n]);
+                gain->setParameter(n, parameters[n]);
             }
 
             return gain;
         };
     };
 
+    /**
+     * @ingroup Models
+     * @brief Tabulated impact ionization coefficients for fast lookup of impact ionization models
+     *
+     * The impact ionization coefficients of electrons and holes are sampled on a regular grid of nodes in the electric field
+     * magnitude between the multiplication threshold and the maximum field, and obtained from linear interpolation between
+     * these nodes. The grid is refined until the maximum relative deviation from the model, evaluated at the centers of all
+     * grid cells, is below the requested tolerance or the maximum table size is reached.
+     */
+    class ImpactIonizationTable {
+    public:
+        /**
+         * Constructor of the impact ionization table
+         * @param model      Impact ionization model to be tabulated
+         * @param field_min  Minimum electric field magnitude covered by the table
+         * @param field_max  Maximum electric field magnitude covered by the table
+         * @param bins       Initial number of bins of the table
+         * @param tolerance  Maximum relative deviation from the model targeted by the table
+         */
+        template <typename MODEL>
+        ImpactIonizationTable(const MODEL& model, double field_min, double field_max, size_t bins, double tolerance)
+            : field_min_(field_min), field_max_(std::max(field_max, field_min)), bins_(std::max<size_t>(bins, 1)) {
+            fill(model);
+
+            // Refine the table until the requested precision is reached or the table exceeds its maximum size:
+            while(deviation_ > tolerance && 2 * bins_ + 1 <= max_nodes_) {
+                bins_ *= 2;
+                fill(model);
+            }
+        }
+
+        /**
+         * @brief Check if an electric field magnitude is covered by the table
+         * @param efield_mag Magnitude of the electric field
+         * @return True if the field is within the tabulated range, false otherwise
+         */
+        bool contains(double efield_mag) const { return efield_mag >= field_min_ && efield_mag <= field_max_; }
+
+        /**
+         * Function call operator to obtain the interpolated impact ionization coefficient
+         * @param type Type of charge carrier (electron or hole)
+         * @param efield_mag Magnitude of the electric field, needs to be within the tabulated range
+         * @return Impact ionization coefficient
+         */
+        double operator()(const CarrierType& type, double efield_mag) const {
+            const auto& table = (type == CarrierType::ELECTRON ? electron_ : hole_);
+
+            auto fx = (efield_mag - field_min_) / (field_max_ - field_min_) * static_cast<double>(bins_);
+            auto ix = std::min(static_cast<size_t>(fx), bins_ - 1);
+            auto wx = fx - static_cast<double>(ix);
+            return (1. - wx) * table[ix] + wx * table[ix + 1];
+        }
+
+        /**
+         * @brief Get the number of bins of the table
+         * @return Number of bins along the electric field axis
+         */
+        size_t getBins() const { return bins_; }
+
+        /**
+         * @brief Get the maximum relative deviation of the table from the tabulated model at the centers of all grid cells
+         * @return Maximum relative deviation
+         */
+        double getMaximumDeviation() const { return deviation_; }
+
+    private:
+        static constexpr size_t max_nodes_ = (1 << 16);
+
+        template <typename MODEL> void fill(const MODEL& model) {
+            auto field_step = (field_max_ - field_min_) / static_cast<double>(bins_);
+
+            // Sample the model at all grid nodes:
+            electron_.resize(bins_ + 1);
+            hole_.resize(bins_ + 1);
+            for(size_t ix = 0; ix <= bins_; ++ix) {
+                auto efield = field_min_ + field_step * static_cast<double>(ix);
+                electron_[ix] = model(CarrierType::ELECTRON, efield);
+                hole_[ix] = model(CarrierType::HOLE, efield);
+            }
+
+            // Validate the table against the model at the center of each grid cell:
+            deviation_ = 0.;
+            for(size_t ix = 0; ix < bins_; ++ix) {
+                auto efield = field_min_ + field_step * (static_cast<double>(ix) + 0.5);
+                for(const auto& type : {CarrierType::ELECTRON, CarrierType::HOLE}) {
+                    auto reference = model(type, efield);
+                    auto deviation = std::fabs(operator()(type, efield) - reference) /
+                                     std::max(std::fabs(reference), std::numeric_limits<double>::min());
+                    deviation_ = std::max(deviation_, deviation);
+                }
+            }
+        }
+
+        double field_min_;
+        double field_max_;
+        size_t bins_;
+        double deviation_{};
+
+        std::vector<double> electron_;
+        std::vector<double> hole_;
+    };
+
     /**
      * @brief Wrapper class and factory for impact ionization models.
      *
@@ -370,39 +486,69 @@ namespace allpix {
                 auto threshold = config.get<double>("multiplication_threshold");
 
                 if(model == "massey") {
-                    model_ = std::make_unique<Massey>(temperature, threshold);
+                    model_.emplace<Massey>(temperature, threshold);
                 } else if(model == "massey_optimized") {
-                    model_ = std::make_unique<MasseyOptimized>(temperature, threshold);
+                    model_.emplace<MasseyOptimized>(temperature, threshold);
                 } else if(model == "overstraeten") {
-                    model_ = std::make_unique<VanOverstraetenDeMan>(temperature, threshold);
+                    model_.emplace<VanOverstraetenDeMan>(temperature, threshold);
                 } else if(model == "overstraeten_optimized") {
-                    model_ = std::make_unique<VanOverstraetenDeManOptimized>(temperature, threshold);
+                    model_.emplace<VanOverstraetenDeManOptimized>(temperature, threshold);
                 } else if(model == "okuto") {
-                    model_ = std::make_unique<OkutoCrowell>(temperature, threshold);
+                    model_.emplace<OkutoCrowell>(temperature, threshold);
                 } else if(model == "okuto_optimized") {
-                    model_ = std::make_unique<OkutoCrowellOptimized>(temperature, threshold);
+                    model_.emplace<OkutoCrowellOptimized>(temperature, threshold);
                 } else if(model == "bologna") {
-                    model_ = std::make_unique<Bologna>(temperature, threshold);
+                    model_.emplace<Bologna>(temperature, threshold);
                 } else if(model == "none") {
                     LOG(INFO) << "No impact ionization model chosen, charge multiplication not simulated";
-                    model_ = std::make_unique<NoImpactIonization>();
+                    model_.emplace<NoImpactIonization>();
                 } else if(model == "custom") {
-                    model_ = std::make_unique<CustomGain>(config, threshold);
+                    model_.emplace<CustomGain>(config, threshold);
                 } else {
                     throw InvalidModelError(model);
                 }
+                threshold_ = std::visit([](const auto& m) { return m.getThreshold(); }, model_);
                 LOG(INFO) << "Selected impact ionization model \"" << model << "\"";
+
+                // Tabulate the impact ionization coefficients if requested
+                if(config.get<bool>("multiplication_tabulated", false) && model != "none") {
+                    if(model == "custom") {
+                        throw InvalidCombinationError(config,
+                                                      {"multiplication_model", "multiplication_tabulated"},
+                                                      "custom impact ionization models cannot be tabulated");
+                    }
+                    table_.emplace(
+                        [this](const CarrierType& type, double efield_mag) { return gain_factor(type, efield_mag); },
+                        threshold_,
+                        config.get<double>("multiplication_table_field_max", Units::get(500.0, "kV/cm")),
+                        config.get<size_t>("multiplication_table_bins", 256),
+                        config.get<double>("multiplication_table_tolerance", 1e-3));
+                    LOG(INFO) << "Tabulated impact ionization model with " << table_->getBins()
+                              << " bins in electric field, maximum relative deviation from model is "
+                              << table_->getMaximumDeviation();
+                }
             } catch(const ModelError& e) {
                 throw InvalidValueError(config, "multiplication_model", e.what());
             }
         }
 
         /**
-         * Function call operator forwarded to the impact ionization model
-         * @return Gain
+         * Function call operator to obtain the gain for the given carrier type, electric field magnitude and step length.
+         * The impact ionization coefficient is taken from the table if available and covering the requested field, or from
+         * the impact ionization model otherwise
+         * @param type Type of charge carrier (electron or hole)
+         * @param efield_mag Magnitude of the electric field
+         * @param step Length of the current step
+         * @return Gain generated by impact ionization in this step
          */
-        template <class... ARGS> double operator()(ARGS&&... args) const {
-            return model_->operator()(std::forward<ARGS>(args)...);
+        double operator()(const CarrierType& type, double efield_mag, double step) const {
+            if(std::fabs(efield_mag) < threshold_) {
+                return 1.;
+            }
+            if(table_.has_value() && table_->contains(efield_mag)) {
+                return std::exp(step * (*table_)(type, efield_mag));
+            }
+            return std::exp(step * gain_factor(type, efield_mag));
         }
 
         /**
@@ -411,10 +557,39 @@ namespace allpix {
          *     if(model->is<MyModel>()) { }
          * @return Boolean indication whether this model is of the given type or not
          */
-        template <class T> bool is() const { return dynamic_cast<T*>(model_.get()) != nullptr; }
+        template <class T> bool is() const {
+            return std::visit([](const auto& model) { return std::is_base_of_v<T, std::decay_t<decltype(model)>>; },
+                              model_);
+        }
 
     private:
-        std::unique_ptr<ImpactIonizationModel> model_{};
+        /**
+         * @brief Evaluate the impact ionization coefficient of the selected model
+         *
+         * The model is called with its static type, such that the call can be inlined instead of being dispatched through
+         * the virtual function of the model base class.
+         */
+        double gain_factor(const CarrierType& type, double efield_mag) const {
+            return std::visit(
+                [&](const auto& model) -> double {
+                    using ModelType = std::decay_t<decltype(model)>;
+                    return model.ModelType::gain_factor(type, efield_mag);
+                },
+                model_);
+        }
+
+        std::variant<NoImpactIonization,
+                     Massey,
+                     MasseyOptimized,
+                     VanOverstraetenDeMan,
+                     VanOverstraetenDeManOptimized,
+                     OkutoCrowell,
+                     OkutoCrowellOptimized,
+                     Bologna,
+                     CustomGain>
+            model_{};
+        double threshold_{std::numeric_limits<double>::max()};
+        std::optional<ImpactIonizationTable> table_{};
     };
 
 } // namespace allpix
@@ -12,7 +12,13 @@
 #ifndef ALLPIX_MOBILITY_MODELS_H
 #define ALLPIX_MOBILITY_MODELS_H
 
-#include <TFormula.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <variant>
+#include <vector>
 
 #include "exceptions.h"
 
@@ -21,6 +27,7 @@
 #include "core/utils/log.h"
 #include "core/utils/unit.h"
 #include "objects/SensorCharge.hpp"
+#include "tools/formula.h"
 
 namespace allpix {
 
@@ -486,35 +493,36 @@ namespace allpix {
 
         double operator()(const CarrierType& type, double efield_mag, double doping) const override {
             if(type == CarrierType::ELECTRON) {
-                return electron_mobility_->Eval(efield_mag, doping);
+                return electron_mobility_->eval(efield_mag, doping);
             } else {
-                return hole_mobility_->Eval(efield_mag, doping);
+                return hole_mobility_->eval(efield_mag, doping);
             }
         };
 
     private:
-        std::unique_ptr<TFormula> electron_mobility_;
-        std::unique_ptr<TFormula> hole_mobility_;
+        std::unique_ptr<Formula> electron_mobility_;
+        std::unique_ptr<Formula> hole_mobility_;
 
-        std::unique_ptr<TFormula> configure_mobility(const Configuration& config, const CarrierType type, bool doping) {
+        std::unique_ptr<Formula> configure_mobility(const Configuration& config, const CarrierType type, bool doping) {
             std::string name = (type == CarrierType::ELECTRON ? "electrons" : "holes");
             auto function = config.get<std::string>("mobility_function_" + name);
             auto parameters = config.getArray<double>("mobility_parameters_" + name, {});
 
-            auto mobility = std::make_unique<TFormula>(("mobility_" + name).c_str(), function.c_str());
+            auto mobility =
+                std::make_unique<Formula>("mobility_" + name, function, config.get<bool>("compile_functions", true));
 
-            if(!mobility->IsValid()) {
+            if(!mobility->isValid()) {
                 throw InvalidValueError(
                     config, "mobility_function_" + name, "The provided model is not a valid ROOT::TFormula expression");
             }
 
             // Check if a doping concentration dependency can be detected by checking for the number of dimensions:
-            if(!doping && mobility->GetNdim() == 2) {
+            if(!doping && mobility->getNDimensions() == 2) {
                 throw ModelUnsuitable("No doping profile available but doping dependence found");
             }
 
             // Check if number of parameters match up
-            if(static_cast<size_t>(mobility->GetNpar()) != parameters.size()) {
+            if(mobility->getNParameters() != parameters.size()) {
                 throw InvalidValueError(config,
                                         "mobility_parameters_" + name,
                                         "The number of provided parameters and parameters in the function do not match");
@@ -522,13 +530,168 @@ namespace allpix {
 
             // Set the parameters
             for(size_t n = 0; n < parameters.size(); ++n) {
-                mobility->SetParameter(static_cast<int>(n), parameters[n]);
+                mobility->setParameter(n, parameters[n]);
             }
 
             return mobility;
         };
     };
 
+    /**
+     * @ingroup Models
+     * @brief Tabulated mobility for fast lookup of mobility models
+     *
+     * The mobility of electrons and holes is sampled on a regular grid of nodes in the electric field magnitude and the
+     * logarithm of the absolute doping concentration, and obtained from bilinear interpolation between these nodes. If the
+     * model does not depend on the doping concentration, a one-dimensional table in the electric field magnitude is used.
+     * The grid is refined until the maximum relative deviation from the model, evaluated at the centers of all grid cells,
+     * is below the requested tolerance or the maximum table size is reached.
+     */
+    class MobilityTable {
+    public:
+        /**
+         * Constructor of the mobility table
+         * @param model      Mobility model to be tabulated
+         * @param field_max  Maximum electric field magnitude covered by the table
+         * @param doping     Boolean to indicate presence of doping profile information
+         * @param bins       Initial number of bins along each axis of the table
+         * @param tolerance  Maximum relative deviation from the model targeted by the table
+         */
+        template <typename MODEL>
+        MobilityTable(const MODEL& model, double field_max, bool doping, size_t bins, double tolerance)
+            : field_max_(field_max), doping_min_(std::log(Units::get(1e8, "/cm/cm/cm"))),
+              doping_max_(std::log(Units::get(1e22, "/cm/cm/cm"))) {
+
+            // Check if the model depends on the doping concentration at all:
+            doping_dependent_ = false;
+            for(const auto& type : {CarrierType::ELECTRON, CarrierType::HOLE}) {
+                for(const auto efield : {0., 0.5 * field_max_, field_max_}) {
+                    auto reference = model(type, efield, std::exp(doping_min_));
+                    for(const auto log_doping : {0.5 * (doping_min_ + doping_max_), doping_max_}) {
+                        doping_dependent_ |= (model(type, efield, std::exp(log_doping)) != reference);
+                        doping_dependent_ |= (model(type, efield, -std::exp(log_doping)) != reference);
+                    }
+                }
+            }
+            doping_dependent_ &= doping;
+
+            field_bins_ = std::max<size_t>(bins, 1);
+            doping_bins_ = (doping_dependent_ ? field_bins_ : 0);
+            fill(model);
+
+            // Refine the table until the requested precision is reached or the table exceeds its maximum size:
+            while(deviation_ > tolerance && nodes(2 * field_bins_, 2 * doping_bins_) <= max_nodes_) {
+                field_bins_ *= 2;
+                doping_bins_ *= 2;
+                fill(model);
+            }
+        }
+
+        /**
+         * @brief Check if a point is covered by the table
+         * @param efield_mag Magnitude of the electric field
+         * @param doping (Effective) doping concentration
+         * @return True if the point is within the tabulated range, false otherwise
+         */
+        bool contains(double efield_mag, double doping) const {
+            if(efield_mag > field_max_) {
+                return false;
+            }
+            if(!doping_dependent_) {
+                return true;
+            }
+            auto log_doping = std::log(std::fabs(doping));
+            return log_doping >= doping_min_ && log_doping <= doping_max_;
+        }
+
+        /**
+         * Function call operator to obtain the interpolated mobility for the given carrier type and electric field magnitude
+         * @param type Type of charge carrier (electron or hole)
+         * @param efield_mag Magnitude of the electric field, needs to be within the tabulated range
+         * @param doping (Effective) doping concentration, needs to be within the tabulated range
+         * @return Mobility of the charge carrier
+         */
+        double operator()(const CarrierType& type, double efield_mag, double doping) const {
+            const auto& table = (type == CarrierType::ELECTRON ? electron_ : hole_);
+
+            auto fx = efield_mag / field_max_ * static_cast<double>(field_bins_);
+            auto ix = std::min(static_cast<size_t>(fx), field_bins_ - 1);
+            auto wx = fx - static_cast<double>(ix);
+            if(!doping_dependent_) {
+                return (1. - wx) * table[ix] + wx * table[ix + 1];
+            }
+
+            auto fy = (std::log(std::fabs(doping)) - doping_min_) / (doping_max_ - doping_min_) *
+                      static_cast<double>(doping_bins_);
+            auto iy = std::min(static_cast<size_t>(fy), doping_bins_ - 1);
+            auto wy = fy - static_cast<double>(iy);
+
+            const auto* node = &table[ix * (doping_bins_ + 1) + iy];
+            return (1. - wx) * ((1. - wy) * node[0] + wy * node[1]) +
+                   wx * ((1. - wy) * node[doping_bins_ + 1] + wy * node[doping_bins_ + 2]);
+        }
+
+        /**
+         * @brief Get the number of bins of the table along the electric field and doping concentration axes
+         * @return Number of bins along both axes, zero bins along the doping axis indicate a one-dimensional table
+         */
+        std::pair<size_t, size_t> getBins() const { return {field_bins_, doping_bins_}; }
+
+        /**
+         * @brief Get the maximum relative deviation of the table from the tabulated model at the centers of all grid cells
+         * @return Maximum relative deviation
+         */
+        double getMaximumDeviation() const { return deviation_; }
+
+    private:
+        static constexpr size_t max_nodes_ = (1 << 20);
+
+        static size_t nodes(size_t field_bins, size_t doping_bins) { return (field_bins + 1) * (doping_bins + 1); }
+
+        template <typename MODEL> void fill(const MODEL& model) {
+            auto field_step = field_max_ / static_cast<double>(field_bins_);
+            auto doping_step = (doping_bins_ > 0 ? (doping_max_ - doping_min_) / static_cast<double>(doping_bins_) : 0.);
+
+            // Sample the model at all grid nodes:
+            electron_.resize(nodes(field_bins_, doping_bins_));
+            hole_.resize(nodes(field_bins_, doping_bins_));
+            for(size_t ix = 0; ix <= field_bins_; ++ix) {
+                for(size_t iy = 0; iy <= doping_bins_; ++iy) {
+                    auto efield = field_step * static_cast<double>(ix);
+                    auto doping = std::exp(doping_min_ + doping_step * static_cast<double>(iy));
+                    electron_[ix * (doping_bins_ + 1) + iy] = model(CarrierType::ELECTRON, efield, doping);
+                    hole_[ix * (doping_bins_ + 1) + iy] = model(CarrierType::HOLE, efield, doping);
+                }
+            }
+
+            // Validate the table against the model at the center of each grid cell:
+            deviation_ = 0.;
+            for(size_t ix = 0; ix < field_bins_; ++ix) {
+                for(size_t iy = 0; iy < std::max<size_t>(doping_bins_, 1); ++iy) {
+                    auto efield = field_step * (static_cast<double>(ix) + 0.5);
+                    auto doping = std::exp(doping_min_ + doping_step * (static_cast<double>(iy) + 0.5));
+                    for(const auto& type : {CarrierType::ELECTRON, CarrierType::HOLE}) {
+                        auto reference = model(type, efield, doping);
+                        auto deviation = std::fabs(operator()(type, efield, doping) - reference) /
+                                         std::max(std::fabs(reference), std::numeric_limits<double>::min());
+                        deviation_ = std::max(deviation_, deviation);
+                    }
+                }
+            }
+        }
+
+        double field_max_;
+        double doping_min_;
+        double doping_max_;
+        size_t field_bins_{};
+        size_t doping_bins_{};
+        bool doping_dependent_{};
+        double deviation_{};
+
+        std::vector<double> electron_;
+        std::vector<double> hole_;
+    };
+
     /**
      * @brief Wrapper class and factory for mobility models.
      *
@@ -554,49 +717,111 @@ namespace allpix {
                 auto model = config.get<std::string>("mobility_model");
                 auto temperature = config.get<double>("temperature");
                 if(model == "jacoboni") {
-                    model_ = std::make_unique<JacoboniCanali>(material, temperature);
+                    model_.emplace<JacoboniCanali>(material, temperature);
                 } else if(model == "canali") {
-                    model_ = std::make_unique<Canali>(material, temperature);
+                    model_.emplace<Canali>(material, temperature);
                 } else if(model == "hamburg") {
-                    model_ = std::make_unique<Hamburg>(material, temperature);
+                    model_.emplace<Hamburg>(material, temperature);
                 } else if(model == "hamburg_highfield") {
-                    model_ = std::make_unique<HamburgHighField>(material, temperature);
+                    model_.emplace<HamburgHighField>(material, temperature);
                 } else if(model == "masetti") {
-                    model_ = std::make_unique<Masetti>(material, temperature, doping);
+                    model_.emplace<Masetti>(material, temperature, doping);
                 } else if(model == "masetti_canali") {
-                    model_ = std::make_unique<MasettiCanali>(material, temperature, doping);
+                    model_.emplace<MasettiCanali>(material, temperature, doping);
                 } else if(model == "arora") {
-                    model_ = std::make_unique<Arora>(material, temperature, doping);
+                    model_.emplace<Arora>(material, temperature, doping);
                 } else if(model == "ruch_kino") {
-                    model_ = std::make_unique<RuchKino>(material);
+                    model_.emplace<RuchKino>(material);
                 } else if(model == "quay") {
-                    model_ = std::make_unique<Quay>(material, temperature);
+                    model_.emplace<Quay>(material, temperature);
                 } else if(model == "levinshtein") {
-                    model_ = std::make_unique<Levinshtein>(material, temperature, doping);
+                    model_.emplace<Levinshtein>(material, temperature, doping);
                 } else if(model == "constant") {
-                    model_ = std::make_unique<ConstantMobility>(config.get<double>("mobility_electron"),
-                                                                config.get<double>("mobility_hole"));
+                    model_.emplace<ConstantMobility>(config.get<double>("mobility_electron"),
+                                                     config.get<double>("mobility_hole"));
                 } else if(model == "custom") {
-                    model_ = std::make_unique<Custom>(config, doping);
+                    model_.emplace<Custom>(config, doping);
                 } else {
                     throw InvalidModelError(model);
                 }
                 LOG(INFO) << "Selected mobility model \"" << model << "\"";
+
+                // Tabulate the mobility model if requested
+                if(config.get<bool>("mobility_tabulated", false)) {
+                    if(model == "custom") {
+                        throw InvalidCombinationError(config,
+                                                      {"mobility_model", "mobility_tabulated"},
+                                                      "custom mobility models cannot be tabulated");
+                    }
+                    table_.emplace(
+                        [this](const CarrierType& type, double efield_mag, double dop) {
+                            return evaluate(type, efield_mag, dop);
+                        },
+                        config.get<double>("mobility_table_field_max", Units::get(200.0, "kV/cm")),
+                        doping,
+                        config.get<size_t>("mobility_table_bins", 256),
+                        config.get<double>("mobility_table_tolerance", 1e-3));
+                    auto [field_bins, doping_bins] = table_->getBins();
+                    LOG(INFO) << "Tabulated mobility model with " << field_bins << " bins in electric field"
+                              << (doping_bins > 0 ? " and " + std::to_string(doping_bins) + " bins in doping concentration"
+                                                  : "")
+                              << ", maximum relative deviation from model is " << table_->getMaximumDeviation();
+                }
             } catch(const ModelError& e) {
                 throw InvalidValueError(config, "mobility_model", e.what());
             }
         }
 
         /**
-         * Function call operator forwarded to the mobility model
+         * Function call operator forwarded to the mobility table if available and covering the requested point, or the
+         * mobility model otherwise
+         * @param type Type of charge carrier (electron or hole)
+         * @param efield_mag Magnitude of the electric field
+         * @param doping (Effective) doping concentration
          * @return Mobility value
          */
-        template <class... ARGS> double operator()(ARGS&&... args) const {
-            return model_->operator()(std::forward<ARGS>(args)...);
+        double operator()(const CarrierType& type, double efield_mag, double doping) const {
+            if(table_.has_value() && table_->contains(efield_mag, doping)) {
+                return (*table_)(type, efield_mag, doping);
+            }
+            return evaluate(type, efield_mag, doping);
         }
 
     private:
-        std::unique_ptr<MobilityModel> model_{};
+        /**
+         * @brief Evaluate the selected mobility model
+         *
+         * The model is called with its static type, such that the call can be inlined instead of being dispatched through
+         * the virtual function call operator of the model base class.
+         */
+        double evaluate(const CarrierType& type, double efield_mag, double doping) const {
+            return std::visit(
+                [&](const auto& model) -> double {
+                    using ModelType = std::decay_t<decltype(model)>;
+                    if constexpr(std::is_same_v<ModelType, std::monostate>) {
+                        return 0.;
+                    } else {
+                        return model.ModelType::operator()(type, efield_mag, doping);
+                    }
+                },
+                model_);
+        }
+
+        std::variant<std::monostate,
+                     JacoboniCanali,
+                     Canali,
+                     Hamburg,
+                     HamburgHighField,
+                     Masetti,
+                     MasettiCanali,
+                     Arora,
+                     RuchKino,
+                     Quay,
+                     Levinshtein,
+                     ConstantMobility,
+                     Custom>
+            model_{};
+        std::optional<MobilityTable> table_{};
     };
 
 } // namespace allpix
@@ -12,6 +12,9 @@
 #ifndef ALLPIX_RECOMBINATION_MODELS_H
 #define ALLPIX_RECOMBINATION_MODELS_H
 
+#include <type_traits>
+#include <variant>
+
 #include "exceptions.h"
 
 #include "core/config/Configuration.hpp"
@@ -195,17 +198,17 @@ namespace allpix {
                 auto model = config.get<std::string>("recombination_model");
                 auto temperature = config.get<double>("temperature");
                 if(model == "srh") {
-                    model_ = std::make_unique<ShockleyReadHall>(temperature, doping);
+                    model_.emplace<ShockleyReadHall>(temperature, doping);
                 } else if(model == "auger") {
-                    model_ = std::make_unique<Auger>(doping);
+                    model_.emplace<Auger>(doping);
                 } else if(model == "combined" || model == "srh_auger") {
-                    model_ = std::make_unique<ShockleyReadHallAuger>(temperature, doping);
+                    model_.emplace<ShockleyReadHallAuger>(temperature, doping);
                 } else if(model == "constant") {
-                    model_ = std::make_unique<ConstantLifetime>(config.get<double>("lifetime_electron"),
-                                                                config.get<double>("lifetime_hole"));
+                    model_.emplace<ConstantLifetime>(config.get<double>("lifetime_electron"),
+                                                     config.get<double>("lifetime_hole"));
                 } else if(model == "none") {
                     LOG(INFO) << "No charge carrier recombination model chosen, finite lifetime not simulated";
-                    model_ = std::make_unique<None>();
+                    model_.emplace<None>();
                 } else {
                     throw InvalidModelError(model);
                 }
@@ -216,15 +219,27 @@ namespace allpix {
         }
 
         /**
-         * Function call operator forwarded to the mobility model
-         * @return Recombination value
+         * Function call operator forwarded to the recombination model
+         *
+         * The model is called with its static type, such that the call can be inlined instead of being dispatched through
+         * the virtual function call operator of the model base class.
+         * @param type Type of charge carrier (electron or hole)
+         * @param doping (Effective) doping concentration
+         * @param survival_prob Current survival probability for this charge carrier
+         * @param timestep Current time step performed for the charge carrier
+         * @return Recombination status, true if charge carrier has recombined, false if it still is alive
          */
-        template <class... ARGS> bool operator()(ARGS&&... args) const {
-            return model_->operator()(std::forward<ARGS>(args)...);
+        bool operator()(const CarrierType& type, double doping, double survival_prob, double timestep) const {
+            return std::visit(
+                [&](const auto& model) -> bool {
+                    using ModelType = std::decay_t<decltype(model)>;
+                    return model.ModelType::operator()(type, doping, survival_prob, timestep);
+                },
+                model_);
         }
 
     private:
-        std::unique_ptr<RecombinationModel> model_{};
+        std::variant<None, ShockleyReadHall, Auger, ShockleyReadHallAuger, ConstantLifetime> model_{};
     };
 
 } // namespace allpix
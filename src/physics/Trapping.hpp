@@ -12,7 +12,9 @@
 #ifndef ALLPIX_TRAPPING_MODELS_H
 #define ALLPIX_TRAPPING_MODELS_H
 
-#include <TFormula.h>
+#include <limits>
+#include <type_traits>
+#include <variant>
 
 #include "exceptions.h"
 
@@ -20,6 +22,7 @@
 #include "core/utils/log.h"
 #include "core/utils/unit.h"
 #include "objects/SensorCharge.hpp"
+#include "tools/formula.h"
 
 namespace allpix {
 
@@ -154,28 +157,29 @@ namespace allpix {
 
         bool operator()(const CarrierType& type, double probability, double timestep, double efield_mag) const override {
             return probability < (1 - std::exp(-1. * timestep /
-                                               (type == CarrierType::ELECTRON ? tf_tau_eff_electron_->Eval(efield_mag)
-                                                                              : tf_tau_eff_hole_->Eval(efield_mag))));
+                                               (type == CarrierType::ELECTRON ? tf_tau_eff_electron_->eval(efield_mag)
+                                                                              : tf_tau_eff_hole_->eval(efield_mag))));
         };
 
     private:
-        std::unique_ptr<TFormula> tf_tau_eff_electron_;
-        std::unique_ptr<TFormula> tf_tau_eff_hole_;
+        std::unique_ptr<Formula> tf_tau_eff_electron_;
+        std::unique_ptr<Formula> tf_tau_eff_hole_;
 
-        std::unique_ptr<TFormula> configure_tau_eff(const Configuration& config, const CarrierType type) {
+        std::unique_ptr<Formula> configure_tau_eff(const Configuration& config, const CarrierType type) {
             std::string name = (type == CarrierType::ELECTRON ? "electrons" : "holes");
             auto function = config.get<std::string>("trapping_function_" + name);
             auto parameters = config.getArray<double>("trapping_parameters_" + name, {});
 
-            auto trapping = std::make_unique<TFormula>(("trapping_" + name).c_str(), function.c_str());
+            auto trapping =
+                std::make_unique<Formula>("trapping_" + name, function, config.get<bool>("compile_functions", true));
 
-            if(!trapping->IsValid()) {
+            if(!trapping->isValid()) {
                 throw InvalidValueError(
                     config, "trapping_function_" + name, "The provided model is not a valid ROOT::TFormula expression");
             }
 
             // Check if number of parameters match up
-            if(static_cast<size_t>(trapping->GetNpar()) != parameters.size()) {
+            if(trapping->getNParameters() != parameters.size()) {
                 throw InvalidValueError(config,
                                         "trapping_parameters_" + name,
                                         "The number of provided parameters and parameters in the function do not match");
@@ -183,7 +187,7 @@ namespace allpix {
 
             // Set the parameters
             for(size_t n = 0; n < parameters.size(); ++n) {
-                trapping->SetParameter(static_cast<int>(n), parameters[n]);
+                trapping->setParameter(n, parameters[n]);
             }
 
             return trapping;
@@ -222,21 +226,21 @@ namespace allpix {
                 }
 
                 if(model == "ljubljana" || model == "kramberger") {
-                    model_ = std::make_unique<Ljubljana>(temperature, fluence);
+                    model_.emplace<Ljubljana>(temperature, fluence);
                 } else if(model == "dortmund" || model == "krasel") {
-                    model_ = std::make_unique<Dortmund>(fluence);
+                    model_.emplace<Dortmund>(fluence);
                 } else if(model == "cmstracker") {
-                    model_ = std::make_unique<CMSTracker>(fluence);
+                    model_.emplace<CMSTracker>(fluence);
                 } else if(model == "mandic") {
-                    model_ = std::make_unique<Mandic>(fluence);
+                    model_.emplace<Mandic>(fluence);
                 } else if(model == "constant") {
-                    model_ = std::make_unique<ConstantTrapping>(config.get<double>("trapping_time_electron"),
-                                                                config.get<double>("trapping_time_hole"));
+                    model_.emplace<ConstantTrapping>(config.get<double>("trapping_time_electron"),
+                                                     config.get<double>("trapping_time_hole"));
                 } else if(model == "none") {
                     LOG(INFO) << "No charge carrier trapping model chosen, no trapping simulated";
-                    model_ = std::make_unique<NoTrapping>();
+                    model_.emplace<NoTrapping>();
                 } else if(model == "custom") {
-                    model_ = std::make_unique<CustomTrapping>(config);
+                    model_.emplace<CustomTrapping>(config);
                 } else {
                     throw InvalidModelError(model);
                 }
@@ -248,14 +252,26 @@ namespace allpix {
 
         /**
          * Function call operator forwarded to the trapping model
+         *
+         * The model is called with its static type, such that the call can be inlined instead of being dispatched through
+         * the virtual function call operator of the model base class.
+         * @param type Type of charge carrier (electron or hole)
+         * @param probability Current trapping probability for this charge carrier
+         * @param timestep Current time step performed for the charge carrier
+         * @param efield_mag Magnitude of the electric field
          * @return Trapping state
          */
-        template <class... ARGS> bool operator()(ARGS&&... args) const {
-            return model_->operator()(std::forward<ARGS>(args)...);
+        bool operator()(const CarrierType& type, double probability, double timestep, double efield_mag) const {
+            return std::visit(
+                [&](const auto& model) -> bool {
+                    using ModelType = std::decay_t<decltype(model)>;
+                    return model.ModelType::operator()(type, probability, timestep, efield_mag);
+                },
+                model_);
         }
 
     private:
-        std::unique_ptr<TrappingModel> model_{};
+        std::variant<NoTrapping, ConstantTrapping, Ljubljana, Dortmund, CMSTracker, Mandic, CustomTrapping> model_{};
     };
 
 } // namespace allpix
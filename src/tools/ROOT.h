@@ -12,10 +12,15 @@
 #ifndef ALLPIX_ROOT_H
 #define ALLPIX_ROOT_H
 
+#include <array>
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <Math/DisplacementVector2D.h>
 #include <Math/DisplacementVector3D.h>
@@ -165,6 +170,10 @@ namespace allpix {
      * does not depend on ROOT implementation changes that have happened to the original class between minor ROOT versions.
      * This class scales to an arbitrary number of thread, irrespective of the underlying ROOT version.
      *
+     * Instead of cloning the full histogram for every thread, only a single histogram is kept. Numeric fills are collected
+     * in small per-thread buffers which are applied to the histogram in batches while holding a lock, such that the memory
+     * required does not grow with the number of bins times the number of threads.
+     *
      * Enables filling histograms in parallel and makes sure an empty instance will exist if not filled.
      */
     template <typename T, typename std::enable_if<std::is_base_of<TH1, T>::value>::type* = nullptr> class ThreadedHistogram {
@@ -173,16 +182,40 @@ namespace allpix {
 
         /**
          * @brief An easy way to fill a histogram
+         *
+         * Fills with up to four numeric arguments are buffered for the calling thread and applied to the histogram once the
+         * buffer is full, all other fills are applied directly.
+         * @return Bin number for fills applied directly, zero for buffered fills
          */
         template <class... ARGS> Int_t Fill(ARGS&&... args) { // NOLINT
-            return this->Get()->Fill(std::forward<ARGS>(args)...);
+            constexpr auto arguments = sizeof...(ARGS);
+            if constexpr(arguments <= max_arguments && (std::is_arithmetic_v<std::decay_t<ARGS>> && ...) &&
+                         is_fillable<std::make_index_sequence<arguments>>::value) {
+                auto& buffer = buffers_[ThreadPool::threadNum()];
+                if(buffer.capacity() == 0) {
+                    buffer.reserve(buffer_size);
+                }
+                buffer.push_back({{static_cast<double>(args)...}, arguments});
+                if(buffer.size() >= buffer_size) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    flush(buffer);
+                }
+                return 0;
+            } else {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return histogram_->Fill(std::forward<ARGS>(args)...);
+            }
         }
 
         /**
          * @brief An easy way to set bin contents
+         *
+         * Fills buffered by the calling thread are applied before, such that they cannot overwrite the bin contents later.
          */
         template <class... ARGS> void SetBinContent(ARGS&&... args) { // NOLINT
-            this->Get()->SetBinContent(std::forward<ARGS>(args)...);
+            std::lock_guard<std::mutex> lock(mutex_);
+            flush(buffers_[ThreadPool::threadNum()]);
+            histogram_->SetBinContent(std::forward<ARGS>(args)...);
         }
 
         /**
@@ -191,66 +224,103 @@ namespace allpix {
         void Write() { this->Merge()->Write(); } // NOLINT
 
         /**
-         * @brief Get the thread local instance of the histogram
+         * @brief Get the histogram including all fills buffered so far
          *
-         * Based on get in https://root.cern/doc/master/classROOT_1_1TThreadedObject.html, optimized for faster retrieval.
+         * The buffers of all threads are applied, this method should therefore not be called while other threads are
+         * filling the histogram, e.g. only during finalization.
          */
         std::shared_ptr<T> Get() { // NOLINT
-            auto idx = ThreadPool::threadNum();
-            auto& object = objects_[idx];
-            if(!object) {
-                object.reset(ROOT::Internal::TThreadedObjectUtils::Cloner<T>::Clone(model_.get(), directories_[idx]));
+            std::lock_guard<std::mutex> lock(mutex_);
+            for(auto& buffer : buffers_) {
+                flush(buffer);
             }
-            return object;
+            return histogram_;
         }
 
         /**
-         * @brief Merge the threaded histograms into final object
+         * @brief Merge the buffered fills of all threads into the final object
          *
-         * Based on merging in https://root.cern/doc/master/classROOT_1_1TThreadedObject.html.
+         * Can be called repeatedly, fills added after a merge are included in the next one.
+         */
+        std::shared_ptr<T> Merge() { return this->Get(); } // NOLINT
+
+    private:
+        // Maximum number of arguments of buffered fills, e.g. coordinates and weight of a three-dimensional histogram
+        static constexpr size_t max_arguments = 4;
+        // Number of fills collected per thread before applying them to the histogram
+        static constexpr size_t buffer_size = 256;
+
+        /**
+         * @brief Arguments of a buffered fill
+         */
+        struct Entry {
+            std::array<double, max_arguments> arguments;
+            size_t count;
+        };
+
+        /**
+         * @brief Check if the histogram can be filled with the given number of floating-point arguments
          */
-        std::shared_ptr<T> Merge() { // NOLINT
-            ROOT::TThreadedObjectUtils::MergeFunctionType<T> mergeFunction = ROOT::TThreadedObjectUtils::MergeTObjects<T>;
-            if(is_merged_) {
-                return objects_[0];
+        template <typename I, typename = void> struct is_fillable : std::false_type {};
+        template <size_t... I>
+        struct is_fillable<std::index_sequence<I...>,
+                           std::void_t<decltype(std::declval<T&>().Fill((static_cast<void>(I), 0.)...))>>
+            : std::true_type {};
+
+        /**
+         * @brief Apply a single buffered fill with a fixed number of arguments
+         */
+        template <size_t... I> void fill(const Entry& entry, std::index_sequence<I...>) {
+            if constexpr(is_fillable<std::index_sequence<I...>>::value) {
+                histogram_->Fill(entry.arguments[I]...);
             }
-            mergeFunction(objects_[0], objects_);
-            is_merged_ = true;
-            return objects_[0];
         }
 
-    private:
+        /**
+         * @brief Apply all fills of a buffer to the histogram and clear it, the lock needs to be held by the caller
+         */
+        void flush(std::vector<Entry>& buffer) {
+            for(const auto& entry : buffer) {
+                switch(entry.count) {
+                case 1:
+                    fill(entry, std::make_index_sequence<1>());
+                    break;
+                case 2:
+                    fill(entry, std::make_index_sequence<2>());
+                    break;
+                case 3:
+                    fill(entry, std::make_index_sequence<3>());
+                    break;
+                default:
+                    fill(entry, std::make_index_sequence<max_arguments>());
+                    break;
+                }
+            }
+            buffer.clear();
+        }
+
         /**
          * @brief Initialize the threaded histogram
          *
-         * Based on initialization in https://root.cern/doc/master/classROOT_1_1TThreadedObject.html, modified to
-         * initialize based on number of preregistered threads.
+         * The histogram is created in a separate directory to avoid clashes with existing objects of the same name, and
+         * detached from it afterwards. One fill buffer is prepared for each preregistered thread.
          */
         template <class... ARGS> void init(ARGS&&... args) {
-            const auto num_slots = ThreadPool::threadCount();
-            objects_.resize(num_slots);
+            buffers_.resize(ThreadPool::threadCount());
 
 #if ROOT_VERSION_CODE < ROOT_VERSION(6, 22, 0)
-            directories_ = ROOT::Internal::TThreadedObjectUtils::DirCreator<T>::Create(num_slots);
+            auto* directory = ROOT::Internal::TThreadedObjectUtils::DirCreator<T>::Create(1).front();
 #else
-            // create at least one directory (we need it for the model), plus others as needed by the size of objects
-            directories_.emplace_back(ROOT::Internal::TThreadedObjectUtils::DirCreator<T>::Create());
-            for(auto i = 1u; i < num_slots; ++i) {
-                directories_.emplace_back(ROOT::Internal::TThreadedObjectUtils::DirCreator<T>::Create());
-            }
+            auto* directory = ROOT::Internal::TThreadedObjectUtils::DirCreator<T>::Create();
 #endif
 
-            TDirectory::TContext ctxt(directories_[0]);
-            model_.reset(ROOT::Internal::TThreadedObjectUtils::Detacher<T>::Detach(new T(std::forward<ARGS>(args)...)));
-
-            // initialize at least the base object
-            objects_[0].reset(ROOT::Internal::TThreadedObjectUtils::Cloner<T>::Clone(model_.get(), directories_[0]));
+            TDirectory::TContext ctxt(directory);
+            histogram_.reset(ROOT::Internal::TThreadedObjectUtils::Detacher<T>::Detach(new T(std::forward<ARGS>(args)...)));
         }
 
-        std::unique_ptr<T> model_;
-        std::vector<std::shared_ptr<T>> objects_;
-        std::vector<TDirectory*> directories_;
-        bool is_merged_{false};
+        std::shared_ptr<T> histogram_;
+        std::vector<std::vector<Entry>> buffers_;
+        std::mutex mutex_;
     };
 
     /**
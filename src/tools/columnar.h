@@ -0,0 +1,726 @@
+/**
+ * @file
+ * @brief Utilities to write and read the columnar Allpix Squared event data format
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ALLPIX_COLUMNAR_H
+#define ALLPIX_COLUMNAR_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <RZip.h>
+
+#include "tools/mapped_file.h"
+
+// Version of the columnar file format
+#define COLUMNAR_FORMAT_VERSION 1
+
+namespace allpix::columnar {
+
+    /**
+     * @brief Tables of the columnar format, one per stored object type plus the event information
+     */
+    enum class Table : uint32_t {
+        EVENT = 0,           ///< Event number and seed, one row per event
+        MCPARTICLE = 1,      ///< Monte-Carlo particles
+        DEPOSITEDCHARGE = 2, ///< Deposited charges
+        PIXELCHARGE = 3,     ///< Charges collected at pixels
+        PIXELHIT = 4,        ///< Digitized pixel hits
+    };
+
+    /**
+     * @brief Columns of the event table
+     */
+    enum class EventColumn : uint32_t { NUMBER = 0, SEED };
+
+    /**
+     * @brief Columns of the Monte-Carlo particle table
+     * @note All object tables start with the row offsets of the events in the chunk and the detector index
+     */
+    enum class MCParticleColumn : uint32_t {
+        ROW_OFFSETS = 0,
+        DETECTOR,
+        PARTICLE_ID,
+        LOCAL_START_X,
+        LOCAL_START_Y,
+        LOCAL_START_Z,
+        GLOBAL_START_X,
+        GLOBAL_START_Y,
+        GLOBAL_START_Z,
+        LOCAL_END_X,
+        LOCAL_END_Y,
+        LOCAL_END_Z,
+        GLOBAL_END_X,
+        GLOBAL_END_Y,
+        GLOBAL_END_Z,
+        LOCAL_TIME,
+        GLOBAL_TIME,
+        DEPOSITED_CHARGE,
+        PARENT,
+    };
+
+    /**
+     * @brief Columns of the deposited charge table
+     */
+    enum class DepositedChargeColumn : uint32_t {
+        ROW_OFFSETS = 0,
+        DETECTOR,
+        LOCAL_X,
+        LOCAL_Y,
+        LOCAL_Z,
+        GLOBAL_X,
+        GLOBAL_Y,
+        GLOBAL_Z,
+        CARRIER_TYPE,
+        CHARGE,
+        LOCAL_TIME,
+        GLOBAL_TIME,
+        MCPARTICLE,
+    };
+
+    /**
+     * @brief Columns of the pixel charge table
+     * @note The related Monte-Carlo particles are stored as number per row and a flat list of particle rows
+     */
+    enum class PixelChargeColumn : uint32_t {
+        ROW_OFFSETS = 0,
+        DETECTOR,
+        INDEX_X,
+        INDEX_Y,
+        CHARGE,
+        LOCAL_TIME,
+        GLOBAL_TIME,
+        MCPARTICLE_COUNT,
+        MCPARTICLES,
+    };
+
+    /**
+     * @brief Columns of the pixel hit table
+     */
+    enum class PixelHitColumn : uint32_t {
+        ROW_OFFSETS = 0,
+        DETECTOR,
+        INDEX_X,
+        INDEX_Y,
+        LOCAL_TIME,
+        GLOBAL_TIME,
+        SIGNAL,
+        PIXELCHARGE,
+        MCPARTICLE_COUNT,
+        MCPARTICLES,
+    };
+
+    // Names of the object types stored in the tables
+    inline const std::set<std::string> object_names{"MCParticle", "DepositedCharge", "PixelCharge", "PixelHit"};
+
+    // Detector index of objects not bound to a detector
+    constexpr uint16_t no_detector = UINT16_MAX;
+
+    // Row index of missing relations
+    constexpr int32_t no_row = -1;
+
+    /**
+     * @brief Header at the start of the file
+     */
+    struct FileHeader {
+        std::array<char, 8> magic;
+        uint32_t version;
+        uint32_t reserved;
+    };
+
+    /**
+     * @brief Header of a chunk of events, followed by the column headers and payloads
+     */
+    struct ChunkHeader {
+        uint64_t first_event;
+        uint64_t event_count;
+        uint32_t column_count;
+        uint32_t reserved;
+    };
+
+    /**
+     * @brief Header of a column in a chunk, followed by its payload padded to eight bytes
+     */
+    struct ColumnHeader {
+        uint32_t table;
+        uint32_t column;
+        uint32_t compressed;
+        uint32_t element_size;
+        uint64_t raw_size;
+        uint64_t stored_size;
+    };
+
+    /**
+     * @brief Index entry locating a chunk in the file
+     */
+    struct IndexEntry {
+        uint64_t offset;
+        uint64_t first_event;
+        uint64_t event_count;
+    };
+
+    /**
+     * @brief Trailer at the end of the file locating the detector table and the chunk index
+     */
+    struct Trailer {
+        uint64_t detectors_offset;
+        uint64_t index_offset;
+        uint64_t chunk_count;
+        std::array<char, 8> magic;
+    };
+
+    // Magic bytes marking the start and the end of a columnar file
+    constexpr std::array<char, 8> file_magic{'A', 'P', 'X', 'C', 'O', 'L', 'M', 'N'};
+
+    // Maximum size of a single compressed block, limited by the ROOT compression routines
+    constexpr size_t max_block_size = 0x7fffff;
+
+    // Columns smaller than this size are never compressed
+    constexpr size_t min_compression_size = 256;
+
+    /**
+     * @brief Build the key identifying a column of a table
+     */
+    inline uint64_t column_key(Table table, uint32_t column) {
+        return (static_cast<uint64_t>(table) << 32) | static_cast<uint64_t>(column);
+    }
+
+    /**
+     * @brief Number of padding bytes required to align a size to eight bytes
+     */
+    inline size_t padding(size_t size) { return (8 - size % 8) % 8; }
+
+    /**
+     * @brief Writer for files of the columnar format
+     *
+     * Objects are appended column by column to the rows of the current event. Events are collected in chunks, which are
+     * written to file once the configured number of events is reached. Every column of a chunk is compressed separately
+     * with the ROOT compression algorithms, unless compression is disabled or does not reduce the size of the column.
+     */
+    class ColumnarWriter {
+    public:
+        /**
+         * @brief Open a new file for writing
+         * @param file_name Path of the file to create
+         * @param compression ROOT compression setting, i.e. hundred times the algorithm plus level, zero to disable
+         * @param chunk_size Number of events per chunk
+         * @throws std::runtime_error if the file cannot be created
+         */
+        ColumnarWriter(const std::string& file_name, int compression, size_t chunk_size)
+            : file_(file_name, std::ios::binary | std::ios::trunc), compression_(compression), chunk_size_(chunk_size) {
+            if(!file_.good()) {
+                throw std::runtime_error("cannot create file " + file_name);
+            }
+            FileHeader header{file_magic, COLUMNAR_FORMAT_VERSION, 0};
+            write(&header, sizeof(header));
+        }
+
+        /**
+         * @brief Finish the file if it has not been closed before
+         */
+        ~ColumnarWriter() {
+            try {
+                close();
+            } catch(const std::exception&) { // NOLINT(bugprone-empty-catch)
+                // Destructors must not throw, the file remains incomplete
+            }
+        }
+
+        /// @{
+        /**
+         * @brief Disallow copy
+         */
+        ColumnarWriter(const ColumnarWriter&) = delete;
+        ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+        /// @}
+
+        /**
+         * @brief Get the index of a detector, adding it to the detector table if not known yet
+         * @param name Name of the detector
+         * @return Index of the detector
+         */
+        uint16_t getDetectorIndex(const std::string& name) {
+            auto iter = std::find(detectors_.begin(), detectors_.end(), name);
+            if(iter != detectors_.end()) {
+                return static_cast<uint16_t>(iter - detectors_.begin());
+            }
+            if(detectors_.size() >= no_detector) {
+                throw std::runtime_error("too many detectors");
+            }
+            detectors_.push_back(name);
+            return static_cast<uint16_t>(detectors_.size() - 1);
+        }
+
+        /**
+         * @brief Add a new row to a table of the current event
+         * @param table Table to add the row to
+         * @return Index of the row in this table within the current event
+         */
+        int32_t addRow(Table table) { return static_cast<int32_t>(event_rows_[static_cast<size_t>(table)]++); }
+
+        /**
+         * @brief Append a value to a column of a table
+         * @param table Table the column belongs to
+         * @param column Column to append to
+         * @param value Value to append
+         */
+        template <typename C, typename T> void append(Table table, C column, T value) {
+            static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types can be stored in columns");
+            auto& buffer = get_column(table, static_cast<uint32_t>(column), sizeof(T));
+            auto size = buffer.data.size();
+            buffer.data.resize(size + sizeof(T));
+            std::memcpy(buffer.data.data() + size, &value, sizeof(T));
+        }
+
+        /**
+         * @brief Finish the current event, writing the chunk to file if it is complete
+         * @param number Number of the event
+         * @param seed Random seed of the event
+         */
+        void endEvent(uint64_t number, uint64_t seed) {
+            append(Table::EVENT, EventColumn::NUMBER, number);
+            append(Table::EVENT, EventColumn::SEED, seed);
+
+            // Store the cumulative row offsets of all object tables
+            for(size_t table = static_cast<size_t>(Table::MCPARTICLE); table < event_rows_.size(); ++table) {
+                auto& offsets = get_column(static_cast<Table>(table), 0, sizeof(uint64_t));
+                if(offsets.data.empty()) {
+                    append(static_cast<Table>(table), 0, uint64_t(0));
+                }
+                chunk_rows_[table] += event_rows_[table];
+                append(static_cast<Table>(table), 0, chunk_rows_[table]);
+                event_rows_[table] = 0;
+            }
+
+            ++chunk_events_;
+            if(chunk_events_ >= chunk_size_) {
+                flush();
+            }
+        }
+
+        /**
+         * @brief Write all completed events not yet written to a new chunk
+         */
+        void flush() {
+            if(chunk_events_ == 0) {
+                return;
+            }
+
+            IndexEntry entry{offset_, total_events_, chunk_events_};
+            ChunkHeader header{total_events_, chunk_events_, static_cast<uint32_t>(columns_.size()), 0};
+            write(&header, sizeof(header));
+
+            for(auto& [key, column] : columns_) {
+                write_column(key, column);
+            }
+
+            index_.push_back(entry);
+            total_events_ += chunk_events_;
+            chunk_events_ = 0;
+            columns_.clear();
+            chunk_rows_.fill(0);
+        }
+
+        /**
+         * @brief Write the remaining events as well as the detector table and index and close the file
+         */
+        void close() {
+            if(!file_.is_open()) {
+                return;
+            }
+            flush();
+
+            // Detector table
+            auto detectors_offset = offset_;
+            auto detector_count = static_cast<uint32_t>(detectors_.size());
+            write(&detector_count, sizeof(detector_count));
+            for(const auto& name : detectors_) {
+                auto length = static_cast<uint32_t>(name.size());
+                write(&length, sizeof(length));
+                write(name.data(), name.size());
+            }
+            write_padding();
+
+            // Chunk index and trailer
+            auto index_offset = offset_;
+            write(index_.data(), index_.size() * sizeof(IndexEntry));
+            Trailer trailer{detectors_offset, index_offset, index_.size(), file_magic};
+            write(&trailer, sizeof(trailer));
+
+            file_.close();
+        }
+
+        /**
+         * @brief Get the total number of events written
+         * @return Number of events
+         */
+        uint64_t getEventCount() const { return total_events_ + chunk_events_; }
+
+    private:
+        struct Column {
+            uint32_t element_size{};
+            std::vector<char> data;
+        };
+
+        Column& get_column(Table table, uint32_t column, size_t element_size) {
+            auto& buffer = columns_[column_key(table, column)];
+            if(buffer.element_size == 0) {
+                buffer.element_size = static_cast<uint32_t>(element_size);
+            } else if(buffer.element_size != element_size) {
+                throw std::logic_error("inconsistent element size for column " + std::to_string(column));
+            }
+            return buffer;
+        }
+
+        void write_column(uint64_t key, Column& column) {
+            const auto raw_size = column.data.size();
+
+            // Compress in blocks, falling back to the raw data if compression fails or does not pay off
+            std::vector<char> compressed;
+            bool use_compression = (compression_ > 0 && raw_size >= min_compression_size);
+            if(use_compression) {
+                compressed.resize(raw_size);
+                size_t in = 0;
+                size_t out = 0;
+                while(in < raw_size) {
+                    int src_size = static_cast<int>(std::min(max_block_size, raw_size - in));
+                    int tgt_size = static_cast<int>(std::min(max_block_size, raw_size - out));
+                    int irep = 0;
+                    if(tgt_size > 0) {
+                        R__zip(compression_, &src_size, column.data.data() + in, &tgt_size, compressed.data() + out, &irep);
+                    }
+                    if(irep <= 0) {
+                        use_compression = false;
+                        break;
+                    }
+                    in += static_cast<size_t>(src_size);
+                    out += static_cast<size_t>(irep);
+                }
+                compressed.resize(out);
+                if(out >= raw_size) {
+                    use_compression = false;
+                }
+            }
+
+            const auto& payload = (use_compression ? compressed : column.data);
+            ColumnHeader header{static_cast<uint32_t>(key >> 32),
+                                static_cast<uint32_t>(key & UINT32_MAX),
+                                use_compression ? 1U : 0U,
+                                column.element_size,
+                                raw_size,
+                                payload.size()};
+            write(&header, sizeof(header));
+            write(payload.data(), payload.size());
+            write_padding();
+        }
+
+        void write(const void* data, size_t size) {
+            file_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            if(!file_.good()) {
+                throw std::runtime_error("writing to file failed");
+            }
+            offset_ += size;
+        }
+
+        void write_padding() {
+            static constexpr std::array<char, 8> zeros{};
+            write(zeros.data(), padding(offset_));
+        }
+
+        std::ofstream file_;
+        uint64_t offset_{};
+        int compression_;
+        size_t chunk_size_;
+
+        std::vector<std::string> detectors_;
+        std::vector<IndexEntry> index_;
+        uint64_t total_events_{};
+
+        // Columns of the current chunk, ordered by table and column
+        std::map<uint64_t, Column> columns_;
+        uint64_t chunk_events_{};
+        std::array<uint64_t, 5> event_rows_{};
+        std::array<uint64_t, 5> chunk_rows_{};
+    };
+
+    /**
+     * @brief Read-only view on the values of a column
+     *
+     * Uncompressed columns are accessed directly in the memory-mapped file, decompressed columns are kept alive by the
+     * view as long as it exists.
+     */
+    template <typename T> class ColumnView {
+    public:
+        ColumnView() = default;
+        ColumnView(const T* data, size_t size, std::shared_ptr<const void> owner = nullptr)
+            : data_(data), size_(size), owner_(std::move(owner)) {}
+
+        const T& operator[](size_t index) const { return data_[index]; }
+        const T* data() const { return data_; }
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+
+    private:
+        const T* data_{nullptr};
+        size_t size_{};
+        std::shared_ptr<const void> owner_;
+    };
+
+    /**
+     * @brief Reader for files of the columnar format
+     *
+     * The file is memory-mapped and only its index is parsed when opening it. Columns are accessed per chunk, compressed
+     * columns are decompressed on first access and cached for a limited number of chunks. All methods are thread-safe.
+     */
+    class ColumnarReader {
+    public:
+        /**
+         * @brief Open and map a file for reading
+         * @param file_name Path of the file to read
+         * @param cached_chunks Maximum number of chunks for which decompressed columns are kept
+         * @throws std::runtime_error if the file cannot be opened or is not a valid columnar file
+         */
+        explicit ColumnarReader(const std::string& file_name, size_t cached_chunks = 4)
+            : file_(file_name), data_(file_.data()), size_(file_.size()),
+              cached_chunks_(std::max<size_t>(cached_chunks, 1)) {
+            if(size_ < sizeof(FileHeader) + sizeof(Trailer)) {
+                throw std::runtime_error("file " + file_name + " is too small to be a columnar file");
+            }
+            parse();
+        }
+
+        /// @{
+        /**
+         * @brief Disallow copy
+         */
+        ColumnarReader(const ColumnarReader&) = delete;
+        ColumnarReader& operator=(const ColumnarReader&) = delete;
+        /// @}
+
+        /**
+         * @brief Get the total number of events in the file
+         * @return Number of events
+         */
+        uint64_t getEventCount() const { return index_.empty() ? 0 : index_.back().first_event + index_.back().event_count; }
+
+        /**
+         * @brief Get the names of the detectors referenced by the detector indices
+         * @return List of detector names
+         */
+        const std::vector<std::string>& getDetectors() const { return detectors_; }
+
+        /**
+         * @brief Locate an event in the file
+         * @param event Index of the event, starting from zero
+         * @return Pair of chunk number and index of the event within this chunk
+         * @throws std::out_of_range if the file contains fewer events
+         */
+        std::pair<size_t, size_t> locate(uint64_t event) const {
+            auto iter = std::upper_bound(index_.begin(), index_.end(), event, [](uint64_t value, const IndexEntry& entry) {
+                return value < entry.first_event;
+            });
+            if(iter == index_.begin() || event >= getEventCount()) {
+                throw std::out_of_range("event " + std::to_string(event) + " not available in file");
+            }
+            --iter;
+            return {static_cast<size_t>(iter - index_.begin()), static_cast<size_t>(event - iter->first_event)};
+        }
+
+        /**
+         * @brief Get the range of rows of a table belonging to an event
+         * @param chunk Chunk containing the event
+         * @param event Index of the event within the chunk
+         * @param table Object table to get the rows for
+         * @return Pair of first and past-the-end row within the chunk, empty if the table is not stored
+         */
+        std::pair<uint64_t, uint64_t> getRows(size_t chunk, size_t event, Table table) const {
+            auto offsets = getColumn<uint64_t>(chunk, table, 0U);
+            if(offsets.size() <= event + 1) {
+                return {0, 0};
+            }
+            return {offsets[event], offsets[event + 1]};
+        }
+
+        /**
+         * @brief Get the values of a column of a chunk
+         * @param chunk Chunk to read the column from
+         * @param table Table the column belongs to
+         * @param column Column to read
+         * @return View on the column values, empty if the column is not stored
+         * @throws std::runtime_error if the column is corrupted or has a different type
+         */
+        template <typename T, typename C> ColumnView<T> getColumn(size_t chunk, Table table, C column) const {
+            const auto& columns = chunks_.at(chunk);
+            auto key = column_key(table, static_cast<uint32_t>(column));
+            auto iter = columns.find(key);
+            if(iter == columns.end()) {
+                return {};
+            }
+
+            const auto* header = iter->second;
+            if(header->element_size != sizeof(T)) {
+                throw std::runtime_error("unexpected element size of column " + std::to_string(header->column));
+            }
+            const auto* payload = reinterpret_cast<const char*>(header + 1); // NOLINT
+            auto count = static_cast<size_t>(header->raw_size / sizeof(T));
+            if(header->compressed == 0) {
+                return {reinterpret_cast<const T*>(payload), count}; // NOLINT
+            }
+
+            auto buffer = get_decompressed(chunk, key, header, payload);
+            return {reinterpret_cast<const T*>(buffer->data()), count, buffer}; // NOLINT
+        }
+
+    private:
+        void parse() {
+            FileHeader header{};
+            std::memcpy(&header, data_, sizeof(header));
+            if(header.magic != file_magic) {
+                throw std::runtime_error("not a columnar file");
+            }
+            if(header.version != COLUMNAR_FORMAT_VERSION) {
+                throw std::runtime_error("unsupported format version " + std::to_string(header.version));
+            }
+
+            Trailer trailer{};
+            std::memcpy(&trailer, data_ + size_ - sizeof(Trailer), sizeof(trailer));
+            if(trailer.magic != file_magic) {
+                throw std::runtime_error("file is incomplete or corrupted");
+            }
+            if(trailer.index_offset + trailer.chunk_count * sizeof(IndexEntry) > size_ - sizeof(Trailer) ||
+               trailer.detectors_offset > trailer.index_offset) {
+                throw std::runtime_error("invalid chunk index");
+            }
+
+            // Detector table
+            auto offset = static_cast<size_t>(trailer.detectors_offset);
+            auto detector_count = read<uint32_t>(offset, trailer.index_offset);
+            for(uint32_t i = 0; i < detector_count; ++i) {
+                auto length = read<uint32_t>(offset, trailer.index_offset);
+                check_range(offset, length, trailer.index_offset);
+                detectors_.emplace_back(data_ + offset, length);
+                offset += length;
+            }
+
+            // Chunk index and column headers of all chunks
+            index_.resize(trailer.chunk_count);
+            std::memcpy(index_.data(), data_ + trailer.index_offset, index_.size() * sizeof(IndexEntry));
+            for(const auto& entry : index_) {
+                offset = static_cast<size_t>(entry.offset);
+                auto chunk_header = read<ChunkHeader>(offset, trailer.detectors_offset);
+                auto& columns = chunks_.emplace_back();
+                for(uint32_t i = 0; i < chunk_header.column_count; ++i) {
+                    check_range(offset, sizeof(ColumnHeader), trailer.detectors_offset);
+                    const auto* column = reinterpret_cast<const ColumnHeader*>(data_ + offset); // NOLINT
+                    offset += sizeof(ColumnHeader);
+                    check_range(offset, column->stored_size, trailer.detectors_offset);
+                    if(column->compressed == 0 && column->stored_size != column->raw_size) {
+                        throw std::runtime_error("invalid column size");
+                    }
+                    columns.emplace(column_key(static_cast<Table>(column->table), column->column), column);
+                    offset += column->stored_size + padding(column->stored_size);
+                }
+            }
+        }
+
+        template <typename T> T read(size_t& offset, uint64_t limit) const {
+            check_range(offset, sizeof(T), limit);
+            T value{};
+            std::memcpy(&value, data_ + offset, sizeof(T));
+            offset += sizeof(T);
+            return value;
+        }
+
+        static void check_range(size_t offset, uint64_t size, uint64_t limit) {
+            if(offset + size > limit) {
+                throw std::runtime_error("unexpected end of data");
+            }
+        }
+
+        std::shared_ptr<const std::vector<uint64_t>>
+        get_decompressed(size_t chunk, uint64_t key, const ColumnHeader* header, const char* payload) const {
+            std::lock_guard<std::mutex> lock{cache_mutex_};
+            auto chunk_iter = cache_.find(chunk);
+            if(chunk_iter != cache_.end()) {
+                auto iter = chunk_iter->second.find(key);
+                if(iter != chunk_iter->second.end()) {
+                    return iter->second;
+                }
+            }
+
+            // Decompress block by block into an eight-byte aligned buffer
+            auto buffer = std::make_shared<std::vector<uint64_t>>((header->raw_size + 7) / 8);
+            auto* target = reinterpret_cast<unsigned char*>(buffer->data());                       // NOLINT
+            auto* source = reinterpret_cast<unsigned char*>(const_cast<char*>(payload));           // NOLINT
+            size_t in = 0;
+            size_t out = 0;
+            while(in < header->stored_size) {
+                int src_size = 0;
+                int tgt_size = 0;
+                if(header->stored_size - in < 9 || R__unzip_header(&src_size, source + in, &tgt_size) != 0 ||
+                   in + static_cast<size_t>(src_size) > header->stored_size ||
+                   out + static_cast<size_t>(tgt_size) > header->raw_size) {
+                    throw std::runtime_error("corrupted compressed column " + std::to_string(header->column));
+                }
+                int irep = 0;
+                R__unzip(&src_size, source + in, &tgt_size, target + out, &irep);
+                if(irep != tgt_size) {
+                    throw std::runtime_error("decompression of column " + std::to_string(header->column) + " failed");
+                }
+                in += static_cast<size_t>(src_size);
+                out += static_cast<size_t>(tgt_size);
+            }
+            if(out != header->raw_size) {
+                throw std::runtime_error("unexpected size of decompressed column " + std::to_string(header->column));
+            }
+
+            // Only cache successfully decompressed columns, evicting the oldest chunks if too many are cached
+            if(chunk_iter == cache_.end()) {
+                cache_order_.push_back(chunk);
+                while(cache_order_.size() > cached_chunks_) {
+                    cache_.erase(cache_order_.front());
+                    cache_order_.pop_front();
+                }
+                chunk_iter = cache_.emplace(chunk, std::map<uint64_t, std::shared_ptr<const std::vector<uint64_t>>>()).first;
+            }
+            chunk_iter->second.emplace(key, buffer);
+            return buffer;
+        }
+
+        MappedFile file_;
+        const char* data_{nullptr};
+        size_t size_{};
+
+        std::vector<std::string> detectors_;
+        std::vector<IndexEntry> index_;
+        std::vector<std::map<uint64_t, const ColumnHeader*>> chunks_;
+
+        // Decompressed columns of the most recently accessed chunks
+        size_t cached_chunks_;
+        mutable std::mutex cache_mutex_;
+        mutable std::map<size_t, std::map<uint64_t, std::shared_ptr<const std::vector<uint64_t>>>> cache_;
+        mutable std::deque<size_t> cache_order_;
+    };
+} // namespace allpix::columnar
+
+#endif /* ALLPIX_COLUMNAR_H */
@@ -0,0 +1,58 @@
+/**
+ * @file
+ * @brief Trilinear interpolation of field data between the centers of the cells of a regular grid
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ALLPIX_FIELD_INTERPOLATION_H
+#define ALLPIX_FIELD_INTERPOLATION_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace allpix {
+
+    /**
+     * @brief Visit the eight cells surrounding a position with their weights for trilinear interpolation
+     * @param bins Number of bins of the grid along each axis
+     * @param position Position in units of bins along each axis
+     * @param accumulate Function called with the indices of each of the eight cells along x, y and z and their weight
+     *
+     * The values are located at the cell centers and the eight cells around the position are weighted with their distance
+     * along each axis. At the edges of the grid, the index of the outer neighbor is clamped to the grid, such that the field
+     * is constant within the outer half of the edge cells. The weights of all cells add up to one.
+     */
+    template <typename F>
+    void interpolate_trilinear(const std::array<size_t, 3>& bins, const std::array<double, 3>& position, F&& accumulate) {
+        std::array<size_t, 3> lower{};
+        std::array<size_t, 3> upper{};
+        std::array<double, 3> weight{};
+        for(size_t axis = 0; axis < 3; ++axis) {
+            auto center = position[axis] - 0.5;
+            auto low = std::floor(center);
+            auto last = static_cast<double>(bins[axis] - 1);
+            weight[axis] = center - low;
+            lower[axis] = static_cast<size_t>(std::clamp(low, 0., last));
+            upper[axis] = static_cast<size_t>(std::clamp(low + 1., 0., last));
+        }
+
+        for(size_t corner = 0; corner < 8; ++corner) {
+            auto wx = ((corner & 4) != 0 ? weight[0] : 1. - weight[0]);
+            auto wy = ((corner & 2) != 0 ? weight[1] : 1. - weight[1]);
+            auto wz = ((corner & 1) != 0 ? weight[2] : 1. - weight[2]);
+            accumulate((corner & 4) != 0 ? upper[0] : lower[0],
+                       (corner & 2) != 0 ? upper[1] : lower[1],
+                       (corner & 1) != 0 ? upper[2] : lower[2],
+                       wx * wy * wz);
+        }
+    }
+} // namespace allpix
+
+#endif /* ALLPIX_FIELD_INTERPOLATION_H */
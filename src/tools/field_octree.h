@@ -0,0 +1,250 @@
+/**
+ * @file
+ * @brief Adaptive octree storage for field data on a regular grid
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ALLPIX_FIELD_OCTREE_H
+#define ALLPIX_FIELD_OCTREE_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace allpix {
+
+    /**
+     * @brief Adaptive storage of field data defined on a regular grid of cells
+     *
+     * The grid is embedded into a cube of 2^depth cells along each axis, which is recursively divided into octants. A block
+     * of cells is stored as a single leaf as soon as all field components vary by less than twice the tolerance within the
+     * block, the leaf then holds the center of the value range of each component. Regions with flat fields such as the bulk
+     * of a sensor are therefore represented by few large leaves, while regions with strong gradients are refined down to
+     * individual cells of the grid.
+     *
+     * The nodes are stored in breadth-first order in a flat vector, with the eight children of a node placed next to each
+     * other. Each node holds either the index of its first child, or the bitwise complement of the index of its leaf value.
+     * A lookup descends from the root following one bit of each cell index per level and thus takes at most depth steps.
+     */
+    template <typename T = double> class FieldOctree {
+    public:
+        /**
+         * @brief Default constructor to create an empty octree
+         */
+        FieldOctree() = default;
+
+        /**
+         * @brief Constructor building the octree from a flat field on a regular grid
+         * @param field      Pointer to the flat field data, with the z index running fastest
+         * @param dimensions Number of bins of the field in each coordinate
+         * @param components Number of components per field value
+         * @param tolerance  Maximum absolute deviation of the stored field components from the field
+         * @throws std::invalid_argument If the dimensions are empty or the tree exceeds the maximum number of nodes
+         */
+        FieldOctree(const T* field, std::array<size_t, 3> dimensions, size_t components, T tolerance)
+            : dimensions_(dimensions) {
+            if(dimensions_[0] == 0 || dimensions_[1] == 0 || dimensions_[2] == 0 || components == 0) {
+                throw std::invalid_argument("field dimensions are empty");
+            }
+            while((size_t(1) << depth_) < *std::max_element(dimensions_.begin(), dimensions_.end())) {
+                ++depth_;
+            }
+
+            // Range of each component for the blocks of cells on every level, the first level is the field itself
+            std::vector<std::array<size_t, 3>> level_dimensions{dimensions_};
+            std::vector<std::vector<T>> minimum(depth_ + 1);
+            std::vector<std::vector<T>> maximum(depth_ + 1);
+            auto range = [&](size_t level, bool upper) -> const T* {
+                return (level == 0 ? field : (upper ? maximum[level] : minimum[level]).data());
+            };
+            for(size_t level = 1; level <= depth_; ++level) {
+                const auto& lower = level_dimensions.back();
+                std::array<size_t, 3> dims{{(lower[0] + 1) / 2, (lower[1] + 1) / 2, (lower[2] + 1) / 2}};
+                minimum[level].assign(dims[0] * dims[1] * dims[2] * components, std::numeric_limits<T>::max());
+                maximum[level].assign(dims[0] * dims[1] * dims[2] * components, std::numeric_limits<T>::lowest());
+                for(size_t x = 0; x < lower[0]; ++x) {
+                    for(size_t y = 0; y < lower[1]; ++y) {
+                        for(size_t z = 0; z < lower[2]; ++z) {
+                            auto from = ((x * lower[1] + y) * lower[2] + z) * components;
+                            auto to = (((x / 2) * dims[1] + y / 2) * dims[2] + z / 2) * components;
+                            for(size_t i = 0; i < components; ++i) {
+                                minimum[level][to + i] = std::min(minimum[level][to + i], range(level - 1, false)[from + i]);
+                                maximum[level][to + i] = std::max(maximum[level][to + i], range(level - 1, true)[from + i]);
+                            }
+                        }
+                    }
+                }
+                level_dimensions.push_back(dims);
+            }
+
+            // Subdivide the blocks breadth-first, starting from the root covering all cells
+            struct Block {
+                size_t node;
+                size_t level;
+                std::array<size_t, 3> cell;
+            };
+            std::vector<Block> queue{{0, depth_, {{0, 0, 0}}}};
+            nodes_.push_back(0);
+            for(size_t next = 0; next < queue.size(); ++next) {
+                auto [node, level, cell] = queue[next];
+                const auto& dims = level_dimensions[level];
+
+                // Blocks outside of the field are never looked up and reference the first leaf
+                if(cell[0] >= dims[0] || cell[1] >= dims[1] || cell[2] >= dims[2]) {
+                    nodes_[node] = ~std::int32_t(0);
+                    continue;
+                }
+
+                auto offset = ((cell[0] * dims[1] + cell[1]) * dims[2] + cell[2]) * components;
+                bool uniform = true;
+                for(size_t i = 0; i < components; ++i) {
+                    uniform &= (range(level, true)[offset + i] - range(level, false)[offset + i] <= 2 * tolerance);
+                }
+                if(level == 0 || uniform) {
+                    nodes_[node] = ~static_cast<std::int32_t>(leaves_++);
+                    for(size_t i = 0; i < components; ++i) {
+                        values_.push_back((range(level, true)[offset + i] + range(level, false)[offset + i]) / 2);
+                    }
+                    continue;
+                }
+
+                if(nodes_.size() + 8 > static_cast<size_t>(std::numeric_limits<std::int32_t>::max())) {
+                    throw std::invalid_argument("field exceeds the maximum number of octree nodes");
+                }
+                nodes_[node] = static_cast<std::int32_t>(nodes_.size());
+                for(size_t child = 0; child < 8; ++child) {
+                    std::array<size_t, 3> child_cell{
+                        {2 * cell[0] + ((child >> 2) & 1), 2 * cell[1] + ((child >> 1) & 1), 2 * cell[2] + (child & 1)}};
+                    queue.push_back({nodes_.size(), level - 1, child_cell});
+                    nodes_.push_back(0);
+                }
+            }
+        }
+
+        /**
+         * @brief Constructor for an octree from its nodes and leaf values, e.g. read from file
+         * @param dimensions Number of bins of the field in each coordinate
+         * @param nodes      Nodes of the octree in breadth-first order
+         * @param values     Flat values of the leaves
+         * @throws std::invalid_argument If the nodes do not form a valid octree for the given dimensions
+         */
+        FieldOctree(std::array<size_t, 3> dimensions, std::vector<std::int32_t> nodes, std::vector<T> values)
+            : dimensions_(dimensions), nodes_(std::move(nodes)), values_(std::move(values)) {
+            if(dimensions_[0] == 0 || dimensions_[1] == 0 || dimensions_[2] == 0 || nodes_.empty()) {
+                throw std::invalid_argument("octree dimensions are empty");
+            }
+            while((size_t(1) << depth_) < *std::max_element(dimensions_.begin(), dimensions_.end())) {
+                ++depth_;
+            }
+
+            // Every node has to be reached exactly once from a parent with lower index and no deeper than the cell level
+            std::vector<size_t> levels(nodes_.size(), std::numeric_limits<size_t>::max());
+            levels.front() = depth_;
+            for(size_t node = 0; node < nodes_.size(); ++node) {
+                if(nodes_[node] < 0) {
+                    leaves_ = std::max(leaves_, static_cast<size_t>(~nodes_[node]) + 1);
+                    continue;
+                }
+                auto child = static_cast<size_t>(nodes_[node]);
+                if(levels[node] == 0 || levels[node] > depth_ || child <= node || child + 8 > nodes_.size()) {
+                    throw std::invalid_argument("invalid octree structure");
+                }
+                for(size_t i = child; i < child + 8; ++i) {
+                    if(levels[i] != std::numeric_limits<size_t>::max()) {
+                        throw std::invalid_argument("invalid octree structure");
+                    }
+                    levels[i] = levels[node] - 1;
+                }
+            }
+            if(leaves_ == 0 || values_.size() % leaves_ != 0) {
+                throw std::invalid_argument("octree values do not match its leaves");
+            }
+        }
+
+        /**
+         * @brief Look up the leaf holding the value of a cell of the grid
+         * @param x Index of the cell along x
+         * @param y Index of the cell along y
+         * @param z Index of the cell along z
+         * @return Index of the leaf, the values of the leaf start at this index times the number of components
+         */
+        size_t getLeaf(size_t x, size_t y, size_t z) const {
+            auto node = nodes_.front();
+            auto level = depth_;
+            while(node >= 0) {
+                --level;
+                auto child = (((x >> level) & 1) << 2) | (((y >> level) & 1) << 1) | ((z >> level) & 1);
+                node = nodes_[static_cast<size_t>(node) + child];
+            }
+            return static_cast<size_t>(~node);
+        }
+
+        /**
+         * @brief Expand the octree onto the regular grid of cells
+         * @return Flat field data, with the z index running fastest
+         */
+        std::vector<T> expand() const {
+            auto components = values_.size() / leaves_;
+            std::vector<T> field;
+            field.reserve(dimensions_[0] * dimensions_[1] * dimensions_[2] * components);
+            for(size_t x = 0; x < dimensions_[0]; ++x) {
+                for(size_t y = 0; y < dimensions_[1]; ++y) {
+                    for(size_t z = 0; z < dimensions_[2]; ++z) {
+                        auto leaf = values_.begin() + static_cast<std::ptrdiff_t>(getLeaf(x, y, z) * components);
+                        field.insert(field.end(), leaf, leaf + static_cast<std::ptrdiff_t>(components));
+                    }
+                }
+            }
+            return field;
+        }
+
+        /**
+         * @brief Get the number of bins of the regular grid represented by the octree
+         * @return array with the number of bins in x, y and z
+         */
+        std::array<size_t, 3> getDimensions() const { return dimensions_; }
+
+        /**
+         * @brief Get the number of levels below the root of the octree
+         * @return Maximum depth of the octree
+         */
+        size_t getDepth() const { return depth_; }
+
+        /**
+         * @brief Get the number of leaves of the octree, i.e. the number of stored field values
+         * @return Number of leaves
+         */
+        size_t getNumberOfLeaves() const { return leaves_; }
+
+        /**
+         * @brief Access the nodes of the octree in breadth-first order
+         * @return Vector of nodes
+         */
+        const std::vector<std::int32_t>& getNodes() const { return nodes_; }
+
+        /**
+         * @brief Access the flat values of the leaves
+         * @return Vector of leaf values
+         */
+        const std::vector<T>& getValues() const { return values_; }
+
+    private:
+        std::array<size_t, 3> dimensions_{};
+        size_t depth_{};
+        size_t leaves_{};
+        std::vector<std::int32_t> nodes_;
+        std::vector<T> values_;
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_FIELD_OCTREE_H */
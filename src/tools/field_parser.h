@@ -14,13 +14,21 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <tuple>
 
 #include "core/utils/log.h"
 #include "core/utils/unit.h"
+#include "tools/field_octree.h"
+#include "tools/mapped_file.h"
 
 #include <cereal/archives/portable_binary.hpp>
 
@@ -31,7 +39,10 @@
 #include <utility>
 
 // Mime type version for APF files
-#define APF_MIME_TYPE_VERSION 1
+#define APF_MIME_TYPE_VERSION 3
+
+// Alignment of the field payload in APF files from version 2 on, allows memory-mapping the payload
+#define APF_PAYLOAD_ALIGNMENT 4096
 
 namespace allpix {
 
@@ -58,6 +69,7 @@ namespace allpix {
      * * The actual field data as shared pointer to vector
      * * An array specifying the number of bins in each dimension
      * * An array containing the physical extent of the field in each dimension, as specified in the file
+     * * Optionally an adaptive octree holding the field, in which case the field data are the values of its leaves
      */
     template <typename T = double> class FieldData {
     public:
@@ -77,7 +89,35 @@ namespace allpix {
                   std::array<size_t, 3> dimensions,
                   std::array<T, 3> size,
                   std::shared_ptr<std::vector<T>> data)
-            : header_(std::move(header)), dimensions_(dimensions), size_(size), data_(std::move(data)){};
+            : header_(std::move(header)), dimensions_(dimensions), size_(size), data_(std::move(data)) {
+            set_values_from_data();
+        };
+
+        /**
+         * @brief Constructor for field data from values owned elsewhere, e.g. a memory-mapped file
+         * @param header     Human readable header string to identify file content, program version used for generation etc.
+         * @param dimensions Number of bins of the field in each coordinate
+         * @param size       Physical extent of the field in each dimension, given in internal units
+         * @param values     Shared pointer to the first value of the flat field data, keeping the data alive
+         * @param count      Number of values of the flat field data
+         */
+        FieldData(std::string header,
+                  std::array<size_t, 3> dimensions,
+                  std::array<T, 3> size,
+                  std::shared_ptr<const T> values,
+                  size_t count)
+            : header_(std::move(header)), dimensions_(dimensions), size_(size), values_(std::move(values)), count_(count){};
+
+        /**
+         * @brief Constructor for field data stored in an adaptive octree
+         * @param header     Human readable header string to identify file content, program version used for generation etc.
+         * @param size       Physical extent of the field in each dimension, given in internal units
+         * @param octree     Shared pointer to the octree holding the field, defining the number of bins in each coordinate
+         */
+        FieldData(std::string header, std::array<T, 3> size, std::shared_ptr<const FieldOctree<T>> octree)
+            : header_(std::move(header)), dimensions_(octree->getDimensions()), size_(size), octree_(std::move(octree)) {
+            set_values_from_octree();
+        };
 
         /**
          * @brief Function to obtain the header (human readbale content description) of the field data
@@ -100,8 +140,37 @@ namespace allpix {
         /**
          * @brief Member to access the actual field data
          * @return shared pointer to the flat vector of field data
+         * @note For field data which is not stored in a vector, such as memory-mapped files, a copy of the data is returned.
+         * Use \ref getValues to access the data without copying. Adaptive fields are expanded onto their regular grid.
+         */
+        std::shared_ptr<std::vector<T>> getData() const {
+            if(octree_ != nullptr) {
+                return std::make_shared<std::vector<T>>(octree_->expand());
+            }
+            if(data_ == nullptr && values_ != nullptr) {
+                return std::make_shared<std::vector<T>>(values_.get(), values_.get() + count_);
+            }
+            return data_;
+        }
+
+        /**
+         * @brief Member to access the field data without copying, independent of where it is stored
+         * @return shared pointer to the first value of the flat field data
+         * @note For adaptive fields, these are the values of the octree leaves
+         */
+        std::shared_ptr<const T> getValues() const { return values_; }
+
+        /**
+         * @brief Member to get the number of values of the flat field data
+         * @return Number of values
          */
-        std::shared_ptr<std::vector<T>> getData() const { return data_; }
+        size_t getNumberOfValues() const { return count_; }
+
+        /**
+         * @brief Member to access the adaptive octree holding the field
+         * @return shared pointer to the octree, or a null pointer if the field is stored on a regular grid
+         */
+        std::shared_ptr<const FieldOctree<T>> getOctree() const { return octree_; }
 
         /**
          * @brief get the dimensionality of the configured field in the x-y plane, e.g whether it is defined in 1D, 2D or 3D.
@@ -115,25 +184,129 @@ namespace allpix {
         }
 
     private:
+        void set_values_from_data() {
+            values_ = (data_ != nullptr ? std::shared_ptr<const T>(data_, data_->data()) : nullptr);
+            count_ = (data_ != nullptr ? data_->size() : 0);
+        }
+
+        void set_values_from_octree() {
+            values_ = std::shared_ptr<const T>(octree_, octree_->getValues().data());
+            count_ = octree_->getValues().size();
+        }
+
         std::string header_;
         std::array<size_t, 3> dimensions_{};
         std::array<T, 3> size_{};
         std::shared_ptr<std::vector<T>> data_;
 
+        // View of the field data, either pointing into data_ or to externally owned memory
+        std::shared_ptr<const T> values_;
+        size_t count_{};
+
+        // Adaptive octree holding the field, if not stored on a regular grid
+        std::shared_ptr<const FieldOctree<T>> octree_;
+
+        /**
+         * @brief Metadata serialized in front of the payload, used to measure the offset of the payload in the archive
+         */
+        struct Preamble {
+            const FieldData<T>* field;
+            std::uint64_t nodes;
+            std::uint64_t count;
+
+            template <class Archive> void save(Archive& archive, std::uint32_t const) const {
+                field->save_preamble(archive, nodes, count, 0);
+            }
+        };
+
+        template <class Archive>
+        void save_preamble(Archive& archive, std::uint64_t nodes, std::uint64_t count, std::uint64_t padding) const {
+            archive(header_);
+            archive(dimensions_);
+            archive(size_);
+            archive(nodes);
+            archive(count);
+            archive(padding);
+        }
+
+        /**
+         * @brief Number of padding bytes required to align the payload of an APF file
+         * @param nodes Number of octree nodes
+         * @param count Number of values in the payload
+         * @return Number of padding bytes written before the payload
+         *
+         * The preamble is written to a probe archive of the same type, which also writes the archive flags and the class
+         * version in front of it, such that the offset follows the archive layout instead of being calculated by hand.
+         */
+        template <class Archive> std::uint64_t get_payload_padding(std::uint64_t nodes, std::uint64_t count) const {
+            std::ostringstream probe;
+            {
+                Archive archive(probe);
+                archive(Preamble{this, nodes, count});
+            }
+            auto offset = static_cast<std::uint64_t>(probe.tellp());
+            return (APF_PAYLOAD_ALIGNMENT - offset % APF_PAYLOAD_ALIGNMENT) % APF_PAYLOAD_ALIGNMENT;
+        }
+
         friend class cereal::access;
 
-        // Versioned serialization function:
-        template <class Archive> void serialize(Archive& archive, std::uint32_t const version) {
-            // For now, we only know one version of this file type:
-            if(version != 1) {
+        // Versioned serialization functions:
+        template <class Archive> void save(Archive& archive, std::uint32_t const version) const {
+            // Number of octree nodes, zero for fields on a regular grid:
+            std::uint64_t nodes = (octree_ != nullptr ? octree_->getNodes().size() : 0);
+
+            // Pad the payload to the alignment boundary and write the values as contiguous block:
+            std::uint64_t count = count_;
+            std::uint64_t padding = get_payload_padding<Archive>(nodes, count);
+            save_preamble(archive, nodes, count, padding);
+            std::vector<std::uint8_t> zeros(padding, 0);
+            archive(cereal::binary_data(zeros.data(), zeros.size()));
+            archive(cereal::binary_data(values_.get(), count_ * sizeof(T)));
+
+            // The octree nodes follow the values of its leaves:
+            if(octree_ != nullptr) {
+                archive(cereal::binary_data(octree_->getNodes().data(), nodes * sizeof(std::int32_t)));
+            }
+            (void)version;
+        }
+
+        template <class Archive> void load(Archive& archive, std::uint32_t const version) {
+            if(version < 1 || version > 3) {
                 throw std::runtime_error("unknown format version " + std::to_string(version));
             }
 
-            // (De-) Serialize the data:
             archive(header_);
             archive(dimensions_);
             archive(size_);
-            archive(data_);
+
+            if(version == 1) {
+                archive(data_);
+                set_values_from_data();
+                return;
+            }
+
+            std::uint64_t nodes = 0, count = 0, padding = 0;
+            if(version >= 3) {
+                archive(nodes);
+            }
+            archive(count);
+            archive(padding);
+            std::vector<std::uint8_t> zeros(padding);
+            archive(cereal::binary_data(zeros.data(), zeros.size()));
+            data_ = std::make_shared<std::vector<T>>(count);
+            archive(cereal::binary_data(data_->data(), count * sizeof(T)));
+
+            if(nodes == 0) {
+                set_values_from_data();
+                return;
+            }
+
+            // Read the octree nodes and move the values into the octree:
+            std::vector<std::int32_t> octree_nodes(nodes);
+            archive(cereal::binary_data(octree_nodes.data(), nodes * sizeof(std::int32_t)));
+            octree_ = std::make_shared<const FieldOctree<T>>(dimensions_, std::move(octree_nodes), std::move(*data_));
+            data_.reset();
+            set_values_from_octree();
         }
     };
 } // namespace allpix
@@ -161,8 +334,10 @@ namespace allpix {
      * @brief Class to parse Allpix Squared field data from files
      *
      * This class can be used to deserialize and parse FieldData objects from files of different format. The FieldData
-     * objects read from file are cached, and a cache hit will be returned when trying to re-read a file with the same
-     * canonical path.
+     * objects read from file are cached in a cache shared by all parsers of the process, and a cache hit will be returned
+     * when trying to re-read a file with the same canonical path, field quantity and units. The cache holds the field data
+     * for the lifetime of the process, such that all detectors and modules reading the same file share one copy. APF files
+     * with aligned payload are memory-mapped read-only instead of being copied into memory.
      */
     template <typename T = double> class FieldParser {
     public:
@@ -192,17 +367,21 @@ namespace allpix {
 
             auto path = std::filesystem::canonical(file_name);
 
-            // Search in cache
-            auto iter = field_map_.find(path);
+            // Deduce the file format
+            auto file_type = guess_file_type(path);
+            LOG(DEBUG) << "Assuming file type \"" << (file_type == FileType::APF ? "APF" : "INIT") << "\"";
+
+            // APF files are stored in internal units, their cache entries do not depend on the requested units
+            auto key = std::make_tuple(path, N_, (file_type == FileType::APF ? std::string() : units));
+
+            // Search in cache, the lock is held while parsing to avoid reading the same file twice
+            std::lock_guard<std::mutex> lock(cache_mutex_);
+            auto iter = field_map_.find(key);
             if(iter != field_map_.end()) {
                 LOG(INFO) << "Using cached field data";
                 return iter->second;
             }
 
-            // Deduce the file format
-            auto file_type = guess_file_type(path);
-            LOG(DEBUG) << "Assuming file type \"" << (file_type == FileType::APF ? "APF" : "INIT") << "\"";
-
             FieldData<T> field_data;
             switch(file_type) {
             case FileType::INIT:
@@ -223,7 +402,7 @@ namespace allpix {
             }
 
             // Store the parsed field data for further reference:
-            field_map_[path] = field_data;
+            field_map_[key] = field_data;
             return field_data;
         }
 
@@ -264,6 +443,14 @@ namespace allpix {
          * @param file_name  File name (as canonical path) of the input file to be parsed
          */
         FieldData<T> parse_apf_file(const std::filesystem::path& file_name) {
+            // Attempt to memory-map the payload directly:
+            auto mapped_data = map_apf_file(file_name);
+            if(mapped_data.has_value()) {
+                LOG(DEBUG) << "Memory-mapped field data from APF file";
+                return mapped_data.value();
+            }
+            LOG(DEBUG) << "APF file cannot be memory-mapped, reading field data from file";
+
             std::ifstream file(file_name, std::ios::binary);
             FieldData<T> field_data;
 
@@ -275,15 +462,84 @@ namespace allpix {
                 throw std::runtime_error(e.what());
             }
 
-            // Check that we have the right number of vector entries
+            // Check that we have the right number of vector entries, either on the grid or in the leaves of the octree
             auto dimensions = field_data.getDimensions();
-            if(field_data.getData()->size() != dimensions[0] * dimensions[1] * dimensions[2] * N_) {
+            auto octree = field_data.getOctree();
+            if(octree != nullptr ? field_data.getNumberOfValues() != octree->getNumberOfLeaves() * N_
+                                 : field_data.getNumberOfValues() != dimensions[0] * dimensions[1] * dimensions[2] * N_) {
                 throw std::runtime_error("invalid data");
             }
 
             return field_data;
         }
 
+        /**
+         * @brief Function to memory-map the payload of an APF file without copying it
+         * @param file_name  File name (as canonical path) of the input file to be mapped
+         * @return Field data referencing the mapped file, or nothing if the file cannot be mapped
+         *
+         * Only files of APF version 2 or later, which have been written in the byte order of this machine and with aligned
+         * payload, can be mapped. Adaptive fields are not mapped since they are read into the octree. The file is mapped
+         * read-only and unmapped once the last reference to the data is gone.
+         */
+        std::optional<FieldData<T>> map_apf_file(const std::filesystem::path& file_name) const {
+            std::shared_ptr<const MappedFile> mapping;
+            try {
+                mapping = std::make_shared<const MappedFile>(file_name.string());
+            } catch(std::runtime_error&) {
+                return std::nullopt;
+            }
+            auto length = mapping->size();
+
+            // Read the archive header, bailing out on anything unexpected
+            size_t offset = 0;
+            auto read = [&](void* target, size_t bytes) {
+                if(offset + bytes > length) {
+                    return false;
+                }
+                std::memcpy(target, mapping->data() + offset, bytes);
+                offset += bytes;
+                return true;
+            };
+
+            std::uint8_t little_endian = 0;
+            std::uint32_t version = 0;
+            std::uint64_t header_length = 0;
+            const std::uint16_t probe = 1;
+            const bool host_little_endian = (*reinterpret_cast<const std::uint8_t*>(&probe) == 1);
+            if(!read(&little_endian, sizeof(little_endian)) || (little_endian == 1) != host_little_endian ||
+               !read(&version, sizeof(version)) || version < 2 || !read(&header_length, sizeof(header_length)) ||
+               offset + header_length > length) {
+                return std::nullopt;
+            }
+            std::string header(mapping->data() + offset, header_length);
+            offset += header_length;
+
+            std::array<std::uint64_t, 3> dimensions{};
+            std::array<T, 3> size{};
+            std::uint64_t nodes = 0, count = 0, padding = 0;
+            if(!read(dimensions.data(), sizeof(dimensions)) || !read(size.data(), sizeof(size)) ||
+               (version >= 3 && !read(&nodes, sizeof(nodes))) || nodes != 0 || !read(&count, sizeof(count)) ||
+               !read(&padding, sizeof(padding))) {
+                return std::nullopt;
+            }
+            offset += padding;
+            if(offset % alignof(T) != 0 || offset + count * sizeof(T) > length ||
+               count != dimensions[0] * dimensions[1] * dimensions[2] * N_) {
+                return std::nullopt;
+            }
+
+            // Hand out the payload, keeping the mapping alive:
+            std::shared_ptr<const T> values(mapping, reinterpret_cast<const T*>(mapping->data() + offset));
+            return FieldData<T>(std::move(header),
+                                {{static_cast<size_t>(dimensions[0]),
+                                  static_cast<size_t>(dimensions[1]),
+                                  static_cast<size_t>(dimensions[2])}},
+                                size,
+                                std::move(values),
+                                count);
+        }
+
         /**
          * @brief Helper function to compare potential units defined in the INIT file against the ones provided:
          * @param file_units Unit string read from the file
@@ -383,7 +639,11 @@ namespace allpix {
         }
 
         size_t N_;
-        std::map<std::filesystem::path, FieldData<T>> field_map_;
+
+        // Cache of field data shared by all parsers of the process, identified by file path, field quantity and units of
+        // INIT files
+        inline static std::map<std::tuple<std::filesystem::path, size_t, std::string>, FieldData<T>> field_map_;
+        inline static std::mutex cache_mutex_;
     };
 
     /**
@@ -422,7 +682,9 @@ namespace allpix {
             auto path = std::filesystem::weakly_canonical(file_name);
 
             auto dimensions = field_data.getDimensions();
-            if(field_data.getData()->size() != N_ * dimensions[0] * dimensions[1] * dimensions[2]) {
+            auto octree = field_data.getOctree();
+            if(octree != nullptr ? field_data.getNumberOfValues() != N_ * octree->getNumberOfLeaves()
+                                 : field_data.getNumberOfValues() != N_ * dimensions[0] * dimensions[1] * dimensions[2]) {
                 throw std::runtime_error("invalid field dimensions");
             }
 
@@ -493,9 +755,13 @@ namespace allpix {
             file << dimensions[0] << " " << dimensions[1] << " " << dimensions[2] << " "; // Field grid dimensions (x, y, z)
             file << "0.0" << std::endl;                                                   // Unused
 
-            // Write the data block:
-            auto data = field_data.getData();
-            auto max_points = data->size() / N_;
+            // Write the data block, adaptive fields are expanded onto their regular grid:
+            auto data = field_data.getValues();
+            if(field_data.getOctree() != nullptr) {
+                auto expanded = field_data.getData();
+                data = std::shared_ptr<const T>(expanded, expanded->data());
+            }
+            auto max_points = dimensions[0] * dimensions[1] * dimensions[2];
 
             for(size_t xind = 0; xind < dimensions[0]; ++xind) {
                 for(size_t yind = 0; yind < dimensions[1]; ++yind) {
@@ -506,8 +772,8 @@ namespace allpix {
                         // Vector or scalar field:
                         for(size_t j = 0; j < N_; j++) {
                             file << " "
-                                 << Units::convert(data->at(xind * dimensions[1] * dimensions[2] * N_ +
-                                                            yind * dimensions[2] * N_ + zind * N_ + j),
+                                 << Units::convert(data.get()[xind * dimensions[1] * dimensions[2] * N_ +
+                                                              yind * dimensions[2] * N_ + zind * N_ + j],
                                                    units);
                         }
                         // End this line
@@ -0,0 +1,758 @@
+/**
+ * @file
+ * @brief Utility to evaluate mathematical expressions from the configuration as compiled programs
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ALLPIX_FORMULA_H
+#define ALLPIX_FORMULA_H
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <TFormula.h>
+#include <TMath.h>
+
+#include "core/utils/log.h"
+
+namespace allpix {
+
+    /**
+     * @brief Mathematical expression evaluated as a compiled program, with ROOT::TFormula as fallback
+     *
+     * The expression is compiled once into a compact stack program with constant sub-expressions folded. Evaluating the
+     * program does not allocate and only reads the formula, such that it can be shared between threads. The supported
+     * syntax covers the usual ROOT::TFormula expressions:
+     * - the variables x, y, z and t, or x[0] to x[3]
+     * - numbered parameters [0], [1], ...
+     * - arithmetic, comparison and logical operators, ^ for exponentiation and the conditional operator ?:
+     * - the common functions of the C++ standard library, also with std:: prefix, and their TMath:: equivalents
+     * - the constants pi, e, sqrt2, ln10, true and false
+     *
+     * Expressions using any other syntax, such as named parameters or predefined ROOT functions, are evaluated with
+     * ROOT::TFormula instead. This also applies to divisions of integer literals, which are evaluated as integer divisions.
+     */
+    class Formula {
+    public:
+        /**
+         * @brief Construct a formula from an expression
+         * @param name Name of the formula
+         * @param expression Expression to evaluate
+         * @param compile Compile the expression if possible, otherwise always evaluate it with ROOT::TFormula
+         */
+        Formula(const std::string& name, const std::string& expression, bool compile = true) {
+            if(compile) {
+                try {
+                    Compiler(expression, *this).run();
+                    LOG(DEBUG) << "Compiled function \"" << expression << "\" into " << program_.size() << " instructions";
+                    return;
+                } catch(const std::invalid_argument& error) {
+                    program_.clear();
+                    parameters_.clear();
+                    dimensions_ = 0;
+                    LOG(DEBUG) << "Cannot compile function \"" << expression << "\" (" << error.what()
+                               << "), evaluating it with ROOT::TFormula";
+                }
+            }
+            fallback_ = std::make_unique<TFormula>(name.c_str(), expression.c_str(), false);
+        }
+
+        /**
+         * @brief Check if the expression is valid
+         */
+        bool isValid() const { return fallback_ == nullptr || fallback_->IsValid(); }
+
+        /**
+         * @brief Check if the expression has been compiled or is evaluated with ROOT::TFormula
+         */
+        bool isCompiled() const { return fallback_ == nullptr; }
+
+        /**
+         * @brief Get the number of dimensions of the expression
+         * @return Index of the highest variable used plus one
+         */
+        size_t getNDimensions() const {
+            return (fallback_ == nullptr ? dimensions_ : static_cast<size_t>(fallback_->GetNdim()));
+        }
+
+        /**
+         * @brief Get the number of parameters of the expression
+         */
+        size_t getNParameters() const {
+            return (fallback_ == nullptr ? parameters_.size() : static_cast<size_t>(fallback_->GetNpar()));
+        }
+
+        /**
+         * @brief Set the value of a parameter
+         * @param n Index of the parameter
+         * @param value Value of the parameter
+         */
+        void setParameter(size_t n, double value) {
+            if(fallback_ != nullptr) {
+                fallback_->SetParameter(static_cast<int>(n), value);
+            } else {
+                parameters_.at(n) = value;
+            }
+        }
+
+        /**
+         * @brief Evaluate the expression
+         * @param x First variable
+         * @param y Second variable
+         * @param z Third variable
+         * @param t Fourth variable
+         * @return Value of the expression
+         */
+        double eval(double x, double y = 0, double z = 0, double t = 0) const {
+            if(fallback_ != nullptr) {
+                return fallback_->Eval(x, y, z, t);
+            }
+
+            const std::array<double, 4> variables{x, y, z, t};
+            std::array<double, max_stack> stack; // NOLINT
+            size_t top = 0;
+            for(const auto& instruction : program_) {
+                switch(instruction.op) {
+                case Op::CONSTANT:
+                    stack[top++] = instruction.value;
+                    break;
+                case Op::VARIABLE:
+                    stack[top++] = variables[instruction.index];
+                    break;
+                case Op::PARAMETER:
+                    stack[top++] = parameters_[instruction.index];
+                    break;
+                default:
+                    top -= arity(instruction.op) - 1;
+                    stack[top - 1] = apply(instruction.op, &stack[top - 1]);
+                    break;
+                }
+            }
+            return stack[0];
+        }
+
+    private:
+        // Maximum depth of the stack of intermediate values
+        static constexpr size_t max_stack = 32;
+
+        /**
+         * @brief Operations of the compiled program
+         */
+        enum class Op {
+            CONSTANT,
+            VARIABLE,
+            PARAMETER,
+            NEGATE,
+            NOT,
+            ADD,
+            SUBTRACT,
+            MULTIPLY,
+            DIVIDE,
+            POWER,
+            LESS,
+            LESS_EQUAL,
+            GREATER,
+            GREATER_EQUAL,
+            EQUAL,
+            NOT_EQUAL,
+            AND,
+            OR,
+            SELECT,
+            EXP,
+            LOG,
+            LOG10,
+            SQRT,
+            CBRT,
+            SQUARE,
+            SIN,
+            COS,
+            TAN,
+            ASIN,
+            ACOS,
+            ATAN,
+            ATAN2,
+            SINH,
+            COSH,
+            TANH,
+            ABS,
+            ERF,
+            ERFC,
+            FLOOR,
+            CEIL,
+            MIN,
+            MAX,
+        };
+
+        /**
+         * @brief Single instruction of the compiled program
+         */
+        struct Instruction {
+            Op op;
+            double value;
+            size_t index;
+        };
+
+        /**
+         * @brief Number of values an operation takes from the stack
+         */
+        static size_t arity(Op op) {
+            switch(op) {
+            case Op::CONSTANT:
+            case Op::VARIABLE:
+            case Op::PARAMETER:
+                return 0;
+            case Op::ADD:
+            case Op::SUBTRACT:
+            case Op::MULTIPLY:
+            case Op::DIVIDE:
+            case Op::POWER:
+            case Op::LESS:
+            case Op::LESS_EQUAL:
+            case Op::GREATER:
+            case Op::GREATER_EQUAL:
+            case Op::EQUAL:
+            case Op::NOT_EQUAL:
+            case Op::AND:
+            case Op::OR:
+            case Op::ATAN2:
+            case Op::MIN:
+            case Op::MAX:
+                return 2;
+            case Op::SELECT:
+                return 3;
+            default:
+                return 1;
+            }
+        }
+
+        /**
+         * @brief Apply an operation to its arguments
+         */
+        static double apply(Op op, const double* a) {
+            switch(op) {
+            case Op::NEGATE:
+                return -a[0];
+            case Op::NOT:
+                return (a[0] == 0 ? 1. : 0.);
+            case Op::ADD:
+                return a[0] + a[1];
+            case Op::SUBTRACT:
+                return a[0] - a[1];
+            case Op::MULTIPLY:
+                return a[0] * a[1];
+            case Op::DIVIDE:
+                return a[0] / a[1];
+            case Op::POWER:
+                return std::pow(a[0], a[1]);
+            case Op::LESS:
+                return static_cast<double>(a[0] < a[1]);
+            case Op::LESS_EQUAL:
+                return static_cast<double>(a[0] <= a[1]);
+            case Op::GREATER:
+                return static_cast<double>(a[0] > a[1]);
+            case Op::GREATER_EQUAL:
+                return static_cast<double>(a[0] >= a[1]);
+            case Op::EQUAL:
+                return static_cast<double>(a[0] == a[1]);
+            case Op::NOT_EQUAL:
+                return static_cast<double>(a[0] != a[1]);
+            case Op::AND:
+                return static_cast<double>(a[0] != 0 && a[1] != 0);
+            case Op::OR:
+                return static_cast<double>(a[0] != 0 || a[1] != 0);
+            case Op::SELECT:
+                return (a[0] != 0 ? a[1] : a[2]);
+            case Op::EXP:
+                return std::exp(a[0]);
+            case Op::LOG:
+                return std::log(a[0]);
+            case Op::LOG10:
+                return std::log10(a[0]);
+            case Op::SQRT:
+                return std::sqrt(a[0]);
+            case Op::CBRT:
+                return std::cbrt(a[0]);
+            case Op::SQUARE:
+                return a[0] * a[0];
+            case Op::SIN:
+                return std::sin(a[0]);
+            case Op::COS:
+                return std::cos(a[0]);
+            case Op::TAN:
+                return std::tan(a[0]);
+            case Op::ASIN:
+                return std::asin(a[0]);
+            case Op::ACOS:
+                return std::acos(a[0]);
+            case Op::ATAN:
+                return std::atan(a[0]);
+            case Op::ATAN2:
+                return std::atan2(a[0], a[1]);
+            case Op::SINH:
+                return std::sinh(a[0]);
+            case Op::COSH:
+                return std::cosh(a[0]);
+            case Op::TANH:
+                return std::tanh(a[0]);
+            case Op::ABS:
+                return std::fabs(a[0]);
+            case Op::ERF:
+                return std::erf(a[0]);
+            case Op::ERFC:
+                return std::erfc(a[0]);
+            case Op::FLOOR:
+                return std::floor(a[0]);
+            case Op::CEIL:
+                return std::ceil(a[0]);
+            case Op::MIN:
+                return std::min(a[0], a[1]);
+            case Op::MAX:
+                return std::max(a[0], a[1]);
+            default:
+                return std::numeric_limits<double>::quiet_NaN();
+            }
+        }
+
+        /**
+         * @brief Recursive descent parser emitting the program of an expression in postfix order
+         *
+         * Every parsing method returns whether the parsed sub-expression is an integer, to detect integer divisions. Syntax
+         * which is not supported throws an std::invalid_argument.
+         */
+        class Compiler {
+        public:
+            Compiler(std::string_view text, Formula& formula) : text_(text), formula_(formula) {}
+
+            void run() {
+                parse_conditional();
+                skip_space();
+                if(position_ != text_.size()) {
+                    fail("unexpected character");
+                }
+            }
+
+        private:
+            [[noreturn]] void fail(const std::string& reason) const {
+                throw std::invalid_argument(reason + " at position " + std::to_string(position_));
+            }
+
+            void skip_space() {
+                while(position_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[position_])) != 0) {
+                    ++position_;
+                }
+            }
+
+            bool accept(std::string_view token) {
+                skip_space();
+                if(text_.substr(position_, token.size()) == token) {
+                    position_ += token.size();
+                    return true;
+                }
+                return false;
+            }
+
+            void expect(std::string_view token) {
+                if(!accept(token)) {
+                    fail("expected \"" + std::string(token) + "\"");
+                }
+            }
+
+            /**
+             * @brief Append an instruction to the program, folding operations on constant arguments
+             */
+            void emit(Op op, double value = 0, size_t index = 0) {
+                auto& program = formula_.program_;
+                auto count = arity(op);
+                auto constant = [](const Instruction& instruction) { return instruction.op == Op::CONSTANT; };
+                if(count > 0 && std::all_of(program.end() - static_cast<std::ptrdiff_t>(count), program.end(), constant)) {
+                    std::array<double, 3> arguments{};
+                    for(size_t i = 0; i < count; ++i) {
+                        arguments[i] = program[program.size() - count + i].value;
+                    }
+                    program.resize(program.size() - count);
+                    depth_ -= count;
+                    emit(Op::CONSTANT, apply(op, arguments.data()));
+                    return;
+                }
+
+                // Squares are frequent in physics models and much cheaper than a call to std::pow
+                if(op == Op::POWER && program.back().op == Op::CONSTANT && program.back().value == 2) {
+                    program.pop_back();
+                    depth_--;
+                    emit(Op::SQUARE);
+                    return;
+                }
+
+                program.push_back({op, value, index});
+                depth_ = depth_ + 1 - count;
+                if(depth_ > max_stack) {
+                    fail("expression nested too deeply");
+                }
+            }
+
+            bool parse_conditional() {
+                auto integral = parse_or();
+                if(accept("?")) {
+                    auto first = parse_conditional();
+                    expect(":");
+                    auto second = parse_conditional();
+                    emit(Op::SELECT);
+                    return first && second;
+                }
+                return integral;
+            }
+
+            bool parse_or() {
+                auto integral = parse_and();
+                while(accept("||")) {
+                    parse_and();
+                    emit(Op::OR);
+                    integral = true;
+                }
+                return integral;
+            }
+
+            bool parse_and() {
+                auto integral = parse_equality();
+                while(accept("&&")) {
+                    parse_equality();
+                    emit(Op::AND);
+                    integral = true;
+                }
+                return integral;
+            }
+
+            bool parse_equality() {
+                auto integral = parse_relational();
+                while(true) {
+                    if(accept("==")) {
+                        parse_relational();
+                        emit(Op::EQUAL);
+                    } else if(accept("!=")) {
+                        parse_relational();
+                        emit(Op::NOT_EQUAL);
+                    } else {
+                        return integral;
+                    }
+                    integral = true;
+                }
+            }
+
+            bool parse_relational() {
+                auto integral = parse_additive();
+                while(true) {
+                    if(accept("<=")) {
+                        parse_additive();
+                        emit(Op::LESS_EQUAL);
+                    } else if(accept(">=")) {
+                        parse_additive();
+                        emit(Op::GREATER_EQUAL);
+                    } else if(accept("<")) {
+                        parse_additive();
+                        emit(Op::LESS);
+                    } else if(accept(">")) {
+                        parse_additive();
+                        emit(Op::GREATER);
+                    } else {
+                        return integral;
+                    }
+                    integral = true;
+                }
+            }
+
+            bool parse_additive() {
+                auto integral = parse_multiplicative();
+                while(true) {
+                    if(accept("+")) {
+                        auto right = parse_multiplicative();
+                        emit(Op::ADD);
+                        integral = integral && right;
+                    } else if(accept("-")) {
+                        auto right = parse_multiplicative();
+                        emit(Op::SUBTRACT);
+                        integral = integral && right;
+                    } else {
+                        return integral;
+                    }
+                }
+            }
+
+            bool parse_multiplicative() {
+                auto integral = parse_unary();
+                while(true) {
+                    if(accept("**")) {
+                        fail("unsupported operator \"**\"");
+                    } else if(accept("*")) {
+                        auto right = parse_unary();
+                        emit(Op::MULTIPLY);
+                        integral = integral && right;
+                    } else if(accept("/")) {
+                        auto right = parse_unary();
+                        if(integral && right) {
+                            fail("integer division");
+                        }
+                        emit(Op::DIVIDE);
+                        integral = false;
+                    } else {
+                        return integral;
+                    }
+                }
+            }
+
+            bool parse_unary() {
+                if(accept("-")) {
+                    auto integral = parse_unary();
+                    emit(Op::NEGATE);
+                    return integral;
+                }
+                if(accept("+")) {
+                    return parse_unary();
+                }
+                if(accept("!")) {
+                    parse_unary();
+                    emit(Op::NOT);
+                    return true;
+                }
+                return parse_power();
+            }
+
+            bool parse_power() {
+                auto integral = parse_primary();
+                if(accept("^")) {
+                    parse_unary();
+                    emit(Op::POWER);
+                    return false;
+                }
+                return integral;
+            }
+
+            bool parse_primary() {
+                skip_space();
+                if(position_ == text_.size()) {
+                    fail("unexpected end of expression");
+                }
+                auto character = text_[position_];
+                if(std::isdigit(static_cast<unsigned char>(character)) != 0 || character == '.') {
+                    return parse_number();
+                }
+                if(accept("(")) {
+                    auto integral = parse_conditional();
+                    expect(")");
+                    return integral;
+                }
+                if(accept("[")) {
+                    auto index = parse_index();
+                    expect("]");
+                    auto& parameters = formula_.parameters_;
+                    parameters.resize(std::max(parameters.size(), index + 1));
+                    emit(Op::PARAMETER, 0, index);
+                    return false;
+                }
+                if(std::isalpha(static_cast<unsigned char>(character)) != 0 || character == '_') {
+                    return parse_identifier();
+                }
+                fail("unexpected character");
+            }
+
+            bool parse_number() {
+                auto begin = position_;
+                auto digits = [&]() {
+                    while(position_ < text_.size() && std::isdigit(static_cast<unsigned char>(text_[position_])) != 0) {
+                        ++position_;
+                    }
+                };
+                digits();
+                auto integral = true;
+                if(position_ < text_.size() && text_[position_] == '.') {
+                    ++position_;
+                    digits();
+                    integral = false;
+                }
+                if(position_ < text_.size() && (text_[position_] == 'e' || text_[position_] == 'E')) {
+                    ++position_;
+                    if(position_ < text_.size() && (text_[position_] == '+' || text_[position_] == '-')) {
+                        ++position_;
+                    }
+                    digits();
+                    integral = false;
+                }
+                if(position_ < text_.size() &&
+                   (std::isalnum(static_cast<unsigned char>(text_[position_])) != 0 || text_[position_] == '_')) {
+                    fail("unsupported number format");
+                }
+
+                auto token = std::string(text_.substr(begin, position_ - begin));
+                char* end = nullptr;
+                auto value = std::strtod(token.c_str(), &end);
+                if(end != token.c_str() + token.size()) {
+                    fail("invalid number \"" + token + "\"");
+                }
+                emit(Op::CONSTANT, value);
+                return integral;
+            }
+
+            size_t parse_index() {
+                skip_space();
+                auto begin = position_;
+                size_t index = 0;
+                while(position_ < text_.size() && std::isdigit(static_cast<unsigned char>(text_[position_])) != 0) {
+                    index = 10 * index + static_cast<size_t>(text_[position_] - '0');
+                    ++position_;
+                }
+                if(position_ == begin || position_ - begin > 3) {
+                    fail("unsupported index");
+                }
+                return index;
+            }
+
+            bool parse_identifier() {
+                auto begin = position_;
+                while(position_ < text_.size()) {
+                    auto character = static_cast<unsigned char>(text_[position_]);
+                    if(std::isalnum(character) != 0 || character == '_') {
+                        ++position_;
+                    } else if(text_.substr(position_, 2) == "::") {
+                        position_ += 2;
+                    } else {
+                        break;
+                    }
+                }
+                auto name = text_.substr(begin, position_ - begin);
+
+                // Function calls
+                if(accept("(")) {
+                    size_t arguments = 0;
+                    if(!accept(")")) {
+                        do {
+                            parse_conditional();
+                            ++arguments;
+                        } while(accept(","));
+                        expect(")");
+                    }
+                    return parse_function(name, arguments);
+                }
+
+                // Variables
+                if(name == "x" || name == "y" || name == "z" || name == "t") {
+                    size_t index = (name == "t" ? 3 : static_cast<size_t>(name.front() - 'x'));
+                    if(name == "x" && accept("[")) {
+                        index = parse_index();
+                        expect("]");
+                        if(index > 3) {
+                            fail("unsupported variable");
+                        }
+                    }
+                    formula_.dimensions_ = std::max(formula_.dimensions_, index + 1);
+                    emit(Op::VARIABLE, 0, index);
+                    return false;
+                }
+
+                // Constants
+                if(name == "true" || name == "false") {
+                    emit(Op::CONSTANT, (name == "true" ? 1. : 0.));
+                    return true;
+                }
+                if(name == "pi") {
+                    emit(Op::CONSTANT, TMath::Pi());
+                } else if(name == "e") {
+                    emit(Op::CONSTANT, TMath::E());
+                } else if(name == "sqrt2") {
+                    emit(Op::CONSTANT, TMath::Sqrt2());
+                } else if(name == "ln10") {
+                    emit(Op::CONSTANT, TMath::Ln10());
+                } else {
+                    fail("unsupported identifier \"" + std::string(name) + "\"");
+                }
+                return false;
+            }
+
+            bool parse_function(std::string_view name, size_t arguments) {
+                if(arguments == 0) {
+                    if(name == "TMath::Pi") {
+                        emit(Op::CONSTANT, TMath::Pi());
+                    } else if(name == "TMath::E") {
+                        emit(Op::CONSTANT, TMath::E());
+                    } else {
+                        fail("unsupported function \"" + std::string(name) + "\"");
+                    }
+                    return false;
+                }
+
+                struct Function {
+                    std::string_view name;
+                    std::string_view root_name;
+                    Op op;
+                    size_t arguments;
+                };
+                static constexpr std::array<Function, 27> functions{{
+                    {"exp", "Exp", Op::EXP, 1},       {"log", "Log", Op::LOG, 1},
+                    {"log10", "Log10", Op::LOG10, 1}, {"sqrt", "Sqrt", Op::SQRT, 1},
+                    {"cbrt", "", Op::CBRT, 1},        {"", "Sq", Op::SQUARE, 1},
+                    {"sin", "Sin", Op::SIN, 1},       {"cos", "Cos", Op::COS, 1},
+                    {"tan", "Tan", Op::TAN, 1},       {"asin", "ASin", Op::ASIN, 1},
+                    {"acos", "ACos", Op::ACOS, 1},    {"atan", "ATan", Op::ATAN, 1},
+                    {"atan2", "ATan2", Op::ATAN2, 2}, {"sinh", "SinH", Op::SINH, 1},
+                    {"cosh", "CosH", Op::COSH, 1},    {"tanh", "TanH", Op::TANH, 1},
+                    {"fabs", "Abs", Op::ABS, 1},      {"abs", "", Op::ABS, 1},
+                    {"erf", "Erf", Op::ERF, 1},       {"erfc", "Erfc", Op::ERFC, 1},
+                    {"floor", "Floor", Op::FLOOR, 1}, {"ceil", "Ceil", Op::CEIL, 1},
+                    {"pow", "Power", Op::POWER, 2},   {"fmin", "Min", Op::MIN, 2},
+                    {"fmax", "Max", Op::MAX, 2},      {"min", "", Op::MIN, 2},
+                    {"max", "", Op::MAX, 2},
+                }};
+
+                // Standard library functions can be used with and without namespace, ROOT functions require it
+                std::string_view root_prefix = "TMath::";
+                std::string_view std_prefix = "std::";
+                auto is_root = (name.substr(0, root_prefix.size()) == root_prefix);
+                if(is_root) {
+                    name.remove_prefix(root_prefix.size());
+                } else if(name.substr(0, std_prefix.size()) == std_prefix) {
+                    name.remove_prefix(std_prefix.size());
+                }
+                if(!name.empty()) {
+                    for(const auto& function : functions) {
+                        if(name == (is_root ? function.root_name : function.name)) {
+                            check_arguments(name, arguments, function.arguments);
+                            emit(function.op);
+                            return false;
+                        }
+                    }
+                }
+                fail("unsupported function \"" + std::string(name) + "\"");
+            }
+
+            void check_arguments(std::string_view name, size_t arguments, size_t expected) const {
+                if(arguments != expected) {
+                    fail("function \"" + std::string(name) + "\" takes " + std::to_string(expected) + " arguments");
+                }
+            }
+
+            std::string_view text_;
+            size_t position_{};
+            size_t depth_{};
+            Formula& formula_;
+        };
+
+        std::vector<Instruction> program_;
+        std::vector<double> parameters_;
+        size_t dimensions_{};
+        std::unique_ptr<TFormula> fallback_;
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_FORMULA_H */
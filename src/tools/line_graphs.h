@@ -33,19 +33,52 @@ namespace allpix {
         using OutputPlotPoints = std::vector<
             std::pair<std::tuple<double, unsigned int, CarrierType, CarrierState>, std::vector<ROOT::Math::XYZPoint>>>;
 
+        /**
+         * @brief Plot settings of a module, parsed once from its configuration before processing events
+         */
+        struct Settings {
+            Settings() = default;
+
+            /**
+             * @brief Obtain handles to all plot settings from a module configuration
+             * @param config Configuration object used for the module instance
+             */
+            explicit Settings(const Configuration& config)
+                : theta(config.getHandle<double>("output_plots_theta")), phi(config.getHandle<double>("output_plots_phi")),
+                  use_pixel_units(config.getHandle<bool>("output_plots_use_pixel_units")),
+                  use_equal_scaling(config.getHandle<bool>("output_plots_use_equal_scaling", true)),
+                  align_pixels(config.getHandle<bool>("output_plots_align_pixels")),
+                  step(config.getHandle<long double>("output_plots_step", 0)),
+                  time_scaling(config.getHandle<long double>("output_animations_time_scaling", 1e9)),
+                  marker_size(config.getHandle<double>("output_animations_marker_size", 1)),
+                  color_markers(config.getHandle<bool>("output_animations_color_markers")),
+                  contour_max_scaling(config.getHandle<double>("output_animations_contour_max_scaling", 10)) {}
+
+            Configuration::Handle<double> theta;
+            Configuration::Handle<double> phi;
+            Configuration::Handle<bool> use_pixel_units;
+            Configuration::Handle<bool> use_equal_scaling;
+            Configuration::Handle<bool> align_pixels;
+            Configuration::Handle<long double> step;
+            Configuration::Handle<long double> time_scaling;
+            Configuration::Handle<double> marker_size;
+            Configuration::Handle<bool> color_markers;
+            Configuration::Handle<double> contour_max_scaling;
+        };
+
         /**
          * @brief Generate line graphs of charge carrier drift paths
          *
          * @param event_num Index for this event
          * @param module Module to generate plots for, used to create output files and to obtain ROOT directory
-         * @param config Configuration object used for this module instance
+         * @param settings Plot settings of this module instance
          * @param output_plot_points List of points cached for plotting
          * @param plotting_state State of charge carriers to be plotted. If state is set to CarrierState::UNKNOWN, all charge
          * carriers are plotted.
          */
         static void Create(uint64_t event_num, // NOLINT
                            Module* module,
-                           const Configuration& config,
+                           const Settings& settings,
                            const OutputPlotPoints& output_plot_points,
                            CarrierState plotting_state) {
 
@@ -55,7 +88,7 @@ namespace allpix {
             LOG(TRACE) << "Writing line graph for " << title << " charge carriers";
 
             auto [minX, maxX, minY, maxY, scale_x, scale_y, max_charge, total_charge, tot_point_cnt, start_time] =
-                get_plot_settings(model, config, output_plot_points);
+                get_plot_settings(model, settings, output_plot_points);
 
             // Use a histogram to create the underlying frame
             auto* histogram_frame =
@@ -78,14 +111,14 @@ namespace allpix {
                                                     1280,
                                                     1024);
             canvas->cd();
-            canvas->SetTheta(config.get<float>("output_plots_theta") * 180.0f / ROOT::Math::Pi());
-            canvas->SetPhi(config.get<float>("output_plots_phi") * 180.0f / ROOT::Math::Pi());
+            canvas->SetTheta(static_cast<float>(*settings.theta) * 180.0f / ROOT::Math::Pi());
+            canvas->SetPhi(static_cast<float>(*settings.phi) * 180.0f / ROOT::Math::Pi());
 
             // Draw the frame on the canvas
             histogram_frame->GetXaxis()->SetTitle(
-                (std::string("x ") + (config.get<bool>("output_plots_use_pixel_units") ? "(pixels)" : "(mm)")).c_str());
+                (std::string("x ") + (*settings.use_pixel_units ? "(pixels)" : "(mm)")).c_str());
             histogram_frame->GetYaxis()->SetTitle(
-                (std::string("y ") + (config.get<bool>("output_plots_use_pixel_units") ? "(pixels)" : "(mm)")).c_str());
+                (std::string("y ") + (*settings.use_pixel_units ? "(pixels)" : "(mm)")).c_str());
             histogram_frame->GetZaxis()->SetTitle("z (mm)");
             histogram_frame->Draw();
 
@@ -123,20 +156,20 @@ namespace allpix {
          *
          * @param event_num Index for this event
          * @param module Module to generate plots for, used to create output files and to obtain ROOT directory
-         * @param config Configuration object used for this module instance
+         * @param settings Plot settings of this module instance
          * @param output_plot_points List of points cached for plotting
          * carriers are plotted.
          */
         static void Animate(uint64_t event_num, // NOLINT
                             Module* module,
-                            const Configuration& config,
+                            const Settings& settings,
                             const OutputPlotPoints& output_plot_points) {
 
             LOG(TRACE) << "Writing animation for all charge carriers";
             auto model = module->getDetector()->getModel();
 
             auto [minX, maxX, minY, maxY, scale_x, scale_y, max_charge, total_charge, tot_point_cnt, start_time] =
-                get_plot_settings(model, config, output_plot_points);
+                get_plot_settings(model, settings, output_plot_points);
 
             // Use a histogram to create the underlying frame
             auto* histogram_frame =
@@ -161,10 +194,10 @@ namespace allpix {
             canvas->cd();
 
             // Change axis labels if close to zero or PI as they behave different here
-            if(std::fabs(config.get<double>("output_plots_theta") / (ROOT::Math::Pi() / 2.0) -
-                         std::round(config.get<double>("output_plots_theta") / (ROOT::Math::Pi() / 2.0))) < 1e-6 ||
-               std::fabs(config.get<double>("output_plots_phi") / (ROOT::Math::Pi() / 2.0) -
-                         std::round(config.get<double>("output_plots_phi") / (ROOT::Math::Pi() / 2.0))) < 1e-6) {
+            if(std::fabs(*settings.theta / (ROOT::Math::Pi() / 2.0) -
+                         std::round(*settings.theta / (ROOT::Math::Pi() / 2.0))) < 1e-6 ||
+               std::fabs(*settings.phi / (ROOT::Math::Pi() / 2.0) - std::round(*settings.phi / (ROOT::Math::Pi() / 2.0))) <
+                   1e-6) {
                 histogram_frame->GetXaxis()->SetLabelOffset(-0.1f);
                 histogram_frame->GetYaxis()->SetLabelOffset(-0.075f);
             } else {
@@ -239,8 +272,7 @@ namespace allpix {
 
             // Create animation of moving charges
             auto animation_time = static_cast<unsigned int>(
-                std::lround((Units::convert(config.get<long double>("output_plots_step"), "ms") / 10.0) *
-                            config.get<long double>("output_animations_time_scaling", 1e9)));
+                std::lround((Units::convert(*settings.step, "ms") / 10.0) * *settings.time_scaling));
             unsigned long plot_idx = 0;
             unsigned int point_cnt = 0;
             LOG_PROGRESS(INFO, module->getUniqueName() + "_OUTPUT_PLOTS")
@@ -251,21 +283,21 @@ namespace allpix {
 
                 // Reset the canvas
                 canvas->Clear();
-                canvas->SetTheta(config.get<float>("output_plots_theta") * 180.0f / ROOT::Math::Pi());
-                canvas->SetPhi(config.get<float>("output_plots_phi") * 180.0f / ROOT::Math::Pi());
+                canvas->SetTheta(static_cast<float>(*settings.theta) * 180.0f / ROOT::Math::Pi());
+                canvas->SetPhi(static_cast<float>(*settings.phi) * 180.0f / ROOT::Math::Pi());
                 canvas->Draw();
 
                 // Reset the histogram frame
                 histogram_frame->SetTitle("Charge propagation in sensor");
                 histogram_frame->GetXaxis()->SetTitle(
-                    (std::string("x ") + (config.get<bool>("output_plots_use_pixel_units") ? "(pixels)" : "(mm)")).c_str());
+                    (std::string("x ") + (*settings.use_pixel_units ? "(pixels)" : "(mm)")).c_str());
                 histogram_frame->GetYaxis()->SetTitle(
-                    (std::string("y ") + (config.get<bool>("output_plots_use_pixel_units") ? "(pixels)" : "(mm)")).c_str());
+                    (std::string("y ") + (*settings.use_pixel_units ? "(pixels)" : "(mm)")).c_str());
                 histogram_frame->GetZaxis()->SetTitle("z (mm)");
                 histogram_frame->Draw();
 
                 auto text = std::make_unique<TPaveText>(-0.75, -0.75, -0.60, -0.65);
-                auto time_ns = Units::convert(plot_idx * config.get<long double>("output_plots_step"), "ns");
+                auto time_ns = Units::convert(plot_idx * *settings.step, "ns");
                 std::stringstream sstr;
                 sstr << std::fixed << std::setprecision(2) << time_ns << "ns";
                 auto time_str = std::string(8 - sstr.str().size(), ' ');
@@ -277,8 +309,7 @@ namespace allpix {
                 for(const auto& [deposit, points] : output_plot_points) {
                     const auto& [time, charge, type, state] = deposit;
 
-                    auto diff = static_cast<unsigned long>(
-                        std::lround((time - start_time) / config.get<long double>("output_plots_step")));
+                    auto diff = static_cast<unsigned long>(std::lround((time - start_time) / *settings.step));
                     if(plot_idx < diff) {
                         min_idx_diff = std::min(min_idx_diff, diff - plot_idx);
                         continue;
@@ -291,13 +322,12 @@ namespace allpix {
 
                     auto marker = std::make_unique<TPolyMarker3D>();
                     marker->SetMarkerStyle(kFullCircle);
-                    marker->SetMarkerSize(
-                        static_cast<float>(charge * config.get<double>("output_animations_marker_size", 1)) /
-                        static_cast<float>(max_charge));
+                    marker->SetMarkerSize(static_cast<float>(charge * *settings.marker_size) /
+                                          static_cast<float>(max_charge));
                     auto initial_z_perc = static_cast<int>(
                         ((points[0].z() + model->getSensorSize().z() / 2.0) / model->getSensorSize().z()) * 80);
                     initial_z_perc = std::max(std::min(79, initial_z_perc), 0);
-                    if(config.get<bool>("output_animations_color_markers")) {
+                    if(*settings.color_markers) {
                         marker->SetMarkerColor(static_cast<Color_t>(colors[initial_z_perc]->GetNumber()));
                     }
                     marker->SetNextPoint(points[idx].x() / scale_x, points[idx].y() / scale_y, points[idx].z());
@@ -331,33 +361,24 @@ namespace allpix {
                         switch(i) {
                         case 0 /* x */:
                             histogram_contour[i]->GetXaxis()->SetTitle(
-                                (std::string("y ") +
-                                 (config.get<bool>("output_plots_use_pixel_units") ? "(pixels)" : "(mm)"))
-                                    .c_str());
+                                (std::string("y ") + (*settings.use_pixel_units ? "(pixels)" : "(mm)")).c_str());
                             histogram_contour[i]->GetYaxis()->SetTitle("z (mm)");
                             break;
                         case 1 /* y */:
                             histogram_contour[i]->GetXaxis()->SetTitle(
-                                (std::string("x ") +
-                                 (config.get<bool>("output_plots_use_pixel_units") ? "(pixels)" : "(mm)"))
-                                    .c_str());
+                                (std::string("x ") + (*settings.use_pixel_units ? "(pixels)" : "(mm)")).c_str());
                             histogram_contour[i]->GetYaxis()->SetTitle("z (mm)");
                             break;
                         case 2 /* z */:
                             histogram_contour[i]->GetXaxis()->SetTitle(
-                                (std::string("x ") +
-                                 (config.get<bool>("output_plots_use_pixel_units") ? "(pixels)" : "(mm)"))
-                                    .c_str());
+                                (std::string("x ") + (*settings.use_pixel_units ? "(pixels)" : "(mm)")).c_str());
                             histogram_contour[i]->GetYaxis()->SetTitle(
-                                (std::string("y ") +
-                                 (config.get<bool>("output_plots_use_pixel_units") ? "(pixels)" : "(mm)"))
-                                    .c_str());
+                                (std::string("y ") + (*settings.use_pixel_units ? "(pixels)" : "(mm)")).c_str());
                             break;
                         default:;
                         }
                         histogram_contour[i]->SetMinimum(1);
-                        histogram_contour[i]->SetMaximum(total_charge /
-                                                         config.get<double>("output_animations_contour_max_scaling", 10));
+                        histogram_contour[i]->SetMaximum(total_charge / *settings.contour_max_scaling);
                         histogram_contour[i]->Draw("CONTZ 0");
                         if(point_cnt < tot_point_cnt - 1) {
                             canvas->Print((file_name_contour[i] + "+" + std::to_string(animation_time)).c_str());
@@ -378,12 +399,12 @@ namespace allpix {
     private:
         static std::tuple<double, double, double, double, double, double, double, double, unsigned long, double>
         get_plot_settings(const std::shared_ptr<DetectorModel>& model,
-                          const Configuration& config,
+                          const Settings& settings,
                           const OutputPlotPoints& output_plot_points) {
 
             // Convert to pixel units if necessary
-            double scale_x = (config.get<bool>("output_plots_use_pixel_units") ? model->getPixelSize().x() : 1);
-            double scale_y = (config.get<bool>("output_plots_use_pixel_units") ? model->getPixelSize().y() : 1);
+            double scale_x = (*settings.use_pixel_units ? model->getPixelSize().x() : 1);
+            double scale_y = (*settings.use_pixel_units ? model->getPixelSize().y() : 1);
 
             // Calculate the axis limits
             double minX = FLT_MAX, maxX = FLT_MIN;
@@ -409,10 +430,10 @@ namespace allpix {
             }
 
             // Compute frame axis sizes if equal scaling is requested
-            if(config.get<bool>("output_plots_use_equal_scaling", true)) {
+            if(*settings.use_equal_scaling) {
                 double centerX = (minX + maxX) / 2.0;
                 double centerY = (minY + maxY) / 2.0;
-                if(config.get<bool>("output_plots_use_pixel_units")) {
+                if(*settings.use_pixel_units) {
                     minX = centerX - model->getSensorSize().z() / model->getPixelSize().x() / 2.0;
                     maxX = centerX + model->getSensorSize().z() / model->getPixelSize().x() / 2.0;
 
@@ -428,8 +449,8 @@ namespace allpix {
             }
 
             // Align on pixels if requested
-            if(config.get<bool>("output_plots_align_pixels")) {
-                if(config.get<bool>("output_plots_use_pixel_units")) {
+            if(*settings.align_pixels) {
+                if(*settings.use_pixel_units) {
                     minX = std::floor(minX - 0.5) + 0.5;
                     minY = std::floor(minY + 0.5) - 0.5;
                     maxX = std::ceil(maxX - 0.5) + 0.5;
@@ -0,0 +1,226 @@
+/**
+ * @file
+ * @brief Read-only files mapped into memory and scanning of numbers from their text without copying
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ALLPIX_MAPPED_FILE_H
+#define ALLPIX_MAPPED_FILE_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace allpix {
+
+    /**
+     * @brief Read-only file mapped into memory
+     *
+     * The operating system only loads the pages of the file which are accessed and shares them between processes mapping
+     * the same file. The mapped content can be read concurrently, while reading line by line via \ref getLine advances a
+     * cursor and is therefore not thread-safe. Numbers are scanned directly from the mapped text, such that large text files
+     * can be parsed without first splitting them into strings and streams.
+     */
+    class MappedFile {
+    public:
+        /**
+         * @brief Map a file into memory
+         * @param file_name Path of the file to map
+         * @param sequential Whether the file is mostly read from front to back, allowing the kernel to read ahead
+         * @throws std::runtime_error if the file cannot be accessed or mapped
+         */
+        explicit MappedFile(const std::string& file_name, bool sequential = false) {
+            auto fd = ::open(file_name.c_str(), O_RDONLY);
+            if(fd < 0) {
+                throw std::runtime_error("file " + file_name + " cannot be accessed");
+            }
+            struct stat file_stat {};
+            if(::fstat(fd, &file_stat) != 0) {
+                ::close(fd);
+                throw std::runtime_error("file " + file_name + " cannot be accessed");
+            }
+            size_ = static_cast<size_t>(file_stat.st_size);
+
+            // Empty files cannot be mapped but are valid, containing no data
+            if(size_ > 0) {
+                auto* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(mapped == MAP_FAILED) { // NOLINT
+                    ::close(fd);
+                    throw std::runtime_error("file " + file_name + " cannot be mapped into memory");
+                }
+                data_ = static_cast<const char*>(mapped);
+                if(sequential) {
+                    ::madvise(mapped, size_, MADV_SEQUENTIAL);
+                }
+            }
+            ::close(fd);
+        }
+
+        /**
+         * @brief Unmap the file
+         */
+        ~MappedFile() {
+            if(data_ != nullptr) {
+                ::munmap(const_cast<char*>(data_), size_); // NOLINT
+            }
+        }
+
+        /// @{
+        /**
+         * @brief Disallow copy
+         */
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        /// @}
+
+        /**
+         * @brief Get the mapped content of the file
+         * @return Pointer to the first byte, valid as long as the file is mapped
+         */
+        const char* data() const { return data_; }
+
+        /**
+         * @brief Get the size of the file
+         * @return Size in bytes
+         */
+        size_t size() const { return size_; }
+
+        /**
+         * @brief Get a view on a range of the file
+         * @param begin Offset of the first byte
+         * @param end Offset one past the last byte
+         * @return View on the range, valid as long as the file is mapped
+         */
+        std::string_view view(size_t begin = 0, size_t end = std::string_view::npos) const {
+            end = std::min(end, size_);
+            return (begin >= end ? std::string_view() : std::string_view(data_ + begin, end - begin));
+        }
+
+        /**
+         * @brief Read the next line of the file
+         * @param line View on the line without surrounding whitespace, valid as long as the file is mapped
+         * @return False if the end of the file has been reached
+         */
+        bool getLine(std::string_view& line) {
+            auto text = view(position_);
+            if(!nextLine(text, line)) {
+                return false;
+            }
+            position_ = size_ - text.size();
+            return true;
+        }
+
+        /**
+         * @brief Get the fraction of the file read line by line so far
+         * @return Progress in percent
+         */
+        unsigned int progress() const {
+            return (size_ == 0 ? 100 : static_cast<unsigned int>(100 * std::min(position_, size_) / size_));
+        }
+
+        /**
+         * @brief Read the next line from a text and remove it from the text
+         * @param text Text to read from
+         * @param line View on the line without surrounding whitespace
+         * @return False if the text is empty
+         */
+        static bool nextLine(std::string_view& text, std::string_view& line) {
+            if(text.empty()) {
+                return false;
+            }
+            // Rely on the vectorized implementation of memchr to find the end of the line
+            const auto* end = static_cast<const char*>(std::memchr(text.data(), '\n', text.size()));
+            auto length = (end == nullptr ? text.size() : static_cast<size_t>(end - text.data()));
+            line = trim(text.substr(0, length));
+            text.remove_prefix(std::min(length + 1, text.size()));
+            return true;
+        }
+
+        /**
+         * @brief Read the next whitespace-separated number from a text and remove it from the text
+         * @param text Text to read from
+         * @param value Value to store the number in
+         * @return False if the text contains no further token or the next token is not a number
+         */
+        template <typename T> static bool next(std::string_view& text, T& value) {
+            text = trim(text);
+            if(text.empty()) {
+                return false;
+            }
+            auto length = std::min(text.find_first_of(whitespace), text.size());
+            if(!parse(text.substr(0, length), value)) {
+                return false;
+            }
+            text.remove_prefix(length);
+            return true;
+        }
+
+        /**
+         * @brief Parse a number from a token
+         * @param token Token to parse without surrounding whitespace
+         * @param value Value to store the number in
+         * @return True if the full token could be parsed, false otherwise
+         */
+        template <typename T> static bool parse(std::string_view token, T& value) {
+            static_assert(std::is_arithmetic_v<T>, "only numeric values can be parsed");
+            const auto* end = token.data() + token.size();
+            if constexpr(std::is_integral_v<T>) {
+                auto [ptr, error] = std::from_chars(token.data(), end, value);
+                return error == std::errc() && ptr == end;
+            } else {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+                auto [ptr, error] = std::from_chars(token.data(), end, value);
+                return error == std::errc() && ptr == end;
+#else
+                // Tokens are copied to terminate them for strtod, the standard library lacks floating-point from_chars
+                char buffer[64]; // NOLINT
+                if(token.empty() || token.size() >= sizeof(buffer)) {
+                    return false;
+                }
+                std::memcpy(buffer, token.data(), token.size());
+                buffer[token.size()] = '\0';
+                char* parsed = nullptr;
+                value = static_cast<T>(std::strtod(buffer, &parsed));
+                return parsed == buffer + token.size();
+#endif
+            }
+        }
+
+        /**
+         * @brief Remove surrounding whitespace, including carriage returns
+         * @param text Text to trim
+         * @return View on the text without surrounding whitespace
+         */
+        static std::string_view trim(std::string_view text) {
+            auto first = text.find_first_not_of(whitespace);
+            if(first == std::string_view::npos) {
+                return {};
+            }
+            return text.substr(first, text.find_last_not_of(whitespace) - first + 1);
+        }
+
+    private:
+        static constexpr std::string_view whitespace = " \t\r\n\v\f";
+
+        const char* data_{};
+        size_t size_{};
+        size_t position_{};
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_MAPPED_FILE_H */
@@ -0,0 +1,115 @@
+/**
+ * @file
+ * @brief Utility to group objects on a pixel matrix into clusters of neighboring pixels
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ALLPIX_PIXEL_CLUSTERING_H
+#define ALLPIX_PIXEL_CLUSTERING_H
+
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/geometry/DetectorModel.hpp"
+#include "objects/Pixel.hpp"
+
+namespace allpix {
+
+    class PixelClustering {
+    public:
+        /**
+         * @brief Group objects into clusters of pixels connected through neighboring pixels
+         *
+         * The objects are looked up by their pixel index in a hash table, and the neighbors of every pixel as defined by the
+         * detector model are joined using a union-find structure. The run time is linear in the number of objects, and the
+         * neighborhood of any detector model is supported, e.g. also for hexagonal pixels and radial strips. Objects on the
+         * same pixel always belong to the same cluster.
+         *
+         * @param objects Objects to group, e.g. pixel hits or pixel charges
+         * @param model Detector model defining the neighbors of each pixel
+         * @param get_index Function returning the pixel index of an object
+         * @param distance Maximum distance of pixels to be considered neighbors
+         * @return Clusters as lists of positions of the objects in the input, ordered by their first object and with the
+         * objects of each cluster in input order
+         */
+        template <typename T, typename F>
+        static std::vector<std::vector<size_t>>
+        findClusters(const std::vector<T>& objects, const DetectorModel& model, F get_index, size_t distance = 1) {
+            // Union-find structure over the positions of all objects, with path halving and union by size
+            std::vector<size_t> parent(objects.size());
+            std::vector<size_t> size(objects.size(), 1);
+            std::iota(parent.begin(), parent.end(), size_t(0));
+            auto find = [&](size_t i) {
+                while(parent[i] != i) {
+                    parent[i] = parent[parent[i]];
+                    i = parent[i];
+                }
+                return i;
+            };
+            auto unite = [&](size_t a, size_t b) {
+                a = find(a);
+                b = find(b);
+                if(a == b) {
+                    return;
+                }
+                if(size[a] < size[b]) {
+                    std::swap(a, b);
+                }
+                parent[b] = a;
+                size[a] += size[b];
+            };
+
+            // Register the first object on every pixel and join all further objects on the same pixel with it
+            std::unordered_map<uint64_t, size_t> pixels;
+            pixels.reserve(objects.size());
+            for(size_t i = 0; i < objects.size(); ++i) {
+                auto [pixel, inserted] = pixels.emplace(key(get_index(objects[i])), i);
+                if(!inserted) {
+                    unite(pixel->second, i);
+                }
+            }
+
+            // Join all objects on neighboring pixels
+            for(const auto& [pixel_key, i] : pixels) {
+                for(const auto& neighbor : model.getNeighbors(get_index(objects[i]), distance)) {
+                    auto other = pixels.find(key(neighbor));
+                    if(other != pixels.end()) {
+                        unite(i, other->second);
+                    }
+                }
+            }
+
+            // Collect the clusters in order of their first object
+            std::vector<std::vector<size_t>> clusters;
+            std::vector<size_t> cluster_of_root(objects.size(), std::numeric_limits<size_t>::max());
+            for(size_t i = 0; i < objects.size(); ++i) {
+                auto root = find(i);
+                if(cluster_of_root[root] == std::numeric_limits<size_t>::max()) {
+                    cluster_of_root[root] = clusters.size();
+                    clusters.emplace_back();
+                }
+                clusters[cluster_of_root[root]].push_back(i);
+            }
+            return clusters;
+        }
+
+    private:
+        /**
+         * @brief Combine both coordinates of a pixel index into a single key
+         */
+        static uint64_t key(const Pixel::Index& index) {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(index.x())) << 32) | static_cast<uint32_t>(index.y());
+        }
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_PIXEL_CLUSTERING_H */
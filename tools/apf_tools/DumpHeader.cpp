@@ -26,12 +26,18 @@ template <typename T> static void print_info(allpix::FieldData<T> field_data, si
               << std::endl;
     std::cout << "Dimensions: " << field_data.getDimensions()[0] << " x " << field_data.getDimensions()[1] << " x "
               << field_data.getDimensions()[2] << " cells" << std::endl;
-    std::cout << "Field vector with " << field_data.getData()->size() << " entries" << std::endl;
+    if(field_data.getOctree() != nullptr) {
+        std::cout << "Adaptive:   " << field_data.getOctree()->getNumberOfLeaves() << " leaves in "
+                  << field_data.getOctree()->getNodes().size() << " nodes, depth " << field_data.getOctree()->getDepth()
+                  << std::endl;
+    }
+    auto data = field_data.getData();
+    std::cout << "Field vector with " << data->size() << " entries" << std::endl;
 
     if(n > 0) {
         std::cout << "First " << n << " entries of field data:" << std::endl;
-        for(size_t i = 0; i < field_data.getData()->size() && i < n; i++) {
-            std::cout << Units::display(field_data.getData()->at(i), units) << " ";
+        for(size_t i = 0; i < data->size() && i < n; i++) {
+            std::cout << Units::display(data->at(i), units) << " ";
         }
         std::cout << std::endl;
     }
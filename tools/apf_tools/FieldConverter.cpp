@@ -11,9 +11,12 @@
 
 #include <algorithm>
 #include <fstream>
+#include <memory>
 #include <string>
 
 #include "core/utils/log.h"
+#include "core/utils/unit.h"
+#include "tools/field_octree.h"
 #include "tools/field_parser.h"
 #include "tools/units.h"
 
@@ -46,6 +49,8 @@ int main(int argc, const char* argv[]) {
         std::string file_output;
         std::string units;
         bool scalar = false;
+        bool adaptive = false;
+        double tolerance = 0.;
         for(int i = 1; i < argc; i++) {
             if(strcmp(argv[i], "-h") == 0) {
                 print_help = true;
@@ -68,6 +73,9 @@ int main(int argc, const char* argv[]) {
                 units = std::string(argv[++i]);
             } else if(strcmp(argv[i], "--scalar") == 0) {
                 scalar = true;
+            } else if(strcmp(argv[i], "--adaptive") == 0 && (i + 1 < argc)) {
+                adaptive = true;
+                tolerance = std::stod(argv[++i]);
             } else {
                 LOG(ERROR) << "Unrecognized command line argument \"" << argv[i] << "\"";
                 print_help = true;
@@ -88,6 +96,10 @@ int main(int argc, const char* argv[]) {
             std::cout << "  --units <units>  units the field is provided in" << std::endl << std::endl;
             std::cout << "Options:" << std::endl;
             std::cout << "  --scalar         Convert scalar field. Default is vector field" << std::endl;
+            std::cout << "  --adaptive <tol> store the field as adaptive grid, merging cells deviating by less than <tol>"
+                      << std::endl;
+            std::cout << "                   given in the units of the field. Only supported for the APF format"
+                      << std::endl;
             std::cout << std::endl;
             std::cout << "For more help, please see <https://cern.ch/allpix-squared>" << std::endl;
             return return_code;
@@ -98,6 +110,21 @@ int main(int argc, const char* argv[]) {
         FieldParser<double> field_parser(quantity);
         LOG(STATUS) << "Reading input file from " << file_input;
         auto field_data = field_parser.getByFileName(file_input, units);
+
+        // Merge blocks of cells with almost constant field into an adaptive grid
+        if(adaptive) {
+            if(format_to != FileType::APF) {
+                throw std::invalid_argument("adaptive grids can only be stored in the APF format");
+            }
+            auto dimensions = field_data.getDimensions();
+            auto field_tolerance = (units.empty() ? tolerance : Units::get(tolerance, units));
+            auto octree = std::make_shared<const FieldOctree<double>>(
+                field_data.getData()->data(), dimensions, static_cast<size_t>(quantity), field_tolerance);
+            LOG(STATUS) << "Merged " << dimensions[0] * dimensions[1] * dimensions[2] << " cells into adaptive grid with "
+                        << octree->getNumberOfLeaves() << " leaves and depth " << octree->getDepth();
+            field_data = FieldData<double>(field_data.getHeader(), field_data.getSize(), octree);
+        }
+
         FieldWriter<double> field_writer(quantity);
         LOG(STATUS) << "Writing output file to " << file_output;
         field_writer.writeFile(field_data, file_output, format_to, (format_to == FileType::INIT ? units : ""));
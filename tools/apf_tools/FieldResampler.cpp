@@ -0,0 +1,212 @@
+/**
+ * @file
+ * @brief Small tool to resample field data onto a coarser grid for use with trilinear interpolation
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "core/utils/log.h"
+#include "tools/field_interpolation.h"
+#include "tools/field_parser.h"
+#include "tools/units.h"
+
+using namespace allpix;
+
+/**
+ * @brief Interpolate a flat field trilinearly between the centers of its cells
+ * @param values Pointer to the flat field values
+ * @param bins Number of bins of the field in each coordinate
+ * @param n Number of components per field value
+ * @param position Position in units of bins of the field
+ * @return Interpolated field components
+ */
+static std::vector<double>
+interpolate(const double* values, const std::array<size_t, 3>& bins, size_t n, const std::array<double, 3>& position) {
+    std::vector<double> result(n, 0.);
+    interpolate_trilinear(bins, position, [&](size_t x, size_t y, size_t z, double weight) {
+        auto index = ((x * bins[1] + y) * bins[2] + z) * n;
+        for(size_t i = 0; i < n; ++i) {
+            result[i] += weight * values[index + i];
+        }
+    });
+    return result;
+}
+
+/**
+ * @brief Main function running the application
+ */
+int main(int argc, const char* argv[]) {
+
+    int return_code = 0;
+    try {
+
+        // Register the default set of units with this executable:
+        register_units();
+
+        // Add cout as the default logging stream
+        Log::addStream(std::cout);
+
+        // If no arguments are provided, print the help:
+        bool print_help = false;
+        if(argc == 1) {
+            print_help = true;
+            return_code = 1;
+        }
+
+        // Parse arguments
+        std::string file_input;
+        std::string file_output;
+        std::string units;
+        std::array<size_t, 3> bins{};
+        size_t factor = 0;
+        bool scalar = false;
+        for(int i = 1; i < argc; i++) {
+            if(strcmp(argv[i], "-h") == 0) {
+                print_help = true;
+            } else if(strcmp(argv[i], "-v") == 0 && (i + 1 < argc)) {
+                try {
+                    LogLevel log_level = Log::getLevelFromString(std::string(argv[++i]));
+                    Log::setReportingLevel(log_level);
+                } catch(std::invalid_argument& e) {
+                    LOG(ERROR) << "Invalid verbosity level \"" << std::string(argv[i]) << "\", ignoring overwrite";
+                }
+            } else if(strcmp(argv[i], "--input") == 0 && (i + 1 < argc)) {
+                file_input = std::string(argv[++i]);
+            } else if(strcmp(argv[i], "--output") == 0 && (i + 1 < argc)) {
+                file_output = std::string(argv[++i]);
+            } else if(strcmp(argv[i], "--units") == 0 && (i + 1 < argc)) {
+                units = std::string(argv[++i]);
+            } else if(strcmp(argv[i], "--bins") == 0 && (i + 3 < argc)) {
+                for(auto& bin : bins) {
+                    bin = std::stoul(argv[++i]);
+                }
+            } else if(strcmp(argv[i], "--factor") == 0 && (i + 1 < argc)) {
+                factor = std::stoul(argv[++i]);
+            } else if(strcmp(argv[i], "--scalar") == 0) {
+                scalar = true;
+            } else {
+                LOG(ERROR) << "Unrecognized command line argument \"" << argv[i] << "\"";
+                print_help = true;
+                return_code = 1;
+            }
+        }
+
+        // Either the number of bins or the reduction factor have to be given
+        if(!print_help && (factor == 0) == (bins[0] == 0 || bins[1] == 0 || bins[2] == 0)) {
+            LOG(ERROR) << "Exactly one of the number of bins or the reduction factor has to be given";
+            print_help = true;
+            return_code = 1;
+        }
+
+        // Print help if requested or no arguments given
+        if(print_help) {
+            std::cout << "Allpix Squared Field Resampler Tool" << std::endl;
+            std::cout << std::endl;
+            std::cout << "Usage: field_resampler <parameters>" << std::endl;
+            std::cout << std::endl;
+            std::cout << "Parameters (all mandatory):" << std::endl;
+            std::cout << "  --input <file>      input field file" << std::endl;
+            std::cout << "  --output <file>     output field file in APF format" << std::endl;
+            std::cout << "  --units <units>     units the field is provided in" << std::endl;
+            std::cout << "  --bins <x> <y> <z>  number of bins of the resampled field" << std::endl;
+            std::cout << "  --factor <n>        alternatively, factor by which the number of bins is reduced" << std::endl;
+            std::cout << std::endl;
+            std::cout << "Options:" << std::endl;
+            std::cout << "  --scalar            Resample scalar field. Default is vector field" << std::endl;
+            std::cout << std::endl;
+            std::cout << "For more help, please see <https://cern.ch/allpix-squared>" << std::endl;
+            return return_code;
+        }
+
+        FieldQuantity quantity = (scalar ? FieldQuantity::SCALAR : FieldQuantity::VECTOR);
+        const size_t n = (scalar ? 1 : 3);
+
+        FieldParser<double> field_parser(quantity);
+        LOG(STATUS) << "Reading input file from " << file_input;
+        auto field_data = field_parser.getByFileName(file_input, units);
+        auto input_bins = field_data.getDimensions();
+
+        // Adaptive fields are expanded onto their regular grid first
+        auto expanded = (field_data.getOctree() != nullptr ? field_data.getData() : nullptr);
+        const auto* input = (expanded != nullptr ? expanded->data() : field_data.getValues().get());
+
+        // Reduce the number of bins by the given factor, keeping at least one bin along each axis
+        if(factor != 0) {
+            for(size_t axis = 0; axis < 3; ++axis) {
+                bins[axis] = std::max<size_t>(1, input_bins[axis] / factor);
+            }
+        }
+        LOG(INFO) << "Resampling field from " << input_bins[0] << " x " << input_bins[1] << " x " << input_bins[2]
+                  << " to " << bins[0] << " x " << bins[1] << " x " << bins[2] << " cells";
+
+        // Sample the input field at the cell centers of the output grid
+        auto output = std::make_shared<std::vector<double>>();
+        output->reserve(bins[0] * bins[1] * bins[2] * n);
+        for(size_t x = 0; x < bins[0]; ++x) {
+            for(size_t y = 0; y < bins[1]; ++y) {
+                for(size_t z = 0; z < bins[2]; ++z) {
+                    std::array<double, 3> position{};
+                    std::array<size_t, 3> index{{x, y, z}};
+                    for(size_t axis = 0; axis < 3; ++axis) {
+                        position[axis] = (static_cast<double>(index[axis]) + 0.5) * static_cast<double>(input_bins[axis]) /
+                                         static_cast<double>(bins[axis]);
+                    }
+                    auto value = interpolate(input, input_bins, n, position);
+                    output->insert(output->end(), value.begin(), value.end());
+                }
+            }
+        }
+
+        // Compare the interpolated output field to the input field at the cell centers of the input grid
+        double max_deviation = 0;
+        double sum_deviation = 0;
+        double max_magnitude = 0;
+        for(size_t x = 0; x < input_bins[0]; ++x) {
+            for(size_t y = 0; y < input_bins[1]; ++y) {
+                for(size_t z = 0; z < input_bins[2]; ++z) {
+                    std::array<double, 3> position{};
+                    std::array<size_t, 3> index{{x, y, z}};
+                    for(size_t axis = 0; axis < 3; ++axis) {
+                        position[axis] = (static_cast<double>(index[axis]) + 0.5) * static_cast<double>(bins[axis]) /
+                                         static_cast<double>(input_bins[axis]);
+                    }
+                    auto value = interpolate(output->data(), bins, n, position);
+                    const auto* reference = input + ((x * input_bins[1] + y) * input_bins[2] + z) * n;
+                    double deviation = 0;
+                    double magnitude = 0;
+                    for(size_t i = 0; i < n; ++i) {
+                        deviation += (value[i] - reference[i]) * (value[i] - reference[i]);
+                        magnitude += reference[i] * reference[i];
+                    }
+                    max_deviation = std::max(max_deviation, std::sqrt(deviation));
+                    max_magnitude = std::max(max_magnitude, std::sqrt(magnitude));
+                    sum_deviation += deviation;
+                }
+            }
+        }
+        auto rms_deviation = std::sqrt(sum_deviation / static_cast<double>(input_bins[0] * input_bins[1] * input_bins[2]));
+        LOG(STATUS) << "Deviation of the resampled field from the input field: maximum " << max_deviation << ", RMS "
+                    << rms_deviation << " (internal units), maximum field magnitude " << max_magnitude;
+
+        FieldData<double> resampled(field_data.getHeader(), bins, field_data.getSize(), output);
+        FieldWriter<double> field_writer(quantity);
+        LOG(STATUS) << "Writing output file to " << file_output;
+        field_writer.writeFile(resampled, file_output, FileType::APF, "");
+    } catch(std::exception& e) {
+        LOG(FATAL) << "Fatal internal error" << std::endl << e.what() << std::endl << "Cannot continue.";
+        return_code = 127;
+    }
+
+    return return_code;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ElementIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "core/utils/log.h"
+
+// Minimum volume of elements to be used, matching the coplanarity criterion of mesh elements
+#define MIN_VOLUME 1e-12
+// Tolerance on barycentric coordinates to accept points on faces shared by neighboring elements
+#define BARYCENTRIC_TOLERANCE 1e-9
+// Maximum number of cells along each axis of the grid
+#define MAX_CELLS 1024
+
+using namespace mesh_converter;
+
+namespace {
+    double coordinate(const Point& point, size_t axis) { return (axis == 0 ? point.x : (axis == 1 ? point.y : point.z)); }
+} // namespace
+
+ElementIndex::ElementIndex(const std::vector<Point>& points, std::vector<ElementVertices> elements, unsigned int dimension)
+    : points_(points), elements_(std::move(elements)), dimension_(dimension) {
+    // Remove degenerate elements which cannot be used for interpolation
+    auto degenerate = std::remove_if(elements_.begin(), elements_.end(), [this](const ElementVertices& element) {
+        return std::fabs(volume(element)) < MIN_VOLUME;
+    });
+    if(degenerate != elements_.end()) {
+        LOG(INFO) << "Ignoring " << std::distance(degenerate, elements_.end()) << " degenerate mesh elements";
+        elements_.erase(degenerate, elements_.end());
+    }
+    if(elements_.empty()) {
+        cells_ = {1, 1, 1};
+        cell_offsets_.assign(2, 0);
+        return;
+    }
+
+    // Determine bounding box of all elements
+    auto vertices = dimension_ + 1;
+    min_.fill(std::numeric_limits<double>::max());
+    max_.fill(std::numeric_limits<double>::lowest());
+    for(const auto& element : elements_) {
+        for(size_t i = 0; i < vertices; ++i) {
+            for(size_t axis = 0; axis < 3; ++axis) {
+                min_[axis] = std::min(min_[axis], coordinate(points_[element[i]], axis));
+                max_[axis] = std::max(max_[axis], coordinate(points_[element[i]], axis));
+            }
+        }
+    }
+
+    // Choose the cell size such that the number of cells is about the number of elements
+    double measure = 1;
+    double active_axes = 0;
+    for(size_t axis = 0; axis < 3; ++axis) {
+        if(max_[axis] > min_[axis]) {
+            measure *= max_[axis] - min_[axis];
+            active_axes++;
+        }
+    }
+    auto cell_length = std::pow(measure / static_cast<double>(elements_.size()), 1. / std::max(active_axes, 1.));
+    for(size_t axis = 0; axis < 3; ++axis) {
+        auto extent = max_[axis] - min_[axis];
+        cells_[axis] = (extent > 0 ? std::clamp<size_t>(static_cast<size_t>(std::ceil(extent / cell_length)), 1, MAX_CELLS)
+                                   : 1);
+        cell_size_[axis] = (extent > 0 ? extent / static_cast<double>(cells_[axis]) : 1);
+    }
+    LOG(DEBUG) << "Sorting " << elements_.size() << " mesh elements into grid of " << cells_[0] << " x " << cells_[1]
+               << " x " << cells_[2] << " cells";
+
+    // Sort the elements into all cells overlapping with their bounding box, counting them first to store them contiguously
+    auto for_each_cell = [&](const ElementVertices& element, auto function) {
+        std::array<size_t, 3> first{}, last{};
+        for(size_t axis = 0; axis < 3; ++axis) {
+            double low = std::numeric_limits<double>::max();
+            double high = std::numeric_limits<double>::lowest();
+            for(size_t i = 0; i < vertices; ++i) {
+                low = std::min(low, coordinate(points_[element[i]], axis));
+                high = std::max(high, coordinate(points_[element[i]], axis));
+            }
+            first[axis] = cell_coordinate(low, axis);
+            last[axis] = cell_coordinate(high, axis);
+        }
+        for(auto i = first[0]; i <= last[0]; ++i) {
+            for(auto j = first[1]; j <= last[1]; ++j) {
+                for(auto k = first[2]; k <= last[2]; ++k) {
+                    function((i * cells_[1] + j) * cells_[2] + k);
+                }
+            }
+        }
+    };
+
+    cell_offsets_.assign(cells_[0] * cells_[1] * cells_[2] + 1, 0);
+    for(const auto& element : elements_) {
+        for_each_cell(element, [&](size_t cell) { cell_offsets_[cell + 1]++; });
+    }
+    for(size_t cell = 1; cell < cell_offsets_.size(); ++cell) {
+        cell_offsets_[cell] += cell_offsets_[cell - 1];
+    }
+
+    cell_elements_.resize(cell_offsets_.back());
+    auto fill = std::vector<size_t>(cell_offsets_.begin(), cell_offsets_.end() - 1);
+    for(size_t index = 0; index < elements_.size(); ++index) {
+        for_each_cell(elements_[index], [&](size_t cell) { cell_elements_[fill[cell]++] = index; });
+    }
+}
+
+std::optional<size_t> ElementIndex::find(const Point& q, std::optional<size_t> hint) const {
+    // Adjacent points are often located in the same element
+    if(hint.has_value() && hint.value() < elements_.size() && contains(hint.value(), q)) {
+        return hint;
+    }
+
+    for(size_t axis = 0; axis < 3; ++axis) {
+        if(coordinate(q, axis) < min_[axis] || coordinate(q, axis) > max_[axis]) {
+            return std::nullopt;
+        }
+    }
+
+    auto cell = (cell_coordinate(q.x, 0) * cells_[1] + cell_coordinate(q.y, 1)) * cells_[2] + cell_coordinate(q.z, 2);
+    for(auto i = cell_offsets_[cell]; i < cell_offsets_[cell + 1]; ++i) {
+        if(contains(cell_elements_[i], q)) {
+            return cell_elements_[i];
+        }
+    }
+    return std::nullopt;
+}
+
+Point ElementIndex::interpolate(size_t element, const std::vector<Point>& field, Point& q) const {
+    std::array<Point, 4> vertices;
+    std::array<Point, 4> values;
+    for(size_t i = 0; i < 4; ++i) {
+        vertices[i] = points_[elements_[element][i]];
+        values[i] = field[elements_[element][i]];
+    }
+
+    MeshElement mesh_element(dimension_, vertices, values);
+    LOG(TRACE) << mesh_element.print(q);
+    return mesh_element.getObservable(q);
+}
+
+bool ElementIndex::contains(size_t element, const Point& q) const {
+    const auto& vertices = elements_[element];
+    const auto& v0 = points_[vertices[0]];
+    const auto& v1 = points_[vertices[1]];
+    const auto& v2 = points_[vertices[2]];
+
+    // Solve for the barycentric coordinates of the point using Cramer's rule
+    std::array<double, 3> lambda{};
+    if(dimension_ == 3) {
+        const auto& v3 = points_[vertices[3]];
+        Eigen::Matrix3d matrix;
+        matrix << v1.x - v0.x, v2.x - v0.x, v3.x - v0.x, v1.y - v0.y, v2.y - v0.y, v3.y - v0.y, v1.z - v0.z, v2.z - v0.z,
+            v3.z - v0.z;
+        Eigen::Vector3d r(q.x - v0.x, q.y - v0.y, q.z - v0.z);
+        auto determinant = matrix.determinant();
+        for(Eigen::Index i = 0; i < 3; ++i) {
+            auto column = matrix;
+            column.col(i) = r;
+            lambda[static_cast<size_t>(i)] = column.determinant() / determinant;
+        }
+    } else {
+        auto ay = v1.y - v0.y, az = v1.z - v0.z;
+        auto by = v2.y - v0.y, bz = v2.z - v0.z;
+        auto ry = q.y - v0.y, rz = q.z - v0.z;
+        auto determinant = ay * bz - az * by;
+        lambda[0] = (ry * bz - rz * by) / determinant;
+        lambda[1] = (ay * rz - az * ry) / determinant;
+    }
+
+    auto sum = lambda[0] + lambda[1] + lambda[2];
+    return std::all_of(lambda.begin(), lambda.end(), [](double l) { return l >= -BARYCENTRIC_TOLERANCE; }) &&
+           sum <= 1 + BARYCENTRIC_TOLERANCE;
+}
+
+double ElementIndex::volume(const ElementVertices& element) const {
+    const auto& v0 = points_[element[0]];
+    const auto& v1 = points_[element[1]];
+    const auto& v2 = points_[element[2]];
+    if(dimension_ == 3) {
+        const auto& v3 = points_[element[3]];
+        Eigen::Matrix3d matrix;
+        matrix << v1.x - v0.x, v2.x - v0.x, v3.x - v0.x, v1.y - v0.y, v2.y - v0.y, v3.y - v0.y, v1.z - v0.z, v2.z - v0.z,
+            v3.z - v0.z;
+        return matrix.determinant() / 6;
+    }
+    return ((v1.y - v0.y) * (v2.z - v0.z) - (v1.z - v0.z) * (v2.y - v0.y)) / 2;
+}
+
+size_t ElementIndex::cell_coordinate(double position, size_t axis) const {
+    auto cell = std::floor((position - min_[axis]) / cell_size_[axis]);
+    return static_cast<size_t>(std::clamp(cell, 0., static_cast<double>(cells_[axis] - 1)));
+}
@@ -0,0 +1,96 @@
+/**
+ * @file
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ALLPIX_ELEMENTINDEX_H
+#define ALLPIX_ELEMENTINDEX_H
+
+#include <array>
+#include <optional>
+#include <vector>
+
+#include "MeshElement.hpp"
+
+namespace mesh_converter {
+    /**
+     * @brief Indices of the vertices of a mesh element, tetrahedra use all four and triangles the first three entries
+     */
+    using ElementVertices = std::array<size_t, 4>;
+
+    /**
+     * @brief Spatial index to locate the mesh element enclosing a point
+     *
+     * The bounding boxes of all elements are sorted into a regular grid of cells, with about one cell per element. A point
+     * is located by testing the barycentric coordinates of the point in the elements overlapping with its cell. For 2D
+     * meshes, the elements are triangles in the y-z plane.
+     */
+    class ElementIndex {
+    public:
+        /**
+         * @brief Construct the index
+         * @param points Mesh points referenced by the elements, need to outlive the index
+         * @param elements Vertex indices of all elements of the mesh
+         * @param dimension Dimension of the mesh, 2 or 3
+         */
+        ElementIndex(const std::vector<Point>& points, std::vector<ElementVertices> elements, unsigned int dimension);
+
+        /**
+         * @brief Find the element enclosing a point
+         * @param q Point to locate
+         * @param hint Element to test first, such as the element found for an adjacent point
+         * @return Index of the enclosing element, or std::nullopt if the point is not within any element
+         */
+        std::optional<size_t> find(const Point& q, std::optional<size_t> hint = std::nullopt) const;
+
+        /**
+         * @brief Interpolate a field barycentrically within an element
+         * @param element Index of the element
+         * @param field Field values at the mesh points
+         * @param q Point to interpolate the field at
+         * @return Interpolated field value
+         */
+        Point interpolate(size_t element, const std::vector<Point>& field, Point& q) const;
+
+        /**
+         * @brief Get the number of indexed elements
+         * @return Number of elements, excluding degenerate elements removed when building the index
+         */
+        size_t size() const { return elements_.size(); }
+
+    private:
+        /**
+         * @brief Check if a point is enclosed by an element, including its faces
+         */
+        bool contains(size_t element, const Point& q) const;
+
+        /**
+         * @brief Signed volume of an element, or signed area for triangles
+         */
+        double volume(const ElementVertices& element) const;
+
+        /**
+         * @brief Get the cell coordinate of a position along one axis, clamped to the grid
+         */
+        size_t cell_coordinate(double position, size_t axis) const;
+
+        const std::vector<Point>& points_;
+        std::vector<ElementVertices> elements_;
+        unsigned int dimension_;
+
+        // Regular grid of cells with the elements overlapping each cell, stored contiguously
+        std::array<double, 3> min_{};
+        std::array<double, 3> max_{};
+        std::array<double, 3> cell_size_{};
+        std::array<size_t, 3> cells_{};
+        std::vector<size_t> cell_offsets_;
+        std::vector<size_t> cell_elements_;
+    };
+} // namespace mesh_converter
+
+#endif // ALLPIX_ELEMENTINDEX_H
@@ -9,13 +9,17 @@
  */
 
 #include <algorithm>
+#include <cctype>
 #include <cfloat>
 #include <chrono>
 #include <climits>
 #include <csignal>
 #include <cstdlib>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -35,6 +39,7 @@
 #include "tools/field_parser.h"
 #include "tools/units.h"
 
+#include "ElementIndex.hpp"
 #include "MeshElement.hpp"
 #include "MeshParser.hpp"
 #include "combinations/combinations.h"
@@ -212,6 +217,24 @@ int main(int argc, char** argv) {
         const auto allow_decay = config.get<bool>("allow_coplanar_interpolation", false);
         const auto radius_step = config.get<double>("radius_step", 0.5);
         const auto volume_cut = config.get<double>("volume_cut", 10e-9);
+        const auto element_search = config.get<bool>("element_search", true);
+
+        // Adaptive grid merging blocks of cells with almost constant observable:
+        const auto adaptive_grid = config.get<bool>("adaptive_grid", false);
+        auto adaptive_tolerance = config.get<double>("adaptive_tolerance", 0.);
+
+        // The tolerance is compared to the observable in internal units, values without explicit units are given in units
+        // of the observable
+        auto tolerance_text = allpix::trim(config.getText("adaptive_tolerance", "0"), " \t\"");
+        if(!tolerance_text.empty() && std::isalpha(static_cast<unsigned char>(tolerance_text.back())) == 0) {
+            adaptive_tolerance = Units::get(adaptive_tolerance, units);
+        }
+        if(adaptive_grid && file_type != FileType::APF) {
+            throw allpix::InvalidValueError(config, "adaptive_grid", "adaptive grids can only be stored in the APF format");
+        }
+        if(adaptive_tolerance < 0) {
+            throw allpix::InvalidValueError(config, "adaptive_tolerance", "tolerance has to be positive");
+        }
 
         // Swapping elements
         auto rot = config.getArray<std::string>("xyz", {"x", "y", "z"});
@@ -221,6 +244,13 @@ int main(int argc, char** argv) {
 
         auto start = std::chrono::system_clock::now();
 
+        // Parse the field data concurrently to the mesh grid
+        std::string data_file = file_prefix + ".dat";
+        auto field_future = std::async(std::launch::async, [&]() {
+            Log::setReportingLevel(log_level);
+            return parser->getField(data_file, observable, regions);
+        });
+
         std::string grid_file = file_prefix + ".grd";
         std::vector<Point> points = parser->getMesh(grid_file, regions);
 
@@ -240,8 +270,7 @@ int main(int argc, char** argv) {
             throw allpix::InvalidValueError(config, "xyz", "For 2D meshes the first coordinate has to remain 'x'");
         }
 
-        std::string data_file = file_prefix + ".dat";
-        std::vector<Point> field = parser->getField(data_file, observable, regions);
+        std::vector<Point> field = field_future.get();
 
         if(points.size() != field.size()) {
             throw std::runtime_error("Field and grid file do not match, found " + std::to_string(points.size()) + " and " +
@@ -353,6 +382,18 @@ int main(int argc, char** argv) {
         unibn::Octree<Point> octree;
         octree.initialize(points);
 
+        // Indexing the mesh elements to locate the element enclosing each point directly, if provided by the parser
+        std::unique_ptr<ElementIndex> element_index;
+        if(interpolate && element_search) {
+            auto elements = parser->getElements(grid_file, regions);
+            if(!elements.empty()) {
+                element_index = std::make_unique<ElementIndex>(points, std::move(elements), dimension);
+                LOG(INFO) << "Indexed " << element_index->size() << " mesh elements for point location";
+            } else {
+                LOG(INFO) << "Mesh elements not available from parser, searching neighboring mesh points instead";
+            }
+        }
+
         unsigned int mesh_points_done = 0;
         auto mesh_section = [&](double x, double y) {
             Log::setReportingLevel(log_level);
@@ -360,6 +401,9 @@ int main(int argc, char** argv) {
             // New mesh slice
             std::vector<Point> new_mesh;
 
+            // Element enclosing the previous point, consecutive points are often located in the same element
+            std::optional<size_t> previous_element;
+
             double z = minz + zstep / 2.0;
             for(unsigned int k = 0; k < divisions.z(); ++k) {
                 // New mesh vertex and field
@@ -374,6 +418,21 @@ int main(int argc, char** argv) {
                     continue;
                 }
 
+                // Locate the mesh element enclosing the point, falling back to the neighbor search for points outside
+                if(element_index) {
+                    auto element = element_index->find(q, previous_element);
+                    if(element.has_value()) {
+                        previous_element = element;
+                        e = element_index->interpolate(element.value(), field, q);
+                        if(e.isFinite()) {
+                            new_mesh.push_back(e);
+                            z += zstep;
+                            continue;
+                        }
+                    }
+                    LOG(DEBUG) << "No mesh element found enclosing point " << q << ", searching neighboring mesh points";
+                }
+
                 bool valid = false;
                 bool allow_zero_volume = false;
                 size_t prev_neighbours = 0;
@@ -544,6 +603,13 @@ int main(int argc, char** argv) {
         }
 
         allpix::FieldData<double> field_data(header, gridsize, size, data);
+        if(adaptive_grid) {
+            auto octree = std::make_shared<const allpix::FieldOctree<double>>(
+                data->data(), gridsize, static_cast<size_t>(quantity), adaptive_tolerance);
+            LOG(INFO) << "Merged " << gridsize[0] * gridsize[1] * gridsize[2] << " cells into adaptive grid with "
+                      << octree->getNumberOfLeaves() << " leaves and depth " << octree->getDepth();
+            field_data = allpix::FieldData<double>(header, size, octree);
+        }
         std::string init_file_name = init_file_prefix + "_" + observable + (file_type == FileType::INIT ? ".init" : ".apf");
 
         allpix::FieldWriter<double> field_writer(quantity);
@@ -97,3 +97,32 @@ MeshParser::getField(const std::string& file, const std::string& observable, con
 
     return field;
 }
+
+std::vector<ElementVertices> MeshParser::getElements(const std::string& file, const std::vector<std::string>& regions) {
+
+    // Populate element map once:
+    if(element_map_.find(file) == element_map_.end()) {
+        element_map_[file] = read_elements(file);
+    }
+
+    // Append the elements of all regions, shifting their vertex indices to the points of the concatenated regions:
+    std::vector<ElementVertices> elements;
+    size_t offset = 0;
+    for(const auto& region : regions) {
+        auto region_elements = element_map_[file].find(region);
+        if(region_elements == element_map_[file].end()) {
+            LOG(DEBUG) << "No elements available for region \"" << region << "\"";
+            return {};
+        }
+        for(auto element : region_elements->second) {
+            for(auto& vertex : element) {
+                vertex += offset;
+            }
+            elements.push_back(element);
+        }
+        offset += mesh_map_[file][region].size();
+    }
+    LOG(DEBUG) << "Mesh with " << elements.size() << " elements";
+
+    return elements;
+}
@@ -11,6 +11,7 @@
 #ifndef ALLPIX_MESHPARSER_H
 #define ALLPIX_MESHPARSER_H
 
+#include "ElementIndex.hpp"
 #include "MeshElement.hpp"
 #include "core/config/Configuration.hpp"
 
@@ -23,6 +24,7 @@ namespace mesh_converter {
 
     using MeshMap = std::map<std::string, std::vector<Point>>;
     using FieldMap = std::map<std::string, std::map<std::string, std::vector<Point>>>;
+    using ElementMap = std::map<std::string, std::vector<ElementVertices>>;
 
     /**
      * @brief Parser class to read different data formats
@@ -39,6 +41,15 @@ namespace mesh_converter {
         std::vector<Point>
         getField(const std::string& file, const std::string& observable, const std::vector<std::string>& regions);
 
+        /**
+         * @brief Get the elements of the mesh for the given regions
+         * @param  file    Canonical path of the mesh file, which has to be read with getMesh before
+         * @param  regions Regions to get the elements for, in the same order as for getMesh
+         * @return         Vertex indices of all elements referring to the points returned by getMesh, or an empty list if
+         *                 the parser does not provide the elements for all regions
+         */
+        std::vector<ElementVertices> getElements(const std::string& file, const std::vector<std::string>& regions);
+
     protected:
         /**
          * @brief Default constructor
@@ -60,11 +71,20 @@ namespace mesh_converter {
          */
         virtual FieldMap read_fields(const std::string& file_name, const std::string& observable = "") = 0;
 
+        /**
+         * @brief Method to read the elements of the mesh from the given file, if supported by the format
+         * @param  file_name Canonical path of the input file, after reading its mesh points
+         * @return           Map with vertex indices of elements for all regions, referring to the mesh points of the region
+         */
+        virtual ElementMap read_elements(const std::string&) { return {}; }
+
     private:
         // Cache of parsed meshes for all regions
         std::map<std::string, MeshMap> mesh_map_;
         // Cache of parsed fields for all regions
         std::map<std::string, FieldMap> field_map_;
+        // Cache of parsed elements for all regions
+        std::map<std::string, ElementMap> element_map_;
     };
 
 } // namespace mesh_converter
@@ -10,72 +10,139 @@
 
 #include "DFISEParser.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cctype>
 #include <cstdlib>
 #include <exception>
-#include <fstream>
 #include <iostream>
-#include <regex>
+#include <iterator>
 #include <set>
 #include <string>
+#include <string_view>
 #include "TFile.h"
 #include "TTree.h"
 
 #include "core/utils/log.h"
-#include "core/utils/text.h"
+#include "tools/mapped_file.h"
 
 using namespace mesh_converter;
+using allpix::MappedFile;
+
+namespace {
+    /**
+     * @brief Split a section header of the form "Name {" or "Name (data) {" into its name and data
+     * @return True if the line is a valid section header
+     */
+    bool parse_header(std::string_view line, std::string_view& name, std::string_view& data) {
+        if(line.empty() || line.back() != '{') {
+            return false;
+        }
+        line = MappedFile::trim(line.substr(0, line.size() - 1));
+        auto name_length = static_cast<size_t>(std::find_if_not(line.begin(), line.end(), [](char c) {
+                                                   return std::isalpha(static_cast<unsigned char>(c)) != 0;
+                                               }) -
+                                               line.begin());
+        name = line.substr(0, name_length);
+        auto rest = MappedFile::trim(line.substr(name_length));
+        if(name.empty()) {
+            return false;
+        }
+        if(rest.empty()) {
+            data = {};
+            return true;
+        }
+        if(rest.size() < 3 || rest.front() != '(' || rest.back() != ')') {
+            return false;
+        }
+        data = MappedFile::trim(rest.substr(1, rest.size() - 2));
+        return !data.empty();
+    }
 
-MeshMap DFISEParser::read_meshes(const std::string& file_name) {
-    std::ifstream file(file_name);
-    if(!file) {
-        throw std::runtime_error("file cannot be accessed");
+    /**
+     * @brief Split a line of the form "key = value" into its key and value
+     * @return True if the line is a valid key-value pair
+     */
+    bool parse_key_value(std::string_view line, std::string_view& key, std::string_view& value) {
+        auto separator = line.find('=');
+        if(separator == std::string_view::npos) {
+            return false;
+        }
+        key = MappedFile::trim(line.substr(0, separator));
+        value = MappedFile::trim(line.substr(separator + 1));
+        return !key.empty() && !value.empty() && std::all_of(key.begin(), key.end(), [](char c) {
+            return std::isalpha(static_cast<unsigned char>(c)) != 0;
+        });
     }
 
-    // Get the total number of lines to parse and reset file to the start:
-    auto num_lines = std::count(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>(), '\n');
-    file.clear();
-    file.seekg(0, std::ios::beg);
-    LOG(DEBUG) << "Grid file contains " << num_lines << " lines to parse";
+    /**
+     * @brief Convert the text of a header or value to an unsigned number
+     * @throws std::runtime_error if the text is not a number
+     */
+    long unsigned int to_number(std::string_view text) {
+        long unsigned int number = 0;
+        if(!MappedFile::parse(text, number)) {
+            throw std::runtime_error("invalid number \"" + std::string(text) + "\"");
+        }
+        return number;
+    }
+
+    /**
+     * @brief Strip the quotes around a region or dataset name
+     */
+    std::string unquote(std::string_view text) {
+        if(text.size() >= 2 && text.front() == '"' && text.back() == '"') {
+            text = text.substr(1, text.size() - 2);
+        }
+        return std::string(text);
+    }
+} // namespace
+
+MeshMap DFISEParser::read_meshes(const std::string& file_name) {
+    MappedFile file(file_name, true);
+    LOG(DEBUG) << "Grid file contains " << file.size() << " bytes to parse";
 
     DFSection main_section = DFSection::HEADER;
     DFSection sub_section = DFSection::NONE;
 
+    // Faces and elements are stored as flat lists of their vertex indices, with the offset of every entry in a second list
     std::vector<Point> vertices;
     std::vector<std::pair<long unsigned int, long unsigned int>> edges;
-    std::vector<std::vector<long unsigned int>> faces;
-    std::vector<std::vector<long unsigned int>> elements;
+    std::vector<size_t> face_offsets{0};
+    std::vector<long unsigned int> face_vertices;
+    std::vector<size_t> element_offsets{0};
+    std::vector<long unsigned int> element_vertices;
 
-    std::map<std::string, std::vector<long unsigned int>> regions_vertices;
+    std::map<std::string, std::vector<long unsigned int>> regions_elements;
 
     std::string region;
     long unsigned int dimension = 1;
     long unsigned int data_count = 0;
     bool in_data_block = false;
     long long num_lines_parsed = 0;
-    while(!file.eof()) {
-        std::string line;
-        std::getline(file, line);
-
+    std::vector<long unsigned int> face;
+    std::string_view line;
+    while(file.getLine(line)) {
         // Log the parsing progress:
-        if(num_lines > 0 && num_lines_parsed % 1000 == 0) {
-            LOG_PROGRESS(STATUS, "gridlines") << "Parsing grid file: " << (100 * num_lines_parsed / num_lines) << "%";
+        if(num_lines_parsed % 1000 == 0) {
+            LOG_PROGRESS(STATUS, "gridlines") << "Parsing grid file: " << file.progress() << "%";
         }
         num_lines_parsed++;
 
-        line = allpix::trim(line);
         if(line.empty()) {
             continue;
         }
 
         // Check if line with begin of section
-        if(line.find('{') != std::string::npos) {
-            // Search for new simple headers
-            auto base_regex = std::regex("([a-zA-Z]+) \\{");
-            std::smatch base_match;
-            if(std::regex_match(line, base_match, base_regex) && base_match.ready()) {
-                auto header_string = base_match[1].str();
+        if(line.find('{') != std::string_view::npos) {
+            std::string_view header_string;
+            std::string_view header_data;
+            if(!parse_header(line, header_string, header_data)) {
+                continue;
+            }
 
+            if(header_data.empty()) {
+                // Simple headers
                 if(header_string == "Info") {
                     main_section = DFSection::INFO;
                 } else if(header_string == "Data") {
@@ -87,33 +154,35 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
                         main_section = DFSection::IGNORED;
                     }
                 }
-            }
-
-            // Search for headers with data
-            base_regex = std::regex("([a-zA-Z]+) \\((\\S+)\\) \\{");
-            if(std::regex_match(line, base_match, base_regex) && base_match.ready()) {
-                auto header_string = base_match[1].str();
-                auto header_data = base_match[2].str();
-
+            } else {
+                // Headers with data
                 if(header_string == "Region") {
                     main_section = DFSection::REGION;
-                    region = header_data.substr(1, header_data.size() - 2);
+                    region = unquote(header_data);
                 } else if(header_string == "Vertices") {
                     main_section = DFSection::VERTICES;
-                    data_count = std::stoul(header_data);
+                    data_count = to_number(header_data);
+                    vertices.reserve(data_count);
                 } else if(header_string == "Edges") {
                     main_section = DFSection::EDGES;
-                    data_count = std::stoul(header_data);
+                    data_count = to_number(header_data);
+                    edges.reserve(data_count);
                 } else if(header_string == "Faces") {
                     main_section = DFSection::FACES;
-                    data_count = std::stoul(header_data);
+                    data_count = to_number(header_data);
+                    face_offsets.reserve(data_count + 1);
                 } else if(header_string == "Elements") {
                     if(main_section == DFSection::REGION) {
                         sub_section = DFSection::ELEMENTS;
                     } else {
                         main_section = DFSection::ELEMENTS;
                     }
-                    data_count = std::stoul(header_data);
+                    data_count = to_number(header_data);
+                    if(main_section == DFSection::ELEMENTS) {
+                        element_offsets.reserve(data_count + 1);
+                    } else {
+                        regions_elements[region].reserve(data_count);
+                    }
                 } else {
                     if(main_section != DFSection::NONE) {
                         sub_section = DFSection::IGNORED;
@@ -127,7 +196,7 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
         }
 
         // Look for close of section
-        if(line.find('}') != std::string::npos) {
+        if(line.find('}') != std::string_view::npos) {
             switch(main_section) {
             case DFSection::VERTICES:
                 if(vertices.size() != data_count) {
@@ -140,12 +209,12 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
                 }
                 break;
             case DFSection::FACES:
-                if(faces.size() != data_count) {
+                if(face_offsets.size() - 1 != data_count) {
                     throw std::runtime_error("incorrect number of faces");
                 }
                 break;
             case DFSection::ELEMENTS:
-                if(elements.size() != data_count) {
+                if(element_offsets.size() - 1 != data_count) {
                     throw std::runtime_error("incorrect number of elements");
                 }
                 break;
@@ -168,28 +237,25 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
         }
 
         // Look for key data pairs
-        if(line.find('=') != std::string::npos) {
-            auto base_regex = std::regex("([a-zA-Z]+)\\s+=\\s+([\\S ]+)");
-            std::smatch base_match;
-            if(std::regex_match(line, base_match, base_regex) && base_match.ready()) {
-                auto key = base_match[1].str();
-                auto value = allpix::trim(base_match[2].str());
-
+        if(line.find('=') != std::string_view::npos) {
+            std::string_view key;
+            std::string_view value;
+            if(parse_key_value(line, key, value)) {
                 // Filter correct electric field type
-                if(main_section == DFSection::INFO) {
-                    if(key == "dimension" && (std::stoul(value) != 3 && std::stoul(value) != 2)) {
+                if(main_section == DFSection::INFO && key == "dimension") {
+                    auto value_dimension = to_number(value);
+                    if(value_dimension == 3 || value_dimension == 2) {
+                        dimension = value_dimension;
+                    } else {
                         main_section = DFSection::IGNORED;
                     }
-                    if(key == "dimension" && (std::stoul(value) == 3 || std::stoul(value) == 2)) {
-                        dimension = std::stoul(value);
-                    }
                 }
             }
             continue;
         }
 
         // Handle data
-        std::stringstream sstr(line);
+        auto data = line;
         switch(main_section) {
         case DFSection::HEADER:
             if(line != "DF-ISE text") {
@@ -201,13 +267,13 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
             // Read vertex points
             if(dimension == 3) {
                 double x = 0, y = 0, z = 0;
-                while(sstr >> x >> y >> z) {
+                while(MappedFile::next(data, x) && MappedFile::next(data, y) && MappedFile::next(data, z)) {
                     vertices.emplace_back(x, y, z);
                 }
             }
             if(dimension == 2) {
                 double y = 0, z = 0;
-                while(sstr >> y >> z) {
+                while(MappedFile::next(data, y) && MappedFile::next(data, z)) {
                     vertices.emplace_back(y, z);
                 }
             }
@@ -215,7 +281,7 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
         case DFSection::EDGES: {
             // Read edges
             std::pair<long unsigned int, long unsigned int> edge;
-            while(sstr >> edge.first >> edge.second) {
+            while(MappedFile::next(data, edge.first) && MappedFile::next(data, edge.second)) {
                 if(edge.first >= vertices.size() || edge.second >= vertices.size()) {
                     throw std::runtime_error("vertex index is higher than number of vertices");
                 }
@@ -225,11 +291,11 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
         case DFSection::FACES: {
             // Get vertex indices for every face
             size_t n = 0;
-            sstr >> n;
-            std::vector<long unsigned int> face;
+            MappedFile::next(data, n);
+            face.clear();
             for(size_t i = 0; i < n; ++i) {
                 long edge_idx = 0;
-                sstr >> edge_idx;
+                MappedFile::next(data, edge_idx);
 
                 bool swap = false;
                 if(edge_idx < 0) {
@@ -253,6 +319,9 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
                 face.push_back(edge.first);
                 face.push_back(edge.second);
             }
+            if(face.empty()) {
+                throw std::runtime_error("face without edges");
+            }
 
             // Check first
             if(face.front() != face.back()) {
@@ -264,12 +333,12 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
             face.erase(iter, face.end());
             face.pop_back();
 
-            faces.push_back(face);
+            face_vertices.insert(face_vertices.end(), face.begin(), face.end());
+            face_offsets.push_back(face_vertices.size());
         } break;
         case DFSection::ELEMENTS: {
             int k = 0;
-            sstr >> k;
-            std::vector<long unsigned int> element;
+            MappedFile::next(data, k);
 
             size_t size = 0;
             switch(k) {
@@ -303,7 +372,7 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
 
             for(size_t i = 0; i < size; ++i) {
                 long element_idx = 0;
-                sstr >> element_idx;
+                MappedFile::next(data, element_idx);
 
                 bool reverse = false;
                 if(element_idx < 0) {
@@ -319,22 +388,29 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
                     if(reverse) {
                         std::swap(edge.first, edge.second);
                     }
-                    element.push_back(edge.first);
-                    element.push_back(edge.second);
+                    element_vertices.push_back(edge.first);
+                    element_vertices.push_back(edge.second);
                 }
                 if(size == 4) {
-                    if(element_idx >= static_cast<long>(faces.size())) {
+                    if(element_idx >= static_cast<long>(face_offsets.size() - 1)) {
                         throw std::runtime_error("face index is higher than number of faces");
                     }
-                    auto face = faces[static_cast<size_t>(element_idx)];
+                    auto face_idx = static_cast<size_t>(element_idx);
+                    auto face_begin = face_vertices.begin() + static_cast<long>(face_offsets[face_idx]);
+                    auto face_end = face_vertices.begin() + static_cast<long>(face_offsets[face_idx + 1]);
                     if(reverse) {
-                        std::reverse(face.begin() + 1, face.end());
+                        // Reversed faces keep their first vertex
+                        element_vertices.push_back(*face_begin);
+                        element_vertices.insert(element_vertices.end(),
+                                                std::make_reverse_iterator(face_end),
+                                                std::make_reverse_iterator(face_begin + 1));
+                    } else {
+                        element_vertices.insert(element_vertices.end(), face_begin, face_end);
                     }
-                    element.insert(element.end(), face.begin(), face.end());
                 }
             }
 
-            elements.push_back(element);
+            element_offsets.push_back(element_vertices.size());
             break;
         }
         case DFSection::REGION: {
@@ -342,13 +418,11 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
                 continue;
             }
             long unsigned int elem_idx = 0;
-            while(sstr >> elem_idx) {
-                if(elem_idx >= elements.size()) {
+            while(MappedFile::next(data, elem_idx)) {
+                if(elem_idx >= element_offsets.size() - 1) {
                     throw std::runtime_error("element index is higher than number of elements");
                 }
-
-                regions_vertices[region].insert(
-                    regions_vertices[region].end(), elements[elem_idx].begin(), elements[elem_idx].end());
+                regions_elements[region].push_back(elem_idx);
             }
 
         } break;
@@ -359,36 +433,69 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
     LOG_PROGRESS(STATUS, "gridlines") << "Parsing grid file: done.";
 
     std::map<std::string, std::vector<Point>> ret_map;
-    for(auto& name_region_vertices : regions_vertices) {
-        auto region_vertices = name_region_vertices.second;
-
-        std::sort(region_vertices.begin(), region_vertices.end());
-        auto iter = std::unique(region_vertices.begin(), region_vertices.end());
-        region_vertices.erase(iter, region_vertices.end());
-
+    region_elements_.clear();
+    std::vector<bool> vertex_used;
+    std::vector<long unsigned int> element;
+    for(auto& [name, element_indices] : regions_elements) {
+        // Collect the vertices of all elements in the region, sorted by their index
+        vertex_used.assign(vertices.size(), false);
+        for(auto& elem_idx : element_indices) {
+            for(auto i = element_offsets[elem_idx]; i < element_offsets[elem_idx + 1]; ++i) {
+                vertex_used[element_vertices[i]] = true;
+            }
+        }
+        std::vector<long unsigned int> region_vertices;
         std::vector<Point> ret_vector;
-        ret_vector.reserve(region_vertices.size());
-        for(auto& vertex_idx : region_vertices) {
-            ret_vector.push_back(vertices[vertex_idx]);
+        for(size_t vertex_idx = 0; vertex_idx < vertices.size(); ++vertex_idx) {
+            if(vertex_used[vertex_idx]) {
+                region_vertices.push_back(vertex_idx);
+                ret_vector.push_back(vertices[vertex_idx]);
+            }
         }
 
-        ret_map[name_region_vertices.first] = ret_vector;
+        ret_map[name] = std::move(ret_vector);
+
+        // Store the elements of the region with the indices of their vertices within the region
+        auto& region_elements = region_elements_[name];
+        size_t skipped = 0;
+        for(auto& elem_idx : element_indices) {
+            element.assign(element_vertices.begin() + static_cast<long>(element_offsets[elem_idx]),
+                           element_vertices.begin() + static_cast<long>(element_offsets[elem_idx + 1]));
+            std::sort(element.begin(), element.end());
+            element.erase(std::unique(element.begin(), element.end()), element.end());
+
+            // Only tetrahedra in 3D and triangles in 2D can be used for barycentric interpolation
+            if(element.size() != dimension + 1) {
+                skipped++;
+                continue;
+            }
+
+            ElementVertices region_element{};
+            for(size_t i = 0; i < element.size(); ++i) {
+                region_element[i] = static_cast<size_t>(
+                    std::lower_bound(region_vertices.begin(), region_vertices.end(), element[i]) - region_vertices.begin());
+            }
+            if(dimension == 2) {
+                region_element[3] = region_element[0];
+            }
+            region_elements.push_back(region_element);
+        }
+        if(skipped > 0) {
+            LOG(INFO) << "Ignoring " << skipped << " elements of region \"" << name
+                      << "\" which are neither tetrahedra nor triangles";
+        }
     }
 
     return ret_map;
 }
 
-FieldMap DFISEParser::read_fields(const std::string& file_name, const std::string&) {
-    std::ifstream file(file_name);
-    if(!file) {
-        throw std::runtime_error("file cannot be accessed");
-    }
+ElementMap DFISEParser::read_elements(const std::string&) {
+    return region_elements_;
+}
 
-    // Get the total number of lines to parse and reset file to the start:
-    auto num_lines = std::count(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>(), '\n');
-    file.clear();
-    file.seekg(0, std::ios::beg);
-    LOG(DEBUG) << "Field data file contains " << num_lines << " lines to parse";
+FieldMap DFISEParser::read_fields(const std::string& file_name, const std::string&) {
+    MappedFile file(file_name, true);
+    LOG(DEBUG) << "Field data file contains " << file.size() << " bytes to parse";
 
     DFSection main_section = DFSection::HEADER;
     DFSection sub_section = DFSection::NONE;
@@ -403,14 +510,11 @@ FieldMap DFISEParser::read_fields(const std::string& file_name, const std::strin
     long unsigned int data_count = 0;
     bool in_data_block = false;
     long long num_lines_parsed = 0;
-    while(!file.eof()) {
-        std::string line;
-        std::getline(file, line);
-        line = allpix::trim(line);
-
+    std::string_view line;
+    while(file.getLine(line)) {
         // Log the parsing progress:
-        if(num_lines > 0 && num_lines_parsed % 1000 == 0) {
-            LOG_PROGRESS(STATUS, "fieldlines") << "Parsing field data file: " << (100 * num_lines_parsed / num_lines) << "%";
+        if(num_lines_parsed % 1000 == 0) {
+            LOG_PROGRESS(STATUS, "fieldlines") << "Parsing field data file: " << file.progress() << "%";
         }
         num_lines_parsed++;
 
@@ -419,12 +523,15 @@ FieldMap DFISEParser::read_fields(const std::string& file_name, const std::strin
         }
 
         // Check if line with begin of section
-        if(line.find('{') != std::string::npos) {
-            // Search for new simple headers
-            auto base_regex = std::regex("([a-zA-Z]+) \\{");
-            std::smatch base_match;
-            if(std::regex_match(line, base_match, base_regex) && base_match.ready()) {
-                auto header_string = base_match[1].str();
+        if(line.find('{') != std::string_view::npos) {
+            std::string_view header_string;
+            std::string_view header_data;
+            if(!parse_header(line, header_string, header_data)) {
+                continue;
+            }
+
+            if(header_data.empty()) {
+                // Simple headers
                 LOG(TRACE) << "Opening section " << header_string;
 
                 if(header_string == "Info") {
@@ -438,16 +545,10 @@ FieldMap DFISEParser::read_fields(const std::string& file_name, const std::strin
                         main_section = DFSection::IGNORED;
                     }
                 }
-            }
-
-            // Search for headers with data
-            base_regex = std::regex("([a-zA-Z]+) \\((\\S+)\\) \\{");
-            if(std::regex_match(line, base_match, base_regex) && base_match.ready()) {
-                auto header_string = base_match[1].str();
-                auto header_data = base_match[2].str();
-
+            } else {
+                // Headers with data
                 if(header_string == "Dataset") {
-                    std::string data_type = header_data.substr(1, header_data.size() - 2);
+                    auto data_type = unquote(header_data);
                     LOG(DEBUG) << "Opening dataset of type " << data_type;
 
                     if(data_type == "ElectricField") {
@@ -466,7 +567,8 @@ FieldMap DFISEParser::read_fields(const std::string& file_name, const std::strin
                 } else if(header_string == "Values") {
                     LOG(DEBUG) << "Opening value section with " << header_data << " entries";
                     sub_section = DFSection::VALUES;
-                    data_count = std::stoul(header_data);
+                    data_count = to_number(header_data);
+                    region_electric_field_num.reserve(data_count);
                 } else {
                     if(main_section != DFSection::NONE) {
                         sub_section = DFSection::IGNORED;
@@ -480,25 +582,29 @@ FieldMap DFISEParser::read_fields(const std::string& file_name, const std::strin
         }
 
         // Look for key data pairs
-        if(line.find('=') != std::string::npos) {
-            auto base_regex = std::regex("([a-zA-Z]+)\\s+=\\s+([\\S ]+)");
-            std::smatch base_match;
-            if(std::regex_match(line, base_match, base_regex) && base_match.ready()) {
-                auto key = base_match[1].str();
-                auto value = allpix::trim(base_match[2].str());
-
-                // Regular expression for matching validity region:
-                base_regex = std::regex("\\[\\s+\"([-\\w\\.]+)\"\\s+\\]");
+        if(line.find('=') != std::string_view::npos) {
+            std::string_view key;
+            std::string_view value;
+            if(parse_key_value(line, key, value)) {
                 if(key == "validity") {
                     // Ignore any electric field valid for multiple regions
-                    if(std::regex_match(value, base_match, base_regex) && base_match.ready()) {
-                        region = base_match[1].str();
+                    auto validity = value;
+                    if(validity.size() >= 2 && validity.front() == '[' && validity.back() == ']') {
+                        validity = MappedFile::trim(validity.substr(1, validity.size() - 2));
+                    }
+                    if(validity.size() > 2 && validity.front() == '"' && validity.back() == '"' &&
+                       validity.find('"', 1) == validity.size() - 1) {
+                        region = unquote(validity);
                     } else {
                         LOG(INFO) << "Could not determine validity region for string \"" << value << "\", ignoring.";
                         main_section = DFSection::IGNORED;
                     }
                 }
 
+                // Dimensions which are not a number are not supported and ignored below
+                long unsigned int value_number = 0;
+                MappedFile::parse(value, value_number);
+
                 // Only use vertex locations:
                 if(key == "location" && value != "vertex") {
                     main_section = DFSection::IGNORED;
@@ -510,10 +616,10 @@ FieldMap DFISEParser::read_fields(const std::string& file_name, const std::strin
                     if(key == "type" && value != "vector") {
                         main_section = DFSection::IGNORED;
                     }
-                    if(key == "dimension" && (std::stoul(value) == 3 || std::stoul(value) == 2)) {
-                        dimension = std::stoul(value);
+                    if(key == "dimension" && (value_number == 3 || value_number == 2)) {
+                        dimension = value_number;
                     }
-                    if(key == "dimension" && (std::stoul(value) != 3 && std::stoul(value) != 2)) {
+                    if(key == "dimension" && (value_number != 3 && value_number != 2)) {
                         main_section = DFSection::IGNORED;
                     }
                 }
@@ -524,10 +630,10 @@ FieldMap DFISEParser::read_fields(const std::string& file_name, const std::strin
                     if(key == "type" && value != "scalar") {
                         main_section = DFSection::IGNORED;
                     }
-                    if(key == "dimension" && std::stoul(value) == 1) {
-                        dimension = std::stoul(value);
+                    if(key == "dimension" && value_number == 1) {
+                        dimension = value_number;
                     }
-                    if(key == "dimension" && std::stoul(value) != 1) {
+                    if(key == "dimension" && value_number != 1) {
                         main_section = DFSection::IGNORED;
                     }
                 }
@@ -537,10 +643,10 @@ FieldMap DFISEParser::read_fields(const std::string& file_name, const std::strin
                     if(key == "type" && value != "scalar") {
                         main_section = DFSection::IGNORED;
                     }
-                    if(key == "dimension" && std::stoul(value) == 1) {
-                        dimension = std::stoul(value);
+                    if(key == "dimension" && value_number == 1) {
+                        dimension = value_number;
                     }
-                    if(key == "dimension" && std::stoul(value) != 1) {
+                    if(key == "dimension" && value_number != 1) {
                         main_section = DFSection::IGNORED;
                     }
                 }
@@ -551,10 +657,10 @@ FieldMap DFISEParser::read_fields(const std::string& file_name, const std::strin
                     if(key == "type" && value != "scalar") {
                         main_section = DFSection::IGNORED;
                     }
-                    if(key == "dimension" && std::stoul(value) == 1) {
-                        dimension = std::stoul(value);
+                    if(key == "dimension" && value_number == 1) {
+                        dimension = value_number;
                     }
-                    if(key == "dimension" && std::stoul(value) != 1) {
+                    if(key == "dimension" && value_number != 1) {
                         main_section = DFSection::IGNORED;
                     }
                 }
@@ -565,10 +671,10 @@ FieldMap DFISEParser::read_fields(const std::string& file_name, const std::strin
                     if(key == "type" && value != "scalar") {
                         main_section = DFSection::IGNORED;
                     }
-                    if(key == "dimension" && std::stoul(value) == 1) {
-                        dimension = std::stoul(value);
+                    if(key == "dimension" && value_number == 1) {
+                        dimension = value_number;
                     }
-                    if(key == "dimension" && std::stoul(value) != 1) {
+                    if(key == "dimension" && value_number != 1) {
                         main_section = DFSection::IGNORED;
                     }
                 }
@@ -577,7 +683,7 @@ FieldMap DFISEParser::read_fields(const std::string& file_name, const std::strin
         }
 
         // Look for close of section
-        if(line.find('}') != std::string::npos) {
+        if(line.find('}') != std::string_view::npos) {
 
             if(main_section == DFSection::ELECTROSTATIC_POTENTIAL && sub_section == DFSection::VALUES) {
                 if(data_count != region_electric_field_num.size()) {
@@ -675,9 +781,9 @@ FieldMap DFISEParser::read_fields(const std::string& file_name, const std::strin
             main_section == DFSection::DOPING_CONCENTRATION || main_section == DFSection::DONOR_CONCENTRATION ||
             main_section == DFSection::ACCEPTOR_CONCENTRATION) &&
            sub_section == DFSection::VALUES) {
-            std::stringstream sstr(line);
+            auto data = line;
             double num = NAN;
-            while(sstr >> num) {
+            while(MappedFile::next(data, num)) {
                 region_electric_field_num.push_back(num);
             }
         }
@@ -47,6 +47,12 @@ namespace mesh_converter {
 
         // Read the electric field
         FieldMap read_fields(const std::string& file_name, const std::string& observable) override;
+
+        // Return the elements stored while reading the grid
+        ElementMap read_elements(const std::string& file_name) override;
+
+        // Elements of all regions found while reading the grid
+        ElementMap region_elements_;
     };
 } // namespace mesh_converter
 